@@ -0,0 +1,401 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(_POSIX_THREADS) && (_POSIX_THREADS > 0)
+#include <pthread.h>
+#define kAnytimeHasReaderThread	1
+#else
+#define kAnytimeHasReaderThread	0
+#endif
+#include "anytime-batch.h"
+#include "utilities.h"
+
+/*
+ *	Weight of the newest measurement in the moving average of the throughput.
+ */
+static const double	kAnytimeThroughputSmoothing = 0.25;
+
+typedef struct
+{
+	BatchReading	reading;
+	double		arrivalSeconds;
+} AnytimeQueueEntry;
+
+struct AnytimeQueue
+{
+	FILE *			file;
+	AnytimeQueueEntry *	entries;
+	size_t			capacity;
+	size_t			head;
+	size_t			count;
+	uint64_t		nextSequenceNumber;
+	size_t			lineNumber;
+	bool			isEndOfInput;
+	bool			hasError;
+#if kAnytimeHasReaderThread
+	pthread_mutex_t		mutex;
+	pthread_cond_t		isNotEmpty;
+	pthread_t		readerThread;
+#endif
+};
+
+double
+anytimeGetTimeSeconds(void)
+{
+#if defined(CLOCK_MONOTONIC)
+	struct timespec	now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (double)now.tv_sec + 1e-9 * (double)now.tv_nsec;
+#else
+	return ((double)clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+void
+anytimeBudgetInit(
+	AnytimeBudget *	budget,
+	double		latencyTargetSeconds,
+	uint64_t	minimumSamplesPerReading,
+	uint64_t	maximumSamplesPerReading,
+	double		initialSamplesPerSecond)
+{
+	budget->latencyTargetSeconds = latencyTargetSeconds;
+	budget->samplesPerSecond = initialSamplesPerSecond;
+	budget->minimumSamplesPerReading = minimumSamplesPerReading;
+	budget->maximumSamplesPerReading = (maximumSamplesPerReading > minimumSamplesPerReading) ? maximumSamplesPerReading : minimumSamplesPerReading;
+
+	return;
+}
+
+uint64_t
+anytimeBudgetGetSamplesPerReading(
+	const AnytimeBudget *	budget,
+	size_t			numberOfPendingReadings,
+	double			oldestArrivalSeconds,
+	double			nowSeconds)
+{
+	double	remainingSeconds = oldestArrivalSeconds + budget->latencyTargetSeconds - nowSeconds;
+	double	samplesPerReading;
+
+	if ((remainingSeconds <= 0.0) || (numberOfPendingReadings == 0))
+	{
+		return budget->minimumSamplesPerReading;
+	}
+
+	samplesPerReading = remainingSeconds * budget->samplesPerSecond / (double)numberOfPendingReadings;
+	if (samplesPerReading <= (double)budget->minimumSamplesPerReading)
+	{
+		return budget->minimumSamplesPerReading;
+	}
+	if (samplesPerReading >= (double)budget->maximumSamplesPerReading)
+	{
+		return budget->maximumSamplesPerReading;
+	}
+
+	return (uint64_t)samplesPerReading;
+}
+
+void
+anytimeBudgetUpdate(AnytimeBudget *  budget, uint64_t numberOfSamples, double elapsedSeconds)
+{
+	if ((numberOfSamples == 0) || (elapsedSeconds <= 0.0))
+	{
+		return;
+	}
+
+	budget->samplesPerSecond += kAnytimeThroughputSmoothing * ((double)numberOfSamples / elapsedSeconds - budget->samplesPerSecond);
+
+	return;
+}
+
+void
+anytimeMergeSummaries(BatchReadingSummary *  summaries, const BatchReadingSummary *  otherSummaries, size_t numberOfReadings)
+{
+	for (size_t reading = 0; reading < numberOfReadings; reading++)
+	{
+		BatchReadingSummary *		summary = &summaries[reading];
+		const BatchReadingSummary *	other = &otherSummaries[reading];
+		double				n = (double)summary->numberOfSamples;
+		double				m = (double)other->numberOfSamples;
+		double				total = n + m;
+
+		if (other->numberOfSamples == 0)
+		{
+			continue;
+		}
+
+		for (size_t output = 0; output < kOutputDistributionIndexMax; output++)
+		{
+			double	delta = other->mean[output] - summary->mean[output];
+			double	sumOfSquaredDeviations = (n - 1.0) * summary->variance[output]
+							+ (m - 1.0) * other->variance[output]
+							+ delta * delta * n * m / total;
+
+			summary->mean[output] += delta * m / total;
+			summary->variance[output] = (total > 1.0) ? fmax(0.0, sumOfSquaredDeviations / (total - 1.0)) : 0.0;
+			summary->minimum[output] = fmin(summary->minimum[output], other->minimum[output]);
+			summary->maximum[output] = fmax(summary->maximum[output], other->maximum[output]);
+		}
+		summary->numberOfSamples += other->numberOfSamples;
+	}
+
+	return;
+}
+
+/*
+ *	Reads lines until one holds a reading, or the input ends. Returns `false` at the end of
+ *	the input or on an error, which is recorded in the queue.
+ */
+static bool
+readNextReading(AnytimeQueue *  queue, AnytimeQueueEntry *  entry)
+{
+	char	line[1024];
+	bool	isReading = false;
+
+	while (!isReading)
+	{
+		if (fgets(line, sizeof(line), queue->file) == NULL)
+		{
+			if (ferror(queue->file))
+			{
+				fprintf(stderr, "Error: Could not read the input.\n");
+				queue->hasError = true;
+			}
+
+			return false;
+		}
+		queue->lineNumber++;
+
+		if (parseBatchReadingFromCSVLine(line, &entry->reading, &isReading) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: Line %zu of the input has fewer than %d values.\n", queue->lineNumber, kInputDistributionIndexMax);
+			queue->hasError = true;
+
+			return false;
+		}
+	}
+
+	entry->arrivalSeconds = anytimeGetTimeSeconds();
+	entry->reading.sequenceNumber = queue->nextSequenceNumber++;
+
+	return true;
+}
+
+/*
+ *	Appends an entry, moving the queued entries to the front or growing the array when the
+ *	end is reached.
+ */
+static bool
+pushEntry(AnytimeQueue *  queue, const AnytimeQueueEntry *  entry)
+{
+	if (queue->head + queue->count == queue->capacity)
+	{
+		if (queue->head > 0)
+		{
+			memmove(queue->entries, &queue->entries[queue->head], queue->count * sizeof(AnytimeQueueEntry));
+			queue->head = 0;
+		}
+		else
+		{
+			size_t			newCapacity = (queue->capacity == 0) ? 1024 : 2 * queue->capacity;
+			AnytimeQueueEntry *	newEntries = realloc(queue->entries, newCapacity * sizeof(AnytimeQueueEntry));
+
+			if (newEntries == NULL)
+			{
+				fprintf(stderr, "Error: Could not allocate memory for the queued readings.\n");
+				queue->hasError = true;
+
+				return false;
+			}
+			queue->entries = newEntries;
+			queue->capacity = newCapacity;
+		}
+	}
+
+	queue->entries[queue->head + queue->count++] = *entry;
+
+	return true;
+}
+
+#if kAnytimeHasReaderThread
+static void *
+readerThreadMain(void *  argument)
+{
+	AnytimeQueue *		queue = argument;
+	AnytimeQueueEntry	entry;
+	bool			isQueued = true;
+	int			previousCancelState;
+
+	while (isQueued)
+	{
+		/*
+		 *	The thread is only cancelled while it waits for input, never while it holds the mutex.
+		 */
+		bool	isRead = readNextReading(queue, &entry);
+
+		pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &previousCancelState);
+		pthread_mutex_lock(&queue->mutex);
+		isQueued = isRead && pushEntry(queue, &entry);
+		queue->isEndOfInput = !isQueued;
+		pthread_cond_signal(&queue->isNotEmpty);
+		pthread_mutex_unlock(&queue->mutex);
+		pthread_setcancelstate(previousCancelState, NULL);
+	}
+
+	return NULL;
+}
+#endif
+
+CommonConstantReturnType
+anytimeQueueOpen(AnytimeQueue **  queue, const char *  filePath)
+{
+	AnytimeQueue *	newQueue = calloc(1, sizeof(AnytimeQueue));
+	bool		isStandardInput = (strcmp(filePath, "-") == 0);
+
+	if (newQueue == NULL)
+	{
+		fprintf(stderr, "Error: Could not allocate memory for the reading queue.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	newQueue->file = isStandardInput ? stdin : fopen(filePath, "r");
+	if (newQueue->file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open the input file \"%s\".\n", filePath);
+		free(newQueue);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+#if kAnytimeHasReaderThread
+	pthread_mutex_init(&newQueue->mutex, NULL);
+	pthread_cond_init(&newQueue->isNotEmpty, NULL);
+	if (pthread_create(&newQueue->readerThread, NULL, readerThreadMain, newQueue) != 0)
+	{
+		fprintf(stderr, "Error: Could not start the input reader thread.\n");
+		pthread_cond_destroy(&newQueue->isNotEmpty);
+		pthread_mutex_destroy(&newQueue->mutex);
+		if (!isStandardInput)
+		{
+			fclose(newQueue->file);
+		}
+		free(newQueue);
+
+		return kCommonConstantReturnTypeError;
+	}
+#endif
+
+	*queue = newQueue;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+anytimeQueueTake(
+	AnytimeQueue *	queue,
+	BatchReading *	readings,
+	double *	arrivalSeconds,
+	size_t		maximumNumberOfReadings,
+	size_t *	numberOfReadings,
+	size_t *	numberOfPendingReadings)
+{
+	size_t	count;
+	bool	hasError;
+
+#if kAnytimeHasReaderThread
+	pthread_mutex_lock(&queue->mutex);
+	while ((queue->count == 0) && !queue->isEndOfInput)
+	{
+		pthread_cond_wait(&queue->isNotEmpty, &queue->mutex);
+	}
+#else
+	/*
+	 *	Without a reader thread, only the reading that has just been read is pending.
+	 */
+	if ((queue->count == 0) && !queue->isEndOfInput)
+	{
+		AnytimeQueueEntry	entry;
+
+		queue->isEndOfInput = !(readNextReading(queue, &entry) && pushEntry(queue, &entry));
+	}
+#endif
+
+	count = (queue->count < maximumNumberOfReadings) ? queue->count : maximumNumberOfReadings;
+	*numberOfPendingReadings = queue->count;
+	for (size_t i = 0; i < count; i++)
+	{
+		readings[i] = queue->entries[queue->head + i].reading;
+		arrivalSeconds[i] = queue->entries[queue->head + i].arrivalSeconds;
+	}
+	queue->head += count;
+	queue->count -= count;
+	hasError = queue->hasError && (count == 0);
+
+#if kAnytimeHasReaderThread
+	pthread_mutex_unlock(&queue->mutex);
+#endif
+
+	*numberOfReadings = count;
+
+	return hasError ? kCommonConstantReturnTypeError : kCommonConstantReturnTypeSuccess;
+}
+
+void
+anytimeQueueClose(AnytimeQueue *  queue)
+{
+#if kAnytimeHasReaderThread
+	bool	isEndOfInput;
+
+	pthread_mutex_lock(&queue->mutex);
+	isEndOfInput = queue->isEndOfInput;
+	pthread_mutex_unlock(&queue->mutex);
+
+	/*
+	 *	A reader still waiting for input is cancelled, so that closing does not block.
+	 */
+	if (!isEndOfInput)
+	{
+		pthread_cancel(queue->readerThread);
+	}
+	pthread_join(queue->readerThread, NULL);
+	pthread_cond_destroy(&queue->isNotEmpty);
+	pthread_mutex_destroy(&queue->mutex);
+#endif
+
+	if (queue->file != stdin)
+	{
+		fclose(queue->file);
+	}
+	free(queue->entries);
+	free(queue);
+
+	return;
+}
@@ -0,0 +1,145 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "batch-engine.h"
+#include "common.h"
+
+/*
+ *	Sample budget of anytime batch mode. The budget per reading is the time left until the
+ *	latency target of the oldest pending reading, times the measured throughput, shared
+ *	among all pending readings, so that the samples per reading fall as the queue grows
+ *	and rise again as it drains. `samplesPerSecond` is an exponentially-weighted moving
+ *	average of the throughput of the batch engine.
+ */
+typedef struct
+{
+	double		latencyTargetSeconds;
+	double		samplesPerSecond;
+	uint64_t	minimumSamplesPerReading;
+	uint64_t	maximumSamplesPerReading;
+} AnytimeBudget;
+
+/*
+ *	Queue of readings that a reader thread parses from the input as they arrive, each
+ *	tagged with its arrival time. Private to the anytime batch module.
+ */
+typedef struct AnytimeQueue	AnytimeQueue;
+
+/**
+ *	@brief	Gets the time from a monotonic clock.
+ *
+ *	@return	: The time in seconds, from an arbitrary origin.
+ */
+double	anytimeGetTimeSeconds(void);
+
+/**
+ *	@brief	Initializes a sample budget.
+ *
+ *	@param	budget				: Pointer to the budget.
+ *	@param	latencyTargetSeconds		: Target time from the arrival of a reading to the output of its summary.
+ *	@param	minimumSamplesPerReading	: The fewest samples per reading, even when the target is missed.
+ *	@param	maximumSamplesPerReading	: The most samples per reading, even when the queue is empty.
+ *	@param	initialSamplesPerSecond		: The throughput assumed until the first measurement.
+ */
+void	anytimeBudgetInit(
+		AnytimeBudget *	budget,
+		double		latencyTargetSeconds,
+		uint64_t	minimumSamplesPerReading,
+		uint64_t	maximumSamplesPerReading,
+		double		initialSamplesPerSecond);
+
+/**
+ *	@brief	Gets the number of samples per reading for the readings at the head of the queue.
+ *
+ *	@param	budget				: Pointer to the budget.
+ *	@param	numberOfPendingReadings		: The number of readings waiting for their summaries, including those about to be evaluated.
+ *	@param	oldestArrivalSeconds		: The arrival time of the oldest pending reading.
+ *	@param	nowSeconds			: The current time.
+ *	@return					: The number of samples per reading.
+ */
+uint64_t	anytimeBudgetGetSamplesPerReading(
+			const AnytimeBudget *	budget,
+			size_t			numberOfPendingReadings,
+			double			oldestArrivalSeconds,
+			double			nowSeconds);
+
+/**
+ *	@brief	Updates the measured throughput with one evaluation.
+ *
+ *	@param	budget			: Pointer to the budget.
+ *	@param	numberOfSamples		: The total number of samples of the evaluation, over all its readings.
+ *	@param	elapsedSeconds		: The wall-clock time of the evaluation.
+ */
+void	anytimeBudgetUpdate(AnytimeBudget *  budget, uint64_t numberOfSamples, double elapsedSeconds);
+
+/**
+ *	@brief	Merges the summaries of independent sample sets of the same readings, with the
+ *		pairwise update of the mean and variance of Chan et al.
+ *
+ *	@param	summaries		: Array of summaries, updated in place.
+ *	@param	otherSummaries		: Array of the summaries of further samples of the same readings.
+ *	@param	numberOfReadings	: The number of readings.
+ */
+void	anytimeMergeSummaries(BatchReadingSummary *  summaries, const BatchReadingSummary *  otherSummaries, size_t numberOfReadings);
+
+/**
+ *	@brief	Opens the input and starts the reader thread. Without POSIX threads, the input is
+ *		read on demand in `anytimeQueueTake()` instead.
+ *
+ *	@param	queue		: Pointer where the dynamically-allocated queue is returned.
+ *	@param	filePath	: Path of the CSV input, in the format of `readBatchReadingsFromCSVFile()`, or `-` for the standard input.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	anytimeQueueOpen(AnytimeQueue **  queue, const char *  filePath);
+
+/**
+ *	@brief	Takes the oldest readings from the queue, waiting until at least one has arrived
+ *		or the input has ended. Readings are numbered in order of arrival.
+ *
+ *	@param	queue				: Pointer to the queue.
+ *	@param	readings			: Array where up to `maximumNumberOfReadings` readings are returned.
+ *	@param	arrivalSeconds			: Array where the arrival times of the readings are returned.
+ *	@param	maximumNumberOfReadings		: The most readings to take.
+ *	@param	numberOfReadings		: Pointer where the number of readings taken is returned, zero at the end of the input.
+ *	@param	numberOfPendingReadings		: Pointer where the number of readings taken plus those still queued is returned.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`
+ *						  if the input could not be read or parsed.
+ */
+CommonConstantReturnType	anytimeQueueTake(
+					AnytimeQueue *	queue,
+					BatchReading *	readings,
+					double *	arrivalSeconds,
+					size_t		maximumNumberOfReadings,
+					size_t *	numberOfReadings,
+					size_t *	numberOfPendingReadings);
+
+/**
+ *	@brief	Stops the reader thread, closes the input and frees the queue.
+ *
+ *	@param	queue	: Pointer to the queue.
+ */
+void	anytimeQueueClose(AnytimeQueue *  queue);
@@ -0,0 +1,593 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arrow-ipc.h"
+
+/*
+ *	Constants of the Arrow columnar format specification (Schema.fbs, Message.fbs, File.fbs).
+ */
+typedef enum
+{
+	kArrowIPCMetadataVersionV5		= 4,
+	kArrowIPCMessageHeaderSchema		= 1,
+	kArrowIPCMessageHeaderRecordBatch	= 3,
+	kArrowIPCTypeFloatingPoint		= 3,
+	kArrowIPCPrecisionDouble		= 2,
+	kArrowIPCEndiannessLittle		= 0,
+	kArrowIPCBufferAlignment		= 64,
+	kArrowIPCMaxFieldsPerTable		= 8,
+	kArrowIPCBlockSize			= 24,
+	kArrowIPCFieldNodeSize			= 16,
+	kArrowIPCBufferDescriptorSize		= 16,
+	kArrowIPCContinuationMarker		= -1,
+} ArrowIPCConstant;
+
+static const char	kArrowIPCFileMagic[8] = {'A', 'R', 'R', 'O', 'W', '1', 0, 0};
+
+/*
+ *	Minimal FlatBuffers builder. Like the reference implementation it fills the buffer
+ *	back to front, so every object is referenced by its distance from the end of the
+ *	buffer (`FlatBufferReference`) and child objects are always created before their
+ *	parents.
+ */
+typedef uint32_t	FlatBufferReference;
+
+typedef struct
+{
+	uint8_t *		buffer;
+	size_t			capacity;
+	size_t			size;
+	size_t			tableStart;
+	size_t			numberOfTableFields;
+	FlatBufferReference	tableFields[kArrowIPCMaxFieldsPerTable];
+	int			hasError;
+} FlatBufferBuilder;
+
+static void
+flatBufferReserve(FlatBufferBuilder *  builder, size_t numberOfBytes)
+{
+	size_t		newCapacity;
+	uint8_t *	newBuffer;
+
+	if (builder->size + numberOfBytes <= builder->capacity)
+	{
+		return;
+	}
+
+	newCapacity = (builder->capacity == 0) ? 1024 : builder->capacity;
+	while (builder->size + numberOfBytes > newCapacity)
+	{
+		newCapacity *= 2;
+	}
+
+	newBuffer = calloc(newCapacity, 1);
+	if (newBuffer == NULL)
+	{
+		builder->hasError = 1;
+
+		return;
+	}
+
+	if (builder->buffer != NULL)
+	{
+		memcpy(newBuffer + newCapacity - builder->size, builder->buffer + builder->capacity - builder->size, builder->size);
+		free(builder->buffer);
+	}
+
+	builder->buffer = newBuffer;
+	builder->capacity = newCapacity;
+
+	return;
+}
+
+/*
+ *	Pads so that, after `numberOfBytes` more bytes are prepended, the size is a multiple of `alignment`.
+ */
+static void
+flatBufferPreAlign(FlatBufferBuilder *  builder, size_t numberOfBytes, size_t alignment)
+{
+	size_t	padding = (alignment - ((builder->size + numberOfBytes) % alignment)) % alignment;
+
+	flatBufferReserve(builder, padding + numberOfBytes);
+	if (builder->hasError)
+	{
+		return;
+	}
+
+	memset(builder->buffer + builder->capacity - builder->size - padding, 0, padding);
+	builder->size += padding;
+
+	return;
+}
+
+static void
+flatBufferPrependBytes(FlatBufferBuilder *  builder, const void *  bytes, size_t numberOfBytes, size_t alignment)
+{
+	flatBufferPreAlign(builder, numberOfBytes, alignment);
+	if (builder->hasError)
+	{
+		return;
+	}
+
+	builder->size += numberOfBytes;
+	memcpy(builder->buffer + builder->capacity - builder->size, bytes, numberOfBytes);
+
+	return;
+}
+
+/*
+ *	FlatBuffers and Arrow are little-endian. The scalar helpers below serialize explicitly so
+ *	that the writer is also correct on big-endian hosts.
+ */
+static void
+flatBufferPrependUnsigned(FlatBufferBuilder *  builder, uint64_t value, size_t numberOfBytes)
+{
+	uint8_t	bytes[8];
+
+	for (size_t i = 0; i < numberOfBytes; i++)
+	{
+		bytes[i] = (uint8_t)(value >> (8 * i));
+	}
+
+	flatBufferPrependBytes(builder, bytes, numberOfBytes, numberOfBytes);
+
+	return;
+}
+
+static FlatBufferReference
+flatBufferPrependOffset(FlatBufferBuilder *  builder, FlatBufferReference target)
+{
+	flatBufferPreAlign(builder, 4, 4);
+	flatBufferPrependUnsigned(builder, (uint32_t)(builder->size + 4 - target), 4);
+
+	return (FlatBufferReference)builder->size;
+}
+
+static FlatBufferReference
+flatBufferCreateString(FlatBufferBuilder *  builder, const char *  string)
+{
+	size_t	length = strlen(string);
+
+	flatBufferPreAlign(builder, length + 1, 4);
+	flatBufferPrependBytes(builder, "", 1, 1);
+	flatBufferPrependBytes(builder, string, length, 1);
+	flatBufferPrependUnsigned(builder, length, 4);
+
+	return (FlatBufferReference)builder->size;
+}
+
+static FlatBufferReference
+flatBufferCreateOffsetVector(FlatBufferBuilder *  builder, const FlatBufferReference *  elements, size_t numberOfElements)
+{
+	flatBufferPreAlign(builder, 4 * numberOfElements, 4);
+	for (size_t i = numberOfElements; i > 0; i--)
+	{
+		flatBufferPrependOffset(builder, elements[i - 1]);
+	}
+	flatBufferPrependUnsigned(builder, numberOfElements, 4);
+
+	return (FlatBufferReference)builder->size;
+}
+
+/*
+ *	Creates a vector of structs made of `int64` members, e.g., `FieldNode` or `Buffer`.
+ */
+static FlatBufferReference
+flatBufferCreateInt64StructVector(
+	FlatBufferBuilder *	builder,
+	const int64_t *		members,
+	size_t			numberOfMembersPerStruct,
+	size_t			numberOfStructs)
+{
+	size_t	numberOfMembers = numberOfMembersPerStruct * numberOfStructs;
+
+	flatBufferPreAlign(builder, 8 * numberOfMembers, 4);
+	flatBufferPreAlign(builder, 8 * numberOfMembers, 8);
+	for (size_t i = numberOfMembers; i > 0; i--)
+	{
+		flatBufferPrependUnsigned(builder, (uint64_t)members[i - 1], 8);
+	}
+	flatBufferPrependUnsigned(builder, numberOfStructs, 4);
+
+	return (FlatBufferReference)builder->size;
+}
+
+static void
+flatBufferStartTable(FlatBufferBuilder *  builder)
+{
+	builder->tableStart = builder->size;
+	builder->numberOfTableFields = 0;
+
+	return;
+}
+
+/*
+ *	Records that the last prepended value is table field number `fieldIndex`.
+ */
+static void
+flatBufferTableField(FlatBufferBuilder *  builder, size_t fieldIndex)
+{
+	for (size_t i = builder->numberOfTableFields; i <= fieldIndex; i++)
+	{
+		builder->tableFields[i] = 0;
+	}
+
+	if (fieldIndex >= builder->numberOfTableFields)
+	{
+		builder->numberOfTableFields = fieldIndex + 1;
+	}
+	builder->tableFields[fieldIndex] = (FlatBufferReference)builder->size;
+
+	return;
+}
+
+static void
+flatBufferAddScalar(FlatBufferBuilder *  builder, size_t fieldIndex, uint64_t value, size_t numberOfBytes)
+{
+	flatBufferPrependUnsigned(builder, value, numberOfBytes);
+	flatBufferTableField(builder, fieldIndex);
+
+	return;
+}
+
+static void
+flatBufferAddOffset(FlatBufferBuilder *  builder, size_t fieldIndex, FlatBufferReference target)
+{
+	flatBufferPrependOffset(builder, target);
+	flatBufferTableField(builder, fieldIndex);
+
+	return;
+}
+
+static FlatBufferReference
+flatBufferEndTable(FlatBufferBuilder *  builder)
+{
+	FlatBufferReference	table;
+	FlatBufferReference	vtable;
+
+	/*
+	 *	Placeholder for the signed offset from the table to its vtable.
+	 */
+	flatBufferPrependUnsigned(builder, 0, 4);
+	table = (FlatBufferReference)builder->size;
+
+	for (size_t i = builder->numberOfTableFields; i > 0; i--)
+	{
+		FlatBufferReference	field = builder->tableFields[i - 1];
+
+		flatBufferPrependUnsigned(builder, (field == 0) ? 0 : (table - field), 2);
+	}
+	flatBufferPrependUnsigned(builder, table - builder->tableStart, 2);
+	flatBufferPrependUnsigned(builder, 2 * (builder->numberOfTableFields + 2), 2);
+	vtable = (FlatBufferReference)builder->size;
+
+	if (!builder->hasError)
+	{
+		uint8_t *	tableBytes = builder->buffer + builder->capacity - table;
+		uint32_t	vtableOffset = vtable - table;
+
+		for (size_t i = 0; i < 4; i++)
+		{
+			tableBytes[i] = (uint8_t)(vtableOffset >> (8 * i));
+		}
+	}
+
+	return table;
+}
+
+/*
+ *	Finishes the buffer and returns its size, which is a multiple of eight bytes.
+ */
+static size_t
+flatBufferFinish(FlatBufferBuilder *  builder, FlatBufferReference root)
+{
+	flatBufferPreAlign(builder, 4, 8);
+	flatBufferPrependOffset(builder, root);
+
+	return builder->size;
+}
+
+static const uint8_t *
+flatBufferData(const FlatBufferBuilder *  builder)
+{
+	return builder->buffer + builder->capacity - builder->size;
+}
+
+static void
+flatBufferReset(FlatBufferBuilder *  builder)
+{
+	free(builder->buffer);
+	*builder = (FlatBufferBuilder) {0};
+
+	return;
+}
+
+static size_t
+alignUp(size_t value, size_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+/*
+ *	Builds a `Schema` table. It is used both in the schema message and in the file footer.
+ */
+static FlatBufferReference
+buildSchema(
+	FlatBufferBuilder *		builder,
+	const char * const *		columnNames,
+	size_t				numberOfColumns,
+	const ArrowIPCMetadataEntry *	metadata,
+	size_t				numberOfMetadataEntries)
+{
+	FlatBufferReference *	fields = calloc(numberOfColumns + numberOfMetadataEntries + 1, sizeof(FlatBufferReference));
+	FlatBufferReference *	keyValues = fields + numberOfColumns;
+	FlatBufferReference	fieldsVector;
+	FlatBufferReference	keyValuesVector;
+
+	if (fields == NULL)
+	{
+		builder->hasError = 1;
+
+		return 0;
+	}
+
+	for (size_t i = 0; i < numberOfColumns; i++)
+	{
+		FlatBufferReference	name = flatBufferCreateString(builder, columnNames[i]);
+		FlatBufferReference	children = flatBufferCreateOffsetVector(builder, NULL, 0);
+		FlatBufferReference	floatingPoint;
+
+		flatBufferStartTable(builder);
+		flatBufferAddScalar(builder, 0, kArrowIPCPrecisionDouble, 2);
+		floatingPoint = flatBufferEndTable(builder);
+
+		flatBufferStartTable(builder);
+		flatBufferAddOffset(builder, 0, name);
+		flatBufferAddOffset(builder, 3, floatingPoint);
+		flatBufferAddOffset(builder, 5, children);
+		flatBufferAddScalar(builder, 1, 0, 1);
+		flatBufferAddScalar(builder, 2, kArrowIPCTypeFloatingPoint, 1);
+		fields[i] = flatBufferEndTable(builder);
+	}
+	fieldsVector = flatBufferCreateOffsetVector(builder, fields, numberOfColumns);
+
+	for (size_t i = 0; i < numberOfMetadataEntries; i++)
+	{
+		FlatBufferReference	key = flatBufferCreateString(builder, metadata[i].key);
+		FlatBufferReference	value = flatBufferCreateString(builder, metadata[i].value);
+
+		flatBufferStartTable(builder);
+		flatBufferAddOffset(builder, 0, key);
+		flatBufferAddOffset(builder, 1, value);
+		keyValues[i] = flatBufferEndTable(builder);
+	}
+	keyValuesVector = flatBufferCreateOffsetVector(builder, keyValues, numberOfMetadataEntries);
+
+	flatBufferStartTable(builder);
+	flatBufferAddOffset(builder, 1, fieldsVector);
+	flatBufferAddOffset(builder, 2, keyValuesVector);
+	flatBufferAddScalar(builder, 0, kArrowIPCEndiannessLittle, 2);
+
+	free(fields);
+
+	return flatBufferEndTable(builder);
+}
+
+/*
+ *	Builds a `Message` table around an already-built header table.
+ */
+static size_t
+finishMessage(FlatBufferBuilder *  builder, uint8_t headerType, FlatBufferReference header, int64_t bodyLength)
+{
+	FlatBufferReference	message;
+
+	flatBufferStartTable(builder);
+	flatBufferAddScalar(builder, 3, (uint64_t)bodyLength, 8);
+	flatBufferAddOffset(builder, 2, header);
+	flatBufferAddScalar(builder, 0, kArrowIPCMetadataVersionV5, 2);
+	flatBufferAddScalar(builder, 1, headerType, 1);
+	message = flatBufferEndTable(builder);
+
+	return flatBufferFinish(builder, message);
+}
+
+static int
+writeLittleEndian(FILE *  file, uint64_t value, size_t numberOfBytes)
+{
+	uint8_t	bytes[8];
+
+	for (size_t i = 0; i < numberOfBytes; i++)
+	{
+		bytes[i] = (uint8_t)(value >> (8 * i));
+	}
+
+	return fwrite(bytes, 1, numberOfBytes, file) != numberOfBytes;
+}
+
+static int
+writePadding(FILE *  file, size_t numberOfBytes)
+{
+	static const uint8_t	zeros[kArrowIPCBufferAlignment] = {0};
+
+	return fwrite(zeros, 1, numberOfBytes, file) != numberOfBytes;
+}
+
+/*
+ *	Writes an encapsulated message: continuation marker, metadata length, and the
+ *	flatbuffer, which is already padded to a multiple of eight bytes.
+ */
+static int
+writeEncapsulatedMessage(FILE *  file, const FlatBufferBuilder *  builder)
+{
+	int	hasError = 0;
+
+	hasError |= writeLittleEndian(file, (uint32_t)kArrowIPCContinuationMarker, 4);
+	hasError |= writeLittleEndian(file, builder->size, 4);
+	hasError |= (fwrite(flatBufferData(builder), 1, builder->size, file) != builder->size);
+
+	return hasError;
+}
+
+CommonConstantReturnType
+writeDoubleColumnsToArrowIPCFile(
+	const char *			filePath,
+	const double * const *		columns,
+	const char * const *		columnNames,
+	size_t				numberOfColumns,
+	size_t				numberOfRows,
+	const ArrowIPCMetadataEntry *	metadata,
+	size_t				numberOfMetadataEntries)
+{
+	FlatBufferBuilder	builder = {0};
+	FILE *			file;
+	int			hasError = 0;
+	size_t			columnLength = numberOfRows * sizeof(double);
+	size_t			columnStride = alignUp(columnLength, kArrowIPCBufferAlignment);
+	int64_t			bodyLength = (int64_t)(columnStride * numberOfColumns);
+	int64_t *		nodes;
+	int64_t *		buffers;
+	int64_t			recordBatchOffset;
+	int64_t			recordBatchMetadataLength;
+	size_t			footerLength;
+
+	nodes = calloc(2 * numberOfColumns + 4 * numberOfColumns + 1, sizeof(int64_t));
+	if (nodes == NULL)
+	{
+		fprintf(stderr, "Error: Could not allocate memory for the Arrow IPC record batch.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+	buffers = nodes + 2 * numberOfColumns;
+
+	file = fopen(filePath, "wb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open \"%s\" for writing.\n", filePath);
+		free(nodes);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	hasError |= (fwrite(kArrowIPCFileMagic, 1, sizeof(kArrowIPCFileMagic), file) != sizeof(kArrowIPCFileMagic));
+
+	/*
+	 *	Schema message.
+	 */
+	finishMessage(
+		&builder,
+		kArrowIPCMessageHeaderSchema,
+		buildSchema(&builder, columnNames, numberOfColumns, metadata, numberOfMetadataEntries),
+		0);
+	hasError |= builder.hasError || writeEncapsulatedMessage(file, &builder);
+	flatBufferReset(&builder);
+
+	/*
+	 *	Record batch message. Each column has an empty validity buffer (no nulls)
+	 *	and a data buffer aligned to 64 bytes within the body.
+	 */
+	for (size_t i = 0; i < numberOfColumns; i++)
+	{
+		nodes[2 * i + 0] = (int64_t)numberOfRows;
+		nodes[2 * i + 1] = 0;
+		buffers[4 * i + 0] = (int64_t)(i * columnStride);
+		buffers[4 * i + 1] = 0;
+		buffers[4 * i + 2] = (int64_t)(i * columnStride);
+		buffers[4 * i + 3] = (int64_t)columnLength;
+	}
+
+	{
+		FlatBufferReference	nodesVector = flatBufferCreateInt64StructVector(&builder, nodes, 2, numberOfColumns);
+		FlatBufferReference	buffersVector = flatBufferCreateInt64StructVector(&builder, buffers, 2, 2 * numberOfColumns);
+		FlatBufferReference	recordBatch;
+
+		flatBufferStartTable(&builder);
+		flatBufferAddScalar(&builder, 0, numberOfRows, 8);
+		flatBufferAddOffset(&builder, 1, nodesVector);
+		flatBufferAddOffset(&builder, 2, buffersVector);
+		recordBatch = flatBufferEndTable(&builder);
+
+		finishMessage(&builder, kArrowIPCMessageHeaderRecordBatch, recordBatch, bodyLength);
+	}
+
+	recordBatchOffset = (int64_t)ftell(file);
+	recordBatchMetadataLength = (int64_t)(8 + builder.size);
+	hasError |= builder.hasError || writeEncapsulatedMessage(file, &builder);
+	flatBufferReset(&builder);
+
+	for (size_t i = 0; i < numberOfColumns; i++)
+	{
+		hasError |= (fwrite(columns[i], sizeof(double), numberOfRows, file) != numberOfRows);
+		hasError |= writePadding(file, columnStride - columnLength);
+	}
+
+	/*
+	 *	End-of-stream marker.
+	 */
+	hasError |= writeLittleEndian(file, (uint32_t)kArrowIPCContinuationMarker, 4);
+	hasError |= writeLittleEndian(file, 0, 4);
+
+	/*
+	 *	Footer, with the schema repeated and the location of the record batch.
+	 */
+	{
+		int64_t			block[3] = {recordBatchOffset, recordBatchMetadataLength, bodyLength};
+		FlatBufferReference	schema = buildSchema(&builder, columnNames, numberOfColumns, metadata, numberOfMetadataEntries);
+		FlatBufferReference	dictionaries = flatBufferCreateInt64StructVector(&builder, NULL, 0, 0);
+		FlatBufferReference	recordBatches;
+		FlatBufferReference	footer;
+
+		/*
+		 *	The `Block` struct is {int64 offset, int32 metaDataLength, int64 bodyLength},
+		 *	so the int32 member is padded to eight bytes, which packs it like an int64.
+		 */
+		recordBatches = flatBufferCreateInt64StructVector(&builder, block, 3, 1);
+
+		flatBufferStartTable(&builder);
+		flatBufferAddOffset(&builder, 1, schema);
+		flatBufferAddOffset(&builder, 2, dictionaries);
+		flatBufferAddOffset(&builder, 3, recordBatches);
+		flatBufferAddScalar(&builder, 0, kArrowIPCMetadataVersionV5, 2);
+		footer = flatBufferEndTable(&builder);
+
+		footerLength = flatBufferFinish(&builder, footer);
+	}
+
+	hasError |= builder.hasError || (fwrite(flatBufferData(&builder), 1, footerLength, file) != footerLength);
+	hasError |= writeLittleEndian(file, footerLength, 4);
+	hasError |= (fwrite(kArrowIPCFileMagic, 1, 6, file) != 6);
+	flatBufferReset(&builder);
+	free(nodes);
+
+	hasError |= (fclose(file) != 0);
+	if (hasError)
+	{
+		fprintf(stderr, "Error: Could not write the Arrow IPC file \"%s\".\n", filePath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
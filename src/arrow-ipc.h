@@ -0,0 +1,60 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "common.h"
+
+/*
+ *	Run metadata entry, stored as Arrow schema custom metadata.
+ */
+typedef struct
+{
+	const char *	key;
+	const char *	value;
+} ArrowIPCMetadataEntry;
+
+/**
+ *	@brief	Writes `float64` columns as a single record batch in the Arrow IPC file format
+ *		(also known as Feather V2). The file can be memory-mapped by `pyarrow`, `polars`
+ *		or any other Arrow reader without parsing. The column data are written directly
+ *		from the given arrays without an intermediate copy.
+ *
+ *	@param	filePath		: Path of the file to write.
+ *	@param	columns			: Array of `numberOfColumns` pointers to the column data.
+ *	@param	columnNames		: Array of `numberOfColumns` column names.
+ *	@param	numberOfColumns		: The number of columns.
+ *	@param	numberOfRows		: The number of values in each column.
+ *	@param	metadata		: Array of run metadata entries stored in the schema.
+ *	@param	numberOfMetadataEntries	: The number of entries in `metadata`.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful,
+ *					  else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	writeDoubleColumnsToArrowIPCFile(
+					const char *			filePath,
+					const double * const *		columns,
+					const char * const *		columnNames,
+					size_t				numberOfColumns,
+					size_t				numberOfRows,
+					const ArrowIPCMetadataEntry *	metadata,
+					size_t				numberOfMetadataEntries);
@@ -0,0 +1,200 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+/*
+ *	Kernels of the batch engine. This file is included once per instruction set by
+ *	batch-engine.c, with `BATCH_ENGINE_KERNEL(name)` giving the name of each variant and
+ *	`kBatchEngineKernelAttributes` its `target` attribute. It has no include guard.
+ *
+ *	The loops over lanes have a constant trip count of `kBatchEngineLanes` and work on
+ *	local copies of the per-lane state, so the compiler keeps the state in vector
+ *	registers for the whole block.
+ */
+
+/*
+ *	Fills a block of uniforms in [0, 1) with xoshiro256+, one generator per lane. The
+ *	generator only needs additions, shifts and xors. The top 53 bits of its output are
+ *	converted to a double as a 31-bit and a 22-bit part, each through a 32-bit integer,
+ *	since AVX2 can convert 32-bit integers to doubles but not 64-bit ones.
+ */
+static kBatchEngineKernelAttributes void
+BATCH_ENGINE_KERNEL(fillUniforms)(BatchEngineWorkspace *  workspace, size_t numberOfSamples)
+{
+	uint64_t * restrict	s0 = workspace->tile.randomState[0];
+	uint64_t * restrict	s1 = workspace->tile.randomState[1];
+	uint64_t * restrict	s2 = workspace->tile.randomState[2];
+	uint64_t * restrict	s3 = workspace->tile.randomState[3];
+
+	for (size_t input = 0; input < kInputDistributionIndexMax; input++)
+	{
+		for (size_t sample = 0; sample < numberOfSamples; sample++)
+		{
+			double * restrict	uniforms = workspace->uniforms[input][sample];
+
+			for (size_t lane = 0; lane < kBatchEngineLanes; lane++)
+			{
+				uint64_t	result = s0[lane] + s3[lane];
+				uint64_t	t = s1[lane] << 17;
+
+				s2[lane] ^= s0[lane];
+				s3[lane] ^= s1[lane];
+				s1[lane] ^= s2[lane];
+				s0[lane] ^= s3[lane];
+				s2[lane] ^= t;
+				s3[lane] = (s3[lane] << 45) | (s3[lane] >> 19);
+
+				uniforms[lane] = (double)(int32_t)(result >> 33) * (1.0 / 2147483648.0)
+							+ (double)(int32_t)((result >> 11) & 0x3FFFFF) * (1.0 / 9007199254740992.0);
+			}
+		}
+	}
+
+	return;
+}
+
+/*
+ *	Evaluates all outputs of the conversion for a block of samples, with the same
+ *	formulas as `calculateSensorOutput()`. The coefficients of the model are loaded
+ *	once per block, and `transfer` is a constant in each caller below, so every transfer
+ *	function gets its own fused loop with no branches or unused divisions.
+ */
+static inline __attribute__((always_inline)) kBatchEngineKernelAttributes void
+BATCH_ENGINE_KERNEL(convertBlockWithTransfer)(BatchEngineWorkspace *  workspace, size_t numberOfSamples, SensorModelTransfer transfer)
+{
+	const BatchEngineTile *			tile = &workspace->tile;
+	const SensorModelChannelTransfer *	channels = workspace->model->channels;
+	InputDistributionIndex			inputRh = channels[kSensorModelChannelRelativeHumidity].input;
+	InputDistributionIndex			inputTcelcius = channels[kSensorModelChannelTemperatureCelcius].input;
+	InputDistributionIndex			inputTfahrenheit = channels[kSensorModelChannelTemperatureFahrenheit].input;
+	double					offsetRh = channels[kSensorModelChannelRelativeHumidity].offset;
+	double					slopeRh = channels[kSensorModelChannelRelativeHumidity].slope;
+	double					offsetTcelcius = channels[kSensorModelChannelTemperatureCelcius].offset;
+	double					slopeTcelcius = channels[kSensorModelChannelTemperatureCelcius].slope;
+	double					offsetTfahrenheit = channels[kSensorModelChannelTemperatureFahrenheit].offset;
+	double					slopeTfahrenheit = channels[kSensorModelChannelTemperatureFahrenheit].slope;
+
+	for (size_t sample = 0; sample < numberOfSamples; sample++)
+	{
+		const double * restrict	uRh = workspace->uniforms[inputRh][sample];
+		const double * restrict	uTcelcius = workspace->uniforms[inputTcelcius][sample];
+		const double * restrict	uTfahrenheit = workspace->uniforms[inputTfahrenheit][sample];
+		const double * restrict	uVsupply = workspace->uniforms[kInputDistributionIndexVsupply][sample];
+		double * restrict	outRh = workspace->outputs[kOutputDistributionIndexCalibratedRelativeHumidity][sample];
+		double * restrict	outTcelcius = workspace->outputs[kOutputDistributionIndexCalibratedTemperatureCelcius][sample];
+		double * restrict	outTfahrenheit = workspace->outputs[kOutputDistributionIndexCalibratedTemperatureFahrenheit][sample];
+		double * restrict	outDewPoint = workspace->outputs[kOutputDistributionIndexDewPointCelcius][sample];
+		double * restrict	outAbsoluteHumidity = workspace->outputs[kOutputDistributionIndexAbsoluteHumidity][sample];
+		double * restrict	outHeatIndex = workspace->outputs[kOutputDistributionIndexHeatIndexCelcius][sample];
+
+		for (size_t lane = 0; lane < kBatchEngineLanes; lane++)
+		{
+			double	VRh = tile->lowerBound[inputRh][lane] + tile->width[inputRh][lane] * uRh[lane];
+			double	VTcelcius = tile->lowerBound[inputTcelcius][lane] + tile->width[inputTcelcius][lane] * uTcelcius[lane];
+			double	VTfahrenheit = tile->lowerBound[inputTfahrenheit][lane] + tile->width[inputTfahrenheit][lane] * uTfahrenheit[lane];
+			double	Rh;
+			double	Tcelcius;
+
+			if (transfer == kSensorModelTransferRatiometric)
+			{
+				double	Vsupply = tile->lowerBound[kInputDistributionIndexVsupply][lane] + tile->width[kInputDistributionIndexVsupply][lane] * uVsupply[lane];
+
+				VRh = VRh / Vsupply;
+				VTcelcius = VTcelcius / Vsupply;
+				VTfahrenheit = VTfahrenheit / Vsupply;
+			}
+
+			Rh = offsetRh + slopeRh * VRh;
+			Tcelcius = offsetTcelcius + slopeTcelcius * VTcelcius;
+			outRh[lane] = Rh;
+			outTcelcius[lane] = Tcelcius;
+			outTfahrenheit[lane] = offsetTfahrenheit + slopeTfahrenheit * VTfahrenheit;
+			outDewPoint[lane] = psychrometricsDewPointCelcius(Rh, Tcelcius);
+			outAbsoluteHumidity[lane] = psychrometricsAbsoluteHumidity(Rh, Tcelcius);
+			outHeatIndex[lane] = psychrometricsHeatIndexCelcius(Rh, Tcelcius);
+		}
+	}
+
+	return;
+}
+
+static kBatchEngineKernelAttributes void
+BATCH_ENGINE_KERNEL(convertBlockRatiometric)(BatchEngineWorkspace *  workspace, size_t numberOfSamples)
+{
+	BATCH_ENGINE_KERNEL(convertBlockWithTransfer)(workspace, numberOfSamples, kSensorModelTransferRatiometric);
+
+	return;
+}
+
+static kBatchEngineKernelAttributes void
+BATCH_ENGINE_KERNEL(convertBlockAffine)(BatchEngineWorkspace *  workspace, size_t numberOfSamples)
+{
+	BATCH_ENGINE_KERNEL(convertBlockWithTransfer)(workspace, numberOfSamples, kSensorModelTransferAffine);
+
+	return;
+}
+
+/*
+ *	Folds a block of outputs into the per-lane accumulators.
+ */
+static kBatchEngineKernelAttributes void
+BATCH_ENGINE_KERNEL(reduceBlock)(BatchEngineWorkspace *  workspace, size_t numberOfSamples)
+{
+	BatchEngineTile *	tile = &workspace->tile;
+
+	for (size_t output = 0; output < kOutputDistributionIndexMax; output++)
+	{
+		double	reference[kBatchEngineLanes];
+		double	sum[kBatchEngineLanes];
+		double	sumOfSquares[kBatchEngineLanes];
+		double	minimum[kBatchEngineLanes];
+		double	maximum[kBatchEngineLanes];
+
+		memcpy(reference, tile->reference[output], sizeof(reference));
+		memcpy(sum, tile->sum[output], sizeof(sum));
+		memcpy(sumOfSquares, tile->sumOfSquares[output], sizeof(sumOfSquares));
+		memcpy(minimum, tile->minimum[output], sizeof(minimum));
+		memcpy(maximum, tile->maximum[output], sizeof(maximum));
+
+		for (size_t sample = 0; sample < numberOfSamples; sample++)
+		{
+			const double * restrict	values = workspace->outputs[output][sample];
+
+			for (size_t lane = 0; lane < kBatchEngineLanes; lane++)
+			{
+				double	value = values[lane];
+				double	deviation = value - reference[lane];
+
+				sum[lane] += deviation;
+				sumOfSquares[lane] += deviation * deviation;
+				minimum[lane] = (value < minimum[lane]) ? value : minimum[lane];
+				maximum[lane] = (value > maximum[lane]) ? value : maximum[lane];
+			}
+		}
+
+		memcpy(tile->sum[output], sum, sizeof(sum));
+		memcpy(tile->sumOfSquares[output], sumOfSquares, sizeof(sumOfSquares));
+		memcpy(tile->minimum[output], minimum, sizeof(minimum));
+		memcpy(tile->maximum[output], maximum, sizeof(maximum));
+	}
+
+	return;
+}
@@ -0,0 +1,637 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(_POSIX_THREADS) && (_POSIX_THREADS > 0)
+#include <pthread.h>
+#include <sched.h>
+#define kBatchEngineHasThreads	1
+#else
+#define kBatchEngineHasThreads	0
+#endif
+#include "batch-engine.h"
+#include "metrics.h"
+#include "psychrometrics.h"
+#include "reorder-buffer.h"
+
+/*
+ *	Multiple kernel variants need the `target` function attribute and
+ *	`__builtin_cpu_supports()`, which GCC and Clang provide on x86-64.
+ */
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define kBatchEngineHasTargetDispatch	1
+#else
+#define kBatchEngineHasTargetDispatch	0
+#endif
+
+/*
+ *	Shortest and longest sleeps of a thread waiting on the reorder window.
+ */
+#define kBatchEngineMinBackOffNanoseconds	(8000ULL)
+#define kBatchEngineMaxBackOffNanoseconds	(1000000ULL)
+
+/*
+ *	Per-tile state, in structure-of-arrays layout so that the innermost loops run
+ *	across lanes and vectorize.
+ */
+typedef struct
+{
+	uint64_t	randomState[4][kBatchEngineLanes];
+	double		lowerBound[kInputDistributionIndexMax][kBatchEngineLanes];
+	double		width[kInputDistributionIndexMax][kBatchEngineLanes];
+
+	/*
+	 *	Sums are of deviations from `reference`, the outputs at the centre of the input
+	 *	bounds, which keeps the one-pass variance accurate.
+	 */
+	double		reference[kOutputDistributionIndexMax][kBatchEngineLanes];
+	double		sum[kOutputDistributionIndexMax][kBatchEngineLanes];
+	double		sumOfSquares[kOutputDistributionIndexMax][kBatchEngineLanes];
+	double		minimum[kOutputDistributionIndexMax][kBatchEngineLanes];
+	double		maximum[kOutputDistributionIndexMax][kBatchEngineLanes];
+} BatchEngineTile;
+
+struct BatchEngineWorkspace
+{
+	double		uniforms[kInputDistributionIndexMax][kBatchEngineSamplesPerBlock][kBatchEngineLanes];
+	double		outputs[kOutputDistributionIndexMax][kBatchEngineSamplesPerBlock][kBatchEngineLanes];
+	BatchEngineTile	tile;
+
+	/*
+	 *	The sensor model whose coefficients the conversion kernels load.
+	 */
+	const SensorModel *	model;
+};
+
+typedef struct
+{
+	const BatchEngineKernels *	kernels;
+	const SensorModel *		model;
+	void				(*convertBlock)(BatchEngineWorkspace *  workspace, size_t numberOfSamples);
+	const BatchReading *		readings;
+	size_t				numberOfReadings;
+	uint64_t			numberOfSamplesPerReading;
+	uint64_t			seed;
+	BatchReadingSummary *		summaries;
+	_Atomic size_t			nextTile;
+	_Atomic size_t			nextMetricsShard;
+
+	/*
+	 *	With a sink, the window that completed tiles are published to, and the number of
+	 *	workers that have not returned yet.
+	 */
+	ReorderBuffer *			reorderBuffer;
+	_Atomic size_t			numberOfActiveWorkers;
+} BatchEngineJob;
+
+static uint64_t
+splitMix64(uint64_t *  state)
+{
+	uint64_t	z = (*state += 0x9E3779B97F4A7C15ULL);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+	return z ^ (z >> 31);
+}
+
+/*
+ *	Instantiate the kernels once for the baseline instruction set, and once for each
+ *	wider instruction set the compiler can target. The variant is picked at runtime.
+ */
+#define kBatchEngineKernelAttributes
+#define BATCH_ENGINE_KERNEL(name)	name##Baseline
+#include "batch-engine-kernels.h"
+#undef kBatchEngineKernelAttributes
+#undef BATCH_ENGINE_KERNEL
+
+#if kBatchEngineHasTargetDispatch
+#define kBatchEngineKernelAttributes	__attribute__((target("avx2")))
+#define BATCH_ENGINE_KERNEL(name)	name##AVX2
+#include "batch-engine-kernels.h"
+#undef kBatchEngineKernelAttributes
+#undef BATCH_ENGINE_KERNEL
+
+#define kBatchEngineKernelAttributes	__attribute__((target("avx512f")))
+#define BATCH_ENGINE_KERNEL(name)	name##AVX512
+#include "batch-engine-kernels.h"
+#undef kBatchEngineKernelAttributes
+#undef BATCH_ENGINE_KERNEL
+#endif
+
+/*
+ *	Kernel variants, from the most to the least capable. The first one the host
+ *	supports is used.
+ */
+static const BatchEngineKernels	kBatchEngineKernelVariants[] =
+{
+#if kBatchEngineHasTargetDispatch
+	{ .name = "avx512", .cpuFeature = "avx512f", .fillUniforms = fillUniformsAVX512, .convertBlock = {[kSensorModelTransferRatiometric] = convertBlockRatiometricAVX512, [kSensorModelTransferAffine] = convertBlockAffineAVX512}, .reduceBlock = reduceBlockAVX512 },
+	{ .name = "avx2", .cpuFeature = "avx2", .fillUniforms = fillUniformsAVX2, .convertBlock = {[kSensorModelTransferRatiometric] = convertBlockRatiometricAVX2, [kSensorModelTransferAffine] = convertBlockAffineAVX2}, .reduceBlock = reduceBlockAVX2 },
+#endif
+	{ .name = "baseline", .cpuFeature = NULL, .fillUniforms = fillUniformsBaseline, .convertBlock = {[kSensorModelTransferRatiometric] = convertBlockRatiometricBaseline, [kSensorModelTransferAffine] = convertBlockAffineBaseline}, .reduceBlock = reduceBlockBaseline },
+};
+
+static bool
+isCPUFeatureSupported(const char *  cpuFeature)
+{
+	if (cpuFeature == NULL)
+	{
+		return true;
+	}
+
+#if kBatchEngineHasTargetDispatch
+	/*
+	 *	`__builtin_cpu_supports()` needs a string literal.
+	 */
+	__builtin_cpu_init();
+	if (strcmp(cpuFeature, "avx512f") == 0)
+	{
+		return __builtin_cpu_supports("avx512f");
+	}
+	if (strcmp(cpuFeature, "avx2") == 0)
+	{
+		return __builtin_cpu_supports("avx2");
+	}
+#endif
+
+	return false;
+}
+
+const BatchEngineKernels *
+batchEngineSelectKernels(void)
+{
+	static const BatchEngineKernels *	selectedKernels = NULL;
+
+	if (selectedKernels == NULL)
+	{
+		size_t	i = 0;
+
+		while (!isCPUFeatureSupported(kBatchEngineKernelVariants[i].cpuFeature))
+		{
+			i++;
+		}
+		selectedKernels = &kBatchEngineKernelVariants[i];
+	}
+
+	return selectedKernels;
+}
+
+/*
+ *	Loads up to `kBatchEngineLanes` readings into the tile. Unused lanes repeat the last
+ *	reading and are discarded at the end.
+ */
+static void
+loadTile(BatchEngineJob *  job, BatchEngineWorkspace *  workspace, size_t firstReading, size_t numberOfReadingsInTile)
+{
+	BatchEngineTile *	tile = &workspace->tile;
+
+	for (size_t lane = 0; lane < kBatchEngineLanes; lane++)
+	{
+		size_t			readingIndex = firstReading + ((lane < numberOfReadingsInTile) ? lane : numberOfReadingsInTile - 1);
+		const BatchReading *	reading = &job->readings[readingIndex];
+		uint64_t		seed = job->seed ^ (readingIndex * 0xD1B54A32D192ED03ULL);
+
+		for (size_t i = 0; i < 4; i++)
+		{
+			tile->randomState[i][lane] = splitMix64(&seed);
+		}
+
+		for (size_t input = 0; input < kInputDistributionIndexMax; input++)
+		{
+			tile->lowerBound[input][lane] = reading->lowerBound[input];
+			tile->width[input][lane] = reading->upperBound[input] - reading->lowerBound[input];
+			workspace->uniforms[input][0][lane] = 0.5;
+		}
+	}
+
+	/*
+	 *	Evaluate the outputs at the centre of the bounds, as the reference of the sums.
+	 */
+	job->convertBlock(workspace, 1);
+	for (size_t output = 0; output < kOutputDistributionIndexMax; output++)
+	{
+		for (size_t lane = 0; lane < kBatchEngineLanes; lane++)
+		{
+			tile->reference[output][lane] = workspace->outputs[output][0][lane];
+			tile->sum[output][lane] = 0.0;
+			tile->sumOfSquares[output][lane] = 0.0;
+			tile->minimum[output][lane] = INFINITY;
+			tile->maximum[output][lane] = -INFINITY;
+		}
+	}
+
+	return;
+}
+
+static void
+storeTile(BatchEngineJob *  job, const BatchEngineTile *  tile, size_t firstReading, size_t numberOfReadingsInTile)
+{
+	double	n = (double)job->numberOfSamplesPerReading;
+
+	for (size_t lane = 0; lane < numberOfReadingsInTile; lane++)
+	{
+		BatchReadingSummary *	summary = &job->summaries[firstReading + lane];
+
+		summary->numberOfSamples = job->numberOfSamplesPerReading;
+		for (size_t output = 0; output < kOutputDistributionIndexMax; output++)
+		{
+			double	meanDeviation = tile->sum[output][lane] / n;
+
+			summary->mean[output] = tile->reference[output][lane] + meanDeviation;
+			summary->variance[output] = (job->numberOfSamplesPerReading > 1)
+							? fmax(0.0, (tile->sumOfSquares[output][lane] - n * meanDeviation * meanDeviation) / (n - 1.0))
+							: 0.0;
+			summary->minimum[output] = tile->minimum[output][lane];
+			summary->maximum[output] = tile->maximum[output][lane];
+		}
+	}
+
+	return;
+}
+
+/*
+ *	Sleeps while waiting on the reorder window, for twice as long as the previous wait of
+ *	the same episode, from 8 us up to 1 ms, so that a waiting thread takes next to no time
+ *	from the workers.
+ */
+static void
+backOff(uint64_t *  backOffNanoseconds)
+{
+#if kBatchEngineHasThreads
+	struct timespec	duration = {.tv_sec = 0, .tv_nsec = (long)*backOffNanoseconds};
+
+	nanosleep(&duration, NULL);
+	*backOffNanoseconds = (*backOffNanoseconds * 2 > kBatchEngineMaxBackOffNanoseconds)
+				? kBatchEngineMaxBackOffNanoseconds
+				: *backOffNanoseconds * 2;
+#else
+	(void)backOffNanoseconds;
+#endif
+
+	return;
+}
+
+/*
+ *	Waits until a tile is inside the reorder window, counting a stall if it was not.
+ */
+static void
+waitForReorderRoom(ReorderBuffer *  buffer, size_t tileIndex)
+{
+	uint64_t	backOffNanoseconds = kBatchEngineMinBackOffNanoseconds;
+
+	if (reorderBufferHasRoom(buffer, tileIndex))
+	{
+		return;
+	}
+
+	metricsCount(kMetricsCounterReorderWindowFullStalls, 1);
+	while (!reorderBufferHasRoom(buffer, tileIndex))
+	{
+		backOff(&backOffNanoseconds);
+	}
+
+	return;
+}
+
+/*
+ *	Passes a tile of summaries to the sink, recording how long it was held in the window.
+ */
+static void
+emitTile(BatchEngineJob *  job, const BatchEngineSink *  sink, size_t tileIndex, uint64_t completedNanoseconds)
+{
+	size_t		firstReading = tileIndex * kBatchEngineLanes;
+	size_t		numberOfReadingsInTile = job->numberOfReadings - firstReading;
+	uint64_t	startNanoseconds = metricsGetTimeNanoseconds();
+
+	if (numberOfReadingsInTile > kBatchEngineLanes)
+	{
+		numberOfReadingsInTile = kBatchEngineLanes;
+	}
+
+	metricsRecordLatency(kMetricsHistogramReorderPerTile, startNanoseconds - completedNanoseconds);
+	sink->emit(sink->context, firstReading, numberOfReadingsInTile);
+	metricsRecordLatency(kMetricsHistogramOutputPerTile, metricsGetTimeNanoseconds() - startNanoseconds);
+
+	return;
+}
+
+static void *
+batchEngineWorker(void *  argument)
+{
+	BatchEngineJob *	job = argument;
+
+	/*
+	 *	`aligned_alloc()` needs a size that is a multiple of the alignment.
+	 */
+	BatchEngineWorkspace *	workspace = aligned_alloc(64, (sizeof(BatchEngineWorkspace) + 63) / 64 * 64);
+	size_t			numberOfTiles = (job->numberOfReadings + kBatchEngineLanes - 1) / kBatchEngineLanes;
+
+	if (workspace == NULL)
+	{
+		return job;
+	}
+	workspace->model = job->model;
+
+	for (size_t tileIndex = atomic_fetch_add(&job->nextTile, 1); tileIndex < numberOfTiles; tileIndex = atomic_fetch_add(&job->nextTile, 1))
+	{
+		size_t	firstReading = tileIndex * kBatchEngineLanes;
+		size_t	numberOfReadingsInTile = job->numberOfReadings - firstReading;
+
+		if (numberOfReadingsInTile > kBatchEngineLanes)
+		{
+			numberOfReadingsInTile = kBatchEngineLanes;
+		}
+
+		if (job->reorderBuffer != NULL)
+		{
+			waitForReorderRoom(job->reorderBuffer, tileIndex);
+		}
+
+		loadTile(job, workspace, firstReading, numberOfReadingsInTile);
+
+		for (uint64_t sample = 0; sample < job->numberOfSamplesPerReading; sample += kBatchEngineSamplesPerBlock)
+		{
+			size_t		numberOfSamples = (job->numberOfSamplesPerReading - sample < kBatchEngineSamplesPerBlock)
+							? (size_t)(job->numberOfSamplesPerReading - sample)
+							: kBatchEngineSamplesPerBlock;
+			uint64_t	startNanoseconds = metricsGetTimeNanoseconds();
+			uint64_t	sampledNanoseconds;
+			uint64_t	convertedNanoseconds;
+
+			job->kernels->fillUniforms(workspace, numberOfSamples);
+			sampledNanoseconds = metricsGetTimeNanoseconds();
+			job->convertBlock(workspace, numberOfSamples);
+			convertedNanoseconds = metricsGetTimeNanoseconds();
+			job->kernels->reduceBlock(workspace, numberOfSamples);
+
+			metricsRecordLatency(kMetricsHistogramSamplingPerBlock, sampledNanoseconds - startNanoseconds);
+			metricsRecordLatency(kMetricsHistogramConversionPerBlock, convertedNanoseconds - sampledNanoseconds);
+			metricsRecordLatency(kMetricsHistogramReductionPerBlock, metricsGetTimeNanoseconds() - convertedNanoseconds);
+		}
+
+		storeTile(job, &workspace->tile, firstReading, numberOfReadingsInTile);
+		metricsCount(kMetricsCounterSamples, job->numberOfSamplesPerReading * numberOfReadingsInTile);
+		if (job->reorderBuffer != NULL)
+		{
+			reorderBufferPublish(job->reorderBuffer, tileIndex, metricsGetTimeNanoseconds());
+		}
+	}
+
+	free(workspace);
+
+	return NULL;
+}
+
+#if kBatchEngineHasThreads
+/*
+ *	Entry point of the worker threads, each of which records its metrics in its own shard.
+ */
+static void *
+batchEngineThreadMain(void *  argument)
+{
+	BatchEngineJob *	job = argument;
+	void *			result;
+
+	metricsBindThread(atomic_fetch_add(&job->nextMetricsShard, 1));
+	result = batchEngineWorker(job);
+	atomic_fetch_sub_explicit(&job->numberOfActiveWorkers, 1, memory_order_release);
+
+	return result;
+}
+
+/*
+ *	Takes completed tiles from the reorder window and passes them to the sink until all
+ *	tiles are passed, or all workers have returned.
+ *
+ *	@return	: `true` if all tiles were passed to the sink.
+ */
+static bool
+drainReorderWindow(BatchEngineJob *  job, const BatchEngineSink *  sink)
+{
+	size_t		numberOfTiles = (job->numberOfReadings + kBatchEngineLanes - 1) / kBatchEngineLanes;
+	size_t		numberOfTakenTiles = 0;
+	bool		isStalled = false;
+	uint64_t	backOffNanoseconds = kBatchEngineMinBackOffNanoseconds;
+
+	while (numberOfTakenTiles < numberOfTiles)
+	{
+		/*
+		 *	Workers publish their last tile before they return, so if none was active before
+		 *	the take, a failed take means that no tile is left.
+		 */
+		bool		isWorkerActive = (atomic_load_explicit(&job->numberOfActiveWorkers, memory_order_acquire) > 0);
+		uint64_t	depth = reorderBufferGetDepth(job->reorderBuffer);
+		uint64_t	tileIndex;
+		uint64_t	completedNanoseconds;
+
+		if (!reorderBufferTake(job->reorderBuffer, &tileIndex, &completedNanoseconds))
+		{
+			if (!isWorkerActive)
+			{
+				break;
+			}
+
+			/*
+			 *	Later tiles are complete, but the oldest one is not.
+			 */
+			if ((depth > 0) && !isStalled)
+			{
+				metricsCount(kMetricsCounterReorderHeadOfLineStalls, 1);
+				isStalled = true;
+			}
+			backOff(&backOffNanoseconds);
+
+			continue;
+		}
+
+		isStalled = false;
+		backOffNanoseconds = kBatchEngineMinBackOffNanoseconds;
+		metricsRecordMaximum(kMetricsGaugeReorderDepthMaximum, depth);
+		emitTile(job, sink, (size_t)tileIndex, completedNanoseconds);
+		numberOfTakenTiles++;
+	}
+
+	return numberOfTakenTiles == numberOfTiles;
+}
+#endif
+
+/*
+ *	Runs a job on `numberOfThreads` workers. Without a sink, the calling thread is the
+ *	first worker. With a sink, it drains the reorder window while the workers run.
+ */
+static CommonConstantReturnType
+runJob(BatchEngineJob *  job, size_t numberOfThreads, const BatchEngineSink *  sink)
+{
+	bool	hasError = false;
+
+	atomic_init(&job->nextTile, 0);
+	atomic_init(&job->nextMetricsShard, 1);
+
+#if kBatchEngineHasThreads
+	{
+		pthread_t	threads[kBatchEngineMaxThreads];
+		size_t		numberOfStartedThreads = 0;
+		size_t		numberOfWorkerThreads;
+
+		numberOfThreads = (numberOfThreads > kBatchEngineMaxThreads) ? kBatchEngineMaxThreads : numberOfThreads;
+		numberOfWorkerThreads = (sink != NULL) ? numberOfThreads : numberOfThreads - 1;
+		atomic_init(&job->numberOfActiveWorkers, numberOfWorkerThreads);
+
+		for (size_t i = 0; i < numberOfWorkerThreads; i++)
+		{
+			if (pthread_create(&threads[numberOfStartedThreads], NULL, batchEngineThreadMain, job) == 0)
+			{
+				numberOfStartedThreads++;
+			}
+			else
+			{
+				atomic_fetch_sub(&job->numberOfActiveWorkers, 1);
+			}
+		}
+
+		metricsBindThread(0);
+		if (sink == NULL)
+		{
+			hasError |= (batchEngineWorker(job) != NULL);
+		}
+		else
+		{
+			hasError |= !drainReorderWindow(job, sink);
+		}
+
+		for (size_t i = 0; i < numberOfStartedThreads; i++)
+		{
+			void *	result;
+
+			pthread_join(threads[i], &result);
+			hasError |= (result != NULL);
+		}
+	}
+#else
+	(void)numberOfThreads;
+
+	/*
+	 *	Without threads, the tiles are evaluated in order and passed to the sink at the end.
+	 */
+	job->reorderBuffer = NULL;
+	hasError = (batchEngineWorker(job) != NULL);
+	for (size_t tileIndex = 0; (sink != NULL) && !hasError && (tileIndex * kBatchEngineLanes < job->numberOfReadings); tileIndex++)
+	{
+		emitTile(job, sink, tileIndex, metricsGetTimeNanoseconds());
+	}
+#endif
+
+	if (hasError)
+	{
+		fprintf(stderr, "Error: Could not allocate the batch engine workspace.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+batchEngineRun(
+	const SensorModel *	model,
+	const BatchReading *	readings,
+	size_t			numberOfReadings,
+	uint64_t		numberOfSamplesPerReading,
+	uint64_t		seed,
+	size_t			numberOfThreads,
+	BatchReadingSummary *	summaries)
+{
+	BatchEngineJob	job = {
+				.kernels			= batchEngineSelectKernels(),
+				.model				= model,
+				.convertBlock			= batchEngineSelectKernels()->convertBlock[model->transfer],
+				.readings			= readings,
+				.numberOfReadings		= numberOfReadings,
+				.numberOfSamplesPerReading	= numberOfSamplesPerReading,
+				.seed				= seed,
+				.summaries			= summaries,
+			};
+
+	if ((numberOfReadings == 0) || (numberOfSamplesPerReading == 0))
+	{
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	return runJob(&job, numberOfThreads, NULL);
+}
+
+CommonConstantReturnType
+batchEngineRunStreaming(
+	const SensorModel *		model,
+	const BatchReading *		readings,
+	size_t				numberOfReadings,
+	uint64_t			numberOfSamplesPerReading,
+	uint64_t			seed,
+	size_t				numberOfThreads,
+	BatchReadingSummary *		summaries,
+	const BatchEngineSink *		sink)
+{
+	ReorderBuffer			reorderBuffer;
+	BatchEngineJob			job = {
+						.kernels			= batchEngineSelectKernels(),
+						.model				= model,
+						.convertBlock			= batchEngineSelectKernels()->convertBlock[model->transfer],
+						.readings			= readings,
+						.numberOfReadings		= numberOfReadings,
+						.numberOfSamplesPerReading	= numberOfSamplesPerReading,
+						.seed				= seed,
+						.summaries			= summaries,
+						.reorderBuffer			= &reorderBuffer,
+					};
+	CommonConstantReturnType	result;
+
+	/*
+	 *	With no samples, the summaries are left as they are, as in `batchEngineRun()`.
+	 */
+	if ((numberOfReadings == 0) || (numberOfSamplesPerReading == 0))
+	{
+		for (size_t firstReading = 0; firstReading < numberOfReadings; firstReading += kBatchEngineLanes)
+		{
+			sink->emit(sink->context, firstReading, (numberOfReadings - firstReading < kBatchEngineLanes) ? numberOfReadings - firstReading : kBatchEngineLanes);
+		}
+
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	if (reorderBufferInit(&reorderBuffer, kBatchEngineReorderWindowTiles, sink->isOrdered))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	result = runJob(&job, numberOfThreads, sink);
+	reorderBufferFree(&reorderBuffer);
+
+	return result;
+}
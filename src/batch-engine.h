@@ -0,0 +1,170 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "common.h"
+#include "sensor-model.h"
+#include "utilities-config.h"
+
+typedef enum
+{
+	/*
+	 *	Readings evaluated together, one per SIMD lane. Eight doubles fill an AVX-512
+	 *	register, or two AVX2 registers.
+	 */
+	kBatchEngineLanes		= 8,
+
+	/*
+	 *	Samples per block. A block of uniforms and outputs for all lanes takes
+	 *	(3 + 6) * 64 * 8 * 8 bytes = 36 KiB, so it stays in L1/L2 between kernels.
+	 */
+	kBatchEngineSamplesPerBlock	= 64,
+	kBatchEngineMaxThreads		= 256,
+
+	/*
+	 *	Tiles held by the reorder window of `batchEngineRunStreaming()`, i.e., how far the
+	 *	fastest worker may run ahead of the oldest tile not yet written.
+	 */
+	kBatchEngineReorderWindowTiles	= 256,
+} BatchEngineConstant;
+
+/*
+ *	One sensor reading with its own input uncertainty: each input is uniformly
+ *	distributed between its lower and upper bound.
+ */
+typedef struct
+{
+	double		lowerBound[kInputDistributionIndexMax];
+	double		upperBound[kInputDistributionIndexMax];
+	uint64_t	sequenceNumber;
+	double		timestamp;
+	uint32_t	sensorId;
+} BatchReading;
+
+/*
+ *	Monte Carlo summary of the outputs of one reading.
+ */
+typedef struct
+{
+	uint64_t	numberOfSamples;
+	double		mean[kOutputDistributionIndexMax];
+	double		variance[kOutputDistributionIndexMax];
+	double		minimum[kOutputDistributionIndexMax];
+	double		maximum[kOutputDistributionIndexMax];
+} BatchReadingSummary;
+
+/*
+ *	Receiver of the summaries of `batchEngineRunStreaming()`. `emit` is called on the calling
+ *	thread for each tile of up to `kBatchEngineLanes` readings once its summaries are final,
+ *	in the order of the readings if `isOrdered`, else in the order in which tiles complete.
+ */
+typedef struct
+{
+	bool	isOrdered;
+	void	(*emit)(void *  context, size_t firstReading, size_t numberOfReadings);
+	void *	context;
+} BatchEngineSink;
+
+/*
+ *	Block buffers and per-lane state of one worker, private to the batch engine.
+ */
+typedef struct BatchEngineWorkspace	BatchEngineWorkspace;
+
+/*
+ *	One compiled variant of the batch engine kernels, for one instruction set.
+ */
+typedef struct
+{
+	const char *	name;
+	const char *	cpuFeature;
+	void		(*fillUniforms)(BatchEngineWorkspace *  workspace, size_t numberOfSamples);
+	void		(*convertBlock[kSensorModelTransferMax])(BatchEngineWorkspace *  workspace, size_t numberOfSamples);
+	void		(*reduceBlock)(BatchEngineWorkspace *  workspace, size_t numberOfSamples);
+} BatchEngineKernels;
+
+/**
+ *	@brief	Selects the kernel variant for the widest instruction set that the host CPU supports
+ *		(AVX-512, AVX2 or the SSE2 baseline on x86-64; the baseline elsewhere). The selection
+ *		is made on the first call and reused afterwards.
+ *
+ *	@return	: Pointer to the selected kernel variant.
+ */
+const BatchEngineKernels *	batchEngineSelectKernels(void);
+
+/**
+ *	@brief	Runs an independent Monte Carlo evaluation of every output for each reading. Readings
+ *		are mapped to SIMD lanes in tiles of `kBatchEngineLanes`, tiles are spread over threads,
+ *		and each tile is processed in blocks of `kBatchEngineSamplesPerBlock` samples that are
+ *		reduced on the fly, so no per-reading sample arrays are materialized. Each reading has
+ *		its own random stream derived from `seed` and its index, so results do not depend on
+ *		the number of threads. The kernels are those returned by `batchEngineSelectKernels()`,
+ *		with the conversion kernel of the transfer function of `model`.
+ *
+ *	@param	model				: Pointer to the sensor model.
+ *	@param	readings			: Array of readings.
+ *	@param	numberOfReadings		: The number of readings.
+ *	@param	numberOfSamplesPerReading	: The number of Monte Carlo samples per reading.
+ *	@param	seed				: Seed of the random number generators.
+ *	@param	numberOfThreads			: The number of threads to use (at least one).
+ *	@param	summaries			: Array of `numberOfReadings` summaries, written by the engine.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	batchEngineRun(
+					const SensorModel *	model,
+					const BatchReading *	readings,
+					size_t			numberOfReadings,
+					uint64_t		numberOfSamplesPerReading,
+					uint64_t		seed,
+					size_t			numberOfThreads,
+					BatchReadingSummary *	summaries);
+
+/**
+ *	@brief	Runs `batchEngineRun()` and passes the summaries of each tile to a sink as soon as
+ *		they are final, so writing overlaps the evaluation. The workers publish completed
+ *		tiles into a bounded lock-free reorder window, and the calling thread, which does
+ *		not evaluate tiles itself, takes them from the window and calls the sink. Workers
+ *		wait while their tile is more than `kBatchEngineReorderWindowTiles` tiles ahead of
+ *		the oldest tile not yet passed to the sink.
+ *
+ *	@param	model				: Pointer to the sensor model.
+ *	@param	readings			: Array of readings.
+ *	@param	numberOfReadings		: The number of readings.
+ *	@param	numberOfSamplesPerReading	: The number of Monte Carlo samples per reading.
+ *	@param	seed				: Seed of the random number generators.
+ *	@param	numberOfThreads			: The number of worker threads to use (at least one).
+ *	@param	summaries			: Array of `numberOfReadings` summaries, written by the engine.
+ *	@param	sink				: Pointer to the sink.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	batchEngineRunStreaming(
+					const SensorModel *		model,
+					const BatchReading *		readings,
+					size_t				numberOfReadings,
+					uint64_t			numberOfSamplesPerReading,
+					uint64_t			seed,
+					size_t				numberOfThreads,
+					BatchReadingSummary *		summaries,
+					const BatchEngineSink *		sink);
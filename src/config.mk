@@ -1,4 +1,25 @@
 SOURCES =\
 	main.c\
 	common.c\
-	utilities.c
+	utilities.c\
+	arrow-ipc.c\
+	ndjson.c\
+	streaming-statistics.c\
+	trace.c\
+	batch-engine.c\
+	random-pool.c\
+	surrogate-table.c\
+	polynomial-chaos.c\
+	anytime-batch.c\
+	progress-snapshot.c\
+	metrics.c\
+	sensor-model.c\
+	reorder-buffer.c\
+	distribution-code.c\
+	csv-scanner.c\
+	kalman-filter.c\
+	out-of-core.c\
+	sample-compression.c\
+	time-series.c\
+	incremental-cache.c\
+	parallel-reservoir.c
@@ -0,0 +1,668 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(_POSIX_MAPPED_FILES) && (_POSIX_MAPPED_FILES > 0)
+#include <sys/mman.h>
+#define kCSVScannerHasMemoryMapping	1
+#else
+#define kCSVScannerHasMemoryMapping	0
+#endif
+#if defined(_POSIX_THREADS) && (_POSIX_THREADS > 0)
+#include <pthread.h>
+#define kCSVScannerHasThreads	1
+#else
+#define kCSVScannerHasThreads	0
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define kCSVScannerHasSSE2	1
+#else
+#define kCSVScannerHasSSE2	0
+#endif
+#include "csv-scanner.h"
+
+/*
+ *	Powers of ten that are exact in double precision.
+ */
+static const double	kCSVScannerExactPowersOfTen[] =
+			{
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+			};
+
+/*
+ *	Most significant digits accumulated exactly in a `uint64_t`, and the largest
+ *	significand that is exact in double precision.
+ */
+#define kCSVScannerMaxSignificantDigits	(19)
+#define kCSVScannerMaxExactSignificand	(1ULL << 53)
+
+/*
+ *	One chunk of the file, parsed by one thread into its own array of items.
+ */
+typedef struct
+{
+	const char *		begin;
+	const char *		end;
+	size_t			itemSize;
+	CSVScannerLineParser	parseLine;
+	unsigned char *		items;
+	size_t			numberOfItems;
+	size_t			capacity;
+	size_t			numberOfLines;
+	bool			hasError;
+	bool			hasMalformedLine;
+} CSVScannerChunk;
+
+static inline bool
+isDigit(char character)
+{
+	return (unsigned)(character - '0') < 10;
+}
+
+static inline bool
+isSpace(char character)
+{
+	return (character == ' ') || ((unsigned)(character - '\t') < 5);
+}
+
+/*
+ *	Parses the number at `start` with `strtod()`, from a terminated copy of at most
+ *	`kCSVScannerMaxNumberLength - 1` characters.
+ */
+static const char *
+parseDoubleWithStrtod(const char *  start, const char *  end, double *  value)
+{
+	char	buffer[kCSVScannerMaxNumberLength];
+	size_t	length = (size_t)(end - start);
+	char *	numberEnd;
+	double	parsedValue;
+
+	if (length > sizeof(buffer) - 1)
+	{
+		length = sizeof(buffer) - 1;
+	}
+	memcpy(buffer, start, length);
+	buffer[length] = '\0';
+
+	parsedValue = strtod(buffer, &numberEnd);
+	if (numberEnd == buffer)
+	{
+		return start;
+	}
+	*value = parsedValue;
+
+	return start + (numberEnd - buffer);
+}
+
+const char *
+csvScannerParseDouble(const char *  cursor, const char *  end, double *  value)
+{
+	const char *	start = cursor;
+	const char *	digitsStart;
+	uint64_t	significand = 0;
+	int		numberOfSignificantDigits = 0;
+	int		exponent = 0;
+	bool		isNegative = false;
+	bool		isTruncated = false;
+
+	while ((cursor < end) && isSpace(*cursor))
+	{
+		cursor++;
+	}
+	if ((cursor < end) && ((*cursor == '+') || (*cursor == '-')))
+	{
+		isNegative = (*cursor == '-');
+		cursor++;
+	}
+
+	/*
+	 *	Accumulate the digits of the integer and fractional parts into one significand,
+	 *	skipping leading zeros, and track the decimal exponent of its last digit.
+	 */
+	digitsStart = cursor;
+	while ((cursor < end) && isDigit(*cursor))
+	{
+		if (numberOfSignificantDigits < kCSVScannerMaxSignificantDigits)
+		{
+			significand = 10 * significand + (uint64_t)(*cursor - '0');
+			numberOfSignificantDigits += (significand != 0);
+		}
+		else
+		{
+			isTruncated = true;
+		}
+		cursor++;
+	}
+
+	/*
+	 *	Hexadecimal numbers are left to `strtod()`.
+	 */
+	if ((cursor == digitsStart + 1) && (*digitsStart == '0') && (cursor < end) && ((*cursor | 0x20) == 'x'))
+	{
+		return parseDoubleWithStrtod(start, end, value);
+	}
+
+	if ((cursor < end) && (*cursor == '.'))
+	{
+		cursor++;
+		while ((cursor < end) && isDigit(*cursor))
+		{
+			if (numberOfSignificantDigits < kCSVScannerMaxSignificantDigits)
+			{
+				significand = 10 * significand + (uint64_t)(*cursor - '0');
+				numberOfSignificantDigits += (significand != 0);
+				exponent--;
+			}
+			else
+			{
+				isTruncated = true;
+			}
+			cursor++;
+		}
+	}
+
+	/*
+	 *	Without digits, this is either not a number or an infinity or NaN.
+	 */
+	if ((cursor == digitsStart) || ((cursor == digitsStart + 1) && (*digitsStart == '.')))
+	{
+		return parseDoubleWithStrtod(start, end, value);
+	}
+
+	/*
+	 *	An exponent marker only belongs to the number if digits follow it.
+	 */
+	if ((cursor < end) && ((*cursor | 0x20) == 'e'))
+	{
+		const char *	exponentCursor = cursor + 1;
+		bool		isExponentNegative = false;
+		int		explicitExponent = 0;
+
+		if ((exponentCursor < end) && ((*exponentCursor == '+') || (*exponentCursor == '-')))
+		{
+			isExponentNegative = (*exponentCursor == '-');
+			exponentCursor++;
+		}
+		if ((exponentCursor < end) && isDigit(*exponentCursor))
+		{
+			while ((exponentCursor < end) && isDigit(*exponentCursor))
+			{
+				if (explicitExponent < 100000)
+				{
+					explicitExponent = 10 * explicitExponent + (*exponentCursor - '0');
+				}
+				exponentCursor++;
+			}
+			exponent += isExponentNegative ? -explicitExponent : explicitExponent;
+			cursor = exponentCursor;
+		}
+	}
+
+	/*
+	 *	Clinger's fast path: an exact significand times or divided by an exact power of
+	 *	ten is correctly rounded by one floating-point operation.
+	 */
+	if (isTruncated || (significand > kCSVScannerMaxExactSignificand) || (exponent < -22) || (exponent > 22))
+	{
+		return parseDoubleWithStrtod(start, end, value);
+	}
+
+	*value = (exponent < 0)
+			? (double)significand / kCSVScannerExactPowersOfTen[-exponent]
+			: (double)significand * kCSVScannerExactPowersOfTen[exponent];
+	if (isNegative)
+	{
+		*value = -*value;
+	}
+
+	return cursor;
+}
+
+/*
+ *	Bit `i` of the result is set if `block[i]` is a line feed.
+ */
+static inline uint64_t
+getLineFeedMask(const char *  block)
+{
+	uint64_t	mask = 0;
+
+#if kCSVScannerHasSSE2
+	const __m128i	lineFeeds = _mm_set1_epi8('\n');
+
+	for (size_t i = 0; i < kCSVScannerBytesPerBlock; i += 16)
+	{
+		__m128i	bytes = _mm_loadu_si128((const __m128i *)&block[i]);
+
+		mask |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, lineFeeds)) << i;
+	}
+#else
+	for (size_t i = 0; i < kCSVScannerBytesPerBlock; i++)
+	{
+		mask |= (uint64_t)(block[i] == '\n') << i;
+	}
+#endif
+
+	return mask;
+}
+
+static inline size_t
+countTrailingZeros(uint64_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return (size_t)__builtin_ctzll(mask);
+#else
+	size_t	count = 0;
+
+	while ((mask & 1) == 0)
+	{
+		mask >>= 1;
+		count++;
+	}
+
+	return count;
+#endif
+}
+
+/*
+ *	Parses one line into the next item of the chunk. Returns `false` on an error.
+ */
+static bool
+scanLine(CSVScannerChunk *  chunk, const char *  line, const char *  lineEnd)
+{
+	bool	isItem;
+
+	chunk->numberOfLines++;
+
+	if (chunk->numberOfItems == chunk->capacity)
+	{
+		size_t		newCapacity = (chunk->capacity == 0) ? 1024 : 2 * chunk->capacity;
+		unsigned char *	newItems = realloc(chunk->items, newCapacity * chunk->itemSize);
+
+		if (newItems == NULL)
+		{
+			chunk->hasError = true;
+
+			return false;
+		}
+		chunk->items = newItems;
+		chunk->capacity = newCapacity;
+	}
+
+	if (chunk->parseLine(line, lineEnd, &chunk->items[chunk->numberOfItems * chunk->itemSize], &isItem) != kCommonConstantReturnTypeSuccess)
+	{
+		chunk->hasError = true;
+		chunk->hasMalformedLine = true;
+
+		return false;
+	}
+	chunk->numberOfItems += isItem;
+
+	return true;
+}
+
+static void
+scanChunk(CSVScannerChunk *  chunk)
+{
+	const char *	line = chunk->begin;
+	const char *	block = chunk->begin;
+	const char *	lineFeed;
+
+	/*
+	 *	Find the line feeds a block at a time, and parse the lines that end in each block.
+	 */
+	while ((size_t)(chunk->end - block) >= kCSVScannerBytesPerBlock)
+	{
+		uint64_t	mask = getLineFeedMask(block);
+
+		while (mask != 0)
+		{
+			lineFeed = &block[countTrailingZeros(mask)];
+			mask &= mask - 1;
+
+			if (!scanLine(chunk, line, lineFeed))
+			{
+				return;
+			}
+			line = lineFeed + 1;
+		}
+		block += kCSVScannerBytesPerBlock;
+	}
+
+	while ((lineFeed = memchr(block, '\n', (size_t)(chunk->end - block))) != NULL)
+	{
+		if (!scanLine(chunk, line, lineFeed))
+		{
+			return;
+		}
+		line = block = lineFeed + 1;
+	}
+
+	/*
+	 *	The last line of the file may not end in a line feed.
+	 */
+	if (line < chunk->end)
+	{
+		scanLine(chunk, line, chunk->end);
+	}
+
+	return;
+}
+
+#if kCSVScannerHasThreads
+static void *
+csvScannerThreadMain(void *  argument)
+{
+	scanChunk(argument);
+
+	return NULL;
+}
+#endif
+
+/*
+ *	Maps the file, or reads it into memory if it cannot be mapped, e.g., if it is a pipe.
+ */
+static CommonConstantReturnType
+loadFile(const char *  filePath, char **  text, size_t *  size, bool *  isMemoryMapped)
+{
+	struct stat	fileStatus;
+	int		fileDescriptor = open(filePath, O_RDONLY);
+	size_t		capacity = 0;
+	ssize_t		length;
+
+	*text = NULL;
+	*size = 0;
+	*isMemoryMapped = false;
+
+	if ((fileDescriptor < 0) || (fstat(fileDescriptor, &fileStatus) != 0))
+	{
+		fprintf(stderr, "Error: Could not open the input file \"%s\": %s.\n", filePath, strerror(errno));
+		if (fileDescriptor >= 0)
+		{
+			close(fileDescriptor);
+		}
+
+		return kCommonConstantReturnTypeError;
+	}
+
+#if kCSVScannerHasMemoryMapping
+	if (S_ISREG(fileStatus.st_mode) && (fileStatus.st_size > 0))
+	{
+		void *	mapping = mmap(NULL, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+		if (mapping != MAP_FAILED)
+		{
+			*text = mapping;
+			*size = (size_t)fileStatus.st_size;
+			*isMemoryMapped = true;
+			close(fileDescriptor);
+
+			return kCommonConstantReturnTypeSuccess;
+		}
+	}
+#endif
+
+	do
+	{
+		if (*size == capacity)
+		{
+			size_t	newCapacity = (capacity == 0) ? (1 << 16) : 2 * capacity;
+			char *	newText = realloc(*text, newCapacity);
+
+			if (newText == NULL)
+			{
+				fprintf(stderr, "Error: Could not allocate memory for the input file.\n");
+				free(*text);
+				close(fileDescriptor);
+
+				return kCommonConstantReturnTypeError;
+			}
+			*text = newText;
+			capacity = newCapacity;
+		}
+
+		length = read(fileDescriptor, &(*text)[*size], capacity - *size);
+		if ((length < 0) && (errno != EINTR))
+		{
+			fprintf(stderr, "Error: Could not read the input file \"%s\": %s.\n", filePath, strerror(errno));
+			free(*text);
+			close(fileDescriptor);
+
+			return kCommonConstantReturnTypeError;
+		}
+		*size += (length > 0) ? (size_t)length : 0;
+	} while (length != 0);
+	close(fileDescriptor);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Cuts the file into chunks of about equal size. Each chunk starts at the first line that
+ *	starts at or after its nominal start, so every line belongs to exactly one chunk.
+ */
+static void
+cutChunks(const char *  text, size_t size, CSVScannerChunk *  chunks, size_t numberOfChunks)
+{
+	for (size_t k = 0; k < numberOfChunks; k++)
+	{
+		size_t	begin = 0;
+
+		if (k > 0)
+		{
+			size_t		nominalBegin = (size_t)(((double)k / (double)numberOfChunks) * (double)size);
+			const char *	lineFeed = memchr(&text[nominalBegin - 1], '\n', size - nominalBegin + 1);
+			size_t		previousBegin = (size_t)(chunks[k - 1].begin - text);
+
+			begin = (lineFeed != NULL) ? (size_t)(lineFeed - text) + 1 : size;
+			begin = (begin > previousBegin) ? begin : previousBegin;
+			chunks[k - 1].end = &text[begin];
+		}
+
+		chunks[k].begin = &text[begin];
+		chunks[k].end = &text[size];
+	}
+
+	return;
+}
+
+static void
+scanChunks(CSVScannerChunk *  chunks, size_t numberOfChunks)
+{
+#if kCSVScannerHasThreads
+	pthread_t	threads[kCSVScannerMaxChunks];
+	bool		isThreadStarted[kCSVScannerMaxChunks];
+
+	/*
+	 *	The calling thread scans the first chunk, and any chunk whose thread did not start.
+	 */
+	for (size_t k = 1; k < numberOfChunks; k++)
+	{
+		isThreadStarted[k] = (pthread_create(&threads[k], NULL, csvScannerThreadMain, &chunks[k]) == 0);
+	}
+
+	scanChunk(&chunks[0]);
+
+	for (size_t k = 1; k < numberOfChunks; k++)
+	{
+		if (isThreadStarted[k])
+		{
+			pthread_join(threads[k], NULL);
+		}
+		else
+		{
+			scanChunk(&chunks[k]);
+		}
+	}
+#else
+	for (size_t k = 0; k < numberOfChunks; k++)
+	{
+		scanChunk(&chunks[k]);
+	}
+#endif
+
+	return;
+}
+
+/*
+ *	Reports the first error in file order, numbering its line across the chunks, or else
+ *	returns the items of all chunks in order. The arrays of the chunks are left to the caller.
+ */
+static CommonConstantReturnType
+collectItems(
+	CSVScannerChunk *	chunks,
+	size_t			numberOfChunks,
+	size_t			itemSize,
+	void **			items,
+	size_t *		numberOfItems,
+	size_t *		errorLineNumber)
+{
+	size_t		totalNumberOfItems = 0;
+	size_t		numberOfPrecedingLines = 0;
+	unsigned char *	allItems;
+
+	for (size_t k = 0; k < numberOfChunks; k++)
+	{
+		if (chunks[k].hasMalformedLine)
+		{
+			*errorLineNumber = numberOfPrecedingLines + chunks[k].numberOfLines;
+
+			return kCommonConstantReturnTypeError;
+		}
+		if (chunks[k].hasError)
+		{
+			fprintf(stderr, "Error: Could not allocate memory for the items of the input file.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+		numberOfPrecedingLines += chunks[k].numberOfLines;
+		totalNumberOfItems += chunks[k].numberOfItems;
+	}
+
+	/*
+	 *	The array of a single chunk is returned as it is.
+	 */
+	if (numberOfChunks == 1)
+	{
+		*items = chunks[0].items;
+		*numberOfItems = totalNumberOfItems;
+		chunks[0].items = NULL;
+
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	allItems = malloc(((totalNumberOfItems > 0) ? totalNumberOfItems : 1) * itemSize);
+	if (allItems == NULL)
+	{
+		fprintf(stderr, "Error: Could not allocate memory for the items of the input file.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t k = 0, offset = 0; k < numberOfChunks; k++)
+	{
+		if (chunks[k].numberOfItems > 0)
+		{
+			memcpy(&allItems[offset * itemSize], chunks[k].items, chunks[k].numberOfItems * itemSize);
+			offset += chunks[k].numberOfItems;
+		}
+	}
+
+	*items = allItems;
+	*numberOfItems = totalNumberOfItems;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+csvScannerReadFile(
+	const char *		filePath,
+	size_t			numberOfThreads,
+	size_t			itemSize,
+	CSVScannerLineParser	parseLine,
+	void **			items,
+	size_t *		numberOfItems,
+	size_t *		errorLineNumber)
+{
+	char *				text;
+	size_t				size;
+	bool				isMemoryMapped;
+	size_t				numberOfChunks;
+	CSVScannerChunk *		chunks;
+	CommonConstantReturnType	result = kCommonConstantReturnTypeError;
+
+	*errorLineNumber = 0;
+
+	if (loadFile(filePath, &text, &size, &isMemoryMapped))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	numberOfChunks = size / kCSVScannerMinimumBytesPerChunk;
+	numberOfChunks = (numberOfChunks < numberOfThreads) ? numberOfChunks : numberOfThreads;
+	numberOfChunks = (numberOfChunks < kCSVScannerMaxChunks) ? numberOfChunks : kCSVScannerMaxChunks;
+	numberOfChunks = (numberOfChunks > 0) ? numberOfChunks : 1;
+
+	chunks = calloc(numberOfChunks, sizeof(CSVScannerChunk));
+	if (chunks == NULL)
+	{
+		fprintf(stderr, "Error: Could not allocate memory for the chunks of the input file.\n");
+	}
+	else
+	{
+		for (size_t k = 0; k < numberOfChunks; k++)
+		{
+			chunks[k].itemSize = itemSize;
+			chunks[k].parseLine = parseLine;
+		}
+
+		cutChunks(text, size, chunks, numberOfChunks);
+		scanChunks(chunks, numberOfChunks);
+		result = collectItems(chunks, numberOfChunks, itemSize, items, numberOfItems, errorLineNumber);
+
+		for (size_t k = 0; k < numberOfChunks; k++)
+		{
+			free(chunks[k].items);
+		}
+		free(chunks);
+	}
+
+#if kCSVScannerHasMemoryMapping
+	if (isMemoryMapped)
+	{
+		munmap(text, size);
+	}
+	else
+#endif
+	{
+		free(text);
+	}
+
+	return result;
+}
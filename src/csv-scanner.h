@@ -0,0 +1,93 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "common.h"
+
+/*
+ *	Scanner for large CSV files. The file is memory-mapped and cut into one chunk per
+ *	thread at line boundaries; each thread finds the line ends of its chunk 64 bytes at a
+ *	time with SIMD compares, and parses each line into a fixed-size item with a callback.
+ *	The items are returned in file order, as if the file had been parsed by one thread.
+ */
+typedef enum
+{
+	kCSVScannerBytesPerBlock	= 64,
+
+	/*
+	 *	Files are only cut into chunks of at least this size, so that small files are
+	 *	parsed by one thread.
+	 */
+	kCSVScannerMinimumBytesPerChunk	= 1 << 20,
+	kCSVScannerMaxChunks		= 256,
+
+	/*
+	 *	Longest number handed to `strtod()` by `csvScannerParseDouble()`.
+	 */
+	kCSVScannerMaxNumberLength	= 128,
+} CSVScannerConstant;
+
+/*
+ *	Parses the line [line, lineEnd), without its line feed, into `item`. Sets `isItem` to
+ *	whether the line holds an item, and returns `kCommonConstantReturnTypeError` if the line
+ *	is malformed.
+ */
+typedef CommonConstantReturnType	(*CSVScannerLineParser)(const char *  line, const char *  lineEnd, void *  item, bool *  isItem);
+
+/**
+ *	@brief	Parses a decimal number at the start of [cursor, end), as `strtod()` would but
+ *		without reading past `end`. Plain decimals whose significand fits in 19 digits and
+ *		whose value is exact in double precision times a power of ten up to 10^22 take a
+ *		fast path, which is correctly rounded; other numbers, including hexadecimal ones,
+ *		infinities and NaNs, fall back to `strtod()`.
+ *
+ *	@param	cursor	: Start of the text.
+ *	@param	end	: End of the text.
+ *	@param	value	: Pointer to the value, written by the function if a number was parsed.
+ *	@return		: Pointer past the number, or `cursor` if there is none.
+ */
+const char *	csvScannerParseDouble(const char *  cursor, const char *  end, double *  value);
+
+/**
+ *	@brief	Reads all the items of a CSV file, in parallel.
+ *
+ *	@param	filePath		: Path of the file.
+ *	@param	numberOfThreads		: The most threads to parse with.
+ *	@param	itemSize		: Size of an item in bytes.
+ *	@param	parseLine		: Parser of one line, called concurrently from the threads.
+ *	@param	items			: Pointer where the dynamically-allocated array of items is returned. Free with `free()`.
+ *	@param	numberOfItems		: Pointer where the number of items is returned.
+ *	@param	errorLineNumber		: Pointer where the 1-based number of the first malformed line is returned, or 0 for other errors.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	csvScannerReadFile(
+					const char *		filePath,
+					size_t			numberOfThreads,
+					size_t			itemSize,
+					CSVScannerLineParser	parseLine,
+					void **			items,
+					size_t *		numberOfItems,
+					size_t *		errorLineNumber);
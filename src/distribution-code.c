@@ -0,0 +1,367 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "distribution-code.h"
+
+static const char	kDistributionCodeBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/*
+ *	The decoded quantile function interpolates linearly between the knots 0, ..., N + 1:
+ *	the minimum at probability 0, the stored quantiles at (k - 1/2) / N, and the maximum
+ *	at probability 1.
+ */
+static double
+getKnotProbability(size_t knot)
+{
+	if (knot == 0)
+	{
+		return 0.0;
+	}
+	if (knot > kDistributionCodeNumberOfQuantiles)
+	{
+		return 1.0;
+	}
+
+	return ((double)knot - 0.5) / kDistributionCodeNumberOfQuantiles;
+}
+
+static double
+getKnotValue(const DistributionCode *  code, size_t knot)
+{
+	if (knot == 0)
+	{
+		return code->minimum;
+	}
+	if (knot > kDistributionCodeNumberOfQuantiles)
+	{
+		return code->maximum;
+	}
+
+	return (double)code->minimum + ((double)code->maximum - (double)code->minimum) * code->quantiles[knot - 1] * (1.0 / UINT16_MAX);
+}
+
+/*
+ *	Sets the support, rounded outwards to float32, so that it still contains all values.
+ */
+static void
+setSupport(DistributionCode *  code, double minimum, double maximum)
+{
+	code->minimum = (float)minimum;
+	code->maximum = (float)maximum;
+	if ((double)code->minimum > minimum)
+	{
+		code->minimum = nextafterf(code->minimum, -INFINITY);
+	}
+	if ((double)code->maximum < maximum)
+	{
+		code->maximum = nextafterf(code->maximum, INFINITY);
+	}
+
+	return;
+}
+
+static uint16_t
+quantizeValue(const DistributionCode *  code, double value)
+{
+	double	width = (double)code->maximum - (double)code->minimum;
+	double	fraction = (width > 0.0) ? (value - (double)code->minimum) / width : 0.0;
+
+	return (uint16_t)lround(fmin(fmax(fraction, 0.0), 1.0) * UINT16_MAX);
+}
+
+void
+distributionCodeEncodeSortedSamples(DistributionCode *  code, const double *  sortedSamples, size_t numberOfSamples)
+{
+	double	sumOfAbsoluteErrors = 0.0;
+
+	setSupport(code, sortedSamples[0], sortedSamples[numberOfSamples - 1]);
+
+	/*
+	 *	Sample quantiles interpolate between the order statistics, the j-th of which is at
+	 *	probability (j + 1/2) / n.
+	 */
+	for (size_t i = 0; i < kDistributionCodeNumberOfQuantiles; i++)
+	{
+		double	position = fmin(fmax(getKnotProbability(i + 1) * (double)numberOfSamples - 0.5, 0.0), (double)(numberOfSamples - 1));
+		size_t	lower = (size_t)position;
+		size_t	upper = (lower + 1 < numberOfSamples) ? lower + 1 : lower;
+		double	fraction = position - (double)lower;
+
+		code->quantiles[i] = quantizeValue(code, sortedSamples[lower] + fraction * (sortedSamples[upper] - sortedSamples[lower]));
+	}
+
+	/*
+	 *	The 1-Wasserstein distance is the integral of the difference of the quantile
+	 *	functions, with the empirical one constant between order statistics.
+	 */
+	for (size_t j = 0; j < numberOfSamples; j++)
+	{
+		sumOfAbsoluteErrors += fabs(sortedSamples[j] - distributionCodeGetQuantile(code, ((double)j + 0.5) / (double)numberOfSamples));
+	}
+	code->wassersteinError = (float)(sumOfAbsoluteErrors / (double)numberOfSamples);
+
+	return;
+}
+
+void
+distributionCodeEncodeDistributionFunction(
+	DistributionCode *	code,
+	double			(*distributionFunction)(const void *  context, double value),
+	const void *		context,
+	double			minimum,
+	double			maximum)
+{
+	double	step = (maximum - minimum) / kDistributionCodeGridSize;
+	double	probabilities[kDistributionCodeGridSize + 1];
+	double	integral = 0.0;
+	size_t	cell = 1;
+
+	setSupport(code, minimum, maximum);
+
+	for (size_t k = 0; k <= kDistributionCodeGridSize; k++)
+	{
+		probabilities[k] = distributionFunction(context, minimum + (double)k * step);
+	}
+
+	/*
+	 *	Each quantile lies in the first cell of the grid whose upper end reaches its
+	 *	probability, which only moves up with the probability, and is refined by bisection
+	 *	within the cell.
+	 */
+	for (size_t i = 0; i < kDistributionCodeNumberOfQuantiles; i++)
+	{
+		double	probability = getKnotProbability(i + 1);
+		double	low;
+		double	high;
+
+		while ((cell < kDistributionCodeGridSize) && (probabilities[cell] < probability))
+		{
+			cell++;
+		}
+		low = minimum + (double)(cell - 1) * step;
+		high = minimum + (double)cell * step;
+
+		for (size_t iteration = 0; iteration < kDistributionCodeBisectionSteps; iteration++)
+		{
+			double	middle = (low + high) / 2.0;
+
+			if (distributionFunction(context, middle) < probability)
+			{
+				low = middle;
+			}
+			else
+			{
+				high = middle;
+			}
+		}
+
+		code->quantiles[i] = quantizeValue(code, (low + high) / 2.0);
+	}
+
+	/*
+	 *	The 1-Wasserstein distance is also the integral of the difference of the distribution
+	 *	functions, here by the trapezoidal rule on the grid.
+	 */
+	for (size_t k = 0; k <= kDistributionCodeGridSize; k++)
+	{
+		double	weight = ((k == 0) || (k == kDistributionCodeGridSize)) ? 0.5 : 1.0;
+
+		integral += weight * fabs(probabilities[k] - distributionCodeGetDistributionFunction(code, minimum + (double)k * step)) * step;
+	}
+	code->wassersteinError = (float)integral;
+
+	return;
+}
+
+double
+distributionCodeGetQuantile(const DistributionCode *  code, double probability)
+{
+	double	position = fmin(fmax(probability, 0.0), 1.0) * kDistributionCodeNumberOfQuantiles + 0.5;
+	size_t	knot = (size_t)position;
+	double	lowerProbability;
+	double	upperProbability;
+
+	/*
+	 *	`position` is the knot index for the stored quantiles, and the first and last
+	 *	segments are half as wide in probability as the others.
+	 */
+	if (knot > kDistributionCodeNumberOfQuantiles)
+	{
+		knot = kDistributionCodeNumberOfQuantiles;
+	}
+	lowerProbability = getKnotProbability(knot);
+	upperProbability = getKnotProbability(knot + 1);
+
+	return getKnotValue(code, knot)
+		+ (getKnotValue(code, knot + 1) - getKnotValue(code, knot)) * (probability - lowerProbability) / (upperProbability - lowerProbability);
+}
+
+double
+distributionCodeGetDistributionFunction(const DistributionCode *  code, double value)
+{
+	size_t	low = 0;
+	size_t	high = kDistributionCodeNumberOfQuantiles + 1;
+
+	if (value < (double)code->minimum)
+	{
+		return 0.0;
+	}
+	if (value >= (double)code->maximum)
+	{
+		return 1.0;
+	}
+
+	/*
+	 *	Find the last knot at or below `value` by bisection over the knots, which are in
+	 *	ascending order. The knot after it is then above `value`.
+	 */
+	while (high - low > 1)
+	{
+		size_t	middle = (low + high) / 2;
+
+		if (getKnotValue(code, middle) <= value)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	return getKnotProbability(low)
+		+ (getKnotProbability(high) - getKnotProbability(low)) * (value - getKnotValue(code, low)) / (getKnotValue(code, high) - getKnotValue(code, low));
+}
+
+static void
+putFloat32(uint8_t *  bytes, float value)
+{
+	uint32_t	bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+	for (size_t i = 0; i < 4; i++)
+	{
+		bytes[i] = (uint8_t)(bits >> (8 * i));
+	}
+
+	return;
+}
+
+static float
+getFloat32(const uint8_t *  bytes)
+{
+	uint32_t	bits = 0;
+	float		value;
+
+	for (size_t i = 0; i < 4; i++)
+	{
+		bits |= (uint32_t)bytes[i] << (8 * i);
+	}
+	memcpy(&value, &bits, sizeof(value));
+
+	return value;
+}
+
+void
+distributionCodeToBase64(const DistributionCode *  code, char *  text)
+{
+	uint8_t	bytes[kDistributionCodeSizeInBytes + 2] = {0};
+	size_t	length = 0;
+
+	putFloat32(&bytes[0], code->minimum);
+	putFloat32(&bytes[4], code->maximum);
+	putFloat32(&bytes[8], code->wassersteinError);
+	for (size_t i = 0; i < kDistributionCodeNumberOfQuantiles; i++)
+	{
+		bytes[12 + 2 * i] = (uint8_t)code->quantiles[i];
+		bytes[12 + 2 * i + 1] = (uint8_t)(code->quantiles[i] >> 8);
+	}
+
+	for (size_t i = 0; i < kDistributionCodeSizeInBytes; i += 3)
+	{
+		uint32_t	group = ((uint32_t)bytes[i] << 16) | ((uint32_t)bytes[i + 1] << 8) | bytes[i + 2];
+
+		text[length++] = kDistributionCodeBase64Alphabet[(group >> 18) & 0x3F];
+		text[length++] = kDistributionCodeBase64Alphabet[(group >> 12) & 0x3F];
+		text[length++] = (i + 1 < kDistributionCodeSizeInBytes) ? kDistributionCodeBase64Alphabet[(group >> 6) & 0x3F] : '=';
+		text[length++] = (i + 2 < kDistributionCodeSizeInBytes) ? kDistributionCodeBase64Alphabet[group & 0x3F] : '=';
+	}
+	text[length] = '\0';
+
+	return;
+}
+
+CommonConstantReturnType
+distributionCodeFromBase64(DistributionCode *  code, const char *  text)
+{
+	uint8_t	bytes[kDistributionCodeSizeInBytes + 2] = {0};
+	size_t	numberOfBytes = 0;
+
+	if (strlen(text) != kDistributionCodeBase64Length)
+	{
+		fprintf(stderr, "Error: A distribution code must be %d base64 characters.\n", kDistributionCodeBase64Length);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t i = 0; i < kDistributionCodeBase64Length; i += 4)
+	{
+		uint32_t	group = 0;
+
+		for (size_t j = 0; j < 4; j++)
+		{
+			const char *	digit = (text[i + j] != '\0') ? strchr(kDistributionCodeBase64Alphabet, text[i + j]) : NULL;
+
+			if ((digit == NULL) && !((text[i + j] == '=') && (numberOfBytes + j > kDistributionCodeSizeInBytes)))
+			{
+				fprintf(stderr, "Error: A distribution code has an invalid base64 character.\n");
+
+				return kCommonConstantReturnTypeError;
+			}
+			group = (group << 6) | ((digit != NULL) ? (uint32_t)(digit - kDistributionCodeBase64Alphabet) : 0);
+		}
+
+		for (size_t j = 0; (j < 3) && (numberOfBytes < kDistributionCodeSizeInBytes); j++)
+		{
+			bytes[numberOfBytes++] = (uint8_t)(group >> (16 - 8 * j));
+		}
+	}
+
+	code->minimum = getFloat32(&bytes[0]);
+	code->maximum = getFloat32(&bytes[4]);
+	code->wassersteinError = getFloat32(&bytes[8]);
+	for (size_t i = 0; i < kDistributionCodeNumberOfQuantiles; i++)
+	{
+		code->quantiles[i] = (uint16_t)(bytes[12 + 2 * i] | (bytes[12 + 2 * i + 1] << 8));
+	}
+
+	if (!(code->minimum <= code->maximum))
+	{
+		fprintf(stderr, "Error: A distribution code has an invalid support.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
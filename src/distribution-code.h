@@ -0,0 +1,130 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "common.h"
+
+/*
+ *	Compact fixed-size encoding of a univariate distribution: its support and its quantiles
+ *	at the probabilities (i + 1/2) / N, i = 0, ..., N - 1. Equally-weighted atoms at these
+ *	quantiles are the N-point Dirac mixture closest to the distribution in the 1-Wasserstein
+ *	distance, and the decoded distribution interpolates linearly between them and the ends of
+ *	the support. Each quantile is stored as a 16-bit fraction of the support, which resolves
+ *	1/65535 of it, finer than a float16 value for any support narrower than 2000 times its
+ *	distance from zero. The code also carries its own 1-Wasserstein error, measured at encode
+ *	time against the samples or the closed form it was encoded from.
+ */
+typedef enum
+{
+	kDistributionCodeNumberOfQuantiles	= 32,
+
+	/*
+	 *	Serialized size: the minimum, maximum and error as float32, then the quantiles,
+	 *	all little-endian.
+	 */
+	kDistributionCodeSizeInBytes		= 3 * 4 + 2 * kDistributionCodeNumberOfQuantiles,
+	kDistributionCodeBase64Length		= ((kDistributionCodeSizeInBytes + 2) / 3) * 4,
+
+	/*
+	 *	Cells of the grid on which a closed form is evaluated, to bracket its quantiles
+	 *	and integrate its 1-Wasserstein error, and bisection steps per quantile within a
+	 *	cell, which resolve 2^-16 of the support, the step of the quantized quantiles.
+	 */
+	kDistributionCodeGridSize		= 256,
+	kDistributionCodeBisectionSteps		= 8,
+} DistributionCodeConstant;
+
+typedef struct
+{
+	float		minimum;
+	float		maximum;
+	float		wassersteinError;
+	uint16_t	quantiles[kDistributionCodeNumberOfQuantiles];
+} DistributionCode;
+
+/**
+ *	@brief	Encodes the empirical distribution of samples, and measures the 1-Wasserstein
+ *		distance between it and the decoded code.
+ *
+ *	@param	code			: Pointer to the code to write.
+ *	@param	sortedSamples		: Array of samples in ascending order.
+ *	@param	numberOfSamples		: The number of samples, at least one.
+ */
+void	distributionCodeEncodeSortedSamples(DistributionCode *  code, const double *  sortedSamples, size_t numberOfSamples);
+
+/**
+ *	@brief	Encodes a continuous distribution given by its distribution function on a bounded
+ *		support, bracketing each quantile on a grid and refining it by bisection, and
+ *		measures the 1-Wasserstein distance between it and the decoded code as the
+ *		integral of the difference of the two distribution functions on the grid.
+ *
+ *	@param	code			: Pointer to the code to write.
+ *	@param	distributionFunction	: The distribution function.
+ *	@param	context			: Context passed to `distributionFunction`.
+ *	@param	minimum			: Lower end of the support.
+ *	@param	maximum			: Upper end of the support.
+ */
+void	distributionCodeEncodeDistributionFunction(
+		DistributionCode *	code,
+		double			(*distributionFunction)(const void *  context, double value),
+		const void *		context,
+		double			minimum,
+		double			maximum);
+
+/**
+ *	@brief	Gets a quantile of the decoded distribution.
+ *
+ *	@param	code		: Pointer to the code.
+ *	@param	probability	: The probability, in [0, 1].
+ *	@return			: The quantile.
+ */
+double	distributionCodeGetQuantile(const DistributionCode *  code, double probability);
+
+/**
+ *	@brief	Gets the distribution function of the decoded distribution at a value.
+ *
+ *	@param	code	: Pointer to the code.
+ *	@param	value	: The value.
+ *	@return		: The probability that the decoded distribution is at most `value`.
+ */
+double	distributionCodeGetDistributionFunction(const DistributionCode *  code, double value);
+
+/**
+ *	@brief	Serializes a code into `kDistributionCodeSizeInBytes` bytes and writes them in
+ *		base64, for text outputs.
+ *
+ *	@param	code	: Pointer to the code.
+ *	@param	text	: Buffer of at least `kDistributionCodeBase64Length + 1` characters.
+ */
+void	distributionCodeToBase64(const DistributionCode *  code, char *  text);
+
+/**
+ *	@brief	Parses a code from its base64 serialization.
+ *
+ *	@param	code	: Pointer to the code to write.
+ *	@param	text	: The base64 text.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	distributionCodeFromBase64(DistributionCode *  code, const char *  text);
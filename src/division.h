@@ -0,0 +1,123 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+/*
+ *	Division with selectable accuracy, for the ratiometric voltages of the conversion.
+ *
+ *	The faster tiers multiply by a reciprocal of the denominator, computed once and shared
+ *	by all numerators. The reciprocal starts from the linear minimax approximation of `1/x`
+ *	over [kDivisionDenominatorLow, kDivisionDenominatorHigh], which has a relative error of
+ *	at most 5.0e-3 there, and each Newton-Raphson step squares that error. Like the
+ *	psychrometric approximations, this uses plain arithmetic only, so it also runs on
+ *	distributional values on Signaloid cores.
+ *
+ *	Measured on an x86-64 Xeon with GCC 12 and -O3 -fno-math-errno -fno-trapping-math.
+ *	Errors are over 10^8 quotients, with the numerators and denominators drawn from the
+ *	default input distributions. Throughput is in pairs of quotients that share one
+ *	denominator, per ns, with SSE2 and with -march=native (AVX-512 and FMA):
+ *
+ *		Tier			Max. error (SSE2)	Max. error (FMA)	Pairs/ns (SSE2)	Pairs/ns (AVX-512)
+ *		Exact			0.5 ULP			0.5 ULP			0.59		0.68
+ *		RefinedReciprocal	1.33 ULP		0.503 ULP		0.39		1.83
+ *		LowPrecision		2.5e-5			2.5e-5			0.85		1.87
+ *
+ *	The refined tier only pays off where FMA is available. A relative error of 2.5e-5 in
+ *	`Vrh / Vsupply` is at most 1.6e-3 %RH in the calibrated humidity, well below the
+ *	uncertainty of the inputs. Outside the domain the error grows, for example to 1.2e-2
+ *	(LowPrecision) and 2.3e-8 (RefinedReciprocal) at 3.3 V.
+ */
+
+/*
+ *	Domain of the initial approximation: a 5 V supply with a 10 % tolerance.
+ */
+#define kDivisionDenominatorLow		(4.5)
+#define kDivisionDenominatorHigh	(5.5)
+
+typedef enum
+{
+	kDivisionAccuracyTierExact		= 0,
+	kDivisionAccuracyTierRefinedReciprocal	= 1,
+	kDivisionAccuracyTierLowPrecision	= 2,
+	kDivisionAccuracyTierMax,
+} DivisionAccuracyTier;
+
+/**
+ *	@brief	Approximates the reciprocal of `denominator` for the faster accuracy tiers: two
+ *		Newton-Raphson steps for `kDivisionAccuracyTierRefinedReciprocal` (relative error
+ *		6.4e-10 over the domain), one step for `kDivisionAccuracyTierLowPrecision`.
+ *
+ *	@param	denominator	: The denominator.
+ *	@param	tier		: The accuracy tier. The exact tier does not use the reciprocal.
+ *	@return			: The approximate reciprocal.
+ */
+static inline double
+divisionApproximateReciprocal(double denominator, DivisionAccuracyTier tier)
+{
+	/*
+	 *	For p(x) = a - b x, the relative error 1 - x p(x) equioscillates at both ends of
+	 *	[l, h] and at its peak when b = 2 / (l h + (l + h)^2 / 4) and a = b (l + h).
+	 */
+	const double	b = 2.0 / (kDivisionDenominatorLow * kDivisionDenominatorHigh
+				+ (kDivisionDenominatorLow + kDivisionDenominatorHigh) * (kDivisionDenominatorLow + kDivisionDenominatorHigh) / 4.0);
+	const double	a = b * (kDivisionDenominatorLow + kDivisionDenominatorHigh);
+	double		reciprocal = a - b * denominator;
+
+	reciprocal = reciprocal + reciprocal * (1.0 - denominator * reciprocal);
+	if (tier == kDivisionAccuracyTierRefinedReciprocal)
+	{
+		reciprocal = reciprocal + reciprocal * (1.0 - denominator * reciprocal);
+	}
+
+	return reciprocal;
+}
+
+/**
+ *	@brief	Divides `numerator` by `denominator` with the given accuracy tier. The refined tier
+ *		corrects the product `numerator * reciprocal` with its residual, which brings the
+ *		quotient to within one ULP.
+ *
+ *	@param	numerator	: The numerator.
+ *	@param	denominator	: The denominator.
+ *	@param	reciprocal	: The result of `divisionApproximateReciprocal(denominator, tier)`. Unused by the exact tier.
+ *	@param	tier		: The accuracy tier.
+ *	@return			: The quotient.
+ */
+static inline double
+divisionQuotient(double numerator, double denominator, double reciprocal, DivisionAccuracyTier tier)
+{
+	double	quotient;
+
+	if (tier == kDivisionAccuracyTierExact)
+	{
+		return numerator / denominator;
+	}
+
+	quotient = numerator * reciprocal;
+	if (tier == kDivisionAccuracyTierRefinedReciprocal)
+	{
+		quotient = quotient + reciprocal * (numerator - quotient * denominator);
+	}
+
+	return quotient;
+}
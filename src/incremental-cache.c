@@ -0,0 +1,540 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "incremental-cache.h"
+#include "psychrometrics.h"
+
+static const char	kIncrementalCacheFileMagic[8] = {'S', 'G', 'I', 'N', 'C', 'R', 'C', '1'};
+static const uint32_t	kIncrementalCacheByteOrderMark = 0x01020304;
+static const char *	kIncrementalCacheColumnKindNames[kIncrementalCacheColumnKindMax] = {"input", "ratio", "output"};
+
+static uint64_t
+splitMix64(uint64_t *  state)
+{
+	uint64_t	z = (*state += 0x9E3779B97F4A7C15ULL);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+	return z ^ (z >> 31);
+}
+
+static uint64_t
+rotateLeft(uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t
+xoshiro256StarStar(uint64_t  state[4])
+{
+	uint64_t	result = rotateLeft(state[1] * 5, 7) * 9;
+	uint64_t	t = state[1] << 17;
+
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+	state[2] ^= t;
+	state[3] = rotateLeft(state[3], 45);
+
+	return result;
+}
+
+static uint64_t
+bitsOfDouble(double value)
+{
+	uint64_t	bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+
+	return bits;
+}
+
+/*
+ *	Key of a column from the words it depends on. It is not cryptographic: distinct
+ *	configurations are only expected to get distinct keys.
+ */
+static uint64_t
+hashWords(const uint64_t *  words, size_t numberOfWords)
+{
+	uint64_t	hash = kIncrementalCacheFileVersion ^ (numberOfWords * 0x9E3779B97F4A7C15ULL);
+
+	for (size_t i = 0; i < numberOfWords; i++)
+	{
+		hash = rotateLeft((hash ^ words[i]) * 0xFF51AFD7ED558CCDULL, 29);
+	}
+
+	return splitMix64(&hash);
+}
+
+static bool
+getColumnFilePath(
+	const IncrementalCache *	cache,
+	IncrementalCacheColumnKind	kind,
+	uint64_t			key,
+	bool				isTemporary,
+	char *				path)
+{
+	int	length = snprintf(
+				path,
+				kIncrementalCacheMaxCharsPerFilepath,
+				"%s/%s-%016" PRIx64 ".col%s",
+				cache->directoryPath,
+				kIncrementalCacheColumnKindNames[kind],
+				key,
+				isTemporary ? ".tmp" : "");
+
+	return (length > 0) && (length < kIncrementalCacheMaxCharsPerFilepath);
+}
+
+/*
+ *	Works out the key of every column, from the configuration of the inputs up to the outputs.
+ */
+static void
+setColumnKeys(IncrementalCache *  cache, uint64_t seed)
+{
+	IncrementalCacheColumn *	inputs = cache->columns[kIncrementalCacheColumnKindInput];
+	IncrementalCacheColumn *	ratios = cache->columns[kIncrementalCacheColumnKindRatio];
+	IncrementalCacheColumn *	outputs = cache->columns[kIncrementalCacheColumnKindOutput];
+	bool				isRatiometric = (cache->model->transfer == kSensorModelTransferRatiometric);
+
+	for (size_t input = 0; input < kInputDistributionIndexMax; input++)
+	{
+		uint64_t	words[] = {
+					kIncrementalCacheColumnKindInput,
+					input,
+					bitsOfDouble(cache->lowerBound[input]),
+					bitsOfDouble(cache->upperBound[input]),
+					seed,
+					cache->numberOfSamples,
+				};
+
+		inputs[input].key = hashWords(words, sizeof(words) / sizeof(words[0]));
+	}
+
+	/*
+	 *	The argument of an affine transfer function is the input itself, which does not
+	 *	depend on `Vsupply` or on the division.
+	 */
+	for (size_t input = 0; input < kInputDistributionIndexMax; input++)
+	{
+		uint64_t	words[] = {
+					kIncrementalCacheColumnKindRatio,
+					input,
+					inputs[input].key,
+					cache->model->transfer,
+					isRatiometric ? inputs[kInputDistributionIndexVsupply].key : 0,
+					isRatiometric ? cache->divisionAccuracyTier : 0,
+				};
+
+		ratios[input].key = hashWords(words, sizeof(words) / sizeof(words[0]));
+	}
+
+	for (size_t output = 0; output < kOutputDistributionIndexMax; output++)
+	{
+		if (output < kSensorModelChannelMax)
+		{
+			const SensorModelChannelTransfer *	channel = &cache->model->channels[output];
+			uint64_t				words[] = {
+									kIncrementalCacheColumnKindOutput,
+									output,
+									ratios[channel->input].key,
+									bitsOfDouble(channel->offset),
+									bitsOfDouble(channel->slope),
+								};
+
+			outputs[output].key = hashWords(words, sizeof(words) / sizeof(words[0]));
+		}
+		else
+		{
+			uint64_t	words[] = {
+						kIncrementalCacheColumnKindOutput,
+						output,
+						outputs[kOutputDistributionIndexCalibratedRelativeHumidity].key,
+						outputs[kOutputDistributionIndexCalibratedTemperatureCelcius].key,
+					};
+
+			outputs[output].key = hashWords(words, sizeof(words) / sizeof(words[0]));
+		}
+	}
+
+	return;
+}
+
+/*
+ *	Opens the file of a column if the cache holds it, and leaves it at its first sample.
+ */
+static bool
+openCachedColumn(IncrementalCache *  cache, IncrementalCacheColumnKind kind, IncrementalCacheColumn *  column)
+{
+	char				path[kIncrementalCacheMaxCharsPerFilepath];
+	IncrementalCacheFileHeader	header;
+	struct stat			fileStatus;
+	bool				isValid;
+
+	if (!getColumnFilePath(cache, kind, column->key, false, path))
+	{
+		return false;
+	}
+
+	column->file = fopen(path, "rb");
+	if (column->file == NULL)
+	{
+		return false;
+	}
+
+	isValid = (fread(&header, sizeof(header), 1, column->file) == 1)
+			&& (memcmp(header.magic, kIncrementalCacheFileMagic, sizeof(header.magic)) == 0)
+			&& (header.version == kIncrementalCacheFileVersion)
+			&& (header.byteOrderMark == kIncrementalCacheByteOrderMark)
+			&& (header.key == column->key)
+			&& (header.numberOfSamples == cache->numberOfSamples)
+			&& (fstat(fileno(column->file), &fileStatus) == 0)
+			&& ((uint64_t)fileStatus.st_size == sizeof(header) + cache->numberOfSamples * sizeof(double));
+
+	/*
+	 *	A damaged file is computed again, and replaced.
+	 */
+	if (!isValid)
+	{
+		fclose(column->file);
+		column->file = NULL;
+	}
+
+	return isValid;
+}
+
+static void
+markDependenciesNeeded(IncrementalCache *  cache, IncrementalCacheColumnKind kind, size_t index)
+{
+	IncrementalCacheColumn *	inputs = cache->columns[kIncrementalCacheColumnKindInput];
+	IncrementalCacheColumn *	ratios = cache->columns[kIncrementalCacheColumnKindRatio];
+	IncrementalCacheColumn *	outputs = cache->columns[kIncrementalCacheColumnKindOutput];
+
+	if (kind == kIncrementalCacheColumnKindRatio)
+	{
+		inputs[index].isNeeded = true;
+		inputs[kInputDistributionIndexVsupply].isNeeded |= (cache->model->transfer == kSensorModelTransferRatiometric);
+	}
+	else if ((kind == kIncrementalCacheColumnKindOutput) && (index < kSensorModelChannelMax))
+	{
+		ratios[cache->model->channels[index].input].isNeeded = true;
+	}
+	else if (kind == kIncrementalCacheColumnKindOutput)
+	{
+		outputs[kOutputDistributionIndexCalibratedRelativeHumidity].isNeeded = true;
+		outputs[kOutputDistributionIndexCalibratedTemperatureCelcius].isNeeded = true;
+	}
+
+	return;
+}
+
+/*
+ *	Closes the files of the columns, and adds the computed columns to the cache if `isComplete`,
+ *	else removes them. Returns false if a computed column could not be added.
+ */
+static bool
+closeColumns(IncrementalCache *  cache, bool isComplete)
+{
+	bool	isAdded = true;
+
+	for (size_t kind = 0; kind < kIncrementalCacheColumnKindMax; kind++)
+	{
+		for (size_t index = 0; index < kOutputDistributionIndexMax; index++)
+		{
+			IncrementalCacheColumn *	column = &cache->columns[kind][index];
+			char				temporaryPath[kIncrementalCacheMaxCharsPerFilepath];
+			char				path[kIncrementalCacheMaxCharsPerFilepath];
+
+			free(column->block);
+			column->block = NULL;
+			if (column->file == NULL)
+			{
+				continue;
+			}
+
+			if (column->isCached)
+			{
+				fclose(column->file);
+			}
+			else if (getColumnFilePath(cache, (IncrementalCacheColumnKind)kind, column->key, true, temporaryPath)
+				&& getColumnFilePath(cache, (IncrementalCacheColumnKind)kind, column->key, false, path))
+			{
+				bool	isWritten = (fclose(column->file) == 0);
+
+				if (!isComplete || !isWritten || (rename(temporaryPath, path) != 0))
+				{
+					remove(temporaryPath);
+					isAdded &= !isComplete;
+				}
+			}
+			column->file = NULL;
+		}
+	}
+
+	return isAdded;
+}
+
+CommonConstantReturnType
+incrementalCacheOpen(
+	IncrementalCache *	cache,
+	const char *		directoryPath,
+	const SensorModel *	model,
+	DivisionAccuracyTier	divisionAccuracyTier,
+	const double *		lowerBound,
+	const double *		upperBound,
+	uint64_t		seed,
+	uint64_t		numberOfSamples,
+	size_t			lowerOutput,
+	size_t			upperOutput)
+{
+	const size_t	numberOfColumns[kIncrementalCacheColumnKindMax] = {
+				[kIncrementalCacheColumnKindInput]	= kInputDistributionIndexMax,
+				[kIncrementalCacheColumnKindRatio]	= kInputDistributionIndexMax,
+				[kIncrementalCacheColumnKindOutput]	= kOutputDistributionIndexMax,
+			};
+	int		length;
+
+	memset(cache, 0, sizeof(*cache));
+	length = snprintf(cache->directoryPath, sizeof(cache->directoryPath), "%s", directoryPath);
+	if ((length < 0) || ((size_t)length >= sizeof(cache->directoryPath)))
+	{
+		fprintf(stderr, "Error: The incremental cache directory path is too long.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+	cache->model = model;
+	cache->divisionAccuracyTier = divisionAccuracyTier;
+	cache->numberOfSamples = numberOfSamples;
+	memcpy(cache->lowerBound, lowerBound, sizeof(cache->lowerBound));
+	memcpy(cache->upperBound, upperBound, sizeof(cache->upperBound));
+	setColumnKeys(cache, seed);
+
+	for (size_t output = lowerOutput; output < upperOutput; output++)
+	{
+		cache->columns[kIncrementalCacheColumnKindOutput][output].isNeeded = true;
+	}
+
+	/*
+	 *	Walk the graph from the outputs back to the inputs, so that only the columns that a
+	 *	column missing from the cache depends on are needed. The derived outputs come after
+	 *	the calibrated outputs that they depend on.
+	 */
+	for (size_t kind = kIncrementalCacheColumnKindMax; kind-- > 0;)
+	{
+		for (size_t index = numberOfColumns[kind]; index-- > 0;)
+		{
+			IncrementalCacheColumn *	column = &cache->columns[kind][index];
+
+			if (!column->isNeeded)
+			{
+				continue;
+			}
+
+			column->isCached = openCachedColumn(cache, (IncrementalCacheColumnKind)kind, column);
+			if (!column->isCached)
+			{
+				markDependenciesNeeded(cache, (IncrementalCacheColumnKind)kind, index);
+			}
+		}
+	}
+
+	for (size_t kind = 0; kind < kIncrementalCacheColumnKindMax; kind++)
+	{
+		for (size_t index = 0; index < numberOfColumns[kind]; index++)
+		{
+			IncrementalCacheColumn *	column = &cache->columns[kind][index];
+			char				path[kIncrementalCacheMaxCharsPerFilepath];
+
+			if (!column->isNeeded)
+			{
+				continue;
+			}
+
+			column->block = malloc(kIncrementalCacheSamplesPerBlock * sizeof(double));
+			if (column->block == NULL)
+			{
+				fprintf(stderr, "Error: Could not allocate memory for the incremental cache.\n");
+				closeColumns(cache, false);
+
+				return kCommonConstantReturnTypeError;
+			}
+
+			if (column->isCached)
+			{
+				continue;
+			}
+
+			/*
+			 *	A computed column is written to a temporary file, which only replaces the
+			 *	column file once all its samples are written.
+			 */
+			if (getColumnFilePath(cache, (IncrementalCacheColumnKind)kind, column->key, true, path))
+			{
+				IncrementalCacheFileHeader	header = {
+									.version		= kIncrementalCacheFileVersion,
+									.byteOrderMark		= kIncrementalCacheByteOrderMark,
+									.key			= column->key,
+									.numberOfSamples	= numberOfSamples,
+								};
+
+				memcpy(header.magic, kIncrementalCacheFileMagic, sizeof(header.magic));
+				column->file = fopen(path, "wb");
+				cache->hasError |= (column->file != NULL) && (fwrite(&header, sizeof(header), 1, column->file) != 1);
+			}
+
+			if ((column->file == NULL) || cache->hasError)
+			{
+				fprintf(stderr, "Error: Could not create a column file in the incremental cache directory \"%s\".\n", directoryPath);
+				closeColumns(cache, false);
+
+				return kCommonConstantReturnTypeError;
+			}
+		}
+	}
+
+	/*
+	 *	Each input has a stream of its own, which only depends on the seed and the input.
+	 */
+	for (size_t input = 0; input < kInputDistributionIndexMax; input++)
+	{
+		uint64_t	inputSeed = seed ^ ((input + 1) * 0xD1B54A32D192ED03ULL);
+
+		for (size_t i = 0; i < 4; i++)
+		{
+			cache->randomState[input][i] = splitMix64(&inputSeed);
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+static void
+computeColumnBlock(IncrementalCache *  cache, IncrementalCacheColumnKind kind, size_t index, size_t numberOfSamples)
+{
+	double *		block = cache->columns[kind][index].block;
+	const SensorModel *	model = cache->model;
+
+	if (kind == kIncrementalCacheColumnKindInput)
+	{
+		double	width = cache->upperBound[index] - cache->lowerBound[index];
+
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			block[i] = cache->lowerBound[index] + width * ((double)(xoshiro256StarStar(cache->randomState[index]) >> 11) * (1.0 / 9007199254740992.0));
+		}
+	}
+	else if (kind == kIncrementalCacheColumnKindRatio)
+	{
+		const double *	V = cache->columns[kIncrementalCacheColumnKindInput][index].block;
+		const double *	Vsupply = cache->columns[kIncrementalCacheColumnKindInput][kInputDistributionIndexVsupply].block;
+		bool		isRatiometric = (model->transfer == kSensorModelTransferRatiometric);
+		bool		isReciprocalUsed = isRatiometric && (cache->divisionAccuracyTier != kDivisionAccuracyTierExact);
+
+		/*
+		 *	As in the sampling loop, the faster division tiers multiply by a reciprocal.
+		 */
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			double	supply = isRatiometric ? Vsupply[i] : 0.0;
+			double	reciprocalOfVsupply = isReciprocalUsed ? divisionApproximateReciprocal(supply, cache->divisionAccuracyTier) : 0.0;
+
+			block[i] = sensorModelTransferArgument(model->transfer, V[i], supply, reciprocalOfVsupply, cache->divisionAccuracyTier);
+		}
+	}
+	else if (index < kSensorModelChannelMax)
+	{
+		const SensorModelChannelTransfer *	channel = &model->channels[index];
+		const double *				ratio = cache->columns[kIncrementalCacheColumnKindRatio][channel->input].block;
+
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			block[i] = channel->offset + channel->slope * ratio[i];
+		}
+	}
+	else
+	{
+		const double *	Rh = cache->columns[kIncrementalCacheColumnKindOutput][kOutputDistributionIndexCalibratedRelativeHumidity].block;
+		const double *	Tcelcius = cache->columns[kIncrementalCacheColumnKindOutput][kOutputDistributionIndexCalibratedTemperatureCelcius].block;
+
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			block[i] = (index == kOutputDistributionIndexDewPointCelcius)
+					? psychrometricsDewPointCelcius(Rh[i], Tcelcius[i])
+					: (index == kOutputDistributionIndexAbsoluteHumidity)
+						? psychrometricsAbsoluteHumidity(Rh[i], Tcelcius[i])
+						: psychrometricsHeatIndexCelcius(Rh[i], Tcelcius[i]);
+		}
+	}
+
+	return;
+}
+
+void
+incrementalCacheEvaluateBlock(IncrementalCache *  cache, size_t numberOfSamples)
+{
+	for (size_t kind = 0; kind < kIncrementalCacheColumnKindMax; kind++)
+	{
+		for (size_t index = 0; index < kOutputDistributionIndexMax; index++)
+		{
+			IncrementalCacheColumn *	column = &cache->columns[kind][index];
+
+			if (!column->isNeeded)
+			{
+				continue;
+			}
+
+			if (column->isCached)
+			{
+				cache->hasError |= (fread(column->block, sizeof(double), numberOfSamples, column->file) != numberOfSamples);
+			}
+			else
+			{
+				computeColumnBlock(cache, (IncrementalCacheColumnKind)kind, index, numberOfSamples);
+				cache->hasError |= (fwrite(column->block, sizeof(double), numberOfSamples, column->file) != numberOfSamples);
+			}
+		}
+	}
+	cache->numberOfEvaluatedSamples += numberOfSamples;
+
+	return;
+}
+
+CommonConstantReturnType
+incrementalCacheClose(IncrementalCache *  cache)
+{
+	bool	isComplete = !cache->hasError && (cache->numberOfEvaluatedSamples == cache->numberOfSamples);
+
+	if (!closeColumns(cache, isComplete) || cache->hasError)
+	{
+		fprintf(stderr, "Error: Could not read or write the columns of the incremental cache directory \"%s\".\n", cache->directoryPath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
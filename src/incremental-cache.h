@@ -0,0 +1,151 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "common.h"
+#include "sensor-model.h"
+
+typedef enum
+{
+	kIncrementalCacheSamplesPerBlock	= 1 << 16,
+	kIncrementalCacheFileVersion		= 1,
+	kIncrementalCacheMaxCharsPerFilepath	= 1024,
+
+	/*
+	 *	Leaves room in a file path for the names of the column files.
+	 */
+	kIncrementalCacheMaxCharsPerDirectoryPath	= kIncrementalCacheMaxCharsPerFilepath - 48,
+} IncrementalCacheConstant;
+
+/*
+ *	The columns of the dependency graph of the conversion: the samples of each input, the
+ *	argument of the transfer function of each input (its ratio to `Vsupply` for a ratiometric
+ *	model), and the samples of each output.
+ */
+typedef enum
+{
+	kIncrementalCacheColumnKindInput	= 0,
+	kIncrementalCacheColumnKindRatio	= 1,
+	kIncrementalCacheColumnKindOutput	= 2,
+	kIncrementalCacheColumnKindMax,
+} IncrementalCacheColumnKind;
+
+/*
+ *	Header at the start of a column file, followed by `numberOfSamples` doubles. All
+ *	fields are in host byte order, which `byteOrderMark` records.
+ */
+typedef struct
+{
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	byteOrderMark;
+	uint64_t	key;
+	uint64_t	numberOfSamples;
+} IncrementalCacheFileHeader;
+
+/*
+ *	One column of the run. `key` is a hash of everything its samples depend on, and names
+ *	its file. A column is read from its file if the cache holds it, else it is computed,
+ *	if it is needed, and written to the cache.
+ */
+typedef struct
+{
+	uint64_t	key;
+	bool		isNeeded;
+	bool		isCached;
+	FILE *		file;
+	double *	block;
+} IncrementalCacheColumn;
+
+/*
+ *	Incremental evaluation of the Monte Carlo samples of a run, a block at a time. Each
+ *	input is drawn from a random number generator of its own, so that its samples do not
+ *	depend on the configuration of the other inputs, and a run that only changes some
+ *	inputs reuses the cached columns of the others and of the outputs that do not depend
+ *	on the changes.
+ */
+typedef struct
+{
+	char			directoryPath[kIncrementalCacheMaxCharsPerDirectoryPath];
+	const SensorModel *	model;
+	DivisionAccuracyTier	divisionAccuracyTier;
+	double			lowerBound[kInputDistributionIndexMax];
+	double			upperBound[kInputDistributionIndexMax];
+	uint64_t		randomState[kInputDistributionIndexMax][4];
+	uint64_t		numberOfSamples;
+	uint64_t		numberOfEvaluatedSamples;
+	IncrementalCacheColumn	columns[kIncrementalCacheColumnKindMax][kOutputDistributionIndexMax];
+	bool			hasError;
+} IncrementalCache;
+
+/**
+ *	@brief	Opens the columns of a run in a cache directory: works out the key of every
+ *		column, which columns the cache holds, and which columns the selected outputs
+ *		need to be computed.
+ *
+ *	@param	cache			: Pointer to the cache.
+ *	@param	directoryPath		: Existing directory of the column files.
+ *	@param	model			: Pointer to the sensor model.
+ *	@param	divisionAccuracyTier	: The accuracy tier of the ratios.
+ *	@param	lowerBound		: Lower bounds of the uniform inputs.
+ *	@param	upperBound		: Upper bounds of the uniform inputs.
+ *	@param	seed			: Seed of the random number generators of the inputs.
+ *	@param	numberOfSamples		: Number of samples of the run.
+ *	@param	lowerOutput		: The first selected output.
+ *	@param	upperOutput		: One past the last selected output.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	incrementalCacheOpen(
+					IncrementalCache *	cache,
+					const char *		directoryPath,
+					const SensorModel *	model,
+					DivisionAccuracyTier	divisionAccuracyTier,
+					const double *		lowerBound,
+					const double *		upperBound,
+					uint64_t		seed,
+					uint64_t		numberOfSamples,
+					size_t			lowerOutput,
+					size_t			upperOutput);
+
+/**
+ *	@brief	Evaluates the next block of samples. The samples of each selected output are then
+ *		in `cache->columns[kIncrementalCacheColumnKindOutput][output].block`. Errors set
+ *		`cache->hasError`.
+ *
+ *	@param	cache			: Pointer to the cache.
+ *	@param	numberOfSamples		: Number of samples of the block, up to `kIncrementalCacheSamplesPerBlock`.
+ */
+void	incrementalCacheEvaluateBlock(IncrementalCache *  cache, size_t numberOfSamples);
+
+/**
+ *	@brief	Closes the columns. The computed columns of a run whose samples were all evaluated
+ *		without errors are added to the cache; the others are discarded.
+ *
+ *	@param	cache	: Pointer to the cache.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if the run had no errors, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	incrementalCacheClose(IncrementalCache *  cache);
@@ -0,0 +1,143 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "kalman-filter.h"
+
+void
+kalmanFilterBankInit(KalmanFilterBank *  bank, const double *  processNoiseVariance)
+{
+	memset(bank, 0, sizeof(*bank));
+	for (size_t channel = 0; channel < kSensorModelChannelMax; channel++)
+	{
+		bank->processNoiseVariance[channel] = processNoiseVariance[channel];
+	}
+
+	return;
+}
+
+/*
+ *	Finds the state of a sensor by linear probing from the hash of its identifier, and
+ *	claims a free slot for a new sensor while the table is not full.
+ */
+static KalmanFilterState *
+findState(KalmanFilterBank *  bank, uint32_t sensorId)
+{
+	size_t	slot = (size_t)((sensorId * 0x9E3779B1U) % kKalmanFilterMaxSensors);
+
+	for (size_t probe = 0; probe < kKalmanFilterMaxSensors; probe++)
+	{
+		KalmanFilterState *	state = &bank->states[slot];
+
+		if (state->isUsed && (state->sensorId == sensorId))
+		{
+			return state;
+		}
+		if (!state->isUsed)
+		{
+			if (bank->numberOfSensors == kKalmanFilterMaxSensors)
+			{
+				return NULL;
+			}
+			state->isUsed = true;
+			state->sensorId = sensorId;
+			state->lastTimestamp = NAN;
+			for (size_t channel = 0; channel < kSensorModelChannelMax; channel++)
+			{
+				state->mean[channel] = NAN;
+				state->variance[channel] = NAN;
+			}
+			bank->numberOfSensors++;
+
+			return state;
+		}
+		slot = (slot + 1) % kKalmanFilterMaxSensors;
+	}
+
+	return NULL;
+}
+
+bool
+kalmanFilterBankUpdate(
+	KalmanFilterBank *		bank,
+	uint32_t			sensorId,
+	double				timestamp,
+	const double *			measurementMean,
+	const double *			measurementVariance,
+	KalmanFilterPosterior *		posterior)
+{
+	KalmanFilterState *	state = findState(bank, sensorId);
+	double			elapsed = 1.0;
+
+	if (state == NULL)
+	{
+		return false;
+	}
+
+	/*
+	 *	The estimates drift for the time since the last reading of the sensor, or for one
+	 *	step if either reading has no timestamp. An output without an estimate yet takes
+	 *	its first finite measurement.
+	 */
+	if (isfinite(timestamp) && isfinite(state->lastTimestamp))
+	{
+		elapsed = fmax(timestamp - state->lastTimestamp, 0.0);
+	}
+
+	for (size_t channel = 0; channel < kSensorModelChannelMax; channel++)
+	{
+		double	z = measurementMean[channel];
+		double	R = measurementVariance[channel];
+
+		if (!isfinite(z) || !isfinite(R))
+		{
+			continue;
+		}
+
+		if (!isfinite(state->mean[channel]))
+		{
+			state->mean[channel] = z;
+			state->variance[channel] = R;
+		}
+		else
+		{
+			double	P = state->variance[channel] + bank->processNoiseVariance[channel] * elapsed;
+			double	K = (P + R > 0.0) ? P / (P + R) : 1.0;
+
+			state->mean[channel] += K * (z - state->mean[channel]);
+			state->variance[channel] = (1.0 - K) * P;
+		}
+	}
+
+	state->lastTimestamp = timestamp;
+	state->numberOfUpdates++;
+
+	posterior->numberOfUpdates = state->numberOfUpdates;
+	for (size_t channel = 0; channel < kSensorModelChannelMax; channel++)
+	{
+		posterior->mean[channel] = state->mean[channel];
+		posterior->variance[channel] = state->variance[channel];
+	}
+
+	return true;
+}
@@ -0,0 +1,97 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor-model.h"
+
+/*
+ *	Recursive estimates of the calibrated outputs of each sensor of a stream of readings.
+ *	Each output is a random walk whose variance grows by `processNoiseVariance` per second,
+ *	or per reading for readings without timestamps, and each converted reading measures it
+ *	with the mean and variance of its output distribution. A scalar Kalman filter per output
+ *	and sensor fuses the readings. The filters of all sensors live in a fixed open-addressed
+ *	table, so an update takes constant time and never allocates.
+ */
+typedef enum
+{
+	kKalmanFilterMaxSensors		= 4096,
+} KalmanFilterConstant;
+
+typedef struct
+{
+	bool		isUsed;
+	uint32_t	sensorId;
+	uint64_t	numberOfUpdates;
+	double		lastTimestamp;
+	double		mean[kSensorModelChannelMax];
+	double		variance[kSensorModelChannelMax];
+} KalmanFilterState;
+
+typedef struct
+{
+	double			processNoiseVariance[kSensorModelChannelMax];
+	size_t			numberOfSensors;
+	KalmanFilterState	states[kKalmanFilterMaxSensors];
+} KalmanFilterBank;
+
+/*
+ *	Posterior of the calibrated outputs of a sensor after one reading.
+ */
+typedef struct
+{
+	uint64_t	numberOfUpdates;
+	double		mean[kSensorModelChannelMax];
+	double		variance[kSensorModelChannelMax];
+} KalmanFilterPosterior;
+
+/**
+ *	@brief	Initializes a bank of filters without any sensors.
+ *
+ *	@param	bank			: Pointer to the bank.
+ *	@param	processNoiseVariance	: Growth of the variance of each calibrated output per second, or per reading without timestamps.
+ */
+void	kalmanFilterBankInit(KalmanFilterBank *  bank, const double *  processNoiseVariance);
+
+/**
+ *	@brief	Fuses one reading into the filters of its sensor. The first reading of a sensor
+ *		sets its estimates. A non-finite measurement leaves the estimate of its output
+ *		unchanged.
+ *
+ *	@param	bank			: Pointer to the bank.
+ *	@param	sensorId		: The sensor of the reading.
+ *	@param	timestamp		: The time of the reading in seconds, or NaN.
+ *	@param	measurementMean		: Means of the calibrated outputs of the reading.
+ *	@param	measurementVariance	: Variances of the calibrated outputs of the reading.
+ *	@param	posterior		: Pointer to the posterior of the sensor, written by the function.
+ *	@return				: `true` if successful, `false` if the bank already holds `kKalmanFilterMaxSensors` other sensors.
+ */
+bool	kalmanFilterBankUpdate(
+		KalmanFilterBank *		bank,
+		uint32_t			sensorId,
+		double				timestamp,
+		const double *			measurementMean,
+		const double *			measurementVariance,
+		KalmanFilterPosterior *		posterior);
@@ -27,36 +27,190 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <inttypes.h>
+#include <unistd.h>
 #include <uxhw.h>
 #include "utilities.h"
+#include "streaming-statistics.h"
+#include "trace.h"
+#include "psychrometrics.h"
+#include "random-pool.h"
+#include "surrogate-table.h"
+#include "polynomial-chaos.h"
+#include "anytime-batch.h"
+#include "progress-snapshot.h"
+#include "metrics.h"
+#include "out-of-core.h"
+#include "sample-compression.h"
+#include "incremental-cache.h"
+#include "parallel-reservoir.h"
+
+/*
+ *	Function multiversioning needs the `target_clones` attribute and an ifunc-capable loader,
+ *	which GCC and Clang provide on x86-64 Linux.
+ */
+#if defined(__x86_64__) && defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+#define kInputCorrelationBlockAttributes	__attribute__((noinline, target_clones("avx512f", "avx2", "default")))
+#else
+#define kInputCorrelationBlockAttributes	__attribute__((noinline))
+#endif
+
+/**
+ *	@brief  Approximates the standard Gaussian CDF, `0.5 * erfc(-z / sqrt(2))`, with arithmetic,
+ *		`fabs()` and `copysign()` only, as in psychrometrics.h, so that loops over samples
+ *		vectorize natively. `erfc(|x|)` is the Chebyshev fit of Numerical Recipes (fractional
+ *		error 1.2e-7), with `exp(-x^2)` as the reciprocal of the 32nd power of the Taylor
+ *		polynomial of `exp(x^2 / 32)`. The sign of `x` then selects the lower or upper tail
+ *		without a branch. The absolute error is below 4.2e-8 for all `z`.
+ *
+ *	@param  z	: The argument.
+ *	@return		: The approximation of the standard Gaussian CDF at `z`.
+ */
+static inline double
+approximateStandardGaussianCDF(double z)
+{
+	double	x = z * M_SQRT1_2;
+	double	absoluteX = fabs(x);
+	double	t = 1.0 / (1.0 + 0.5 * absoluteX);
+	double	y = x * x * (1.0 / 32.0);
+	double	p = 1.0 + y * (1.0 + y * (1.0 / 2.0 + y * (1.0 / 6.0 + y * (1.0 / 24.0 + y * (1.0 / 120.0 + y * (1.0 / 720.0 + y * (1.0 / 5040.0)))))));
+	double	erfcOfAbsoluteX;
+	double	isUpperTail;
+
+	p = p * p;
+	p = p * p;
+	p = p * p;
+	p = p * p;
+	p = p * p;
+
+	erfcOfAbsoluteX = t * psychrometricsApproximateExp(
+				-1.26551223 + t * (1.00002368 + t * (0.37409196 + t * (0.09678418 + t * (-0.18628806
+				+ t * (0.27886807 + t * (-1.13520398 + t * (1.48851587 + t * (-0.82215223 + t * 0.17087277)))))))))
+				/ p;
+
+	/*
+	 *	1 when the sign bit of `x` is clear and 0 when it is set; both tails give 0.5 at zero.
+	 *	The tails are not computed as differences from 1, so the lower tail keeps its relative
+	 *	accuracy.
+	 */
+	isUpperTail = 0.5 + 0.5 * copysign(1.0, x);
+
+	return isUpperTail * (1.0 - 0.5 * erfcOfAbsoluteX) + (1.0 - isUpperTail) * 0.5 * erfcOfAbsoluteX;
+}
+
+/**
+ *	@brief  Sets a block of Input Distributions via a Gaussian copula. Draws a block of independent
+ *		standard Gaussians, correlates them with the precomputed Cholesky factor, and maps each
+ *		one through the standard Gaussian CDF onto the uniform input distribution. The product
+ *		and the CDF are loops over the block, which vectorize in the native Monte Carlo
+ *		Execution Mode. The function is kept out of line, since GCC optimizes `main()`, which
+ *		runs once, as cold code and does not vectorize loops inlined into it, and on x86-64 it
+ *		is compiled for AVX-512, AVX2 and the baseline, with the loader picking the widest
+ *		variant the host supports.
+ *
+ *	@param  inputBlock		: Array of `kInputCorrelationSamplesPerBlock` samples of each input, where
+ *					the function writes the distributional data.
+ *	@param  numberOfSamples		: The number of samples of each input to set, at most `kInputCorrelationSamplesPerBlock`.
+ *	@param  arguments		: Pointer to command line arguments struct, with the bounds of the inputs.
+ *	@param  inputCorrelation	: Pointer to the precomputed Cholesky factor of the input correlation matrix.
+ */
+static kInputCorrelationBlockAttributes void
+setCorrelatedInputDistributionBlockViaUxHwCall(
+	double				inputBlock[kInputDistributionIndexMax][kInputCorrelationSamplesPerBlock],
+	size_t				numberOfSamples,
+	CommandLineArguments *		arguments,
+	const InputCorrelation *	inputCorrelation)
+{
+	double	independentGaussians[kInputDistributionIndexMax][kInputCorrelationSamplesPerBlock];
+	double	correlatedGaussians[kInputCorrelationSamplesPerBlock];
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		for (size_t k = 0; k < numberOfSamples; k++)
+		{
+			independentGaussians[i][k] = UxHwDoubleGaussDist(0.0, 1.0);
+		}
+	}
+
+	/*
+	 *	Row `i` of the product is accumulated one column of the Cholesky factor at a time, so
+	 *	that each loop runs over the samples of the block.
+	 */
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		double	lowerBound = arguments->inputLowerBound[i];
+		double	width = arguments->inputUpperBound[i] - arguments->inputLowerBound[i];
+		double	factor = inputCorrelation->choleskyFactor[i][0];
+
+		for (size_t k = 0; k < numberOfSamples; k++)
+		{
+			correlatedGaussians[k] = factor * independentGaussians[0][k];
+		}
+
+		for (size_t j = 1; j <= i; j++)
+		{
+			factor = inputCorrelation->choleskyFactor[i][j];
+			for (size_t k = 0; k < numberOfSamples; k++)
+			{
+				correlatedGaussians[k] += factor * independentGaussians[j][k];
+			}
+		}
+
+		for (size_t k = 0; k < numberOfSamples; k++)
+		{
+			inputBlock[i][k] = lowerBound + width * approximateStandardGaussianCDF(correlatedGaussians[k]);
+		}
+	}
+
+	return;
+}
 
 /**
  *	@brief  Sets the Input Distributions via call to UxHw Parametric function.
  *
  *	@param  inputDistributions	: An array of double values, where the function writes
  *					the distributional data.
+ *	@param  arguments		: Pointer to command line arguments struct, with the bounds of the inputs.
  */
 static void
-setInputDistributionsViaUxHwCall(double *  inputDistributions)
+setInputDistributionsViaUxHwCall(double *  inputDistributions, CommandLineArguments *  arguments)
 {
 	inputDistributions[kInputDistributionIndexVrh] = UxHwDoubleUniformDist(
-							kDefaultInputDistributionVrhUniformDistLow,
-							kDefaultInputDistributionVrhUniformDistHigh);
+							arguments->inputLowerBound[kInputDistributionIndexVrh],
+							arguments->inputUpperBound[kInputDistributionIndexVrh]);
 
 	inputDistributions[kInputDistributionIndexVt] = UxHwDoubleUniformDist(
-								kDefaultInputDistributionVtUniformDistLow,
-								kDefaultInputDistributionVtUniformDistHigh);
+								arguments->inputLowerBound[kInputDistributionIndexVt],
+								arguments->inputUpperBound[kInputDistributionIndexVt]);
 
 	inputDistributions[kInputDistributionIndexVsupply] = UxHwDoubleUniformDist(
-								kDefaultInputDistributionVsupplyUniformDistLow,
-								kDefaultInputDistributionVsupplyUniformDistHigh);
+								arguments->inputLowerBound[kInputDistributionIndexVsupply],
+								arguments->inputUpperBound[kInputDistributionIndexVsupply]);
+
+	return;
+}
+
+/**
+ *	@brief  Sets the Input Distributions from uniforms of a pre-generated random pool, for the
+ *		native Monte Carlo Execution Mode. There is no random number generation on this path.
+ *
+ *	@param  inputDistributions	: An array of double values, where the function writes the samples.
+ *	@param  arguments		: Pointer to command line arguments struct, with the bounds of the inputs.
+ *	@param  uniforms		: The `kInputDistributionIndexMax` uniforms in [0, 1) of this sample.
+ */
+static void
+setInputDistributionsFromRandomPool(double *  inputDistributions, CommandLineArguments *  arguments, const double *  uniforms)
+{
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		inputDistributions[i] = arguments->inputLowerBound[i] + (arguments->inputUpperBound[i] - arguments->inputLowerBound[i]) * uniforms[i];
+	}
 
 	return;
 }
 
 /**
- *	@brief  Sensor calibration routines taken from Figure 4 in page 8
- *		of Sensirion_Datasheet_SHT4xI-analog.pdf, 2024-07-03.
+ *	@brief  Sensor calibration routines of the selected sensor model (-V), by default those
+ *		of Figure 4 in page 8 of Sensirion_Datasheet_SHT4xI-analog.pdf, 2024-07-03.
  *
  *	@param  arguments		: Pointer to command line arguments struct.
  *	@param  inputDistributions	: The array of input distributions used in the calculation.
@@ -67,81 +221,1054 @@ setInputDistributionsViaUxHwCall(double *  inputDistributions)
 static double
 calculateSensorOutput(CommandLineArguments *  arguments, double *  inputDistributions, double *  outputDistributions)
 {
-	double	Rh;
-	double	Tcelcius;
-	double	Tfahrenheit;
-	double	Vsupply;
-	double	Vt;
-	double	Vrh;
-	double	calibratedValue = 0.0;
+	const SensorModel *			model = arguments->sensorModel;
+	const SensorModelChannelTransfer *	channels = model->channels;
+	double					Rh = 0.0;
+	double					Tcelcius = 0.0;
+	double					Tfahrenheit;
+	double					Vsupply;
+	double					VrhOverVsupply;
+	double					reciprocalOfVsupply;
+	double					calibratedValue = 0.0;
 
 	Vsupply = inputDistributions[kInputDistributionIndexVsupply];
-	Vt = inputDistributions[kInputDistributionIndexVt];
-	Vrh = inputDistributions[kInputDistributionIndexVrh];
+
+	/*
+	 *	All ratios share the denominator, so the faster division tiers compute its
+	 *	reciprocal once.
+	 */
+	reciprocalOfVsupply = ((arguments->divisionAccuracyTier == kDivisionAccuracyTierExact) || (model->transfer != kSensorModelTransferRatiometric))
+				? 0.0
+				: divisionApproximateReciprocal(Vsupply, arguments->divisionAccuracyTier);
 
 	bool	calculateAllOutputs = (arguments->common.outputSelect == kOutputDistributionIndexMax);
 
-	if (calculateAllOutputs || (arguments->common.outputSelect == kOutputDistributionIndexCalibratedRelativeHumidity))
+	/*
+	 *	The derived psychrometric outputs reuse `Rh` and `Tcelcius` of the same sample.
+	 */
+	bool	calculateDerivedOutputs = calculateAllOutputs
+					|| (arguments->common.outputSelect == kOutputDistributionIndexDewPointCelcius)
+					|| (arguments->common.outputSelect == kOutputDistributionIndexAbsoluteHumidity)
+					|| (arguments->common.outputSelect == kOutputDistributionIndexHeatIndexCelcius);
+
+	if (calculateDerivedOutputs || (arguments->common.outputSelect == kOutputDistributionIndexCalibratedRelativeHumidity))
 	{
-		Rh = kSensorCalibrationConstant1 + kSensorCalibrationConstant2* (Vrh / Vsupply);
+		const SensorModelChannelTransfer *	channel = &channels[kSensorModelChannelRelativeHumidity];
+
+		VrhOverVsupply = sensorModelTransferArgument(model->transfer, inputDistributions[channel->input], Vsupply, reciprocalOfVsupply, arguments->divisionAccuracyTier);
+		Rh = channel->offset + channel->slope * VrhOverVsupply;
 		calibratedValue = outputDistributions[kOutputDistributionIndexCalibratedRelativeHumidity] = Rh;
+		traceValue(kTraceVariableIndexVrhOverVsupply, VrhOverVsupply);
+		traceValue(kTraceVariableIndexRh, Rh);
+	}
+
+	if (calculateDerivedOutputs || (arguments->common.outputSelect == kOutputDistributionIndexCalibratedTemperatureCelcius))
+	{
+		const SensorModelChannelTransfer *	channel = &channels[kSensorModelChannelTemperatureCelcius];
+
+		Tcelcius = channel->offset
+				+ channel->slope * sensorModelTransferArgument(model->transfer, inputDistributions[channel->input], Vsupply, reciprocalOfVsupply, arguments->divisionAccuracyTier);
+		calibratedValue = outputDistributions[kOutputDistributionIndexCalibratedTemperatureCelcius] = Tcelcius;
+		traceValue(kTraceVariableIndexTcelcius, Tcelcius);
+	}
+
+	if (calculateAllOutputs || (arguments->common.outputSelect == kOutputDistributionIndexCalibratedTemperatureFahrenheit))
+	{
+		const SensorModelChannelTransfer *	channel = &channels[kSensorModelChannelTemperatureFahrenheit];
+
+		Tfahrenheit = channel->offset
+				+ channel->slope * sensorModelTransferArgument(model->transfer, inputDistributions[channel->input], Vsupply, reciprocalOfVsupply, arguments->divisionAccuracyTier);
+		calibratedValue = outputDistributions[kOutputDistributionIndexCalibratedTemperatureFahrenheit] = Tfahrenheit;
+		traceValue(kTraceVariableIndexTfahrenheit, Tfahrenheit);
+	}
+
+	if (calculateAllOutputs || (arguments->common.outputSelect == kOutputDistributionIndexDewPointCelcius))
+	{
+		calibratedValue = outputDistributions[kOutputDistributionIndexDewPointCelcius] = psychrometricsDewPointCelcius(Rh, Tcelcius);
+	}
+
+	if (calculateAllOutputs || (arguments->common.outputSelect == kOutputDistributionIndexAbsoluteHumidity))
+	{
+		calibratedValue = outputDistributions[kOutputDistributionIndexAbsoluteHumidity] = psychrometricsAbsoluteHumidity(Rh, Tcelcius);
+	}
+
+	if (calculateAllOutputs || (arguments->common.outputSelect == kOutputDistributionIndexHeatIndexCelcius))
+	{
+		calibratedValue = outputDistributions[kOutputDistributionIndexHeatIndexCelcius] = psychrometricsHeatIndexCelcius(Rh, Tcelcius);
+	}
+
+	return	calibratedValue;
+}
+
+/**
+ *	@brief  The sensor model in the form expanded by the polynomial chaos engine.
+ *
+ *	@param  context	: Pointer to command line arguments struct.
+ *	@param  inputs	: The input values.
+ *	@param  outputs	: The array of outputs, where the selected outputs are written.
+ */
+static void
+evaluateSensorModel(void *  context, double *  inputs, double *  outputs)
+{
+	calculateSensorOutput((CommandLineArguments *)context, inputs, outputs);
+
+	return;
+}
+
+/**
+ *	@brief  Evaluates the summaries of batch mode with a surrogate table: the readings in the
+ *		domain of the table are answered by interpolation, and only the others are evaluated
+ *		by the batch engine.
+ *
+ *	@param  arguments			: Pointer to command line arguments struct.
+ *	@param  readings			: Array of readings.
+ *	@param  numberOfReadings		: The number of readings.
+ *	@param  numberOfSamplesPerReading	: The number of Monte Carlo samples per reading outside the domain of the table.
+ *	@param  numberOfThreads			: The number of threads of the batch engine.
+ *	@param  summaries			: Array of the summaries of the readings, written by this function.
+ *	@param  quantiles			: Array of the surrogate table quantiles of the readings, written by this function.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+evaluateBatchReadingsWithSurrogateTable(
+	CommandLineArguments *		arguments,
+	const BatchReading *		readings,
+	size_t				numberOfReadings,
+	uint64_t			numberOfSamplesPerReading,
+	size_t				numberOfThreads,
+	BatchReadingSummary *		summaries,
+	SurrogateTableQuantiles *	quantiles)
+{
+	SurrogateTable			table;
+	BatchReading *			fallbackReadings;
+	BatchReadingSummary *		fallbackSummaries;
+	size_t *			fallbackIndices;
+	size_t				numberOfFallbackReadings = 0;
+	size_t				lowerOutput;
+	size_t				upperOutput;
+	size_t				numberOfSlots = (numberOfReadings > 0) ? numberOfReadings : 1;
+	clock_t				lookupStart;
+	double				lookupSeconds;
+	CommonConstantReturnType	result = kCommonConstantReturnTypeSuccess;
+
+	if (surrogateTableLoad(&table, arguments->surrogateTableFilePath))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	fallbackReadings = malloc(numberOfSlots * sizeof(BatchReading));
+	fallbackSummaries = calloc(numberOfSlots, sizeof(BatchReadingSummary));
+	fallbackIndices = malloc(numberOfSlots * sizeof(size_t));
+	if ((fallbackReadings == NULL) || (fallbackSummaries == NULL) || (fallbackIndices == NULL))
+	{
+		fprintf(stderr, "Error: Could not allocate memory for the readings outside the surrogate table.\n");
+		free(fallbackReadings);
+		free(fallbackSummaries);
+		free(fallbackIndices);
+		surrogateTableFree(&table);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	getSelectedOutputRange(arguments, &lowerOutput, &upperOutput);
+
+	lookupStart = clock();
+	for (size_t reading = 0; reading < numberOfReadings; reading++)
+	{
+		if (!surrogateTableLookup(&table, arguments->sensorModel, &readings[reading], lowerOutput, upperOutput, &summaries[reading], &quantiles[reading]))
+		{
+			quantiles[reading].isFromTable = false;
+			fallbackReadings[numberOfFallbackReadings] = readings[reading];
+			fallbackIndices[numberOfFallbackReadings] = reading;
+			numberOfFallbackReadings++;
+		}
+	}
+	lookupSeconds = ((double)(clock() - lookupStart)) / CLOCKS_PER_SEC;
+	metricsCount(kMetricsCounterSurrogateTableHits, numberOfReadings - numberOfFallbackReadings);
+	metricsCount(kMetricsCounterSurrogateTableMisses, numberOfFallbackReadings);
+
+	if (arguments->common.isTimingEnabled || arguments->common.isVerbose)
+	{
+		fprintf(
+			stderr,
+			"Surrogate table: answered %zu of %zu readings in %.1lf ns per reading.\n",
+			numberOfReadings - numberOfFallbackReadings,
+			numberOfReadings,
+			(numberOfReadings > numberOfFallbackReadings) ? lookupSeconds * 1e9 / (double)numberOfReadings : 0.0);
+	}
+
+	/*
+	 *	Monte Carlo fallback for the readings outside the domain of the table.
+	 */
+	if (numberOfFallbackReadings > 0)
+	{
+		fprintf(stderr, "Batch engine: using the %s kernels for %zu readings.\n", batchEngineSelectKernels()->name, numberOfFallbackReadings);
+
+		result = batchEngineRun(arguments->sensorModel, fallbackReadings, numberOfFallbackReadings, numberOfSamplesPerReading, kBatchDefaultSeed, numberOfThreads, fallbackSummaries);
+		for (size_t i = 0; (i < numberOfFallbackReadings) && (result == kCommonConstantReturnTypeSuccess); i++)
+		{
+			summaries[fallbackIndices[i]] = fallbackSummaries[i];
+		}
+	}
+
+	free(fallbackReadings);
+	free(fallbackSummaries);
+	free(fallbackIndices);
+	surrogateTableFree(&table);
+
+	return result;
+}
+
+/*
+ *	Time stamps of the stages of one sample of the native Monte Carlo loop.
+ */
+typedef enum
+{
+	kLoopStageStart,
+	kLoopStageSampled,
+	kLoopStageConverted,
+	kLoopStageReduced,
+	kLoopStageWritten,
+	kLoopStageMax,
+} LoopStage;
+
+/**
+ *	@brief  Records the end of a stage of the native Monte Carlo loop: its time if the sample
+ *		is timed, else zero.
+ *
+ *	@param  stageNanoseconds	: Array of the time stamps of the stages of the sample.
+ *	@param  stage			: The stage that ended.
+ *	@param  isTimedSample		: Whether the stages of this sample are timed.
+ */
+static inline void
+markLoopStage(uint64_t *  stageNanoseconds, LoopStage stage, bool isTimedSample)
+{
+	stageNanoseconds[stage] = isTimedSample ? metricsGetTimeNanoseconds() : 0;
+
+	return;
+}
+
+/**
+ *	@brief  Records the stage latencies of a timed sample of the native Monte Carlo loop, counts
+ *		the samples up to the next timed one, and writes the metrics file (-X) when its
+ *		interval has passed.
+ *
+ *	@param  arguments		: Pointer to command line arguments struct.
+ *	@param  stageNanoseconds	: Array of the time stamps of the stages of the sample.
+ *	@param  sampleIndex		: The index of the sample.
+ *	@param  lastMetricsWriteNanoseconds	: Pointer to the time of the last write of the metrics file.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`
+ *					  if the metrics file could not be written.
+ */
+static CommonConstantReturnType
+recordLoopStages(CommandLineArguments *  arguments, const uint64_t *  stageNanoseconds, size_t sampleIndex, uint64_t *  lastMetricsWriteNanoseconds)
+{
+	size_t	remaining = arguments->common.numberOfMonteCarloIterations - sampleIndex;
+
+	metricsRecordLatency(kMetricsHistogramSamplingPerSample, stageNanoseconds[kLoopStageSampled] - stageNanoseconds[kLoopStageStart]);
+
+	/*
+	 *	The polynomial chaos expansion draws the outputs directly, with no conversion.
+	 */
+	if (arguments->polynomialChaosOrder == 0)
+	{
+		metricsRecordLatency(kMetricsHistogramConversionPerSample, stageNanoseconds[kLoopStageConverted] - stageNanoseconds[kLoopStageSampled]);
+	}
+	metricsRecordLatency(kMetricsHistogramReductionPerSample, stageNanoseconds[kLoopStageReduced] - stageNanoseconds[kLoopStageConverted]);
+	if (arguments->isNDJSONOutputEnabled)
+	{
+		metricsRecordLatency(kMetricsHistogramOutputPerSample, stageNanoseconds[kLoopStageWritten] - stageNanoseconds[kLoopStageReduced]);
+	}
+	metricsCount(kMetricsCounterSamples, (remaining < kMetricsSampleTimingInterval) ? remaining : kMetricsSampleTimingInterval);
+
+	if (arguments->isMetricsOutputEnabled
+		&& (stageNanoseconds[kLoopStageWritten] - *lastMetricsWriteNanoseconds >= kMetricsDefaultWriteIntervalMilliseconds * 1000000ULL))
+	{
+		*lastMetricsWriteNanoseconds = stageNanoseconds[kLoopStageWritten];
+
+		return metricsWrite(arguments->metricsFilePath);
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief  Gets the number of threads of batch mode: the -W option, or else the number of
+ *		online processors.
+ *
+ *	@param  arguments	: Pointer to command line arguments struct.
+ *	@return			: The number of threads.
+ */
+static size_t
+getNumberOfBatchThreads(CommandLineArguments *  arguments)
+{
+	size_t	numberOfThreads = arguments->numberOfThreads;
+
+	if (numberOfThreads == 0)
+	{
+#if defined(_SC_NPROCESSORS_ONLN)
+		long	numberOfProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+
+		numberOfThreads = (numberOfProcessors > 0) ? (size_t)numberOfProcessors : 1;
+#else
+		numberOfThreads = 1;
+#endif
+	}
+
+	return numberOfThreads;
+}
+
+/*
+ *	Destination of the summaries of batch mode: NDJSON if `writer` is set, else CSV on the
+ *	standard output, and a time series if `timeSeries` is set.
+ */
+typedef struct
+{
+	CommandLineArguments *		arguments;
+	NDJSONWriter *			writer;
+	const BatchReading *		readings;
+	const BatchReadingSummary *	summaries;
+	KalmanFilterBank *		filterBank;
+	TimeSeriesWriter *		timeSeries;
+} BatchOutputSink;
+
+/**
+ *	@brief  Writes the summaries of a tile of readings as the batch engine completes it.
+ *
+ *	@param  context			: Pointer to the `BatchOutputSink`.
+ *	@param  firstReading		: The index of the first reading of the tile.
+ *	@param  numberOfReadings	: The number of readings of the tile.
+ */
+static void
+writeBatchOutputTile(void *  context, size_t firstReading, size_t numberOfReadings)
+{
+	BatchOutputSink *	sink = context;
+
+	writeBatchReadingSummaries(sink->writer, sink->arguments, &sink->readings[firstReading], &sink->summaries[firstReading], NULL, sink->filterBank, sink->timeSeries, numberOfReadings);
+
+	return;
+}
+
+/**
+ *	@brief  Batch mode: reads the readings of the input file, evaluates a Monte Carlo summary
+ *		of every reading with the batch engine, or answers it from the surrogate table (-Q),
+ *		and writes the summaries as NDJSON (-n) or as CSV to the standard output. Summaries
+ *		evaluated by the batch engine are written as they complete, in the order of the
+ *		readings unless unordered output (-O) is selected.
+ *
+ *	@param  arguments	: Pointer to command line arguments struct.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+runBatchMode(CommandLineArguments *  arguments)
+{
+	BatchReading *			readings = NULL;
+	BatchReadingSummary *		summaries;
+	SurrogateTableQuantiles *	quantiles = NULL;
+	size_t				numberOfReadings = 0;
+	size_t				numberOfThreads = getNumberOfBatchThreads(arguments);
+	uint64_t			numberOfSamplesPerReading = arguments->common.isMonteCarloMode
+								? arguments->common.numberOfMonteCarloIterations
+								: kBatchDefaultSamplesPerReading;
+	clock_t				start = clock();
+	CommonConstantReturnType	result;
+	uint64_t			stageStartNanoseconds = metricsGetTimeNanoseconds();
+	static NDJSONWriter		ndjsonWriter;
+	static KalmanFilterBank		kalmanFilterBank;
+	static TimeSeriesWriter		timeSeriesWriter;
+	BatchOutputSink			outputSink;
+
+	if (readBatchReadingsFromCSVFile(arguments->common.inputFilePath, numberOfThreads, &readings, &numberOfReadings))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+	metricsRecordLatency(kMetricsHistogramIngestPerBatch, metricsGetTimeNanoseconds() - stageStartNanoseconds);
+	metricsCount(kMetricsCounterReadings, numberOfReadings);
+
+	summaries = calloc((numberOfReadings > 0) ? numberOfReadings : 1, sizeof(BatchReadingSummary));
+	if (arguments->isSurrogateTableEnabled)
+	{
+		quantiles = calloc((numberOfReadings > 0) ? numberOfReadings : 1, sizeof(SurrogateTableQuantiles));
+	}
+	if ((summaries == NULL) || (arguments->isSurrogateTableEnabled && (quantiles == NULL)))
+	{
+		fprintf(stderr, "Error: Could not allocate memory for the reading summaries.\n");
+		free(quantiles);
+		free(summaries);
+		free(readings);
+
+		return kCommonConstantReturnTypeError;
+	}
+	outputSink = (BatchOutputSink) {
+			.arguments	= arguments,
+			.writer		= arguments->isNDJSONOutputEnabled ? &ndjsonWriter : NULL,
+			.readings	= readings,
+			.summaries	= summaries,
+			.filterBank	= arguments->isKalmanFilterEnabled ? &kalmanFilterBank : NULL,
+			.timeSeries	= arguments->isTimeSeriesOutputEnabled ? &timeSeriesWriter : NULL,
+		};
+	if (arguments->isKalmanFilterEnabled)
+	{
+		kalmanFilterBankInit(&kalmanFilterBank, arguments->kalmanFilterProcessNoiseVariance);
+	}
+
+	/*
+	 *	Open the output before the evaluation, so that summaries are written as they complete.
+	 */
+	if (arguments->isNDJSONOutputEnabled)
+	{
+		if (ndjsonWriterOpen(&ndjsonWriter, arguments->ndjsonOutputFilePath))
+		{
+			free(quantiles);
+			free(summaries);
+			free(readings);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+	else
+	{
+		writeBatchReadingSummariesHeader(arguments, quantiles != NULL);
+	}
+
+	if (arguments->isTimeSeriesOutputEnabled && openBatchReadingTimeSeries(arguments, &timeSeriesWriter))
+	{
+		if (arguments->isNDJSONOutputEnabled)
+		{
+			ndjsonWriterClose(&ndjsonWriter);
+		}
+		free(quantiles);
+		free(summaries);
+		free(readings);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (arguments->isSurrogateTableEnabled)
+	{
+		result = evaluateBatchReadingsWithSurrogateTable(
+				arguments,
+				readings,
+				numberOfReadings,
+				numberOfSamplesPerReading,
+				numberOfThreads,
+				summaries,
+				quantiles);
+		if (result == kCommonConstantReturnTypeSuccess)
+		{
+			stageStartNanoseconds = metricsGetTimeNanoseconds();
+			writeBatchReadingSummaries(outputSink.writer, arguments, readings, summaries, quantiles, outputSink.filterBank, outputSink.timeSeries, numberOfReadings);
+			metricsRecordLatency(kMetricsHistogramOutputPerBatch, metricsGetTimeNanoseconds() - stageStartNanoseconds);
+		}
+	}
+	else
+	{
+		BatchEngineSink	sink = {
+					.isOrdered	= !arguments->isUnorderedOutputEnabled,
+					.emit		= writeBatchOutputTile,
+					.context	= &outputSink,
+				};
+
+		/*
+		 *	Log the kernel variant picked for this host on the standard error.
+		 */
+		fprintf(stderr, "Batch engine: using the %s kernels.\n", batchEngineSelectKernels()->name);
+
+		result = batchEngineRunStreaming(
+				arguments->sensorModel,
+				readings,
+				numberOfReadings,
+				numberOfSamplesPerReading,
+				kBatchDefaultSeed,
+				numberOfThreads,
+				summaries,
+				&sink);
+	}
+
+	if (arguments->isNDJSONOutputEnabled && ndjsonWriterClose(&ndjsonWriter) && (result == kCommonConstantReturnTypeSuccess))
+	{
+		fprintf(stderr, "Error: Could not write the NDJSON output.\n");
+		result = kCommonConstantReturnTypeError;
+	}
+
+	if (arguments->isTimeSeriesOutputEnabled && timeSeriesWriterClose(&timeSeriesWriter))
+	{
+		result = kCommonConstantReturnTypeError;
+	}
+
+	if (result != kCommonConstantReturnTypeSuccess)
+	{
+		free(quantiles);
+		free(summaries);
+		free(readings);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (arguments->isMetricsOutputEnabled && metricsWrite(arguments->metricsFilePath))
+	{
+		free(quantiles);
+		free(summaries);
+		free(readings);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	The summaries may be on the standard output, so report the time on the standard error.
+	 */
+	if (arguments->common.isTimingEnabled)
+	{
+		fprintf(
+			stderr,
+			"CPU time used: %lf seconds (%zu readings, %" PRIu64 " samples per reading, %zu threads)\n",
+			((double)(clock() - start)) / CLOCKS_PER_SEC,
+			numberOfReadings,
+			numberOfSamplesPerReading,
+			numberOfThreads);
+	}
+
+	free(quantiles);
+	free(summaries);
+	free(readings);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief  Evaluates the readings taken from the queue in progressive rounds. Each round
+ *		draws as many fresh samples per reading as all earlier rounds together, and is
+ *		merged into the summaries. The rounds stop when the sample budget is spent, or
+ *		when the next round would end after the latency target of the oldest reading, so
+ *		the summaries are always those of the most samples that fit in the target.
+ *
+ *	@param  model			: Pointer to the sensor model.
+ *	@param  budget			: Pointer to the sample budget, whose throughput is updated.
+ *	@param  readings		: Array of readings.
+ *	@param  numberOfReadings	: The number of readings.
+ *	@param  numberOfPendingReadings	: The number of readings plus those still queued.
+ *	@param  oldestArrivalSeconds	: The arrival time of the first reading.
+ *	@param  numberOfThreads		: The number of threads of the batch engine.
+ *	@param  summaries		: Array of `numberOfReadings` summaries, written by this function.
+ *	@param  roundSummaries		: Array of `numberOfReadings` summaries used as scratch space.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+evaluateAnytimeReadings(
+	const SensorModel *	model,
+	AnytimeBudget *		budget,
+	const BatchReading *	readings,
+	size_t			numberOfReadings,
+	size_t			numberOfPendingReadings,
+	double			oldestArrivalSeconds,
+	size_t			numberOfThreads,
+	BatchReadingSummary *	summaries,
+	BatchReadingSummary *	roundSummaries)
+{
+	double		nowSeconds = anytimeGetTimeSeconds();
+	double		deadlineSeconds = oldestArrivalSeconds + budget->latencyTargetSeconds;
+	uint64_t	numberOfSamplesPerReading = anytimeBudgetGetSamplesPerReading(budget, numberOfPendingReadings, oldestArrivalSeconds, nowSeconds);
+	uint64_t	numberOfSamplesDone = 0;
+	uint64_t	numberOfRoundSamples = budget->minimumSamplesPerReading;
+
+	for (uint64_t round = 0; numberOfSamplesDone < numberOfSamplesPerReading; round++)
+	{
+		double	roundStartSeconds = nowSeconds;
+
+		if (numberOfRoundSamples > numberOfSamplesPerReading - numberOfSamplesDone)
+		{
+			numberOfRoundSamples = numberOfSamplesPerReading - numberOfSamplesDone;
+		}
+
+		/*
+		 *	Every round of every evaluation has its own seed, so rounds draw independent samples.
+		 */
+		if (batchEngineRun(
+				model,
+				readings,
+				numberOfReadings,
+				numberOfRoundSamples,
+				kBatchDefaultSeed + (readings[0].sequenceNumber << 8) + round,
+				numberOfThreads,
+				(round == 0) ? summaries : roundSummaries))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		nowSeconds = anytimeGetTimeSeconds();
+		anytimeBudgetUpdate(budget, numberOfRoundSamples * numberOfReadings, nowSeconds - roundStartSeconds);
+		if (round > 0)
+		{
+			anytimeMergeSummaries(summaries, roundSummaries, numberOfReadings);
+		}
+		numberOfSamplesDone += numberOfRoundSamples;
+
+		numberOfRoundSamples = numberOfSamplesDone;
+		if (nowSeconds + (double)(numberOfRoundSamples * numberOfReadings) / budget->samplesPerSecond > deadlineSeconds)
+		{
+			break;
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief  Anytime batch mode (-L): evaluates the readings of the input as they arrive, with
+ *		as many samples per reading as the backlog allows within the latency target, and
+ *		writes each summary, with the standard errors of its means, as soon as it is ready.
+ *
+ *	@param  arguments	: Pointer to command line arguments struct.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+runAnytimeBatchMode(CommandLineArguments *  arguments)
+{
+	AnytimeQueue *			queue;
+	AnytimeBudget			budget;
+	BatchReading *			readings = malloc(kAnytimeMaxReadingsPerEvaluation * sizeof(BatchReading));
+	double *			arrivalSeconds = malloc(kAnytimeMaxReadingsPerEvaluation * sizeof(double));
+	BatchReadingSummary *		summaries = malloc(kAnytimeMaxReadingsPerEvaluation * sizeof(BatchReadingSummary));
+	BatchReadingSummary *		roundSummaries = malloc(kAnytimeMaxReadingsPerEvaluation * sizeof(BatchReadingSummary));
+	size_t				numberOfThreads = getNumberOfBatchThreads(arguments);
+	size_t				numberOfReadings;
+	size_t				numberOfPendingReadings;
+	size_t				totalNumberOfReadings = 0;
+	size_t				numberOfLateReadings = 0;
+	uint64_t			totalNumberOfSamples = 0;
+	double				maximumLatencySeconds = 0.0;
+	double				lastMetricsWriteSeconds = anytimeGetTimeSeconds();
+	uint64_t			outputStartNanoseconds;
+	CommonConstantReturnType	result = kCommonConstantReturnTypeSuccess;
+	static NDJSONWriter		ndjsonWriter;
+	static KalmanFilterBank		kalmanFilterBank;
+	KalmanFilterBank *		filterBank = arguments->isKalmanFilterEnabled ? &kalmanFilterBank : NULL;
+	static TimeSeriesWriter		timeSeriesWriter;
+	TimeSeriesWriter *		timeSeries = arguments->isTimeSeriesOutputEnabled ? &timeSeriesWriter : NULL;
+
+	if ((readings == NULL) || (arrivalSeconds == NULL) || (summaries == NULL) || (roundSummaries == NULL))
+	{
+		fprintf(stderr, "Error: Could not allocate memory for the reading summaries.\n");
+		free(readings);
+		free(arrivalSeconds);
+		free(summaries);
+		free(roundSummaries);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	anytimeBudgetInit(
+		&budget,
+		(double)arguments->latencyTargetMilliseconds * 1e-3,
+		kAnytimeMinimumSamplesPerReading,
+		arguments->common.isMonteCarloMode ? arguments->common.numberOfMonteCarloIterations : kBatchDefaultSamplesPerReading,
+		kAnytimeInitialSamplesPerSecond);
+	if (filterBank != NULL)
+	{
+		kalmanFilterBankInit(filterBank, arguments->kalmanFilterProcessNoiseVariance);
+	}
+
+	if (arguments->isNDJSONOutputEnabled && ndjsonWriterOpen(&ndjsonWriter, arguments->ndjsonOutputFilePath))
+	{
+		free(readings);
+		free(arrivalSeconds);
+		free(summaries);
+		free(roundSummaries);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((timeSeries != NULL) && openBatchReadingTimeSeries(arguments, timeSeries))
+	{
+		if (arguments->isNDJSONOutputEnabled)
+		{
+			ndjsonWriterClose(&ndjsonWriter);
+		}
+		free(readings);
+		free(arrivalSeconds);
+		free(summaries);
+		free(roundSummaries);
+
+		return kCommonConstantReturnTypeError;
 	}
 
-	if (calculateAllOutputs || (arguments->common.outputSelect == kOutputDistributionIndexCalibratedTemperatureCelcius))
+	if (anytimeQueueOpen(&queue, arguments->common.inputFilePath))
+	{
+		if (arguments->isNDJSONOutputEnabled)
+		{
+			ndjsonWriterClose(&ndjsonWriter);
+		}
+		if (timeSeries != NULL)
+		{
+			timeSeriesWriterClose(timeSeries);
+		}
+		free(readings);
+		free(arrivalSeconds);
+		free(summaries);
+		free(roundSummaries);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (!arguments->isNDJSONOutputEnabled)
+	{
+		writeBatchReadingSummariesHeader(arguments, false);
+	}
+	fprintf(stderr, "Batch engine: using the %s kernels.\n", batchEngineSelectKernels()->name);
+
+	while (result == kCommonConstantReturnTypeSuccess)
+	{
+		double	nowSeconds;
+
+		result = anytimeQueueTake(queue, readings, arrivalSeconds, kAnytimeMaxReadingsPerEvaluation, &numberOfReadings, &numberOfPendingReadings);
+		if ((result != kCommonConstantReturnTypeSuccess) || (numberOfReadings == 0))
+		{
+			break;
+		}
+
+		nowSeconds = anytimeGetTimeSeconds();
+		for (size_t reading = 0; reading < numberOfReadings; reading++)
+		{
+			metricsRecordLatency(kMetricsHistogramIngestPerReading, (uint64_t)((nowSeconds - arrivalSeconds[reading]) * 1e9));
+		}
+		metricsCount(kMetricsCounterReadings, numberOfReadings);
+
+		result = evaluateAnytimeReadings(
+				arguments->sensorModel,
+				&budget,
+				readings,
+				numberOfReadings,
+				numberOfPendingReadings,
+				arrivalSeconds[0],
+				numberOfThreads,
+				summaries,
+				roundSummaries);
+		if (result != kCommonConstantReturnTypeSuccess)
+		{
+			break;
+		}
+
+		/*
+		 *	Publish the summaries now, rather than when the output buffers fill.
+		 */
+		outputStartNanoseconds = metricsGetTimeNanoseconds();
+		if (arguments->isNDJSONOutputEnabled)
+		{
+			writeBatchReadingSummaries(&ndjsonWriter, arguments, readings, summaries, NULL, filterBank, timeSeries, numberOfReadings);
+			ndjsonWriterFlush(&ndjsonWriter);
+		}
+		else
+		{
+			writeBatchReadingSummaries(NULL, arguments, readings, summaries, NULL, filterBank, timeSeries, numberOfReadings);
+			fflush(stdout);
+		}
+
+		metricsRecordLatency(kMetricsHistogramOutputPerBatch, metricsGetTimeNanoseconds() - outputStartNanoseconds);
+
+		nowSeconds = anytimeGetTimeSeconds();
+		for (size_t reading = 0; reading < numberOfReadings; reading++)
+		{
+			double	latencySeconds = nowSeconds - arrivalSeconds[reading];
+
+			maximumLatencySeconds = fmax(maximumLatencySeconds, latencySeconds);
+			numberOfLateReadings += (latencySeconds > budget.latencyTargetSeconds);
+			totalNumberOfSamples += summaries[reading].numberOfSamples;
+			metricsRecordLatency(kMetricsHistogramEndToEndPerReading, (uint64_t)(latencySeconds * 1e9));
+			metricsCount(kMetricsCounterLateReadings, latencySeconds > budget.latencyTargetSeconds);
+		}
+		totalNumberOfReadings += numberOfReadings;
+
+		if (arguments->isMetricsOutputEnabled && (nowSeconds - lastMetricsWriteSeconds >= kMetricsDefaultWriteIntervalMilliseconds * 1e-3))
+		{
+			result = metricsWrite(arguments->metricsFilePath);
+			lastMetricsWriteSeconds = nowSeconds;
+		}
+	}
+
+	anytimeQueueClose(queue);
+
+	if (arguments->isNDJSONOutputEnabled && ndjsonWriterClose(&ndjsonWriter) && (result == kCommonConstantReturnTypeSuccess))
+	{
+		fprintf(stderr, "Error: Could not write the NDJSON output.\n");
+		result = kCommonConstantReturnTypeError;
+	}
+
+	if ((timeSeries != NULL) && timeSeriesWriterClose(timeSeries))
+	{
+		result = kCommonConstantReturnTypeError;
+	}
+
+	if (arguments->isMetricsOutputEnabled && (result == kCommonConstantReturnTypeSuccess))
+	{
+		result = metricsWrite(arguments->metricsFilePath);
+	}
+
+	/*
+	 *	The summaries may be on the standard output, so report the latencies on the standard error.
+	 */
+	if (arguments->common.isTimingEnabled || arguments->common.isVerbose)
+	{
+		fprintf(
+			stderr,
+			"Anytime batch mode: %zu readings, %.1lf samples per reading on average, maximum latency %.3lf ms, "
+			"%zu readings over the %zu ms target (%zu threads)\n",
+			totalNumberOfReadings,
+			(totalNumberOfReadings > 0) ? (double)totalNumberOfSamples / (double)totalNumberOfReadings : 0.0,
+			maximumLatencySeconds * 1e3,
+			numberOfLateReadings,
+			arguments->latencyTargetMilliseconds,
+			numberOfThreads);
+	}
+
+	free(readings);
+	free(arrivalSeconds);
+	free(summaries);
+	free(roundSummaries);
+
+	return result;
+}
+
+int
+main(int argc, char *  argv[])
+{
+	CommandLineArguments	arguments = {0};
+
+	double			calibratedSensorOutput;
+	double *		monteCarloOutputSamples = NULL;
+	size_t			numberOfMonteCarloOutputSamples = 0;
+	Reservoir		monteCarloOutputReservoir = {0};
+	StreamingStatistics	monteCarloOutputStatistics = {0};
+	static OutOfCoreSampleSet	outOfCoreSampleSet;
+	OutOfCoreSummary	outOfCoreSummary;
+	StreamingCovariance	jointOutputCovariance;
+	Histogram2D		jointOutputHistogram;
+	bool			isJointMonteCarloMode;
+	bool			isParallelReservoirMode;
+	clock_t			start;
+	clock_t			end;
+	double			cpuTimeUsedSeconds = 0.0;
+	double			inputDistributions[kInputDistributionIndexMax];
+	double			outputDistributions[kOutputDistributionIndexMax];
+	const char *		outputVariableNames[kOutputDistributionIndexMax] =
+				{
+					"Calibrated Relative Humidity",
+					"Calibrated Temperature (in Celsius)",
+					"Calibrated Temperature (in Farenheit)",
+					"Dew Point (in Celsius)",
+					"Absolute Humidity",
+					"Heat Index (in Celsius)",
+				};
+	const char *		unitsOfMeasurement[] =
+				{
+					[kOutputDistributionIndexCalibratedRelativeHumidity]		= "%",
+					[kOutputDistributionIndexCalibratedTemperatureCelcius]		= "Celcius",
+					[kOutputDistributionIndexCalibratedTemperatureFahrenheit]	= "Fahrenheit",
+					[kOutputDistributionIndexDewPointCelcius]			= "Celcius",
+					[kOutputDistributionIndexAbsoluteHumidity]			= "g/m^3",
+					[kOutputDistributionIndexHeatIndexCelcius]			= "Celcius",
+				};
+	const char *		traceVariableNames[kTraceVariableIndexMax] =
+				{
+					[kTraceVariableIndexVrhOverVsupply]	= "Vrh / Vsupply",
+					[kTraceVariableIndexRh]			= "Rh",
+					[kTraceVariableIndexTcelcius]		= "Tcelcius",
+					[kTraceVariableIndexTfahrenheit]	= "Tfahrenheit",
+				};
+	MeanAndVariance		meanAndVariance;
+	InputCorrelation	inputCorrelation;
+	static NDJSONWriter	ndjsonWriter;
+	NDJSONBatchSummary	ndjsonBatchSummary = {0};
+	size_t			ndjsonBatchIndex = 0;
+	RandomPool		randomPool = {0};
+	RandomPoolRegion	randomPoolRegion = {0};
+	static PolynomialChaosExpansion	polynomialChaosExpansion;
+	static double		polynomialChaosSamples[kOutputDistributionIndexMax][kPolynomialChaosSamplesPerBlock];
+	static double		correlatedInputSamples[kInputDistributionIndexMax][kInputCorrelationSamplesPerBlock];
+	static IncrementalCache	incrementalCache;
+	static ProgressPublisher	progressPublisher;
+	uint64_t		lastMetricsWriteNanoseconds = metricsGetTimeNanoseconds();
+	bool			hasMetricsWriteError = false;
+	ProgressSnapshot	progressSnapshot;
+	DistributionCode	distributionCode;
+	size_t			lowerOutput;
+	size_t			upperOutput;
+	size_t			lowerSampledOutput;
+
+	/*
+	 *	Get command line arguments.
+	 */
+	if (getCommandLineArguments(argc, argv, &arguments))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (arguments.common.isInputFromFileEnabled)
+	{
+		if (arguments.latencyTargetMilliseconds > 0)
+		{
+			return runAnytimeBatchMode(&arguments);
+		}
+
+		return runBatchMode(&arguments);
+	}
+
+	if (arguments.isRandomPoolGenerationEnabled)
+	{
+		return randomPoolGenerate(arguments.randomPoolFilePath, arguments.randomPoolNumberOfValues, kRandomPoolDefaultGeneratorSeed);
+	}
+
+	if (arguments.isSurrogateTableBuildEnabled)
+	{
+		return surrogateTableBuild(arguments.surrogateTableFilePath);
+	}
+
+	if (arguments.isProgressShowEnabled)
+	{
+		if (progressSnapshotRead(arguments.progressFilePath, &progressSnapshot))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+		printProgressSnapshot(&progressSnapshot, outputVariableNames, unitsOfMeasurement);
+
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	if (arguments.isSampleDecompressionEnabled)
+	{
+		return printCompressedSamples(arguments.compressedSamplesFilePath);
+	}
+
+	if (arguments.isTimeSeriesPrintEnabled)
+	{
+		return printTimeSeries(&arguments);
+	}
+
+	if (arguments.isDistributionCodeDecodeEnabled)
+	{
+		if (distributionCodeFromBase64(&distributionCode, arguments.distributionCodeText))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+		printDecodedDistributionCode(&distributionCode);
+
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	/*
+	 *	Map the random pool and check the region of this run before the loop, so that the
+	 *	loop only reads uniforms.
+	 */
+	if (arguments.isRandomPoolEnabled)
+	{
+		if (randomPoolOpen(&randomPool, arguments.randomPoolFilePath))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (randomPoolSelectRegion(
+				&randomPool,
+				arguments.randomPoolRegionSeed,
+				arguments.common.numberOfMonteCarloIterations * kInputDistributionIndexMax,
+				&randomPoolRegion))
+		{
+			randomPoolClose(&randomPool);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments.common.isVerbose)
+		{
+			fprintf(stderr, "Random pool: using region %zu of %zu.\n", randomPoolRegion.regionIndex, randomPoolRegion.numberOfRegions);
+		}
+	}
+
+	/*
+	 *	Factorize the input correlation matrix once, outside the sampling loop.
+	 */
+	if (setInputCorrelation(&arguments, &inputCorrelation))
 	{
-		Tcelcius = kSensorCalibrationConstant3 + kSensorCalibrationConstant4 * (Vt / Vsupply);
-		calibratedValue = outputDistributions[kOutputDistributionIndexCalibratedTemperatureCelcius] = Tcelcius;
+		return kCommonConstantReturnTypeError;
 	}
 
-	if (calculateAllOutputs || (arguments->common.outputSelect == kOutputDistributionIndexCalibratedTemperatureFahrenheit))
+	/*
+	 *	In Monte Carlo mode with all outputs selected, the loop also accumulates the joint
+	 *	statistics of the outputs. The histogram covers the support of (Rh, Tcelcius), which
+	 *	follows from the bounds of the uniform inputs.
+	 */
+	isJointMonteCarloMode = arguments.common.isMonteCarloMode && (arguments.common.outputSelect == kOutputDistributionIndexMax);
+	if (isJointMonteCarloMode)
 	{
-		Tfahrenheit =  kSensorCalibrationConstant5 + kSensorCalibrationConstant6 * (Vt / Vsupply);
-		calibratedValue = outputDistributions[kOutputDistributionIndexCalibratedTemperatureFahrenheit] = Tfahrenheit;
-	}
+		double	RhMinimum;
+		double	RhMaximum;
+		double	TcelciusMinimum;
+		double	TcelciusMaximum;
 
-	return	calibratedValue;
-}
+		streamingCovarianceInit(&jointOutputCovariance, kOutputDistributionIndexMax);
+		sensorModelGetChannelRange(arguments.sensorModel, kSensorModelChannelRelativeHumidity, arguments.inputLowerBound, arguments.inputUpperBound, &RhMinimum, &RhMaximum);
+		sensorModelGetChannelRange(arguments.sensorModel, kSensorModelChannelTemperatureCelcius, arguments.inputLowerBound, arguments.inputUpperBound, &TcelciusMinimum, &TcelciusMaximum);
+		histogram2DInit(&jointOutputHistogram, RhMinimum, RhMaximum, TcelciusMinimum, TcelciusMaximum);
+	}
 
-int
-main(int argc, char *  argv[])
-{
-	CommandLineArguments	arguments = {0};
+	getSelectedOutputRange(&arguments, &lowerOutput, &upperOutput);
 
-	double			calibratedSensorOutput;
-	double *		monteCarloOutputSamples = NULL;
-	clock_t			start;
-	clock_t			end;
-	double			cpuTimeUsedSeconds;
-	double			inputDistributions[kInputDistributionIndexMax];
-	double			outputDistributions[kOutputDistributionIndexMax];
-	const char *		outputVariableNames[kOutputDistributionIndexMax] =
-				{
-					"Calibrated Relative Humidity",
-					"Calibrated Temperature (in Celsius)",
-					"Calibrated Temperature (in Farenheit)",
-				};
-	const char *		unitsOfMeasurement[] =
-				{
-					[kOutputDistributionIndexCalibratedRelativeHumidity]		= "%",
-					[kOutputDistributionIndexCalibratedTemperatureCelcius]		= "Celcius",
-					[kOutputDistributionIndexCalibratedTemperatureFahrenheit]	= "Fahrenheit",
-				};
-	MeanAndVariance		meanAndVariance;
+	/*
+	 *	With all outputs selected, only the samples of the tracked output, the last one, are
+	 *	kept for `data.out`, unless the Arrow file (-a) needs a column of each output.
+	 */
+	lowerSampledOutput = (isJointMonteCarloMode && !arguments.isArrowOutputEnabled) ? upperOutput - 1 : lowerOutput;
 
 	/*
-	 *	Get command line arguments.
+	 *	With a reservoir, only a bounded, uniformly-chosen subset of the samples is kept. On
+	 *	more than one thread (-W), the threads fill reservoirs of their own, which are merged.
 	 */
-	if (getCommandLineArguments(argc, argv, &arguments))
+	isParallelReservoirMode = (arguments.reservoirCapacity > 0) && (arguments.numberOfThreads > 1);
+	if (arguments.reservoirCapacity > 0)
 	{
-		return kCommonConstantReturnTypeError;
+		if (reservoirInit(&monteCarloOutputReservoir, arguments.reservoirCapacity, kReservoirDefaultSeed))
+		{
+			return kCommonConstantReturnTypeError;
+		}
 	}
-
-	if (arguments.common.isMonteCarloMode)
+	else if (arguments.isOutOfCoreEnabled)
+	{
+		/*
+		 *	Out of core, the samples are spilled to disk in sorted runs instead.
+		 */
+		if (outOfCoreInit(&outOfCoreSampleSet, arguments.outOfCoreDirectoryPath))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+	else if (arguments.common.isMonteCarloMode)
 	{
+		/*
+		 *	The samples of each sampled output are kept one column after the other.
+		 */
 		monteCarloOutputSamples = (double *) checkedMalloc(
-							arguments.common.numberOfMonteCarloIterations * sizeof(double),
+							(upperOutput - lowerSampledOutput) * arguments.common.numberOfMonteCarloIterations * sizeof(double),
 							__FILE__,
 							__LINE__);
+		numberOfMonteCarloOutputSamples = arguments.common.numberOfMonteCarloIterations;
+	}
+
+	if (arguments.isNDJSONOutputEnabled)
+	{
+		if (ndjsonWriterOpen(&ndjsonWriter, arguments.ndjsonOutputFilePath))
+		{
+			free(monteCarloOutputSamples);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (arguments.isTraceEnabled)
+	{
+		if (traceOpen(arguments.traceFilePath, traceVariableNames, kTraceVariableIndexMax, arguments.traceSamplingInterval))
+		{
+			free(monteCarloOutputSamples);
+
+			return kCommonConstantReturnTypeError;
+		}
 	}
 
 	/*
@@ -152,23 +1279,334 @@ main(int argc, char *  argv[])
 		start = clock();
 	}
 
-	for (size_t i = 0; i < arguments.common.numberOfMonteCarloIterations; i++)
+	/*
+	 *	The fit is timed with the sampling, since it evaluates the model.
+	 */
+	if (arguments.polynomialChaosOrder > 0)
+	{
+		if (polynomialChaosFit(
+				&polynomialChaosExpansion,
+				arguments.polynomialChaosOrder,
+				arguments.inputLowerBound,
+				arguments.inputUpperBound,
+				lowerOutput,
+				upperOutput,
+				evaluateSensorModel,
+				&arguments,
+				kPolynomialChaosDefaultSeed))
+		{
+			free(monteCarloOutputSamples);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	/*
+	 *	Open the columns of the incremental cache, so that the loop only computes those it misses.
+	 */
+	if (arguments.isIncrementalCacheEnabled)
+	{
+		if (incrementalCacheOpen(
+				&incrementalCache,
+				arguments.incrementalCacheDirectoryPath,
+				arguments.sensorModel,
+				arguments.divisionAccuracyTier,
+				arguments.inputLowerBound,
+				arguments.inputUpperBound,
+				kIncrementalCacheDefaultSeed,
+				arguments.common.numberOfMonteCarloIterations,
+				lowerOutput,
+				upperOutput))
+		{
+			free(monteCarloOutputSamples);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments.common.isVerbose)
+		{
+			printIncrementalCacheColumns(&incrementalCache);
+		}
+	}
+
+	if (arguments.isProgressPublicationEnabled)
+	{
+		if (progressPublisherOpen(
+				&progressPublisher,
+				arguments.progressFilePath,
+				lowerOutput,
+				upperOutput,
+				arguments.common.numberOfMonteCarloIterations,
+				(double)arguments.progressIntervalMilliseconds * 1e-3))
+		{
+			free(monteCarloOutputSamples);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (isParallelReservoirMode)
+	{
+		if (parallelReservoirRun(
+				evaluateSensorModel,
+				&arguments,
+				arguments.inputLowerBound,
+				arguments.inputUpperBound,
+				lowerOutput,
+				arguments.common.numberOfMonteCarloIterations,
+				arguments.numberOfThreads,
+				kParallelReservoirDefaultSeed,
+				&monteCarloOutputStatistics,
+				&monteCarloOutputReservoir))
+		{
+			reservoirFree(&monteCarloOutputReservoir);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	for (size_t i = 0; !isParallelReservoirMode && (i < arguments.common.numberOfMonteCarloIterations); i++)
 	{
+		/*
+		 *	The stages of one in every `kMetricsSampleTimingInterval` samples are timed.
+		 */
+		bool		isTimedSample = ((i % kMetricsSampleTimingInterval) == 0);
+		uint64_t	stageNanoseconds[kLoopStageMax];
+
+		markLoopStage(stageNanoseconds, kLoopStageStart, isTimedSample);
+
 		/*
 		 *	Set input distribution values, inside the main computation
 		 *	loop, so that it can also generate samples in the native
 		 *	Monte Carlo Execution Mode.
 		 */
-		setInputDistributionsViaUxHwCall(inputDistributions);
+		if (arguments.polynomialChaosOrder > 0)
+		{
+			/*
+			 *	Draw the outputs from the expansion, a block at a time, instead of evaluating the model.
+			 */
+			size_t	blockIndex = i % kPolynomialChaosSamplesPerBlock;
+
+			if (blockIndex == 0)
+			{
+				size_t	remaining = arguments.common.numberOfMonteCarloIterations - i;
+
+				polynomialChaosSampleBlock(
+					&polynomialChaosExpansion,
+					(remaining < kPolynomialChaosSamplesPerBlock) ? remaining : kPolynomialChaosSamplesPerBlock,
+					polynomialChaosSamples);
+			}
+
+			for (size_t output = lowerOutput; output < upperOutput; output++)
+			{
+				outputDistributions[output] = polynomialChaosSamples[output][blockIndex];
+			}
+			calibratedSensorOutput = outputDistributions[upperOutput - 1];
+			markLoopStage(stageNanoseconds, kLoopStageSampled, isTimedSample);
+			markLoopStage(stageNanoseconds, kLoopStageConverted, isTimedSample);
+		}
+		else if (arguments.isIncrementalCacheEnabled)
+		{
+			/*
+			 *	Read or compute the output columns a block at a time.
+			 */
+			size_t	blockIndex = i % kIncrementalCacheSamplesPerBlock;
+
+			if (blockIndex == 0)
+			{
+				size_t	remaining = arguments.common.numberOfMonteCarloIterations - i;
+
+				incrementalCacheEvaluateBlock(
+					&incrementalCache,
+					(remaining < kIncrementalCacheSamplesPerBlock) ? remaining : kIncrementalCacheSamplesPerBlock);
+			}
+
+			for (size_t output = lowerOutput; output < upperOutput; output++)
+			{
+				outputDistributions[output] = incrementalCache.columns[kIncrementalCacheColumnKindOutput][output].block[blockIndex];
+			}
+			calibratedSensorOutput = outputDistributions[upperOutput - 1];
+			markLoopStage(stageNanoseconds, kLoopStageSampled, isTimedSample);
+			markLoopStage(stageNanoseconds, kLoopStageConverted, isTimedSample);
+		}
+		else
+		{
+			if (arguments.isRandomPoolEnabled)
+			{
+				setInputDistributionsFromRandomPool(inputDistributions, &arguments, &randomPoolRegion.values[i * kInputDistributionIndexMax]);
+			}
+			else if (inputCorrelation.isEnabled)
+			{
+				/*
+				 *	Draw the correlated inputs a block at a time.
+				 */
+				size_t	blockIndex = i % kInputCorrelationSamplesPerBlock;
+
+				if (blockIndex == 0)
+				{
+					size_t	remaining = arguments.common.numberOfMonteCarloIterations - i;
+
+					setCorrelatedInputDistributionBlockViaUxHwCall(
+						correlatedInputSamples,
+						(remaining < kInputCorrelationSamplesPerBlock) ? remaining : kInputCorrelationSamplesPerBlock,
+						&arguments,
+						&inputCorrelation);
+				}
+
+				for (size_t input = 0; input < kInputDistributionIndexMax; input++)
+				{
+					inputDistributions[input] = correlatedInputSamples[input][blockIndex];
+				}
+			}
+			else
+			{
+				setInputDistributionsViaUxHwCall(inputDistributions, &arguments);
+			}
 
-		calibratedSensorOutput = calculateSensorOutput(&arguments, inputDistributions, outputDistributions);
+			markLoopStage(stageNanoseconds, kLoopStageSampled, isTimedSample);
+
+			traceBeginSample(i);
+			calibratedSensorOutput = calculateSensorOutput(&arguments, inputDistributions, outputDistributions);
+			markLoopStage(stageNanoseconds, kLoopStageConverted, isTimedSample);
+		}
 
 		/*
 		 *	For this application, calibratedSensorOutput is the item we track.
 		 */
-		if (arguments.common.isMonteCarloMode)
+		if (isJointMonteCarloMode)
+		{
+			streamingCovarianceAdd(&jointOutputCovariance, outputDistributions);
+			histogram2DAdd(
+				&jointOutputHistogram,
+				outputDistributions[kOutputDistributionIndexCalibratedRelativeHumidity],
+				outputDistributions[kOutputDistributionIndexCalibratedTemperatureCelcius]);
+		}
+
+		if (arguments.reservoirCapacity > 0)
+		{
+			streamingStatisticsAdd(&monteCarloOutputStatistics, calibratedSensorOutput);
+			reservoirAdd(&monteCarloOutputReservoir, calibratedSensorOutput);
+		}
+		else if (arguments.isOutOfCoreEnabled)
+		{
+			streamingStatisticsAdd(&monteCarloOutputStatistics, calibratedSensorOutput);
+			outOfCoreAdd(&outOfCoreSampleSet, calibratedSensorOutput);
+		}
+		else if (arguments.common.isMonteCarloMode)
+		{
+			for (size_t output = lowerSampledOutput; output < upperOutput; output++)
+			{
+				monteCarloOutputSamples[(output - lowerSampledOutput) * numberOfMonteCarloOutputSamples + i] = outputDistributions[output];
+			}
+		}
+
+		if (arguments.isProgressPublicationEnabled)
+		{
+			progressPublisherAdd(&progressPublisher, outputDistributions);
+		}
+		markLoopStage(stageNanoseconds, kLoopStageReduced, isTimedSample);
+
+		/*
+		 *	Stream the converted reading, or fold it into the current batch summary.
+		 */
+		if (arguments.isNDJSONOutputEnabled)
+		{
+			if (arguments.ndjsonBatchSize > 0)
+			{
+				accumulateNDJSONBatchSummary(&ndjsonWriter, &arguments, &ndjsonBatchSummary, &ndjsonBatchIndex, outputDistributions);
+			}
+			else
+			{
+				writeNDJSONReadingRecord(&ndjsonWriter, &arguments, i, outputDistributions);
+			}
+		}
+		markLoopStage(stageNanoseconds, kLoopStageWritten, isTimedSample);
+
+		if (isTimedSample)
+		{
+			hasMetricsWriteError |= (recordLoopStages(&arguments, stageNanoseconds, i, &lastMetricsWriteNanoseconds) != kCommonConstantReturnTypeSuccess);
+		}
+	}
+
+	/*
+	 *	Merge the runs first, so that no run files are left behind by the errors below.
+	 */
+	if (arguments.isOutOfCoreEnabled)
+	{
+		CommonConstantReturnType	mergeResult = outOfCoreMerge(
+								&outOfCoreSampleSet,
+								arguments.isWassersteinReferenceEnabled ? arguments.wassersteinReferenceFilePath : NULL,
+								&outOfCoreSummary);
+
+		outOfCoreFree(&outOfCoreSampleSet);
+		if (mergeResult != kCommonConstantReturnTypeSuccess)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (arguments.isIncrementalCacheEnabled)
+	{
+		if (incrementalCacheClose(&incrementalCache))
+		{
+			free(monteCarloOutputSamples);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (arguments.isRandomPoolEnabled)
+	{
+		randomPoolClose(&randomPool);
+	}
+
+	if (arguments.isProgressPublicationEnabled)
+	{
+		if (progressPublisherClose(&progressPublisher))
+		{
+			free(monteCarloOutputSamples);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (arguments.isMetricsOutputEnabled)
+	{
+		if ((metricsWrite(arguments.metricsFilePath) != kCommonConstantReturnTypeSuccess) || hasMetricsWriteError)
+		{
+			free(monteCarloOutputSamples);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (arguments.isTraceEnabled)
+	{
+		if (traceClose())
+		{
+			fprintf(stderr, "Error: Could not write the trace file.\n");
+			free(monteCarloOutputSamples);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (arguments.isNDJSONOutputEnabled)
+	{
+		/*
+		 *	Write out the last, partially-filled batch.
+		 */
+		if (arguments.ndjsonBatchSize > 0)
+		{
+			accumulateNDJSONBatchSummary(&ndjsonWriter, &arguments, &ndjsonBatchSummary, &ndjsonBatchIndex, NULL);
+		}
+
+		if (ndjsonWriterClose(&ndjsonWriter))
 		{
-			monteCarloOutputSamples[i] = calibratedSensorOutput;
+			fprintf(stderr, "Error: Could not write the NDJSON output.\n");
+			free(monteCarloOutputSamples);
+
+			return kCommonConstantReturnTypeError;
 		}
 	}
 
@@ -176,14 +1614,44 @@ main(int argc, char *  argv[])
 	 *	If not doing Laplace version, then approximate the cost of the third phase of
 	 *	Monte Carlo (post-processing), by calculating the mean and variance.
 	 */
-	if (arguments.common.isMonteCarloMode)
+	if (arguments.reservoirCapacity > 0)
+	{
+		meanAndVariance = streamingStatisticsGetMeanAndVariance(&monteCarloOutputStatistics);
+		calibratedSensorOutput = meanAndVariance.mean;
+
+		/*
+		 *	The reservoir's samples take the place of the full sample array in the outputs below.
+		 */
+		monteCarloOutputSamples = monteCarloOutputReservoir.samples;
+		numberOfMonteCarloOutputSamples = monteCarloOutputReservoir.count;
+	}
+	else if (arguments.isOutOfCoreEnabled)
+	{
+		meanAndVariance = streamingStatisticsGetMeanAndVariance(&monteCarloOutputStatistics);
+		calibratedSensorOutput = meanAndVariance.mean;
+	}
+	else if (arguments.common.isMonteCarloMode)
 	{
+		/*
+		 *	The tracked output is the last selected one, as in the loop.
+		 */
 		meanAndVariance = calculateMeanAndVarianceOfDoubleSamples(
-					monteCarloOutputSamples,
-					arguments.common.numberOfMonteCarloIterations);
+					&monteCarloOutputSamples[(upperOutput - 1 - lowerSampledOutput) * numberOfMonteCarloOutputSamples],
+					numberOfMonteCarloOutputSamples);
 		calibratedSensorOutput = meanAndVariance.mean;
 	}
 
+	if (isJointMonteCarloMode)
+	{
+		/*
+		 *	Report the mean of each output in place of its value.
+		 */
+		for (size_t i = 0; i < kOutputDistributionIndexMax; i++)
+		{
+			outputDistributions[i] = jointOutputCovariance.mean[i];
+		}
+	}
+
 	/*
 	 *	Stop timing.
 	 */
@@ -218,6 +1686,15 @@ main(int argc, char *  argv[])
 						outputVariableNames[i],
 						unitsOfMeasurement[i]);
 				}
+
+				if (isJointMonteCarloMode)
+				{
+					printJointOutputStatistics(
+						&jointOutputCovariance,
+						&jointOutputHistogram,
+						outputVariableNames,
+						unitsOfMeasurement);
+				}
 			}
 			else
 			{
@@ -225,17 +1702,42 @@ main(int argc, char *  argv[])
 					calibratedSensorOutput,
 					outputVariableNames[arguments.common.outputSelect],
 					unitsOfMeasurement[arguments.common.outputSelect]);
+
+				if (arguments.isDistributionCodeEnabled
+					&& printDistributionCodeOfSamples(
+						monteCarloOutputSamples,
+						numberOfMonteCarloOutputSamples,
+						unitsOfMeasurement[arguments.common.outputSelect]))
+				{
+					free(monteCarloOutputSamples);
+
+					return kCommonConstantReturnTypeError;
+				}
+
+				if (arguments.isOutOfCoreEnabled)
+				{
+					printOutOfCoreSummary(&outOfCoreSummary, unitsOfMeasurement[arguments.common.outputSelect]);
+				}
 			}
 		}
 		else
 		{
+			/*
+			 *	With all outputs selected, the JSON output holds the mean of each output.
+			 */
 			printJSONFormattedOutput(
 				&arguments,
-				monteCarloOutputSamples,
+				isJointMonteCarloMode ? NULL : monteCarloOutputSamples,
+				numberOfMonteCarloOutputSamples,
 				outputDistributions,
 				outputVariableNames);
 		}
 
+		if ((arguments.polynomialChaosOrder > 0) && !arguments.common.isOutputJSONMode)
+		{
+			printPolynomialChaosSummary(&polynomialChaosExpansion, outputVariableNames, unitsOfMeasurement);
+		}
+
 		/*
 		 *	Print timing result.
 		 */
@@ -261,13 +1763,54 @@ main(int argc, char *  argv[])
 	}
 
 	/*
-	 *	Save Monte carlo outputs in an output file.
+	 *	Write the output columns and run metadata in Arrow IPC format.
+	 */
+	if (arguments.isArrowOutputEnabled)
+	{
+		if (writeOutputsToArrowIPCFile(
+			&arguments,
+			monteCarloOutputSamples,
+			numberOfMonteCarloOutputSamples,
+			outputDistributions,
+			outputVariableNames,
+			(uint64_t)(cpuTimeUsedSeconds*1000000)))
+		{
+			free(monteCarloOutputSamples);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	/*
+	 *	Save Monte carlo outputs in an output file, or in a compressed sample file.
 	 *	Free dynamically-allocated memory.
+	 *	With all outputs selected, `data.out` holds the samples of the tracked output, the
+	 *	last one. Out-of-core samples are already in the merged file of the spill directory.
 	 */
-	if (arguments.common.isMonteCarloMode)
+	if (arguments.common.isMonteCarloMode && !arguments.isOutOfCoreEnabled)
 	{
-		saveMonteCarloDoubleDataToDataDotOutFile(monteCarloOutputSamples, (uint64_t)(cpuTimeUsedSeconds*1000000), arguments.common.numberOfMonteCarloIterations);
-		
+		if (arguments.isSampleCompressionEnabled)
+		{
+			if (sampleCompressionWriteFile(
+				arguments.compressedSamplesFilePath,
+				monteCarloOutputSamples,
+				numberOfMonteCarloOutputSamples,
+				(uint64_t)(cpuTimeUsedSeconds*1000000),
+				arguments.sampleCompressionErrorBound))
+			{
+				free(monteCarloOutputSamples);
+
+				return kCommonConstantReturnTypeError;
+			}
+		}
+		else
+		{
+			saveMonteCarloDoubleDataToDataDotOutFile(
+				&monteCarloOutputSamples[(upperOutput - 1 - lowerSampledOutput) * numberOfMonteCarloOutputSamples],
+				(uint64_t)(cpuTimeUsedSeconds*1000000),
+				numberOfMonteCarloOutputSamples);
+		}
+
 		free(monteCarloOutputSamples);
 	}
 
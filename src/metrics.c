@@ -0,0 +1,411 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "metrics.h"
+
+/*
+ *	Prefix of the names of all exported metrics.
+ */
+#define kMetricsNamePrefix	"sht4x_"
+
+_Thread_local MetricsShard *	metricsThreadShard = NULL;
+
+static _Atomic(MetricsShard *)	shards[kMetricsMaxShards];
+
+static const struct
+{
+	const char *	stage;
+	const char *	unit;
+} kMetricsHistogramLabels[kMetricsHistogramMax] =
+{
+	[kMetricsHistogramIngestPerBatch]	= {"ingest", "batch"},
+	[kMetricsHistogramIngestPerReading]	= {"ingest", "reading"},
+	[kMetricsHistogramSamplingPerSample]	= {"sampling", "sample"},
+	[kMetricsHistogramSamplingPerBlock]	= {"sampling", "block"},
+	[kMetricsHistogramConversionPerSample]	= {"conversion", "sample"},
+	[kMetricsHistogramConversionPerBlock]	= {"conversion", "block"},
+	[kMetricsHistogramReductionPerSample]	= {"reduction", "sample"},
+	[kMetricsHistogramReductionPerBlock]	= {"reduction", "block"},
+	[kMetricsHistogramOutputPerSample]	= {"output", "sample"},
+	[kMetricsHistogramOutputPerBatch]	= {"output", "batch"},
+	[kMetricsHistogramEndToEndPerReading]	= {"end_to_end", "reading"},
+	[kMetricsHistogramReorderPerTile]	= {"reorder", "tile"},
+	[kMetricsHistogramOutputPerTile]	= {"output", "tile"},
+};
+
+static const struct
+{
+	const char *	name;
+	const char *	help;
+} kMetricsCounterDescriptions[kMetricsCounterMax] =
+{
+	[kMetricsCounterReadings]		= {"readings_total", "Readings evaluated in batch mode."},
+	[kMetricsCounterSamples]		= {"samples_total", "Monte Carlo samples evaluated."},
+	[kMetricsCounterSurrogateTableHits]	= {"surrogate_table_hits_total", "Readings answered from the surrogate table."},
+	[kMetricsCounterSurrogateTableMisses]	= {"surrogate_table_misses_total", "Readings outside the surrogate table, evaluated by Monte Carlo."},
+	[kMetricsCounterLateReadings]		= {"late_readings_total", "Readings whose summary was written after the latency target."},
+	[kMetricsCounterDroppedTraceRecords]	= {"dropped_trace_records_total", "Trace records dropped because a trace ring was full."},
+	[kMetricsCounterReorderWindowFullStalls]	= {"reorder_window_full_stalls_total", "Times a batch worker waited because the reorder window was full."},
+	[kMetricsCounterReorderHeadOfLineStalls]	= {"reorder_head_of_line_stalls_total", "Times the batch writer waited for the oldest tile while later tiles were complete."},
+};
+
+static const struct
+{
+	const char *	name;
+	const char *	help;
+} kMetricsGaugeDescriptions[kMetricsGaugeMax] =
+{
+	[kMetricsGaugeReorderDepthMaximum]	= {"reorder_depth_max", "Most completed tiles held in the reorder window at once."},
+};
+
+/*
+ *	Upper bounds of the exported histogram buckets, in seconds: 1, 2 and 5 times each power
+ *	of ten from 100 ns to 100 s.
+ */
+static const double	kMetricsExportedBucketBounds[] =
+{
+	1e-7, 2e-7, 5e-7, 1e-6, 2e-6, 5e-6, 1e-5, 2e-5, 5e-5, 1e-4, 2e-4, 5e-4,
+	1e-3, 2e-3, 5e-3, 1e-2, 2e-2, 5e-2, 1e-1, 2e-1, 5e-1, 1e0, 2e0, 5e0, 1e1, 2e1, 5e1, 1e2,
+};
+
+static const double	kMetricsExportedQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+static inline void
+increment(_Atomic uint64_t *  value, uint64_t amount)
+{
+	atomic_store_explicit(value, atomic_load_explicit(value, memory_order_relaxed) + amount, memory_order_relaxed);
+
+	return;
+}
+
+static size_t
+getBucketIndex(uint64_t nanoseconds)
+{
+	size_t	exponent = 0;
+	size_t	shift;
+
+	if (nanoseconds < (2ULL << kMetricsHistogramSubBucketBits))
+	{
+		return (size_t)nanoseconds;
+	}
+	if (nanoseconds >= (1ULL << kMetricsHistogramMaxExponent))
+	{
+		return kMetricsHistogramNumberOfBuckets - 1;
+	}
+
+#if defined(__GNUC__) || defined(__clang__)
+	exponent = 63 - (size_t)__builtin_clzll(nanoseconds);
+#else
+	for (uint64_t value = nanoseconds; value > 1; value >>= 1)
+	{
+		exponent++;
+	}
+#endif
+
+	shift = exponent - kMetricsHistogramSubBucketBits;
+
+	return (shift << kMetricsHistogramSubBucketBits) + (size_t)(nanoseconds >> shift);
+}
+
+/*
+ *	Midpoint of the values counted in a bucket.
+ */
+static double
+getBucketMidpointNanoseconds(size_t bucketIndex)
+{
+	size_t		shift;
+	uint64_t	subBucket;
+
+	if (bucketIndex < (2U << kMetricsHistogramSubBucketBits))
+	{
+		return (double)bucketIndex;
+	}
+
+	shift = (bucketIndex >> kMetricsHistogramSubBucketBits) - 1;
+	subBucket = bucketIndex - (shift << kMetricsHistogramSubBucketBits);
+
+	return ((double)(subBucket << shift) + (double)((subBucket + 1) << shift)) / 2.0;
+}
+
+static MetricsShard *
+getShard(size_t shardIndex)
+{
+	MetricsShard *	shard = atomic_load_explicit(&shards[shardIndex], memory_order_acquire);
+	MetricsShard *	expected = NULL;
+
+	if (shard != NULL)
+	{
+		return shard;
+	}
+
+	shard = calloc(1, sizeof(MetricsShard));
+	if ((shard != NULL) && !atomic_compare_exchange_strong(&shards[shardIndex], &expected, shard))
+	{
+		free(shard);
+		shard = expected;
+	}
+
+	return shard;
+}
+
+uint64_t
+metricsGetTimeNanoseconds(void)
+{
+#if defined(CLOCK_MONOTONIC)
+	struct timespec	now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+#else
+	return (uint64_t)((double)clock() * (1e9 / CLOCKS_PER_SEC));
+#endif
+}
+
+MetricsShard *
+metricsBindThreadSlowPath(void)
+{
+	metricsThreadShard = getShard(0);
+
+	return metricsThreadShard;
+}
+
+void
+metricsBindThread(size_t shardIndex)
+{
+	metricsThreadShard = getShard((shardIndex < kMetricsMaxShards) ? shardIndex : kMetricsMaxShards - 1);
+
+	return;
+}
+
+void
+metricsRecordLatency(MetricsHistogram histogram, uint64_t latencyNanoseconds)
+{
+	MetricsShard *		shard = (metricsThreadShard != NULL) ? metricsThreadShard : metricsBindThreadSlowPath();
+	MetricsHistogramData *	data;
+
+	if (shard == NULL)
+	{
+		return;
+	}
+
+	data = &shard->histograms[histogram];
+	increment(&data->buckets[getBucketIndex(latencyNanoseconds)], 1);
+	increment(&data->sumNanoseconds, latencyNanoseconds);
+	increment(&data->count, 1);
+	if (latencyNanoseconds > atomic_load_explicit(&data->maximumNanoseconds, memory_order_relaxed))
+	{
+		atomic_store_explicit(&data->maximumNanoseconds, latencyNanoseconds, memory_order_relaxed);
+	}
+
+	return;
+}
+
+/*
+ *	Adds the histograms and counters of every shard. A shard that is being written may be
+ *	up to one record behind.
+ */
+static void
+mergeShards(uint64_t (*  buckets)[kMetricsHistogramNumberOfBuckets], uint64_t *  counts, uint64_t *  sums, uint64_t *  maxima, uint64_t *  counters, uint64_t *  gauges)
+{
+	for (size_t shardIndex = 0; shardIndex < kMetricsMaxShards; shardIndex++)
+	{
+		MetricsShard *	shard = atomic_load_explicit(&shards[shardIndex], memory_order_acquire);
+
+		if (shard == NULL)
+		{
+			continue;
+		}
+
+		for (size_t histogram = 0; histogram < kMetricsHistogramMax; histogram++)
+		{
+			MetricsHistogramData *	data = &shard->histograms[histogram];
+			uint64_t		maximum = atomic_load_explicit(&data->maximumNanoseconds, memory_order_relaxed);
+
+			counts[histogram] += atomic_load_explicit(&data->count, memory_order_relaxed);
+			sums[histogram] += atomic_load_explicit(&data->sumNanoseconds, memory_order_relaxed);
+			maxima[histogram] = (maximum > maxima[histogram]) ? maximum : maxima[histogram];
+			for (size_t bucket = 0; bucket < kMetricsHistogramNumberOfBuckets; bucket++)
+			{
+				buckets[histogram][bucket] += atomic_load_explicit(&data->buckets[bucket], memory_order_relaxed);
+			}
+		}
+
+		for (size_t counter = 0; counter < kMetricsCounterMax; counter++)
+		{
+			counters[counter] += atomic_load_explicit(&shard->counters[counter], memory_order_relaxed);
+		}
+
+		for (size_t gauge = 0; gauge < kMetricsGaugeMax; gauge++)
+		{
+			uint64_t	value = atomic_load_explicit(&shard->gauges[gauge], memory_order_relaxed);
+
+			gauges[gauge] = (value > gauges[gauge]) ? value : gauges[gauge];
+		}
+	}
+
+	return;
+}
+
+static void
+writeHistograms(FILE *  file, uint64_t (*  buckets)[kMetricsHistogramNumberOfBuckets], const uint64_t *  counts, const uint64_t *  sums, const uint64_t *  maxima)
+{
+	fprintf(file, "# HELP " kMetricsNamePrefix "stage_latency_seconds Latency of a pipeline stage per unit of work.\n");
+	fprintf(file, "# TYPE " kMetricsNamePrefix "stage_latency_seconds histogram\n");
+	for (size_t histogram = 0; histogram < kMetricsHistogramMax; histogram++)
+	{
+		const char *	stage = kMetricsHistogramLabels[histogram].stage;
+		const char *	unit = kMetricsHistogramLabels[histogram].unit;
+		uint64_t	cumulativeCount = 0;
+		size_t		bucket = 0;
+
+		if (counts[histogram] == 0)
+		{
+			continue;
+		}
+
+		/*
+		 *	Each bucket of the HDR histogram is counted at its midpoint.
+		 */
+		for (size_t bound = 0; bound < sizeof(kMetricsExportedBucketBounds) / sizeof(kMetricsExportedBucketBounds[0]); bound++)
+		{
+			for (; (bucket < kMetricsHistogramNumberOfBuckets) && (getBucketMidpointNanoseconds(bucket) <= kMetricsExportedBucketBounds[bound] * 1e9); bucket++)
+			{
+				cumulativeCount += buckets[histogram][bucket];
+			}
+			fprintf(
+				file,
+				kMetricsNamePrefix "stage_latency_seconds_bucket{stage=\"%s\",unit=\"%s\",le=\"%g\"} %" PRIu64 "\n",
+				stage,
+				unit,
+				kMetricsExportedBucketBounds[bound],
+				cumulativeCount);
+		}
+		fprintf(file, kMetricsNamePrefix "stage_latency_seconds_bucket{stage=\"%s\",unit=\"%s\",le=\"+Inf\"} %" PRIu64 "\n", stage, unit, counts[histogram]);
+		fprintf(file, kMetricsNamePrefix "stage_latency_seconds_sum{stage=\"%s\",unit=\"%s\"} %.9g\n", stage, unit, (double)sums[histogram] * 1e-9);
+		fprintf(file, kMetricsNamePrefix "stage_latency_seconds_count{stage=\"%s\",unit=\"%s\"} %" PRIu64 "\n", stage, unit, counts[histogram]);
+	}
+
+	fprintf(file, "# HELP " kMetricsNamePrefix "stage_latency_quantile_seconds Quantiles of the latency of a pipeline stage, within 3.2%%.\n");
+	fprintf(file, "# TYPE " kMetricsNamePrefix "stage_latency_quantile_seconds gauge\n");
+	for (size_t histogram = 0; histogram < kMetricsHistogramMax; histogram++)
+	{
+		if (counts[histogram] == 0)
+		{
+			continue;
+		}
+
+		for (size_t q = 0; q < sizeof(kMetricsExportedQuantiles) / sizeof(kMetricsExportedQuantiles[0]); q++)
+		{
+			uint64_t	rank = (uint64_t)ceil(kMetricsExportedQuantiles[q] * (double)counts[histogram]);
+			uint64_t	cumulativeCount = 0;
+			size_t		bucket = 0;
+			double		nanoseconds;
+
+			for (; bucket < kMetricsHistogramNumberOfBuckets - 1; bucket++)
+			{
+				cumulativeCount += buckets[histogram][bucket];
+				if (cumulativeCount >= rank)
+				{
+					break;
+				}
+			}
+			nanoseconds = fmin(getBucketMidpointNanoseconds(bucket), (double)maxima[histogram]);
+
+			fprintf(
+				file,
+				kMetricsNamePrefix "stage_latency_quantile_seconds{stage=\"%s\",unit=\"%s\",quantile=\"%g\"} %.9g\n",
+				kMetricsHistogramLabels[histogram].stage,
+				kMetricsHistogramLabels[histogram].unit,
+				kMetricsExportedQuantiles[q],
+				nanoseconds * 1e-9);
+		}
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+metricsWrite(const char *  filePath)
+{
+	uint64_t	(*buckets)[kMetricsHistogramNumberOfBuckets] = calloc(kMetricsHistogramMax, sizeof(*buckets));
+	uint64_t	counts[kMetricsHistogramMax] = {0};
+	uint64_t	sums[kMetricsHistogramMax] = {0};
+	uint64_t	maxima[kMetricsHistogramMax] = {0};
+	uint64_t	counters[kMetricsCounterMax] = {0};
+	uint64_t	gauges[kMetricsGaugeMax] = {0};
+	char		temporaryFilePath[kCommonConstantMaxCharsPerFilepath + 8];
+	FILE *		file;
+	bool		hasError = false;
+
+	if (buckets == NULL)
+	{
+		fprintf(stderr, "Error: Could not allocate memory for the metrics.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	snprintf(temporaryFilePath, sizeof(temporaryFilePath), "%s.tmp", filePath);
+	file = fopen(temporaryFilePath, "w");
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open the metrics file \"%s\".\n", temporaryFilePath);
+		free(buckets);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	mergeShards(buckets, counts, sums, maxima, counters, gauges);
+	writeHistograms(file, buckets, counts, sums, maxima);
+	for (size_t counter = 0; counter < kMetricsCounterMax; counter++)
+	{
+		fprintf(file, "# HELP " kMetricsNamePrefix "%s %s\n", kMetricsCounterDescriptions[counter].name, kMetricsCounterDescriptions[counter].help);
+		fprintf(file, "# TYPE " kMetricsNamePrefix "%s counter\n", kMetricsCounterDescriptions[counter].name);
+		fprintf(file, kMetricsNamePrefix "%s %" PRIu64 "\n", kMetricsCounterDescriptions[counter].name, counters[counter]);
+	}
+	for (size_t gauge = 0; gauge < kMetricsGaugeMax; gauge++)
+	{
+		fprintf(file, "# HELP " kMetricsNamePrefix "%s %s\n", kMetricsGaugeDescriptions[gauge].name, kMetricsGaugeDescriptions[gauge].help);
+		fprintf(file, "# TYPE " kMetricsNamePrefix "%s gauge\n", kMetricsGaugeDescriptions[gauge].name);
+		fprintf(file, kMetricsNamePrefix "%s %" PRIu64 "\n", kMetricsGaugeDescriptions[gauge].name, gauges[gauge]);
+	}
+
+	hasError |= (ferror(file) != 0);
+	hasError |= (fclose(file) != 0);
+	free(buckets);
+
+	if (hasError || (rename(temporaryFilePath, filePath) != 0))
+	{
+		fprintf(stderr, "Error: Could not write the metrics file \"%s\".\n", filePath);
+		remove(temporaryFilePath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
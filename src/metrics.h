@@ -0,0 +1,193 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "common.h"
+
+typedef enum
+{
+	/*
+	 *	Each power of two of a latency, in nanoseconds, is split into 2^5 linear
+	 *	sub-buckets, so recorded latencies are within 3.2% of their true value. Latencies
+	 *	from 2^40 ns (18 minutes) up are counted in the last bucket.
+	 */
+	kMetricsHistogramSubBucketBits		= 5,
+	kMetricsHistogramMaxExponent		= 40,
+	kMetricsHistogramNumberOfBuckets	= (kMetricsHistogramMaxExponent - kMetricsHistogramSubBucketBits + 1) << kMetricsHistogramSubBucketBits,
+
+	/*
+	 *	Shards of per-thread metrics. Shard 0 belongs to the main thread, and worker
+	 *	threads bind to the others by index.
+	 */
+	kMetricsMaxShards			= 257,
+
+	/*
+	 *	The native Monte Carlo loop times its stages on one in this many samples.
+	 */
+	kMetricsSampleTimingInterval		= 1024,
+} MetricsConstant;
+
+/*
+ *	Latency histograms, one per pipeline stage and unit of work.
+ */
+typedef enum
+{
+	kMetricsHistogramIngestPerBatch,
+	kMetricsHistogramIngestPerReading,
+	kMetricsHistogramSamplingPerSample,
+	kMetricsHistogramSamplingPerBlock,
+	kMetricsHistogramConversionPerSample,
+	kMetricsHistogramConversionPerBlock,
+	kMetricsHistogramReductionPerSample,
+	kMetricsHistogramReductionPerBlock,
+	kMetricsHistogramOutputPerSample,
+	kMetricsHistogramOutputPerBatch,
+	kMetricsHistogramEndToEndPerReading,
+	kMetricsHistogramReorderPerTile,
+	kMetricsHistogramOutputPerTile,
+	kMetricsHistogramMax,
+} MetricsHistogram;
+
+typedef enum
+{
+	kMetricsCounterReadings,
+	kMetricsCounterSamples,
+	kMetricsCounterSurrogateTableHits,
+	kMetricsCounterSurrogateTableMisses,
+	kMetricsCounterLateReadings,
+	kMetricsCounterDroppedTraceRecords,
+	kMetricsCounterReorderWindowFullStalls,
+	kMetricsCounterReorderHeadOfLineStalls,
+	kMetricsCounterMax,
+} MetricsCounter;
+
+/*
+ *	Gauges that keep the largest value recorded.
+ */
+typedef enum
+{
+	kMetricsGaugeReorderDepthMaximum,
+	kMetricsGaugeMax,
+} MetricsGauge;
+
+/*
+ *	HDR histogram of latencies in nanoseconds. Only its owning thread writes it, with
+ *	relaxed atomic stores, so it can be read while it is written without locks.
+ */
+typedef struct
+{
+	_Atomic uint64_t	count;
+	_Atomic uint64_t	sumNanoseconds;
+	_Atomic uint64_t	maximumNanoseconds;
+	_Atomic uint64_t	buckets[kMetricsHistogramNumberOfBuckets];
+} MetricsHistogramData;
+
+typedef struct
+{
+	MetricsHistogramData	histograms[kMetricsHistogramMax];
+	_Atomic uint64_t	counters[kMetricsCounterMax];
+	_Atomic uint64_t	gauges[kMetricsGaugeMax];
+} MetricsShard;
+
+extern _Thread_local MetricsShard *	metricsThreadShard;
+
+MetricsShard *	metricsBindThreadSlowPath(void);
+
+/**
+ *	@brief	Gets a monotonic time stamp for latency measurements.
+ *
+ *	@return	: The time in nanoseconds, from an arbitrary origin.
+ */
+uint64_t	metricsGetTimeNanoseconds(void);
+
+/**
+ *	@brief	Binds the calling thread to a shard, allocated on first use. Threads that run at
+ *		the same time must bind to different shards. A thread that never binds uses shard 0.
+ *
+ *	@param	shardIndex	: The index of the shard, below `kMetricsMaxShards`.
+ */
+void	metricsBindThread(size_t shardIndex);
+
+/**
+ *	@brief	Records a latency in a histogram of the calling thread's shard.
+ *
+ *	@param	histogram		: The histogram.
+ *	@param	latencyNanoseconds	: The latency.
+ */
+void	metricsRecordLatency(MetricsHistogram histogram, uint64_t latencyNanoseconds);
+
+/**
+ *	@brief	Adds to a counter of the calling thread's shard.
+ *
+ *	@param	counter	: The counter.
+ *	@param	value	: The value to add.
+ */
+static inline void
+metricsCount(MetricsCounter counter, uint64_t value)
+{
+	MetricsShard *	shard = (metricsThreadShard != NULL) ? metricsThreadShard : metricsBindThreadSlowPath();
+
+	if (shard != NULL)
+	{
+		atomic_store_explicit(
+			&shard->counters[counter],
+			atomic_load_explicit(&shard->counters[counter], memory_order_relaxed) + value,
+			memory_order_relaxed);
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Raises a gauge of the calling thread's shard to a value, if it is below it.
+ *
+ *	@param	gauge	: The gauge.
+ *	@param	value	: The value.
+ */
+static inline void
+metricsRecordMaximum(MetricsGauge gauge, uint64_t value)
+{
+	MetricsShard *	shard = (metricsThreadShard != NULL) ? metricsThreadShard : metricsBindThreadSlowPath();
+
+	if ((shard != NULL) && (value > atomic_load_explicit(&shard->gauges[gauge], memory_order_relaxed)))
+	{
+		atomic_store_explicit(&shard->gauges[gauge], value, memory_order_relaxed);
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Merges the shards of all threads and writes the metrics in the Prometheus text
+ *		exposition format, with a histogram and the 50%, 90%, 99% and 99.9% quantiles of
+ *		each stage latency that was recorded. The file is written to a temporary path and
+ *		renamed, so scrapers never read a partial file.
+ *
+ *	@param	filePath	: Path of the metrics file.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	metricsWrite(const char *  filePath);
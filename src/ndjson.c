@@ -0,0 +1,283 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "ndjson.h"
+
+/*
+ *	Values at or above this magnitude do not fit the fixed-point fast path and are
+ *	formatted with `snprintf()`.
+ */
+static const double	kNDJSONWriterFastPathLimit = 1e12;
+
+static const char	kDecimalDigitPairs[] =
+			"00010203040506070809"
+			"10111213141516171819"
+			"20212223242526272829"
+			"30313233343536373839"
+			"40414243444546474849"
+			"50515253545556575859"
+			"60616263646566676869"
+			"70717273747576777879"
+			"80818283848586878889"
+			"90919293949596979899";
+
+/*
+ *	Writes the decimal digits of `value`, right-aligned and zero-padded to at least
+ *	`minimumDigits` digits, and returns the number of characters written.
+ */
+static size_t
+formatUnsigned(char *  output, uint64_t value, size_t minimumDigits)
+{
+	char	digits[24];
+	size_t	position = sizeof(digits);
+	size_t	length;
+
+	while (value >= 100)
+	{
+		unsigned	pair = (unsigned)(value % 100);
+
+		value /= 100;
+		position -= 2;
+		memcpy(&digits[position], &kDecimalDigitPairs[2 * pair], 2);
+	}
+
+	if (value >= 10)
+	{
+		position -= 2;
+		memcpy(&digits[position], &kDecimalDigitPairs[2 * value], 2);
+	}
+	else
+	{
+		digits[--position] = (char)('0' + value);
+	}
+
+	while (sizeof(digits) - position < minimumDigits)
+	{
+		digits[--position] = '0';
+	}
+
+	length = sizeof(digits) - position;
+	memcpy(output, &digits[position], length);
+
+	return length;
+}
+
+static size_t
+formatDouble(char *  output, double value)
+{
+	double		magnitude = fabs(value);
+	uint64_t	scale = 1;
+	uint64_t	scaled;
+	size_t		length = 0;
+
+	if (!isfinite(value))
+	{
+		memcpy(output, "null", 4);
+
+		return 4;
+	}
+
+	if (magnitude >= kNDJSONWriterFastPathLimit)
+	{
+		return (size_t)snprintf(output, kNDJSONWriterMaxFieldSize, "%.17g", value);
+	}
+
+	for (int i = 0; i < kNDJSONWriterFractionalDigits; i++)
+	{
+		scale *= 10;
+	}
+
+	scaled = (uint64_t)(magnitude * (double)scale + 0.5);
+	if ((value < 0) && (scaled != 0))
+	{
+		output[length++] = '-';
+	}
+
+	length += formatUnsigned(&output[length], scaled / scale, 1);
+	output[length++] = '.';
+	length += formatUnsigned(&output[length], scaled % scale, kNDJSONWriterFractionalDigits);
+
+	return length;
+}
+
+/*
+ *	Makes room for `numberOfBytes` more bytes in the buffer.
+ */
+static char *
+reserve(NDJSONWriter *  writer, size_t numberOfBytes)
+{
+	if (writer->length + numberOfBytes > sizeof(writer->buffer))
+	{
+		ndjsonWriterFlush(writer);
+	}
+
+	return &writer->buffer[writer->length];
+}
+
+static void
+addKey(NDJSONWriter *  writer, const char *  key)
+{
+	size_t	keyLength = strlen(key);
+	char *	output = reserve(writer, keyLength + 4 + kNDJSONWriterMaxFieldSize);
+	size_t	length = 0;
+
+	if (!writer->isFirstField)
+	{
+		output[length++] = ',';
+	}
+	output[length++] = '"';
+	memcpy(&output[length], key, keyLength);
+	length += keyLength;
+	output[length++] = '"';
+	output[length++] = ':';
+
+	writer->length += length;
+	writer->isFirstField = false;
+
+	return;
+}
+
+CommonConstantReturnType
+ndjsonWriterOpen(NDJSONWriter *  writer, const char *  filePath)
+{
+	writer->length = 0;
+	writer->hasError = false;
+	writer->isFirstField = true;
+	writer->isStandardOutput = (strcmp(filePath, "-") == 0);
+	writer->file = writer->isStandardOutput ? stdout : fopen(filePath, "w");
+
+	if (writer->file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open \"%s\" for writing.\n", filePath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+ndjsonWriterBeginRecord(NDJSONWriter *  writer)
+{
+	*reserve(writer, 1) = '{';
+	writer->length++;
+	writer->isFirstField = true;
+
+	return;
+}
+
+void
+ndjsonWriterAddUnsigned(NDJSONWriter *  writer, const char *  key, uint64_t value)
+{
+	addKey(writer, key);
+	writer->length += formatUnsigned(&writer->buffer[writer->length], value, 1);
+
+	return;
+}
+
+void
+ndjsonWriterAddDouble(NDJSONWriter *  writer, const char *  key, double value)
+{
+	addKey(writer, key);
+	writer->length += formatDouble(&writer->buffer[writer->length], value);
+
+	return;
+}
+
+void
+ndjsonWriterAddString(NDJSONWriter *  writer, const char *  key, const char *  value)
+{
+	size_t	valueLength = strlen(value);
+	char *	output;
+
+	addKey(writer, key);
+	output = reserve(writer, valueLength + 2);
+	output[0] = '"';
+	memcpy(&output[1], value, valueLength);
+	output[valueLength + 1] = '"';
+	writer->length += valueLength + 2;
+
+	return;
+}
+
+void
+ndjsonWriterBeginObject(NDJSONWriter *  writer, const char *  key)
+{
+	addKey(writer, key);
+	writer->buffer[writer->length++] = '{';
+	writer->isFirstField = true;
+
+	return;
+}
+
+void
+ndjsonWriterEndObject(NDJSONWriter *  writer)
+{
+	*reserve(writer, 1) = '}';
+	writer->length++;
+	writer->isFirstField = false;
+
+	return;
+}
+
+void
+ndjsonWriterEndRecord(NDJSONWriter *  writer)
+{
+	char *	output = reserve(writer, 2);
+
+	output[0] = '}';
+	output[1] = '\n';
+	writer->length += 2;
+
+	return;
+}
+
+void
+ndjsonWriterFlush(NDJSONWriter *  writer)
+{
+	if (writer->length > 0)
+	{
+		writer->hasError |= (fwrite(writer->buffer, 1, writer->length, writer->file) != writer->length);
+		writer->length = 0;
+	}
+
+	writer->hasError |= (fflush(writer->file) != 0);
+
+	return;
+}
+
+CommonConstantReturnType
+ndjsonWriterClose(NDJSONWriter *  writer)
+{
+	ndjsonWriterFlush(writer);
+
+	if (!writer->isStandardOutput)
+	{
+		writer->hasError |= (fclose(writer->file) != 0);
+	}
+	writer->file = NULL;
+
+	return writer->hasError ? kCommonConstantReturnTypeError : kCommonConstantReturnTypeSuccess;
+}
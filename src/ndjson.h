@@ -0,0 +1,133 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "common.h"
+
+typedef enum
+{
+	kNDJSONWriterBufferSize		= 64 * 1024,
+	kNDJSONWriterMaxFieldSize	= 128,
+	kNDJSONWriterFractionalDigits	= 6,
+} NDJSONWriterConstant;
+
+/*
+ *	Buffered writer for newline-delimited JSON (NDJSON) records. The writer owns a
+ *	fixed-size buffer and never allocates, so one record per converted reading can
+ *	be emitted from inside the sampling loop.
+ */
+typedef struct
+{
+	FILE *		file;
+	bool		isStandardOutput;
+	bool		hasError;
+	bool		isFirstField;
+	size_t		length;
+	char		buffer[kNDJSONWriterBufferSize];
+} NDJSONWriter;
+
+/**
+ *	@brief	Opens an NDJSON writer.
+ *
+ *	@param	writer		: Pointer to the writer.
+ *	@param	filePath	: Path of the output file, or "-" for the standard output.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	ndjsonWriterOpen(NDJSONWriter *  writer, const char *  filePath);
+
+/**
+ *	@brief	Starts a new record.
+ *
+ *	@param	writer	: Pointer to the writer.
+ */
+void	ndjsonWriterBeginRecord(NDJSONWriter *  writer);
+
+/**
+ *	@brief	Appends an unsigned integer field to the current record.
+ *
+ *	@param	writer	: Pointer to the writer.
+ *	@param	key	: The field name. It is written verbatim, so it must not need JSON escaping.
+ *	@param	value	: The field value.
+ */
+void	ndjsonWriterAddUnsigned(NDJSONWriter *  writer, const char *  key, uint64_t value);
+
+/**
+ *	@brief	Appends a double field to the current record. Finite values are written in fixed
+ *		point with `kNDJSONWriterFractionalDigits` fractional digits, without going through
+ *		`printf()`. Non-finite values are written as `null`.
+ *
+ *	@param	writer	: Pointer to the writer.
+ *	@param	key	: The field name. It is written verbatim, so it must not need JSON escaping.
+ *	@param	value	: The field value.
+ */
+void	ndjsonWriterAddDouble(NDJSONWriter *  writer, const char *  key, double value);
+
+/**
+ *	@brief	Appends a string field to the current record.
+ *
+ *	@param	writer	: Pointer to the writer.
+ *	@param	key	: The field name. It is written verbatim, so it must not need JSON escaping.
+ *	@param	value	: The field value. It is also written verbatim, so it must not need JSON escaping.
+ */
+void	ndjsonWriterAddString(NDJSONWriter *  writer, const char *  key, const char *  value);
+
+/**
+ *	@brief	Starts a nested object field in the current record.
+ *
+ *	@param	writer	: Pointer to the writer.
+ *	@param	key	: The field name. It is written verbatim, so it must not need JSON escaping.
+ */
+void	ndjsonWriterBeginObject(NDJSONWriter *  writer, const char *  key);
+
+/**
+ *	@brief	Ends the innermost nested object.
+ *
+ *	@param	writer	: Pointer to the writer.
+ */
+void	ndjsonWriterEndObject(NDJSONWriter *  writer);
+
+/**
+ *	@brief	Ends the current record.
+ *
+ *	@param	writer	: Pointer to the writer.
+ */
+void	ndjsonWriterEndRecord(NDJSONWriter *  writer);
+
+/**
+ *	@brief	Writes the buffered records to the output.
+ *
+ *	@param	writer	: Pointer to the writer.
+ */
+void	ndjsonWriterFlush(NDJSONWriter *  writer);
+
+/**
+ *	@brief	Flushes and closes the writer.
+ *
+ *	@param	writer	: Pointer to the writer.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if all records were written, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	ndjsonWriterClose(NDJSONWriter *  writer);
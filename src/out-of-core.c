@@ -0,0 +1,760 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "out-of-core.h"
+
+const double	kOutOfCoreQuantileProbabilities[kOutOfCoreNumberOfQuantiles] = {0.001, 0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99, 0.999};
+const char *	kOutOfCoreQuantileKeys[kOutOfCoreNumberOfQuantiles] = {"p0.1", "p1", "p5", "p25", "p50", "p75", "p95", "p99", "p99.9"};
+
+static const char	kOutOfCoreSortedFileName[] = "samples.sorted";
+
+typedef enum
+{
+	kOutOfCoreRadixBits	= 8,
+	kOutOfCoreRadixBuckets	= 1 << kOutOfCoreRadixBits,
+	kOutOfCoreRadixPasses	= 64 / kOutOfCoreRadixBits,
+} OutOfCoreRadixConstant;
+
+/*
+ *	Sequential reader of a file of sorted keys or doubles, one large block at a time.
+ */
+typedef struct
+{
+	FILE *		file;
+	uint64_t *	block;
+	size_t		blockCapacity;
+	size_t		numberInBlock;
+	size_t		position;
+	uint64_t	current;
+} BlockReader;
+
+static double
+doubleFromKey(uint64_t key)
+{
+	uint64_t	bits = (key >> 63) ? (key ^ (UINT64_C(1) << 63)) : ~key;
+	double		value;
+
+	memcpy(&value, &bits, sizeof(value));
+
+	return value;
+}
+
+static void
+runFilePath(const OutOfCoreSampleSet *  set, size_t run, char *  path)
+{
+	snprintf(path, kOutOfCoreMaxCharsPerFilepath, "%s/run-%06zu.bin", set->directoryPath, run);
+
+	return;
+}
+
+/*
+ *	Least-significant-digit radix sort of `keys`, using `scratch` of the same size. Digits on
+ *	which all keys agree, such as the exponent bits of samples of a narrow range, are
+ *	skipped. Returns the buffer holding the sorted keys.
+ */
+static uint64_t *
+radixSort(uint64_t *  keys, uint64_t *  scratch, size_t numberOfKeys)
+{
+	size_t	counts[kOutOfCoreRadixPasses][kOutOfCoreRadixBuckets];
+
+	memset(counts, 0, sizeof(counts));
+	for (size_t i = 0; i < numberOfKeys; i++)
+	{
+		for (size_t pass = 0; pass < kOutOfCoreRadixPasses; pass++)
+		{
+			counts[pass][(keys[i] >> (pass * kOutOfCoreRadixBits)) & (kOutOfCoreRadixBuckets - 1)]++;
+		}
+	}
+
+	for (size_t pass = 0; pass < kOutOfCoreRadixPasses; pass++)
+	{
+		size_t		shift = pass * kOutOfCoreRadixBits;
+		size_t		offset = 0;
+		uint64_t *	swap;
+
+		if (counts[pass][(keys[0] >> shift) & (kOutOfCoreRadixBuckets - 1)] == numberOfKeys)
+		{
+			continue;
+		}
+
+		for (size_t bucket = 0; bucket < kOutOfCoreRadixBuckets; bucket++)
+		{
+			size_t	count = counts[pass][bucket];
+
+			counts[pass][bucket] = offset;
+			offset += count;
+		}
+
+		for (size_t i = 0; i < numberOfKeys; i++)
+		{
+			scratch[counts[pass][(keys[i] >> shift) & (kOutOfCoreRadixBuckets - 1)]++] = keys[i];
+		}
+
+		swap = keys;
+		keys = scratch;
+		scratch = swap;
+	}
+
+	return keys;
+}
+
+/*
+ *	Sorts the run of the spill buffer and writes it to its run file in one sequential write.
+ *	Runs on the spill thread, if there is one, while the sampling loop fills the other buffer.
+ */
+static void
+sortAndWriteRun(OutOfCoreSampleSet *  set)
+{
+	char		path[kOutOfCoreMaxCharsPerFilepath];
+	uint64_t *	keys = set->runBuffers[set->spillRunBuffer];
+	size_t		numberOfKeys = set->numberOfSpillSamples;
+	uint64_t *	sorted = radixSort(keys, set->scratchBuffer, numberOfKeys);
+	FILE *		file;
+
+	/*
+	 *	Keep the sorted keys in the run buffer, so that the scratch buffer is always free.
+	 */
+	if (sorted != keys)
+	{
+		set->scratchBuffer = keys;
+		set->runBuffers[set->spillRunBuffer] = sorted;
+	}
+
+	set->minimum = fmin(set->minimum, doubleFromKey(sorted[0]));
+	set->maximum = fmax(set->maximum, doubleFromKey(sorted[numberOfKeys - 1]));
+
+	runFilePath(set, set->spillRun, path);
+	file = fopen(path, "wb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not create the run file \"%s\": %s.\n", path, strerror(errno));
+		set->hasSpillError = true;
+
+		return;
+	}
+
+	setvbuf(file, NULL, _IONBF, 0);
+	if ((fwrite(sorted, sizeof(uint64_t), numberOfKeys, file) != numberOfKeys) | (fclose(file) != 0))
+	{
+		fprintf(stderr, "Error: Could not write the run file \"%s\": %s.\n", path, strerror(errno));
+		set->hasSpillError = true;
+	}
+
+	return;
+}
+
+#if kOutOfCoreHasThreads
+static void *
+spillThreadMain(void *  argument)
+{
+	sortAndWriteRun(argument);
+
+	return NULL;
+}
+#endif
+
+static void
+waitForSpill(OutOfCoreSampleSet *  set)
+{
+#if kOutOfCoreHasThreads
+	if (set->isSpilling)
+	{
+		pthread_join(set->spillThread, NULL);
+	}
+#endif
+	set->isSpilling = false;
+
+	return;
+}
+
+CommonConstantReturnType
+outOfCoreInit(OutOfCoreSampleSet *  set, const char *  directoryPath)
+{
+	struct stat	directoryStatus;
+
+	memset(set, 0, sizeof(*set));
+	set->minimum = INFINITY;
+	set->maximum = -INFINITY;
+
+	if ((stat(directoryPath, &directoryStatus) != 0) || !S_ISDIR(directoryStatus.st_mode))
+	{
+		fprintf(stderr, "Error: The out-of-core spill directory \"%s\" is not an existing directory.\n", directoryPath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (strlen(directoryPath) >= kOutOfCoreMaxCharsPerDirectoryPath)
+	{
+		fprintf(stderr, "Error: The out-of-core spill directory path is longer than %d characters.\n", kOutOfCoreMaxCharsPerDirectoryPath - 1);
+
+		return kCommonConstantReturnTypeError;
+	}
+	strcpy(set->directoryPath, directoryPath);
+
+	set->runBuffers[0] = malloc(kOutOfCoreSamplesPerRun * sizeof(uint64_t));
+	set->runBuffers[1] = malloc(kOutOfCoreSamplesPerRun * sizeof(uint64_t));
+	set->scratchBuffer = malloc(kOutOfCoreSamplesPerRun * sizeof(uint64_t));
+	if ((set->runBuffers[0] == NULL) || (set->runBuffers[1] == NULL) || (set->scratchBuffer == NULL))
+	{
+		fprintf(stderr, "Error: Could not allocate the out-of-core run buffers.\n");
+		outOfCoreFree(set);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+outOfCoreSpill(OutOfCoreSampleSet *  set)
+{
+	waitForSpill(set);
+
+	if (set->numberOfRuns == kOutOfCoreMaxRuns)
+	{
+		if (!set->hasSpillError)
+		{
+			fprintf(stderr, "Error: More than %d out-of-core runs of %d samples.\n", kOutOfCoreMaxRuns, kOutOfCoreSamplesPerRun);
+		}
+		set->hasSpillError = true;
+	}
+
+	if (!set->hasSpillError)
+	{
+		set->spillRunBuffer = set->activeRunBuffer;
+		set->numberOfSpillSamples = set->numberOfBufferedSamples;
+		set->spillRun = set->numberOfRuns++;
+		set->numberOfSamples += set->numberOfBufferedSamples;
+		set->activeRunBuffer ^= 1;
+
+#if kOutOfCoreHasThreads
+		set->isSpilling = (pthread_create(&set->spillThread, NULL, spillThreadMain, set) == 0);
+#endif
+		if (!set->isSpilling)
+		{
+			sortAndWriteRun(set);
+		}
+	}
+
+	set->numberOfBufferedSamples = 0;
+
+	return;
+}
+
+static CommonConstantReturnType
+openBlockReader(BlockReader *  reader, const char *  path, size_t blockCapacity)
+{
+	memset(reader, 0, sizeof(*reader));
+	reader->file = fopen(path, "rb");
+	reader->block = malloc(blockCapacity * sizeof(uint64_t));
+	reader->blockCapacity = blockCapacity;
+	if ((reader->file == NULL) || (reader->block == NULL))
+	{
+		fprintf(stderr, "Error: Could not open \"%s\": %s.\n", path, strerror(errno));
+
+		return kCommonConstantReturnTypeError;
+	}
+	setvbuf(reader->file, NULL, _IONBF, 0);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Moves `reader->current` to the next word of the file. Returns false at the end of the
+ *	file or on a read error, which `ferror()` tells apart.
+ */
+static bool
+advanceBlockReader(BlockReader *  reader)
+{
+	if (reader->position == reader->numberInBlock)
+	{
+		reader->numberInBlock = fread(reader->block, sizeof(uint64_t), reader->blockCapacity, reader->file);
+		reader->position = 0;
+		if (reader->numberInBlock == 0)
+		{
+			return false;
+		}
+	}
+	reader->current = reader->block[reader->position++];
+
+	return true;
+}
+
+static void
+closeBlockReader(BlockReader *  reader)
+{
+	if (reader->file != NULL)
+	{
+		fclose(reader->file);
+	}
+	free(reader->block);
+	memset(reader, 0, sizeof(*reader));
+
+	return;
+}
+
+/*
+ *	Restores the heap order of `heap`, a min-heap of run readers on their current key, below `index`.
+ */
+static void
+siftDown(size_t *  heap, size_t heapSize, const BlockReader *  readers, size_t index)
+{
+	size_t	top = heap[index];
+
+	for (;;)
+	{
+		size_t	child = 2 * index + 1;
+
+		if (child >= heapSize)
+		{
+			break;
+		}
+		if ((child + 1 < heapSize) && (readers[heap[child + 1]].current < readers[heap[child]].current))
+		{
+			child++;
+		}
+		if (readers[top].current <= readers[heap[child]].current)
+		{
+			break;
+		}
+		heap[index] = heap[child];
+		index = child;
+	}
+	heap[index] = top;
+
+	return;
+}
+
+/*
+ *	Exact order statistics, empirical distribution function and 1-Wasserstein distance of the
+ *	merged samples, accumulated as they leave the merge in ascending order.
+ */
+typedef struct
+{
+	OutOfCoreSummary *	summary;
+	uint64_t		numberOfSamples;
+	uint64_t		orderStatisticIndex[2 * kOutOfCoreNumberOfQuantiles];
+	double			orderStatistic[2 * kOutOfCoreNumberOfQuantiles];
+	uint64_t		nextOrderStatisticIndex;
+	size_t			nextECDFPoint;
+
+	BlockReader *		reference;
+	bool			hasReferenceSample;
+	double			referenceSample;
+	uint64_t		numberOfReferenceSamplesSeen;
+	uint64_t		numberOfSamplesSeen;
+	double			lastValue;
+	bool			isReferenceUnsorted;
+} MergeAccumulator;
+
+static void
+advanceReference(MergeAccumulator *  accumulator)
+{
+	double	previous = accumulator->referenceSample;
+
+	accumulator->hasReferenceSample = advanceBlockReader(accumulator->reference);
+	if (accumulator->hasReferenceSample)
+	{
+		memcpy(&accumulator->referenceSample, &accumulator->reference->current, sizeof(double));
+		accumulator->isReferenceUnsorted |= (accumulator->numberOfReferenceSamplesSeen > 0) && !(accumulator->referenceSample >= previous);
+	}
+
+	return;
+}
+
+/*
+ *	Adds the area between the two empirical distribution functions up to `value`, the next
+ *	point of either set, to the 1-Wasserstein distance.
+ */
+static void
+accumulateWasserstein(MergeAccumulator *  accumulator, double value)
+{
+	if (accumulator->numberOfSamplesSeen + accumulator->numberOfReferenceSamplesSeen > 0)
+	{
+		double	difference = (double)accumulator->numberOfSamplesSeen / (double)accumulator->numberOfSamples -
+					(double)accumulator->numberOfReferenceSamplesSeen / (double)accumulator->summary->numberOfReferenceSamples;
+
+		accumulator->summary->wassersteinDistance += fabs(difference) * (value - accumulator->lastValue);
+	}
+	accumulator->lastValue = value;
+
+	return;
+}
+
+static void
+accumulateSample(MergeAccumulator *  accumulator, uint64_t index, double value)
+{
+	OutOfCoreSummary *	summary = accumulator->summary;
+
+	if (index == accumulator->nextOrderStatisticIndex)
+	{
+		accumulator->nextOrderStatisticIndex = UINT64_MAX;
+		for (size_t i = 0; i < 2 * kOutOfCoreNumberOfQuantiles; i++)
+		{
+			if (accumulator->orderStatisticIndex[i] == index)
+			{
+				accumulator->orderStatistic[i] = value;
+			}
+			else if ((accumulator->orderStatisticIndex[i] > index) && (accumulator->orderStatisticIndex[i] < accumulator->nextOrderStatisticIndex))
+			{
+				accumulator->nextOrderStatisticIndex = accumulator->orderStatisticIndex[i];
+			}
+		}
+	}
+
+	while ((accumulator->nextECDFPoint < kOutOfCoreNumberOfECDFPoints) && (value > summary->ecdfValue[accumulator->nextECDFPoint]))
+	{
+		summary->ecdf[accumulator->nextECDFPoint++] = (double)index / (double)accumulator->numberOfSamples;
+	}
+
+	if (accumulator->reference != NULL)
+	{
+		while (accumulator->hasReferenceSample && (accumulator->referenceSample <= value))
+		{
+			accumulateWasserstein(accumulator, accumulator->referenceSample);
+			accumulator->numberOfReferenceSamplesSeen++;
+			advanceReference(accumulator);
+		}
+		accumulateWasserstein(accumulator, value);
+	}
+	accumulator->numberOfSamplesSeen++;
+
+	return;
+}
+
+static void
+initMergeAccumulator(MergeAccumulator *  accumulator, OutOfCoreSummary *  summary, uint64_t numberOfSamples)
+{
+	memset(accumulator, 0, sizeof(*accumulator));
+	accumulator->summary = summary;
+	accumulator->numberOfSamples = numberOfSamples;
+
+	/*
+	 *	Quantiles interpolate between the order statistics at floor((n - 1) p) and the one
+	 *	after it, as type 7 of Hyndman and Fan. The first index needed is the lowest one.
+	 */
+	for (size_t i = 0; i < kOutOfCoreNumberOfQuantiles; i++)
+	{
+		uint64_t	lower = (uint64_t)floor((double)(numberOfSamples - 1) * kOutOfCoreQuantileProbabilities[i]);
+
+		accumulator->orderStatisticIndex[2 * i] = lower;
+		accumulator->orderStatisticIndex[2 * i + 1] = (lower + 1 < numberOfSamples) ? lower + 1 : lower;
+	}
+	accumulator->nextOrderStatisticIndex = accumulator->orderStatisticIndex[0];
+
+	for (size_t k = 0; k < kOutOfCoreNumberOfECDFPoints; k++)
+	{
+		summary->ecdfValue[k] = summary->minimum + (summary->maximum - summary->minimum) * (double)k / (kOutOfCoreNumberOfECDFPoints - 1);
+	}
+
+	return;
+}
+
+static void
+finishMergeAccumulator(MergeAccumulator *  accumulator)
+{
+	OutOfCoreSummary *	summary = accumulator->summary;
+
+	for (size_t i = 0; i < kOutOfCoreNumberOfQuantiles; i++)
+	{
+		double	lower = accumulator->orderStatistic[2 * i];
+		double	upper = accumulator->orderStatistic[2 * i + 1];
+		double	position = (double)(accumulator->numberOfSamples - 1) * kOutOfCoreQuantileProbabilities[i];
+
+		summary->quantile[i] = lower + (position - floor(position)) * (upper - lower);
+	}
+
+	while (accumulator->nextECDFPoint < kOutOfCoreNumberOfECDFPoints)
+	{
+		summary->ecdf[accumulator->nextECDFPoint++] = 1.0;
+	}
+
+	if (accumulator->reference != NULL)
+	{
+		while (accumulator->hasReferenceSample)
+		{
+			accumulateWasserstein(accumulator, accumulator->referenceSample);
+			accumulator->numberOfReferenceSamplesSeen++;
+			advanceReference(accumulator);
+		}
+	}
+
+	return;
+}
+
+/*
+ *	Opens the reference file, which must hold whole doubles and must not be the file the
+ *	merge is about to overwrite.
+ */
+static CommonConstantReturnType
+openReference(BlockReader *  reader, const char *  referenceFilePath, const char *  sortedFilePath, size_t blockCapacity, uint64_t *  numberOfSamples)
+{
+	struct stat	referenceStatus;
+	struct stat	sortedStatus;
+
+	if (openBlockReader(reader, referenceFilePath, blockCapacity) != kCommonConstantReturnTypeSuccess)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((fstat(fileno(reader->file), &referenceStatus) != 0) || !S_ISREG(referenceStatus.st_mode) ||
+		(referenceStatus.st_size == 0) || (referenceStatus.st_size % sizeof(double) != 0))
+	{
+		fprintf(stderr, "Error: The reference \"%s\" is not a non-empty file of sorted doubles.\n", referenceFilePath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((stat(sortedFilePath, &sortedStatus) == 0) && (sortedStatus.st_dev == referenceStatus.st_dev) && (sortedStatus.st_ino == referenceStatus.st_ino))
+	{
+		fprintf(stderr, "Error: The reference \"%s\" is the file that the merge writes; copy it or use another spill directory.\n", referenceFilePath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	*numberOfSamples = (uint64_t)referenceStatus.st_size / sizeof(double);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Merges the runs with a binary heap of their readers, writing the samples in ascending
+ *	order to `output` and handing them to `accumulator`. Returns the number merged.
+ */
+static uint64_t
+mergeRuns(BlockReader *  readers, size_t numberOfRuns, FILE *  output, double *  outputBlock, size_t blockCapacity, MergeAccumulator *  accumulator, bool *  hasError)
+{
+	size_t *	heap = malloc(numberOfRuns * sizeof(size_t));
+	size_t		heapSize = 0;
+	size_t		numberInBlock = 0;
+	uint64_t	numberMerged = 0;
+
+	if (heap == NULL)
+	{
+		fprintf(stderr, "Error: Could not allocate the out-of-core merge heap.\n");
+		*hasError = true;
+
+		return 0;
+	}
+
+	for (size_t run = 0; run < numberOfRuns; run++)
+	{
+		if (advanceBlockReader(&readers[run]))
+		{
+			heap[heapSize++] = run;
+		}
+		*hasError |= (ferror(readers[run].file) != 0);
+	}
+	for (size_t i = heapSize / 2; i-- > 0;)
+	{
+		siftDown(heap, heapSize, readers, i);
+	}
+
+	while (heapSize > 0)
+	{
+		BlockReader *	reader = &readers[heap[0]];
+		double		value = doubleFromKey(reader->current);
+
+		accumulateSample(accumulator, numberMerged++, value);
+		outputBlock[numberInBlock++] = value;
+		if (numberInBlock == blockCapacity)
+		{
+			*hasError |= (fwrite(outputBlock, sizeof(double), numberInBlock, output) != numberInBlock);
+			numberInBlock = 0;
+		}
+
+		if (!advanceBlockReader(reader))
+		{
+			*hasError |= (ferror(reader->file) != 0);
+			heap[0] = heap[--heapSize];
+		}
+		if (heapSize > 0)
+		{
+			siftDown(heap, heapSize, readers, 0);
+		}
+	}
+	*hasError |= (fwrite(outputBlock, sizeof(double), numberInBlock, output) != numberInBlock);
+
+	free(heap);
+
+	return numberMerged;
+}
+
+static void
+removeRuns(OutOfCoreSampleSet *  set)
+{
+	char	path[kOutOfCoreMaxCharsPerFilepath];
+
+	for (size_t run = 0; run < set->numberOfRuns; run++)
+	{
+		runFilePath(set, run, path);
+		remove(path);
+	}
+	set->numberOfRuns = 0;
+
+	return;
+}
+
+CommonConstantReturnType
+outOfCoreMerge(OutOfCoreSampleSet *  set, const char *  referenceFilePath, OutOfCoreSummary *  summary)
+{
+	char			path[kOutOfCoreMaxCharsPerFilepath];
+	char *			sortedFilePath = summary->sortedFilePath;
+	BlockReader		reference;
+	BlockReader *		readers;
+	MergeAccumulator	accumulator;
+	double *		outputBlock;
+	FILE *			output;
+	size_t			blockCapacity;
+	uint64_t		numberMerged;
+	bool			hasError = false;
+
+	if (set->numberOfBufferedSamples > 0)
+	{
+		outOfCoreSpill(set);
+	}
+	waitForSpill(set);
+
+	/*
+	 *	The run buffers are not needed any more; free them before the merge takes its memory.
+	 */
+	for (size_t i = 0; i < 2; i++)
+	{
+		free(set->runBuffers[i]);
+		set->runBuffers[i] = NULL;
+	}
+	free(set->scratchBuffer);
+	set->scratchBuffer = NULL;
+
+	if (set->hasSpillError || (set->numberOfSamples == 0))
+	{
+		if (!set->hasSpillError)
+		{
+			fprintf(stderr, "Error: There are no out-of-core samples to merge.\n");
+		}
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	memset(summary, 0, sizeof(*summary));
+	summary->numberOfSamples = set->numberOfSamples;
+	summary->numberOfRuns = set->numberOfRuns;
+	summary->minimum = set->minimum;
+	summary->maximum = set->maximum;
+	initMergeAccumulator(&accumulator, summary, set->numberOfSamples);
+
+	/*
+	 *	Share the merge memory between the run readers, the reference reader and the output
+	 *	block, keeping every block large enough for reads and writes to stay sequential.
+	 */
+	blockCapacity = kOutOfCoreMergeBufferBytes / sizeof(uint64_t) / (set->numberOfRuns + 2);
+	if (blockCapacity < kOutOfCoreMinimumBlockSamples)
+	{
+		blockCapacity = kOutOfCoreMinimumBlockSamples;
+	}
+
+	snprintf(sortedFilePath, kOutOfCoreMaxCharsPerFilepath, "%s/%s", set->directoryPath, kOutOfCoreSortedFileName);
+	memset(&reference, 0, sizeof(reference));
+	if (referenceFilePath != NULL)
+	{
+		if (openReference(&reference, referenceFilePath, sortedFilePath, blockCapacity, &summary->numberOfReferenceSamples) != kCommonConstantReturnTypeSuccess)
+		{
+			closeBlockReader(&reference);
+			removeRuns(set);
+
+			return kCommonConstantReturnTypeError;
+		}
+		summary->hasReference = true;
+		accumulator.reference = &reference;
+		advanceReference(&accumulator);
+	}
+
+	readers = calloc(set->numberOfRuns, sizeof(BlockReader));
+	outputBlock = malloc(blockCapacity * sizeof(double));
+	output = fopen(sortedFilePath, "wb");
+	hasError = (readers == NULL) || (outputBlock == NULL) || (output == NULL);
+	if (hasError)
+	{
+		fprintf(stderr, "Error: Could not start the out-of-core merge into \"%s\": %s.\n", sortedFilePath, strerror(errno));
+	}
+
+	for (size_t run = 0; !hasError && (run < set->numberOfRuns); run++)
+	{
+		runFilePath(set, run, path);
+		hasError = (openBlockReader(&readers[run], path, blockCapacity) != kCommonConstantReturnTypeSuccess);
+	}
+
+	if (!hasError)
+	{
+		setvbuf(output, NULL, _IONBF, 0);
+		numberMerged = mergeRuns(readers, set->numberOfRuns, output, outputBlock, blockCapacity, &accumulator, &hasError);
+		finishMergeAccumulator(&accumulator);
+		if (hasError || (numberMerged != set->numberOfSamples))
+		{
+			fprintf(stderr, "Error: Could not merge the out-of-core runs into \"%s\".\n", sortedFilePath);
+			hasError = true;
+		}
+		else if (reference.file != NULL && (ferror(reference.file) || accumulator.isReferenceUnsorted))
+		{
+			fprintf(stderr, "Error: Could not read the reference \"%s\" as sorted doubles.\n", referenceFilePath);
+			hasError = true;
+		}
+	}
+
+	if ((output != NULL) && (fclose(output) != 0) && !hasError)
+	{
+		fprintf(stderr, "Error: Could not write \"%s\": %s.\n", sortedFilePath, strerror(errno));
+		hasError = true;
+	}
+	for (size_t run = 0; (readers != NULL) && (run < set->numberOfRuns); run++)
+	{
+		closeBlockReader(&readers[run]);
+	}
+	closeBlockReader(&reference);
+	free(readers);
+	free(outputBlock);
+	removeRuns(set);
+
+	return hasError ? kCommonConstantReturnTypeError : kCommonConstantReturnTypeSuccess;
+}
+
+void
+outOfCoreFree(OutOfCoreSampleSet *  set)
+{
+	waitForSpill(set);
+	for (size_t i = 0; i < 2; i++)
+	{
+		free(set->runBuffers[i]);
+		set->runBuffers[i] = NULL;
+	}
+	free(set->scratchBuffer);
+	set->scratchBuffer = NULL;
+	removeRuns(set);
+
+	return;
+}
@@ -0,0 +1,187 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(_POSIX_THREADS) && (_POSIX_THREADS > 0)
+#include <pthread.h>
+#define kOutOfCoreHasThreads	1
+#else
+#define kOutOfCoreHasThreads	0
+#endif
+#include "common.h"
+
+typedef enum
+{
+	/*
+	 *	Samples per sorted run. Two run buffers, one filled by the sampling loop while
+	 *	the other is sorted and written, and the scratch buffer of the radix sort bound
+	 *	the memory of sampling to three times this many samples.
+	 */
+	kOutOfCoreSamplesPerRun		= 1 << 22,
+
+	/*
+	 *	Memory shared by the blocks of the readers of the runs during the merge, and the
+	 *	smallest block, so that the reads stay large and sequential.
+	 */
+	kOutOfCoreMergeBufferBytes	= 64 << 20,
+	kOutOfCoreMinimumBlockSamples	= 1 << 13,
+	kOutOfCoreMaxRuns		= 1024,
+
+	kOutOfCoreNumberOfQuantiles	= 9,
+	kOutOfCoreNumberOfECDFPoints	= 11,
+	kOutOfCoreMaxCharsPerFilepath	= 1024,
+
+	/*
+	 *	Leaves room in a file path for the names of the run and merged files.
+	 */
+	kOutOfCoreMaxCharsPerDirectoryPath	= kOutOfCoreMaxCharsPerFilepath - 32,
+} OutOfCoreConstant;
+
+extern const double	kOutOfCoreQuantileProbabilities[kOutOfCoreNumberOfQuantiles];
+extern const char *	kOutOfCoreQuantileKeys[kOutOfCoreNumberOfQuantiles];
+
+/*
+ *	Sample set larger than memory. Samples are collected into a run buffer, as keys whose
+ *	unsigned order is the order of the samples; each full run is radix sorted and written
+ *	to a file of the spill directory by a background thread while the sampling loop fills
+ *	the other buffer. The sorted runs are merged at the end.
+ */
+typedef struct
+{
+	char		directoryPath[kOutOfCoreMaxCharsPerDirectoryPath];
+	uint64_t *	runBuffers[2];
+	uint64_t *	scratchBuffer;
+	size_t		activeRunBuffer;
+	size_t		numberOfBufferedSamples;
+	size_t		numberOfRuns;
+	uint64_t	numberOfSamples;
+	double		minimum;
+	double		maximum;
+
+	/*
+	 *	The run being sorted and written by the spill thread, and whether it failed.
+	 */
+	size_t		spillRunBuffer;
+	size_t		numberOfSpillSamples;
+	size_t		spillRun;
+	bool		isSpilling;
+	bool		hasSpillError;
+#if kOutOfCoreHasThreads
+	pthread_t	spillThread;
+#endif
+} OutOfCoreSampleSet;
+
+/*
+ *	Exact summary of all samples: quantiles, the empirical distribution function at
+ *	evenly-spaced points of the range, and the 1-Wasserstein distance to a reference set.
+ */
+typedef struct
+{
+	char		sortedFilePath[kOutOfCoreMaxCharsPerFilepath];
+	uint64_t	numberOfSamples;
+	size_t		numberOfRuns;
+	double		minimum;
+	double		maximum;
+	double		quantile[kOutOfCoreNumberOfQuantiles];
+	double		ecdfValue[kOutOfCoreNumberOfECDFPoints];
+	double		ecdf[kOutOfCoreNumberOfECDFPoints];
+	bool		hasReference;
+	uint64_t	numberOfReferenceSamples;
+	double		wassersteinDistance;
+} OutOfCoreSummary;
+
+/**
+ *	@brief	Initializes an empty out-of-core sample set.
+ *
+ *	@param	set		: Pointer to the set.
+ *	@param	directoryPath	: Existing directory for the runs and the merged samples.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	outOfCoreInit(OutOfCoreSampleSet *  set, const char *  directoryPath);
+
+/**
+ *	@brief	Maps a sample to an unsigned key of the same order: the sign bit is flipped for
+ *		positive numbers and all bits are flipped for negative ones.
+ *
+ *	@param	value	: The sample.
+ *	@return		: The key.
+ */
+static inline uint64_t
+outOfCoreKeyFromDouble(double value)
+{
+	uint64_t	bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+
+	return bits ^ ((uint64_t)((int64_t)bits >> 63) | (UINT64_C(1) << 63));
+}
+
+/**
+ *	@brief	Hands the full run buffer to the spill thread and switches to the other buffer.
+ *		Called by `outOfCoreAdd()`. Errors are reported by `outOfCoreMerge()`.
+ *
+ *	@param	set	: Pointer to the set.
+ */
+void	outOfCoreSpill(OutOfCoreSampleSet *  set);
+
+/**
+ *	@brief	Adds a sample to the set.
+ *
+ *	@param	set	: Pointer to the set.
+ *	@param	value	: The sample.
+ */
+static inline void
+outOfCoreAdd(OutOfCoreSampleSet *  set, double value)
+{
+	set->runBuffers[set->activeRunBuffer][set->numberOfBufferedSamples++] = outOfCoreKeyFromDouble(value);
+	if (set->numberOfBufferedSamples == kOutOfCoreSamplesPerRun)
+	{
+		outOfCoreSpill(set);
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Spills the last run and merges all runs, in one k-way merge, into the file
+ *		`samples.sorted` of the spill directory, as native-endian doubles in ascending
+ *		order, and summarizes them in the same pass. The runs are then removed.
+ *
+ *	@param	set			: Pointer to the set.
+ *	@param	referenceFilePath	: Path of a `samples.sorted` file of another run to measure the 1-Wasserstein distance to, or `NULL`.
+ *	@param	summary			: Pointer to the summary, written by the function.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	outOfCoreMerge(OutOfCoreSampleSet *  set, const char *  referenceFilePath, OutOfCoreSummary *  summary);
+
+/**
+ *	@brief	Frees the buffers of a set and removes any runs left.
+ *
+ *	@param	set	: Pointer to the set.
+ */
+void	outOfCoreFree(OutOfCoreSampleSet *  set);
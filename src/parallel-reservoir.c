@@ -0,0 +1,220 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#if defined(_POSIX_THREADS) && (_POSIX_THREADS > 0)
+#include <pthread.h>
+#define kParallelReservoirHasThreads	1
+#else
+#define kParallelReservoirHasThreads	0
+#endif
+#include "parallel-reservoir.h"
+
+/*
+ *	The share of the samples of one thread, and its results.
+ */
+typedef struct
+{
+	ParallelReservoirModel	model;
+	void *			context;
+	const double *		inputLowerBound;
+	const double *		inputUpperBound;
+	size_t			output;
+	uint64_t		numberOfSamples;
+	uint64_t		seed;
+	StreamingStatistics	statistics;
+	Reservoir		reservoir;
+	bool			hasError;
+} ParallelReservoirWorker;
+
+static uint64_t
+splitMix64(uint64_t *  state)
+{
+	uint64_t	z = (*state += 0x9E3779B97F4A7C15ULL);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+	return z ^ (z >> 31);
+}
+
+static uint64_t
+rotateLeft(uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t
+xoshiro256StarStar(uint64_t  state[4])
+{
+	uint64_t	result = rotateLeft(state[1] * 5, 7) * 9;
+	uint64_t	t = state[1] << 17;
+
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+	state[2] ^= t;
+	state[3] = rotateLeft(state[3], 45);
+
+	return result;
+}
+
+static void *
+parallelReservoirWorkerMain(void *  argument)
+{
+	ParallelReservoirWorker *	worker = argument;
+	double				inputs[kInputDistributionIndexMax];
+	double				outputs[kOutputDistributionIndexMax];
+	uint64_t			state[4];
+	uint64_t			seed = worker->seed;
+
+	for (size_t i = 0; i < 4; i++)
+	{
+		state[i] = splitMix64(&seed);
+	}
+
+	/*
+	 *	The reservoirs of the threads must pick their samples independently of each other.
+	 */
+	if (reservoirInit(&worker->reservoir, worker->reservoir.capacity, splitMix64(&seed)))
+	{
+		worker->hasError = true;
+
+		return NULL;
+	}
+
+	for (uint64_t sample = 0; sample < worker->numberOfSamples; sample++)
+	{
+		for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+		{
+			double	uniform = (double)(xoshiro256StarStar(state) >> 11) * (1.0 / 9007199254740992.0);
+
+			inputs[i] = worker->inputLowerBound[i] + (worker->inputUpperBound[i] - worker->inputLowerBound[i]) * uniform;
+		}
+
+		worker->model(worker->context, inputs, outputs);
+		streamingStatisticsAdd(&worker->statistics, outputs[worker->output]);
+		reservoirAdd(&worker->reservoir, outputs[worker->output]);
+	}
+
+	return NULL;
+}
+
+CommonConstantReturnType
+parallelReservoirRun(
+	ParallelReservoirModel	model,
+	void *			context,
+	const double *		inputLowerBound,
+	const double *		inputUpperBound,
+	size_t			output,
+	uint64_t		numberOfSamples,
+	size_t			numberOfThreads,
+	uint64_t		seed,
+	StreamingStatistics *	statistics,
+	Reservoir *		reservoir)
+{
+	ParallelReservoirWorker *	workers;
+	bool				hasError = false;
+
+	numberOfThreads = (numberOfThreads > kParallelReservoirMaxThreads) ? kParallelReservoirMaxThreads : numberOfThreads;
+	numberOfThreads = (numberOfThreads == 0) ? 1 : numberOfThreads;
+	workers = calloc(numberOfThreads, sizeof(ParallelReservoirWorker));
+	if (workers == NULL)
+	{
+		fprintf(stderr, "Error: Could not allocate memory for the parallel reservoir.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t i = 0; i < numberOfThreads; i++)
+	{
+		workers[i] = (ParallelReservoirWorker) {
+				.model			= model,
+				.context		= context,
+				.inputLowerBound	= inputLowerBound,
+				.inputUpperBound	= inputUpperBound,
+				.output			= output,
+				.numberOfSamples	= numberOfSamples / numberOfThreads + ((i < numberOfSamples % numberOfThreads) ? 1 : 0),
+				.seed			= seed + i,
+				.reservoir		= {.capacity = reservoir->capacity},
+			};
+	}
+
+#if kParallelReservoirHasThreads
+	{
+		pthread_t	threads[kParallelReservoirMaxThreads];
+		bool		isThreadStarted[kParallelReservoirMaxThreads] = {false};
+
+		/*
+		 *	The calling thread is the first worker, and also runs the share of any thread
+		 *	that could not be started.
+		 */
+		for (size_t i = 1; i < numberOfThreads; i++)
+		{
+			isThreadStarted[i] = (pthread_create(&threads[i], NULL, parallelReservoirWorkerMain, &workers[i]) == 0);
+		}
+
+		for (size_t i = 0; i < numberOfThreads; i++)
+		{
+			if (!isThreadStarted[i])
+			{
+				parallelReservoirWorkerMain(&workers[i]);
+			}
+		}
+
+		for (size_t i = 1; i < numberOfThreads; i++)
+		{
+			if (isThreadStarted[i])
+			{
+				pthread_join(threads[i], NULL);
+			}
+		}
+	}
+#else
+	for (size_t i = 0; i < numberOfThreads; i++)
+	{
+		parallelReservoirWorkerMain(&workers[i]);
+	}
+#endif
+
+	/*
+	 *	Merge in the order of the threads, so that the result only depends on the seed and
+	 *	the number of threads.
+	 */
+	for (size_t i = 0; i < numberOfThreads; i++)
+	{
+		hasError |= workers[i].hasError;
+		if (!hasError)
+		{
+			streamingStatisticsMerge(statistics, &workers[i].statistics);
+			hasError |= (reservoirMerge(reservoir, &workers[i].reservoir) != kCommonConstantReturnTypeSuccess);
+		}
+		reservoirFree(&workers[i].reservoir);
+	}
+	free(workers);
+
+	return hasError ? kCommonConstantReturnTypeError : kCommonConstantReturnTypeSuccess;
+}
@@ -0,0 +1,71 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "common.h"
+#include "streaming-statistics.h"
+#include "utilities-config.h"
+
+typedef enum
+{
+	kParallelReservoirMaxThreads	= 256,
+} ParallelReservoirConstant;
+
+/*
+ *	The model sampled: computes the selected output for the given input values.
+ */
+typedef void	(*ParallelReservoirModel)(void *  context, double *  inputs, double *  outputs);
+
+/**
+ *	@brief	Draws `numberOfSamples` Monte Carlo samples of one output on `numberOfThreads`
+ *		threads, with independent uniform inputs within the given bounds. Each thread
+ *		draws its share of the samples from a generator of its own and keeps its own
+ *		streaming statistics and reservoir, and the results are merged into `statistics`
+ *		and `reservoir` at the end, so that `reservoir` holds a uniform sample of all of
+ *		the samples.
+ *
+ *	@param	model			: The model that computes the output.
+ *	@param	context			: Context passed to `model`.
+ *	@param	inputLowerBound		: Lower bound of each input.
+ *	@param	inputUpperBound		: Upper bound of each input.
+ *	@param	output			: The index of the output in the outputs of `model`.
+ *	@param	numberOfSamples		: The number of samples.
+ *	@param	numberOfThreads		: The number of threads, at most `kParallelReservoirMaxThreads`.
+ *	@param	seed			: Seed of the generators of the inputs.
+ *	@param	statistics		: Pointer to the statistics of the output. Zero-initialize before the call.
+ *	@param	reservoir		: Pointer to an empty reservoir, which receives the samples.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	parallelReservoirRun(
+					ParallelReservoirModel	model,
+					void *			context,
+					const double *		inputLowerBound,
+					const double *		inputUpperBound,
+					size_t			output,
+					uint64_t		numberOfSamples,
+					size_t			numberOfThreads,
+					uint64_t		seed,
+					StreamingStatistics *	statistics,
+					Reservoir *		reservoir);
@@ -0,0 +1,410 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "polynomial-chaos.h"
+
+/*
+ *	Coefficients smaller than this fraction of the standard deviation of their output are
+ *	left out of sampling. For the inputs that an output does not depend on, the quadrature
+ *	gives coefficients at the level of rounding errors.
+ */
+static const double	kPolynomialChaosPruneTolerance = 1e-10;
+
+static uint64_t
+splitMix64(uint64_t *  state)
+{
+	uint64_t	z = (*state += 0x9E3779B97F4A7C15ULL);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+	return z ^ (z >> 31);
+}
+
+static uint64_t
+rotateLeft(uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t
+xoshiro256Plus(uint64_t  state[4])
+{
+	uint64_t	result = state[0] + state[3];
+	uint64_t	t = state[1] << 17;
+
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+	state[2] ^= t;
+	state[3] = rotateLeft(state[3], 45);
+
+	return result;
+}
+
+/**
+ *	@brief	Orthonormal Legendre polynomials `sqrt(2n + 1) P_n(x)` for `n` up to `order`, from
+ *		the three-term recurrence `(n + 1) P_{n+1} = (2n + 1) x P_n - n P_{n-1}`.
+ */
+static void
+evaluateOrthonormalLegendre(double x, size_t order, double *  values)
+{
+	double	previous = 1.0;
+	double	current = x;
+
+	values[0] = 1.0;
+	for (size_t n = 1; n <= order; n++)
+	{
+		double	next = ((2.0 * n + 1.0) * x * current - n * previous) / (n + 1.0);
+
+		values[n] = sqrt(2.0 * n + 1.0) * current;
+		previous = current;
+		current = next;
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Nodes and weights of the Gauss-Legendre rule with `numberOfNodes` nodes, by Newton's
+ *		method on `P_n`. The weights are those of the uniform density on [-1, 1], so they sum to one.
+ */
+static void
+computeGaussLegendreRule(size_t numberOfNodes, double *  nodes, double *  weights)
+{
+	for (size_t i = 0; i < numberOfNodes; i++)
+	{
+		double	x = cos(M_PI * (i + 0.75) / (numberOfNodes + 0.5));
+		double	derivative = 1.0;
+
+		for (int iteration = 0; iteration < 100; iteration++)
+		{
+			double	previous = 1.0;
+			double	current = x;
+			double	step;
+
+			for (size_t n = 1; n < numberOfNodes; n++)
+			{
+				double	next = ((2.0 * n + 1.0) * x * current - n * previous) / (n + 1.0);
+
+				previous = current;
+				current = next;
+			}
+
+			derivative = numberOfNodes * (x * current - previous) / (x * x - 1.0);
+			step = current / derivative;
+			x -= step;
+			if (fabs(step) <= 1e-15)
+			{
+				break;
+			}
+		}
+
+		nodes[i] = x;
+		weights[i] = 1.0 / ((1.0 - x * x) * derivative * derivative);
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+polynomialChaosFit(
+	PolynomialChaosExpansion *	expansion,
+	size_t				order,
+	const double			inputLow[kInputDistributionIndexMax],
+	const double			inputHigh[kInputDistributionIndexMax],
+	size_t				lowerOutput,
+	size_t				upperOutput,
+	PolynomialChaosModel		model,
+	void *				context,
+	uint64_t			seed)
+{
+	size_t	numberOfNodes = order + 1;
+	double	nodes[kPolynomialChaosMaxOrder + 1];
+	double	weights[kPolynomialChaosMaxOrder + 1];
+	double	basisAtNodes[kPolynomialChaosMaxOrder + 1][kPolynomialChaosMaxOrder + 1];
+
+	if ((order < 1) || (order > kPolynomialChaosMaxOrder))
+	{
+		fprintf(stderr, "Error: The order of the polynomial chaos expansion must be from 1 to %d.\n", kPolynomialChaosMaxOrder);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	memset(expansion, 0, sizeof(*expansion));
+	expansion->order = order;
+	expansion->lowerOutput = lowerOutput;
+	expansion->upperOutput = upperOutput;
+
+	/*
+	 *	Total-degree basis, in order of increasing degree.
+	 */
+	for (size_t degree = 0; degree <= order; degree++)
+	{
+		for (size_t a = degree + 1; a-- > 0;)
+		{
+			for (size_t b = degree - a + 1; b-- > 0;)
+			{
+				expansion->multiIndex[expansion->numberOfTerms][0] = (uint8_t)a;
+				expansion->multiIndex[expansion->numberOfTerms][1] = (uint8_t)b;
+				expansion->multiIndex[expansion->numberOfTerms][2] = (uint8_t)(degree - a - b);
+				expansion->numberOfTerms++;
+			}
+		}
+	}
+
+	computeGaussLegendreRule(numberOfNodes, nodes, weights);
+	for (size_t i = 0; i < numberOfNodes; i++)
+	{
+		evaluateOrthonormalLegendre(nodes[i], order, basisAtNodes[i]);
+	}
+
+	/*
+	 *	Projection of each output on each basis term: the coefficient is the expectation of
+	 *	the output times the term, by quadrature on the tensor grid of nodes.
+	 */
+	for (size_t i = 0; i < numberOfNodes; i++)
+	{
+		for (size_t j = 0; j < numberOfNodes; j++)
+		{
+			for (size_t k = 0; k < numberOfNodes; k++)
+			{
+				const size_t	node[kInputDistributionIndexMax] = {i, j, k};
+				double		inputs[kInputDistributionIndexMax];
+				double		outputs[kOutputDistributionIndexMax];
+				double		weight = weights[i] * weights[j] * weights[k];
+
+				for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+				{
+					inputs[d] = 0.5 * (inputLow[d] + inputHigh[d]) + 0.5 * (inputHigh[d] - inputLow[d]) * nodes[node[d]];
+				}
+
+				model(context, inputs, outputs);
+				expansion->numberOfModelEvaluations++;
+
+				for (size_t term = 0; term < expansion->numberOfTerms; term++)
+				{
+					const uint8_t *	degrees = expansion->multiIndex[term];
+					double		basis = basisAtNodes[i][degrees[0]] * basisAtNodes[j][degrees[1]] * basisAtNodes[k][degrees[2]];
+
+					for (size_t output = lowerOutput; output < upperOutput; output++)
+					{
+						expansion->coefficient[output][term] += weight * outputs[output] * basis;
+					}
+				}
+			}
+		}
+	}
+
+	for (size_t output = lowerOutput; output < upperOutput; output++)
+	{
+		double	mean;
+		double	variance;
+
+		polynomialChaosGetMoments(expansion, output, &mean, &variance);
+		for (size_t term = 0; term < expansion->numberOfTerms; term++)
+		{
+			if ((term == 0) || (fabs(expansion->coefficient[output][term]) > kPolynomialChaosPruneTolerance * sqrt(variance)))
+			{
+				expansion->activeTerms[output][expansion->numberOfActiveTerms[output]++] = (uint16_t)term;
+
+				for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+				{
+					if (expansion->multiIndex[term][d] > expansion->maximumActiveDegree[d])
+					{
+						expansion->maximumActiveDegree[d] = expansion->multiIndex[term][d];
+					}
+				}
+			}
+		}
+	}
+
+	/*
+	 *	Three-term recurrence of the orthonormal polynomials,
+	 *	`psi_{n+1} = alpha_n xi psi_n - beta_n psi_{n-1}`, from that of `P_n`.
+	 */
+	for (size_t n = 1; n < order; n++)
+	{
+		expansion->recurrenceAlpha[n] = sqrt((2.0 * n + 3.0) * (2.0 * n + 1.0)) / (n + 1.0);
+		expansion->recurrenceBeta[n] = n * sqrt((2.0 * n + 3.0) / (2.0 * n - 1.0)) / (n + 1.0);
+	}
+
+	for (size_t i = 0; i < 4; i++)
+	{
+		expansion->state[i] = splitMix64(&seed);
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+polynomialChaosGetMoments(const PolynomialChaosExpansion *  expansion, size_t output, double *  mean, double *  variance)
+{
+	double	sumOfSquares = 0.0;
+
+	for (size_t term = 1; term < expansion->numberOfTerms; term++)
+	{
+		sumOfSquares += expansion->coefficient[output][term] * expansion->coefficient[output][term];
+	}
+
+	*mean = expansion->coefficient[output][0];
+	*variance = sumOfSquares;
+
+	return;
+}
+
+void
+polynomialChaosGetSobolIndices(
+	const PolynomialChaosExpansion *	expansion,
+	size_t					output,
+	double					firstOrder[kInputDistributionIndexMax],
+	double					total[kInputDistributionIndexMax])
+{
+	double	mean;
+	double	variance;
+
+	polynomialChaosGetMoments(expansion, output, &mean, &variance);
+
+	for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+	{
+		firstOrder[d] = 0.0;
+		total[d] = 0.0;
+	}
+
+	for (size_t term = 1; term < expansion->numberOfTerms; term++)
+	{
+		const uint8_t *	degrees = expansion->multiIndex[term];
+		double		squaredCoefficient = expansion->coefficient[output][term] * expansion->coefficient[output][term];
+		size_t		numberOfInputsInvolved = 0;
+
+		for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+		{
+			numberOfInputsInvolved += (degrees[d] > 0);
+		}
+
+		for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+		{
+			if (degrees[d] > 0)
+			{
+				total[d] += squaredCoefficient;
+				firstOrder[d] += (numberOfInputsInvolved == 1) ? squaredCoefficient : 0.0;
+			}
+		}
+	}
+
+	for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+	{
+		firstOrder[d] = (variance > 0.0) ? firstOrder[d] / variance : 0.0;
+		total[d] = (variance > 0.0) ? total[d] / variance : 0.0;
+	}
+
+	return;
+}
+
+void
+polynomialChaosSampleBlock(
+	PolynomialChaosExpansion *	expansion,
+	size_t				numberOfSamples,
+	double				outputs[kOutputDistributionIndexMax][kPolynomialChaosSamplesPerBlock])
+{
+	double	basis[kInputDistributionIndexMax][kPolynomialChaosMaxOrder + 1][kPolynomialChaosSamplesPerBlock];
+	double	xi[kPolynomialChaosSamplesPerBlock];
+	uint64_t	state[4];
+
+	/*
+	 *	A local copy of the generator state stays in registers.
+	 */
+	memcpy(state, expansion->state, sizeof(state));
+
+	/*
+	 *	Basis values of each input, up to the highest degree that an active term uses, laid
+	 *	out so that the loops over samples vectorize.
+	 */
+	for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+	{
+		for (size_t k = 0; k < numberOfSamples; k++)
+		{
+			basis[d][0][k] = 1.0;
+		}
+
+		/*
+		 *	Inputs that no active term depends on are not sampled.
+		 */
+		if (expansion->maximumActiveDegree[d] == 0)
+		{
+			continue;
+		}
+
+		for (size_t k = 0; k < numberOfSamples; k++)
+		{
+			xi[k] = (double)(xoshiro256Plus(state) >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+			basis[d][1][k] = sqrt(3.0) * xi[k];
+		}
+
+		for (size_t n = 1; n < expansion->maximumActiveDegree[d]; n++)
+		{
+			double *	next = basis[d][n + 1];
+			const double *	current = basis[d][n];
+			const double *	previous = basis[d][n - 1];
+			double		alpha = expansion->recurrenceAlpha[n];
+			double		beta = expansion->recurrenceBeta[n];
+
+			for (size_t k = 0; k < numberOfSamples; k++)
+			{
+				next[k] = alpha * xi[k] * current[k] - beta * previous[k];
+			}
+		}
+	}
+
+	for (size_t output = expansion->lowerOutput; output < expansion->upperOutput; output++)
+	{
+		double *	values = outputs[output];
+
+		for (size_t k = 0; k < numberOfSamples; k++)
+		{
+			values[k] = 0.0;
+		}
+
+		for (size_t t = 0; t < expansion->numberOfActiveTerms[output]; t++)
+		{
+			size_t		term = expansion->activeTerms[output][t];
+			const uint8_t *	degrees = expansion->multiIndex[term];
+			double		coefficient = expansion->coefficient[output][term];
+			const double *	basis0 = basis[0][degrees[0]];
+			const double *	basis1 = basis[1][degrees[1]];
+			const double *	basis2 = basis[2][degrees[2]];
+
+			for (size_t k = 0; k < numberOfSamples; k++)
+			{
+				values[k] += coefficient * basis0[k] * basis1[k] * basis2[k];
+			}
+		}
+	}
+
+	memcpy(expansion->state, state, sizeof(state));
+
+	return;
+}
@@ -0,0 +1,139 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "common.h"
+#include "utilities-config.h"
+
+typedef enum
+{
+	kPolynomialChaosMaxOrder		= 12,
+
+	/*
+	 *	Terms of the total-degree basis of the maximum order in three inputs: (12 + 3)! / (12! 3!).
+	 */
+	kPolynomialChaosMaxTerms		= 455,
+
+	/*
+	 *	Samples evaluated together. The basis values of a block, 3 * 13 * 128 doubles,
+	 *	take 39 KiB.
+	 */
+	kPolynomialChaosSamplesPerBlock		= 128,
+} PolynomialChaosConstant;
+
+/*
+ *	The model expanded: computes the outputs from `lowerOutput` up to, but not including,
+ *	`upperOutput` for the given input values.
+ */
+typedef void	(*PolynomialChaosModel)(void *  context, double *  inputs, double *  outputs);
+
+/*
+ *	Legendre polynomial chaos expansion of the outputs in the uniform inputs. Each input is
+ *	mapped to `xi` in [-1, 1], and each output is the sum of `coefficient[output][term]` times
+ *	the product of the orthonormal Legendre polynomials `sqrt(2n + 1) P_n(xi)` of the degrees
+ *	in `multiIndex[term]`. Terms with negligible coefficients are left out of sampling.
+ */
+typedef struct
+{
+	size_t		order;
+	size_t		numberOfTerms;
+	size_t		numberOfModelEvaluations;
+	size_t		lowerOutput;
+	size_t		upperOutput;
+	uint8_t		multiIndex[kPolynomialChaosMaxTerms][kInputDistributionIndexMax];
+	double		coefficient[kOutputDistributionIndexMax][kPolynomialChaosMaxTerms];
+	size_t		numberOfActiveTerms[kOutputDistributionIndexMax];
+	uint16_t	activeTerms[kOutputDistributionIndexMax][kPolynomialChaosMaxTerms];
+	size_t		maximumActiveDegree[kInputDistributionIndexMax];
+	double		recurrenceAlpha[kPolynomialChaosMaxOrder];
+	double		recurrenceBeta[kPolynomialChaosMaxOrder];
+	uint64_t	state[4];
+} PolynomialChaosExpansion;
+
+/**
+ *	@brief	Fits the expansion of the given total order by tensor Gauss-Legendre quadrature
+ *		with `order + 1` nodes per input, i.e., `(order + 1)^3` model evaluations.
+ *
+ *	@param	expansion	: Pointer to the expansion to fit.
+ *	@param	order		: The total order of the expansion, from 1 to `kPolynomialChaosMaxOrder`.
+ *	@param	inputLow	: The lower bounds of the uniform inputs.
+ *	@param	inputHigh	: The upper bounds of the uniform inputs.
+ *	@param	lowerOutput	: The first output to expand.
+ *	@param	upperOutput	: One past the last output to expand.
+ *	@param	model		: The model to expand.
+ *	@param	context		: Context passed to `model`.
+ *	@param	seed		: Seed of the random number generator for sampling.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	polynomialChaosFit(
+					PolynomialChaosExpansion *	expansion,
+					size_t				order,
+					const double			inputLow[kInputDistributionIndexMax],
+					const double			inputHigh[kInputDistributionIndexMax],
+					size_t				lowerOutput,
+					size_t				upperOutput,
+					PolynomialChaosModel		model,
+					void *				context,
+					uint64_t			seed);
+
+/**
+ *	@brief	Gets the mean and variance of one output from the coefficients: the mean is the
+ *		constant coefficient, and the variance is the sum of the squares of the others.
+ *
+ *	@param	expansion	: Pointer to the fitted expansion.
+ *	@param	output		: The output.
+ *	@param	mean		: Pointer where the mean is returned.
+ *	@param	variance	: Pointer where the variance is returned.
+ */
+void	polynomialChaosGetMoments(const PolynomialChaosExpansion *  expansion, size_t output, double *  mean, double *  variance);
+
+/**
+ *	@brief	Gets the Sobol sensitivity indices of one output to each input from the coefficients:
+ *		the first-order index sums the squared coefficients of the terms in that input
+ *		alone, and the total index those of all terms that involve it, over the variance.
+ *
+ *	@param	expansion	: Pointer to the fitted expansion.
+ *	@param	output		: The output.
+ *	@param	firstOrder	: Array where the first-order indices are returned.
+ *	@param	total		: Array where the total indices are returned.
+ */
+void	polynomialChaosGetSobolIndices(
+		const PolynomialChaosExpansion *	expansion,
+		size_t					output,
+		double					firstOrder[kInputDistributionIndexMax],
+		double					total[kInputDistributionIndexMax]);
+
+/**
+ *	@brief	Draws a block of samples of the expanded outputs: samples the inputs uniformly and
+ *		evaluates the active terms of the expansion, without calling the model.
+ *
+ *	@param	expansion		: Pointer to the fitted expansion.
+ *	@param	numberOfSamples		: The number of samples, at most `kPolynomialChaosSamplesPerBlock`.
+ *	@param	outputs			: The samples of each expanded output.
+ */
+void	polynomialChaosSampleBlock(
+		PolynomialChaosExpansion *	expansion,
+		size_t				numberOfSamples,
+		double				outputs[kOutputDistributionIndexMax][kPolynomialChaosSamplesPerBlock]);
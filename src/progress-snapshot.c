@@ -0,0 +1,406 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(_POSIX_MAPPED_FILES) && (_POSIX_MAPPED_FILES > 0)
+#include <sys/mman.h>
+#define kProgressSnapshotHasMemoryMapping	1
+#else
+#define kProgressSnapshotHasMemoryMapping	0
+#endif
+#include "progress-snapshot.h"
+
+static const char	kProgressSnapshotFileMagic[8] = {'S', 'G', 'P', 'R', 'O', 'G', 'R', '1'};
+static const uint32_t	kProgressSnapshotByteOrderMark = 0x01020304;
+
+const double		kProgressSnapshotQuantileProbabilities[kProgressSnapshotNumberOfQuantiles] = {0.05, 0.5, 0.95};
+const char * const	kProgressSnapshotQuantileKeys[kProgressSnapshotNumberOfQuantiles] = {"p05", "p50", "p95"};
+
+static const uint64_t	kProgressSnapshotReservoirSeed = 0x960F5ULL;
+
+/*
+ *	The file is this structure, in host byte order. `sequence` is odd while the snapshot
+ *	is being written.
+ */
+struct ProgressSnapshotFile
+{
+	char			magic[8];
+	uint32_t		version;
+	uint32_t		byteOrderMark;
+	_Atomic uint64_t	sequence;
+	ProgressSnapshot	snapshot;
+};
+
+static double
+getMonotonicTimeSeconds(void)
+{
+#if defined(CLOCK_MONOTONIC)
+	struct timespec	now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (double)now.tv_sec + 1e-9 * (double)now.tv_nsec;
+#else
+	return ((double)clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+/*
+ *	Without memory mapping, the sequence and the snapshot are written to the file in the
+ *	same order. A failed write is reported when the publisher is closed.
+ */
+static void
+writeSequence(ProgressPublisher *  publisher, uint64_t sequence)
+{
+	if (publisher->isMemoryMapped)
+	{
+		atomic_store_explicit(&publisher->mapping->sequence, sequence, memory_order_release);
+
+		return;
+	}
+
+	publisher->hasError |= (pwrite(publisher->fileDescriptor, &sequence, sizeof(sequence), offsetof(ProgressSnapshotFile, sequence)) != sizeof(sequence));
+
+	return;
+}
+
+static int
+compareDoubles(const void *  a, const void *  b)
+{
+	double	x = *(const double *)a;
+	double	y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+static void
+buildSnapshot(ProgressPublisher *  publisher, bool isFinal, ProgressSnapshot *  snapshot)
+{
+	*snapshot = (ProgressSnapshot) {0};
+	snapshot->numberOfSamples = publisher->statistics[publisher->lowerOutput].count;
+	snapshot->numberOfSamplesRequested = publisher->numberOfSamplesRequested;
+	snapshot->elapsedSeconds = getMonotonicTimeSeconds() - publisher->startSeconds;
+	snapshot->lowerOutput = (uint32_t)publisher->lowerOutput;
+	snapshot->upperOutput = (uint32_t)publisher->upperOutput;
+	snapshot->isFinal = isFinal;
+
+	for (size_t output = publisher->lowerOutput; output < publisher->upperOutput; output++)
+	{
+		MeanAndVariance	meanAndVariance = streamingStatisticsGetMeanAndVariance(&publisher->statistics[output]);
+
+		snapshot->mean[output] = meanAndVariance.mean;
+		snapshot->variance[output] = meanAndVariance.variance;
+		snapshot->standardError[output] = (snapshot->numberOfSamples > 0)
+							? sqrt(meanAndVariance.variance / (double)snapshot->numberOfSamples)
+							: NAN;
+
+		/*
+		 *	Quantiles interpolate linearly between the order statistics of the reservoir.
+		 */
+		size_t	count = publisher->reservoirs[output].count;
+
+		memcpy(publisher->sortedSamples, publisher->reservoirs[output].samples, count * sizeof(double));
+		qsort(publisher->sortedSamples, count, sizeof(double), compareDoubles);
+		for (size_t q = 0; q < kProgressSnapshotNumberOfQuantiles; q++)
+		{
+			double	position = kProgressSnapshotQuantileProbabilities[q] * (double)(count - 1);
+			size_t	lower = (size_t)position;
+			size_t	upper = (lower + 1 < count) ? lower + 1 : lower;
+
+			snapshot->quantile[output][q] = (count > 0)
+							? publisher->sortedSamples[lower] + (position - (double)lower) * (publisher->sortedSamples[upper] - publisher->sortedSamples[lower])
+							: NAN;
+		}
+	}
+
+	return;
+}
+
+/*
+ *	Frees the reservoirs and the sort buffer, and marks the buffer as missing.
+ */
+static void
+freeReservoirs(ProgressPublisher *  publisher)
+{
+	for (size_t output = 0; output < kOutputDistributionIndexMax; output++)
+	{
+		reservoirFree(&publisher->reservoirs[output]);
+	}
+	free(publisher->sortedSamples);
+	publisher->sortedSamples = NULL;
+
+	return;
+}
+
+CommonConstantReturnType
+progressPublisherOpen(
+	ProgressPublisher *	publisher,
+	const char *		filePath,
+	size_t			lowerOutput,
+	size_t			upperOutput,
+	uint64_t		numberOfSamplesRequested,
+	double			intervalSeconds)
+{
+	ProgressSnapshotFile	header = {0};
+
+	*publisher = (ProgressPublisher) {0};
+	publisher->fileDescriptor = open(filePath, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if ((publisher->fileDescriptor < 0) || (ftruncate(publisher->fileDescriptor, sizeof(ProgressSnapshotFile)) != 0))
+	{
+		fprintf(stderr, "Error: Could not create the progress file \"%s\": %s.\n", filePath, strerror(errno));
+		if (publisher->fileDescriptor >= 0)
+		{
+			close(publisher->fileDescriptor);
+		}
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	Write the header before the snapshot area is shared, so that readers never see a
+	 *	valid magic with an uninitialized sequence.
+	 */
+	memcpy(header.magic, kProgressSnapshotFileMagic, sizeof(header.magic));
+	header.version = kProgressSnapshotFileVersion;
+	header.byteOrderMark = kProgressSnapshotByteOrderMark;
+	atomic_init(&header.sequence, 1);
+	if (pwrite(publisher->fileDescriptor, &header, offsetof(ProgressSnapshotFile, snapshot), 0) != (ssize_t)offsetof(ProgressSnapshotFile, snapshot))
+	{
+		fprintf(stderr, "Error: Could not write the progress file \"%s\".\n", filePath);
+		close(publisher->fileDescriptor);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+#if kProgressSnapshotHasMemoryMapping
+	publisher->mapping = mmap(NULL, sizeof(ProgressSnapshotFile), PROT_READ | PROT_WRITE, MAP_SHARED, publisher->fileDescriptor, 0);
+	if (publisher->mapping == MAP_FAILED)
+	{
+		publisher->mapping = NULL;
+	}
+	publisher->isMemoryMapped = (publisher->mapping != NULL);
+#endif
+
+	publisher->lowerOutput = lowerOutput;
+	publisher->upperOutput = upperOutput;
+	publisher->numberOfSamplesRequested = numberOfSamplesRequested;
+	publisher->numberOfSamplesUntilClockCheck = kProgressSnapshotSamplesPerClockCheck;
+	publisher->intervalSeconds = intervalSeconds;
+	publisher->startSeconds = getMonotonicTimeSeconds();
+	publisher->lastPublicationSeconds = publisher->startSeconds;
+	publisher->sortedSamples = malloc(kProgressSnapshotReservoirCapacity * sizeof(double));
+	for (size_t output = lowerOutput; (output < upperOutput) && (publisher->sortedSamples != NULL); output++)
+	{
+		if (reservoirInit(&publisher->reservoirs[output], kProgressSnapshotReservoirCapacity, kProgressSnapshotReservoirSeed + output))
+		{
+			freeReservoirs(publisher);
+		}
+	}
+	if (publisher->sortedSamples == NULL)
+	{
+		fprintf(stderr, "Error: Could not allocate memory for the progress snapshots.\n");
+#if kProgressSnapshotHasMemoryMapping
+		if (publisher->isMemoryMapped)
+		{
+			munmap(publisher->mapping, sizeof(ProgressSnapshotFile));
+		}
+#endif
+		close(publisher->fileDescriptor);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	The sequence in the file starts odd, so readers wait for this first publication.
+	 */
+	progressPublisherPublish(publisher, false);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+progressPublisherAdd(ProgressPublisher *  publisher, const double *  outputs)
+{
+	for (size_t output = publisher->lowerOutput; output < publisher->upperOutput; output++)
+	{
+		streamingStatisticsAdd(&publisher->statistics[output], outputs[output]);
+		reservoirAdd(&publisher->reservoirs[output], outputs[output]);
+	}
+
+	if (--publisher->numberOfSamplesUntilClockCheck == 0)
+	{
+		publisher->numberOfSamplesUntilClockCheck = kProgressSnapshotSamplesPerClockCheck;
+		if (getMonotonicTimeSeconds() - publisher->lastPublicationSeconds >= publisher->intervalSeconds)
+		{
+			progressPublisherPublish(publisher, false);
+		}
+	}
+
+	return;
+}
+
+void
+progressPublisherPublish(ProgressPublisher *  publisher, bool isFinal)
+{
+	ProgressSnapshot	snapshot;
+
+	buildSnapshot(publisher, isFinal, &snapshot);
+
+	writeSequence(publisher, publisher->sequence + 1);
+	atomic_thread_fence(memory_order_release);
+	if (publisher->isMemoryMapped)
+	{
+		publisher->mapping->snapshot = snapshot;
+	}
+	else
+	{
+		publisher->hasError |= (pwrite(publisher->fileDescriptor, &snapshot, sizeof(snapshot), offsetof(ProgressSnapshotFile, snapshot)) != sizeof(snapshot));
+	}
+	publisher->sequence += 2;
+	writeSequence(publisher, publisher->sequence);
+
+	publisher->lastPublicationSeconds = getMonotonicTimeSeconds();
+
+	return;
+}
+
+CommonConstantReturnType
+progressPublisherClose(ProgressPublisher *  publisher)
+{
+	bool	hasError;
+
+	progressPublisherPublish(publisher, true);
+	hasError = publisher->hasError;
+
+#if kProgressSnapshotHasMemoryMapping
+	if (publisher->isMemoryMapped)
+	{
+		hasError |= (msync(publisher->mapping, sizeof(ProgressSnapshotFile), MS_ASYNC) != 0);
+		munmap(publisher->mapping, sizeof(ProgressSnapshotFile));
+	}
+#endif
+	hasError |= (close(publisher->fileDescriptor) != 0);
+	freeReservoirs(publisher);
+	*publisher = (ProgressPublisher) {0};
+
+	if (hasError)
+	{
+		fprintf(stderr, "Error: Could not write the progress file.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Copies the snapshot between two reads of the sequence. Returns `false` if the publisher
+ *	was writing it.
+ */
+static bool
+tryCopySnapshot(const ProgressSnapshotFile *  mapping, int fileDescriptor, ProgressSnapshot *  snapshot)
+{
+	uint64_t	sequenceBefore;
+	uint64_t	sequenceAfter;
+
+	if (mapping != NULL)
+	{
+		sequenceBefore = atomic_load_explicit(&((ProgressSnapshotFile *)mapping)->sequence, memory_order_acquire);
+		*snapshot = mapping->snapshot;
+		atomic_thread_fence(memory_order_acquire);
+		sequenceAfter = atomic_load_explicit(&((ProgressSnapshotFile *)mapping)->sequence, memory_order_relaxed);
+	}
+	else if ((pread(fileDescriptor, &sequenceBefore, sizeof(uint64_t), offsetof(ProgressSnapshotFile, sequence)) != sizeof(uint64_t))
+		|| (pread(fileDescriptor, snapshot, sizeof(ProgressSnapshot), offsetof(ProgressSnapshotFile, snapshot)) != sizeof(ProgressSnapshot))
+		|| (pread(fileDescriptor, &sequenceAfter, sizeof(uint64_t), offsetof(ProgressSnapshotFile, sequence)) != sizeof(uint64_t)))
+	{
+		return false;
+	}
+
+	return ((sequenceBefore & 1) == 0) && (sequenceBefore == sequenceAfter);
+}
+
+CommonConstantReturnType
+progressSnapshotRead(const char *  filePath, ProgressSnapshot *  snapshot)
+{
+	ProgressSnapshotFile	header;
+	ProgressSnapshotFile *	mapping = NULL;
+	bool			isCopied = false;
+	int			fileDescriptor = open(filePath, O_RDONLY);
+
+	if (fileDescriptor < 0)
+	{
+		fprintf(stderr, "Error: Could not open the progress file \"%s\": %s.\n", filePath, strerror(errno));
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((pread(fileDescriptor, &header, offsetof(ProgressSnapshotFile, sequence), 0) != (ssize_t)offsetof(ProgressSnapshotFile, sequence))
+		|| (memcmp(header.magic, kProgressSnapshotFileMagic, sizeof(header.magic)) != 0)
+		|| (header.version != kProgressSnapshotFileVersion)
+		|| (header.byteOrderMark != kProgressSnapshotByteOrderMark))
+	{
+		fprintf(stderr, "Error: \"%s\" is not a progress file of this version and byte order.\n", filePath);
+		close(fileDescriptor);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+#if kProgressSnapshotHasMemoryMapping
+	mapping = mmap(NULL, sizeof(ProgressSnapshotFile), PROT_READ, MAP_SHARED, fileDescriptor, 0);
+	if (mapping == MAP_FAILED)
+	{
+		mapping = NULL;
+	}
+#endif
+
+	for (size_t attempt = 0; (attempt < kProgressSnapshotMaxReadAttempts) && !isCopied; attempt++)
+	{
+		isCopied = tryCopySnapshot(mapping, fileDescriptor, snapshot);
+	}
+
+#if kProgressSnapshotHasMemoryMapping
+	if (mapping != NULL)
+	{
+		munmap(mapping, sizeof(ProgressSnapshotFile));
+	}
+#endif
+	close(fileDescriptor);
+
+	if (!isCopied)
+	{
+		fprintf(stderr, "Error: Could not read a consistent snapshot from the progress file \"%s\".\n", filePath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
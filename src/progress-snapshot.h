@@ -0,0 +1,161 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "common.h"
+#include "streaming-statistics.h"
+#include "utilities-config.h"
+
+typedef enum
+{
+	kProgressSnapshotNumberOfQuantiles	= 3,
+	kProgressSnapshotFileVersion		= 1,
+
+	/*
+	 *	Samples per output kept to estimate the quantiles of a snapshot. For a Gaussian
+	 *	output, the standard error of the 5% and 95% quantiles of a uniform random subset
+	 *	of this size is about 0.01 standard deviations.
+	 */
+	kProgressSnapshotReservoirCapacity	= 65536,
+
+	/*
+	 *	Samples between two reads of the clock, so that checking the publication interval
+	 *	costs less than a nanosecond per sample.
+	 */
+	kProgressSnapshotSamplesPerClockCheck	= 1024,
+
+	/*
+	 *	Attempts of a reader to copy a snapshot that the publisher is not writing.
+	 */
+	kProgressSnapshotMaxReadAttempts	= 10000,
+} ProgressSnapshotConstant;
+
+extern const double		kProgressSnapshotQuantileProbabilities[kProgressSnapshotNumberOfQuantiles];
+extern const char * const	kProgressSnapshotQuantileKeys[kProgressSnapshotNumberOfQuantiles];
+
+/*
+ *	Summary of the outputs of a Monte Carlo run so far. Only the outputs in
+ *	[`lowerOutput`, `upperOutput`) are set. The quantiles are those of a uniform random
+ *	subset of the samples.
+ */
+typedef struct
+{
+	uint64_t	numberOfSamples;
+	uint64_t	numberOfSamplesRequested;
+	double		elapsedSeconds;
+	uint32_t	lowerOutput;
+	uint32_t	upperOutput;
+	uint32_t	isFinal;
+	uint32_t	reserved;
+	double		mean[kOutputDistributionIndexMax];
+	double		variance[kOutputDistributionIndexMax];
+	double		standardError[kOutputDistributionIndexMax];
+	double		quantile[kOutputDistributionIndexMax][kProgressSnapshotNumberOfQuantiles];
+} ProgressSnapshot;
+
+/*
+ *	Layout of a progress file, private to the progress snapshot module.
+ */
+typedef struct ProgressSnapshotFile	ProgressSnapshotFile;
+
+/*
+ *	Accumulates the outputs of a run and publishes snapshots of their summary to a file,
+ *	memory-mapped where possible, at a fixed wall-clock interval.
+ */
+typedef struct
+{
+	int			fileDescriptor;
+	ProgressSnapshotFile *	mapping;
+	bool			isMemoryMapped;
+	bool			hasError;
+	size_t			lowerOutput;
+	size_t			upperOutput;
+	uint64_t		numberOfSamplesRequested;
+	uint64_t		numberOfSamplesUntilClockCheck;
+	uint64_t		sequence;
+	double			intervalSeconds;
+	double			startSeconds;
+	double			lastPublicationSeconds;
+	StreamingStatistics	statistics[kOutputDistributionIndexMax];
+	Reservoir		reservoirs[kOutputDistributionIndexMax];
+	double *		sortedSamples;
+} ProgressPublisher;
+
+/**
+ *	@brief	Creates the progress file and publishes an empty snapshot.
+ *
+ *	@param	publisher			: Pointer to the publisher.
+ *	@param	filePath			: Path of the progress file.
+ *	@param	lowerOutput			: The first output tracked.
+ *	@param	upperOutput			: One past the last output tracked.
+ *	@param	numberOfSamplesRequested	: The number of samples of the run.
+ *	@param	intervalSeconds			: The wall-clock time between two publications.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	progressPublisherOpen(
+					ProgressPublisher *	publisher,
+					const char *		filePath,
+					size_t			lowerOutput,
+					size_t			upperOutput,
+					uint64_t		numberOfSamplesRequested,
+					double			intervalSeconds);
+
+/**
+ *	@brief	Adds the outputs of one sample, and publishes a snapshot if the interval has passed.
+ *
+ *	@param	publisher	: Pointer to the publisher.
+ *	@param	outputs		: Array of all outputs, of which the tracked ones are read.
+ */
+void	progressPublisherAdd(ProgressPublisher *  publisher, const double *  outputs);
+
+/**
+ *	@brief	Publishes a snapshot of the samples added so far. Monitors that read the file
+ *		concurrently never see a partially-written snapshot: the snapshot is guarded by a
+ *		sequence counter (a seqlock), which is odd while it is written, and readers retry
+ *		until they copy it between two equal, even values. The publisher never waits for
+ *		readers.
+ *
+ *	@param	publisher	: Pointer to the publisher.
+ *	@param	isFinal		: Whether the run has ended.
+ */
+void	progressPublisherPublish(ProgressPublisher *  publisher, bool isFinal);
+
+/**
+ *	@brief	Publishes the final snapshot and closes the progress file, which remains for monitors.
+ *
+ *	@param	publisher	: Pointer to the publisher.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	progressPublisherClose(ProgressPublisher *  publisher);
+
+/**
+ *	@brief	Reads the latest snapshot from a progress file, without blocking its publisher.
+ *
+ *	@param	filePath	: Path of the progress file.
+ *	@param	snapshot	: Pointer where the snapshot is returned.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	progressSnapshotRead(const char *  filePath, ProgressSnapshot *  snapshot);
@@ -0,0 +1,368 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(_POSIX_MAPPED_FILES) && (_POSIX_MAPPED_FILES > 0)
+#include <sys/mman.h>
+#define kRandomPoolHasMemoryMapping	1
+#else
+#define kRandomPoolHasMemoryMapping	0
+#endif
+#include "random-pool.h"
+
+static const char	kRandomPoolFileMagic[8] = {'S', 'G', 'R', 'P', 'O', 'O', 'L', '1'};
+static const uint32_t	kRandomPoolByteOrderMark = 0x01020304;
+
+static uint64_t
+splitMix64(uint64_t *  state)
+{
+	uint64_t	z = (*state += 0x9E3779B97F4A7C15ULL);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+	return z ^ (z >> 31);
+}
+
+static uint64_t
+rotateLeft(uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t
+xoshiro256StarStar(uint64_t  state[4])
+{
+	uint64_t	result = rotateLeft(state[1] * 5, 7) * 9;
+	uint64_t	t = state[1] << 17;
+
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+	state[2] ^= t;
+	state[3] = rotateLeft(state[3], 45);
+
+	return result;
+}
+
+/*
+ *	Checksum of a run of 64-bit words. It is not cryptographic: it detects truncated,
+ *	overwritten or corrupted pools.
+ */
+static uint64_t
+checksumWords(const void *  data, size_t numberOfWords, uint64_t seed)
+{
+	const unsigned char *	bytes = data;
+	uint64_t		hash = seed ^ (numberOfWords * 0x9E3779B97F4A7C15ULL);
+
+	for (size_t i = 0; i < numberOfWords; i++)
+	{
+		uint64_t	word;
+
+		memcpy(&word, bytes + i * sizeof(word), sizeof(word));
+		hash = rotateLeft((hash ^ word) * 0xFF51AFD7ED558CCDULL, 29);
+	}
+
+	return hash ^ (hash >> 32);
+}
+
+static uint64_t
+checksumHeader(const RandomPoolFileHeader *  header)
+{
+	RandomPoolFileHeader	copy = *header;
+
+	copy.headerChecksum = 0;
+
+	return checksumWords(&copy, sizeof(copy) / sizeof(uint64_t), 0);
+}
+
+CommonConstantReturnType
+randomPoolGenerate(const char *  filePath, uint64_t numberOfValues, uint64_t generatorSeed)
+{
+	uint64_t		numberOfBlocks = (numberOfValues + kRandomPoolValuesPerBlock - 1) / kRandomPoolValuesPerBlock;
+	uint64_t		checksumTableEnd = sizeof(RandomPoolFileHeader) + numberOfBlocks * sizeof(uint64_t);
+	RandomPoolFileHeader	header = {
+					.version	= kRandomPoolFileVersion,
+					.byteOrderMark	= kRandomPoolByteOrderMark,
+					.numberOfValues	= numberOfValues,
+					.valuesPerBlock	= kRandomPoolValuesPerBlock,
+					.generatorSeed	= generatorSeed,
+					.valuesOffset	= (checksumTableEnd + kRandomPoolPageSize - 1) / kRandomPoolPageSize * kRandomPoolPageSize,
+				};
+	uint64_t *		blockChecksums = calloc(numberOfBlocks > 0 ? numberOfBlocks : 1, sizeof(uint64_t));
+	double *		block = malloc(kRandomPoolValuesPerBlock * sizeof(double));
+	char			temporaryFilePath[kCommonConstantMaxCharsPerFilepath];
+	uint64_t		state[4];
+	uint64_t		seed = generatorSeed;
+	FILE *			file;
+	bool			hasError = false;
+
+	if ((blockChecksums == NULL) || (block == NULL))
+	{
+		fprintf(stderr, "Error: Could not allocate memory for the random pool.\n");
+		free(blockChecksums);
+		free(block);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (snprintf(temporaryFilePath, sizeof(temporaryFilePath), "%s.tmp", filePath) >= (int)sizeof(temporaryFilePath))
+	{
+		fprintf(stderr, "Error: The random pool file path is too long.\n");
+		free(blockChecksums);
+		free(block);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	file = fopen(temporaryFilePath, "wb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open the random pool file \"%s\" for writing.\n", temporaryFilePath);
+		free(blockChecksums);
+		free(block);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t i = 0; i < 4; i++)
+	{
+		state[i] = splitMix64(&seed);
+	}
+
+	/*
+	 *	Write the values first, then go back for the header and checksum table.
+	 */
+	hasError |= (fseek(file, (long)header.valuesOffset, SEEK_SET) != 0);
+	for (uint64_t blockIndex = 0; (blockIndex < numberOfBlocks) && !hasError; blockIndex++)
+	{
+		size_t	count = (size_t)((numberOfValues - blockIndex * kRandomPoolValuesPerBlock < kRandomPoolValuesPerBlock)
+					? numberOfValues - blockIndex * kRandomPoolValuesPerBlock
+					: kRandomPoolValuesPerBlock);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			block[i] = (double)(xoshiro256StarStar(state) >> 11) * (1.0 / 9007199254740992.0);
+		}
+
+		blockChecksums[blockIndex] = checksumWords(block, count, blockIndex);
+		hasError |= (fwrite(block, sizeof(double), count, file) != count);
+	}
+
+	memcpy(header.magic, kRandomPoolFileMagic, sizeof(header.magic));
+	header.headerChecksum = checksumHeader(&header);
+	hasError |= (fseek(file, 0, SEEK_SET) != 0);
+	hasError |= (fwrite(&header, sizeof(header), 1, file) != 1);
+	hasError |= (fwrite(blockChecksums, sizeof(uint64_t), (size_t)numberOfBlocks, file) != numberOfBlocks);
+	hasError |= (fclose(file) != 0);
+
+	free(blockChecksums);
+	free(block);
+
+	if (hasError || (rename(temporaryFilePath, filePath) != 0))
+	{
+		fprintf(stderr, "Error: Could not write the random pool file \"%s\".\n", filePath);
+		remove(temporaryFilePath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+randomPoolOpen(RandomPool *  pool, const char *  filePath)
+{
+	const RandomPoolFileHeader *	header;
+	struct stat			fileStatus;
+	int				fileDescriptor = open(filePath, O_RDONLY);
+
+	*pool = (RandomPool) {0};
+
+	if ((fileDescriptor < 0) || (fstat(fileDescriptor, &fileStatus) != 0))
+	{
+		fprintf(stderr, "Error: Could not open the random pool file \"%s\": %s.\n", filePath, strerror(errno));
+		if (fileDescriptor >= 0)
+		{
+			close(fileDescriptor);
+		}
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	pool->mappingSize = (size_t)fileStatus.st_size;
+	if (pool->mappingSize < sizeof(RandomPoolFileHeader))
+	{
+		fprintf(stderr, "Error: The random pool file \"%s\" is truncated.\n", filePath);
+		close(fileDescriptor);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+#if kRandomPoolHasMemoryMapping
+	pool->mapping = mmap(NULL, pool->mappingSize, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+	if (pool->mapping == MAP_FAILED)
+	{
+		pool->mapping = NULL;
+	}
+	pool->isMemoryMapped = (pool->mapping != NULL);
+#endif
+	if (pool->mapping == NULL)
+	{
+		/*
+		 *	Without memory mapping, read the file into private memory.
+		 */
+		pool->mapping = malloc(pool->mappingSize);
+		if ((pool->mapping == NULL) || (pread(fileDescriptor, pool->mapping, pool->mappingSize, 0) != (ssize_t)pool->mappingSize))
+		{
+			fprintf(stderr, "Error: Could not read the random pool file \"%s\".\n", filePath);
+			free(pool->mapping);
+			close(fileDescriptor);
+			*pool = (RandomPool) {0};
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+	close(fileDescriptor);
+
+	header = pool->mapping;
+	if ((memcmp(header->magic, kRandomPoolFileMagic, sizeof(header->magic)) != 0)
+		|| (header->version != kRandomPoolFileVersion)
+		|| (header->byteOrderMark != kRandomPoolByteOrderMark)
+		|| (header->headerChecksum != checksumHeader(header))
+		|| (header->valuesPerBlock != kRandomPoolValuesPerBlock)
+		|| (header->valuesOffset % kRandomPoolPageSize != 0)
+		|| (header->valuesOffset > pool->mappingSize)
+		|| (header->numberOfValues > (pool->mappingSize - header->valuesOffset) / sizeof(double)))
+	{
+		fprintf(stderr, "Error: \"%s\" is not a valid random pool file, or it is truncated or from a host with another byte order.\n", filePath);
+		randomPoolClose(pool);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	pool->header = header;
+	pool->blockChecksums = (const uint64_t *)((const char *)pool->mapping + sizeof(RandomPoolFileHeader));
+	pool->values = (const double *)((const char *)pool->mapping + header->valuesOffset);
+	pool->numberOfValues = (size_t)header->numberOfValues;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+randomPoolSelectRegion(
+	const RandomPool *	pool,
+	uint64_t		regionSeed,
+	size_t			numberOfValuesNeeded,
+	RandomPoolRegion *	region)
+{
+	size_t	blocksPerRegion = (numberOfValuesNeeded + kRandomPoolValuesPerBlock - 1) / kRandomPoolValuesPerBlock;
+	size_t	numberOfRegions;
+	size_t	firstBlock;
+
+	/*
+	 *	Coverage: the pool must hold at least one whole region.
+	 */
+	blocksPerRegion = (blocksPerRegion > 0) ? blocksPerRegion : 1;
+	numberOfRegions = (pool->numberOfValues / kRandomPoolValuesPerBlock) / blocksPerRegion;
+	if (numberOfRegions == 0)
+	{
+		fprintf(
+			stderr,
+			"Error: The random pool holds %zu values, but this run needs %zu values in whole blocks of %d.\n",
+			pool->numberOfValues,
+			blocksPerRegion * kRandomPoolValuesPerBlock,
+			kRandomPoolValuesPerBlock);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (regionSeed >= numberOfRegions)
+	{
+		fprintf(
+			stderr,
+			"Warning: The random pool has %zu regions for runs of this size, so region seed %" PRIu64 " shares its region with seed %" PRIu64 ".\n",
+			numberOfRegions,
+			regionSeed,
+			regionSeed % numberOfRegions);
+	}
+
+	*region = (RandomPoolRegion) {
+			.regionIndex		= (size_t)(regionSeed % numberOfRegions),
+			.numberOfRegions	= numberOfRegions,
+			.numberOfValues		= numberOfValuesNeeded,
+		};
+	firstBlock = region->regionIndex * blocksPerRegion;
+	region->values = pool->values + firstBlock * kRandomPoolValuesPerBlock;
+
+	/*
+	 *	Integrity: verify only the blocks this run consumes.
+	 */
+	for (size_t block = firstBlock; block < firstBlock + blocksPerRegion; block++)
+	{
+		if (checksumWords(pool->values + block * kRandomPoolValuesPerBlock, kRandomPoolValuesPerBlock, block) != pool->blockChecksums[block])
+		{
+			fprintf(stderr, "Error: Block %zu of the random pool is corrupted.\n", block);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+#if kRandomPoolHasMemoryMapping && defined(POSIX_MADV_SEQUENTIAL)
+	if (pool->isMemoryMapped)
+	{
+		/*
+		 *	The region is read once, front to back. The advice needs a page-aligned address,
+		 *	and blocks are multiples of the page size.
+		 */
+		posix_madvise((void *)region->values, blocksPerRegion * kRandomPoolValuesPerBlock * sizeof(double), POSIX_MADV_SEQUENTIAL);
+	}
+#endif
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+randomPoolClose(RandomPool *  pool)
+{
+#if kRandomPoolHasMemoryMapping
+	if (pool->isMemoryMapped)
+	{
+		munmap(pool->mapping, pool->mappingSize);
+		*pool = (RandomPool) {0};
+
+		return;
+	}
+#endif
+	free(pool->mapping);
+	*pool = (RandomPool) {0};
+
+	return;
+}
@@ -0,0 +1,130 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "common.h"
+
+typedef enum
+{
+	/*
+	 *	Values per integrity block. Each block of the pool file has its own checksum, so
+	 *	a run only verifies the blocks it consumes.
+	 */
+	kRandomPoolValuesPerBlock	= 65536,
+	kRandomPoolFileVersion		= 1,
+	kRandomPoolPageSize		= 4096,
+} RandomPoolConstant;
+
+/*
+ *	Header at the start of a pool file. The file continues with one `uint64_t` checksum per
+ *	block and, from `valuesOffset`, which is page-aligned, the `double` uniforms in [0, 1).
+ *	All fields are in host byte order, which `byteOrderMark` records.
+ */
+typedef struct
+{
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	byteOrderMark;
+	uint64_t	numberOfValues;
+	uint64_t	valuesPerBlock;
+	uint64_t	generatorSeed;
+	uint64_t	valuesOffset;
+	uint64_t	headerChecksum;
+} RandomPoolFileHeader;
+
+/*
+ *	A pool file mapped read-only into memory.
+ */
+typedef struct
+{
+	const RandomPoolFileHeader *	header;
+	const uint64_t *		blockChecksums;
+	const double *			values;
+	size_t				numberOfValues;
+	void *				mapping;
+	size_t				mappingSize;
+	bool				isMemoryMapped;
+} RandomPool;
+
+/*
+ *	The part of a pool consumed by one run.
+ */
+typedef struct
+{
+	const double *	values;
+	size_t		numberOfValues;
+	size_t		regionIndex;
+	size_t		numberOfRegions;
+} RandomPoolRegion;
+
+/**
+ *	@brief	Generates a pool file of uniforms in [0, 1) with xoshiro256**, with a checksum per
+ *		block of `kRandomPoolValuesPerBlock` values. The file is written to a temporary
+ *		path and renamed once complete, so concurrent runs never map a partial pool.
+ *
+ *	@param	filePath	: Path of the pool file to write.
+ *	@param	numberOfValues	: The number of uniforms in the pool.
+ *	@param	generatorSeed	: Seed of the random number generator.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	randomPoolGenerate(const char *  filePath, uint64_t numberOfValues, uint64_t generatorSeed);
+
+/**
+ *	@brief	Maps a pool file read-only, and checks its header. Many runs can map the same file
+ *		concurrently and share its pages.
+ *
+ *	@param	pool		: Pointer to the pool to open.
+ *	@param	filePath	: Path of the pool file.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	randomPoolOpen(RandomPool *  pool, const char *  filePath);
+
+/**
+ *	@brief	Selects the region of the pool for one run. The pool is split into disjoint
+ *		regions of whole blocks, each large enough for `numberOfValuesNeeded` values, and
+ *		`regionSeed` modulo the number of regions picks one, so runs with distinct seeds
+ *		below the number of regions consume disjoint values. Verifies the checksums of the
+ *		blocks of the region.
+ *
+ *	@param	pool			: Pointer to the open pool.
+ *	@param	regionSeed		: Seed that selects the region.
+ *	@param	numberOfValuesNeeded	: The number of values the run consumes.
+ *	@param	region			: Pointer to the region to set.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`
+ *					  if the pool is too small or a checksum does not match.
+ */
+CommonConstantReturnType	randomPoolSelectRegion(
+					const RandomPool *	pool,
+					uint64_t		regionSeed,
+					size_t			numberOfValuesNeeded,
+					RandomPoolRegion *	region);
+
+/**
+ *	@brief	Unmaps a pool.
+ *
+ *	@param	pool	: Pointer to the open pool.
+ */
+void	randomPoolClose(RandomPool *  pool);
@@ -0,0 +1,126 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "reorder-buffer.h"
+
+CommonConstantReturnType
+reorderBufferInit(ReorderBuffer *  buffer, size_t capacity, bool isOrdered)
+{
+	*buffer = (ReorderBuffer) {
+			.capacity		= capacity,
+			.isOrdered		= isOrdered,
+			.completedIndices	= malloc(capacity * sizeof(_Atomic uint64_t)),
+			.completedNanoseconds	= calloc(capacity, sizeof(uint64_t)),
+			.isTaken		= calloc(capacity, sizeof(bool)),
+		};
+	if ((buffer->completedIndices == NULL) || (buffer->completedNanoseconds == NULL) || (buffer->isTaken == NULL))
+	{
+		fprintf(stderr, "Error: Could not allocate memory for the reorder buffer.\n");
+		reorderBufferFree(buffer);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t slot = 0; slot < capacity; slot++)
+	{
+		atomic_init(&buffer->completedIndices[slot], 0);
+	}
+	atomic_init(&buffer->head, 0);
+	atomic_init(&buffer->numberOfPublishedItems, 0);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+reorderBufferPublish(ReorderBuffer *  buffer, uint64_t index, uint64_t completedNanoseconds)
+{
+	size_t	slot = (size_t)(index % buffer->capacity);
+
+	buffer->completedNanoseconds[slot] = completedNanoseconds;
+	atomic_fetch_add_explicit(&buffer->numberOfPublishedItems, 1, memory_order_relaxed);
+	atomic_store_explicit(&buffer->completedIndices[slot], index + 1, memory_order_release);
+
+	return;
+}
+
+/*
+ *	Whether the item `index` was published into its slot.
+ */
+static bool
+isCompleted(ReorderBuffer *  buffer, uint64_t index)
+{
+	return atomic_load_explicit(&buffer->completedIndices[index % buffer->capacity], memory_order_acquire) == index + 1;
+}
+
+bool
+reorderBufferTake(ReorderBuffer *  buffer, uint64_t *  index, uint64_t *  completedNanoseconds)
+{
+	uint64_t	head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+	uint64_t	candidate = head;
+
+	/*
+	 *	In unordered mode, skip past items that are not complete yet, or were taken already.
+	 */
+	if (!buffer->isOrdered)
+	{
+		while ((candidate < head + buffer->capacity)
+			&& (buffer->isTaken[candidate % buffer->capacity] || !isCompleted(buffer, candidate)))
+		{
+			candidate++;
+		}
+	}
+
+	if ((candidate == head + buffer->capacity) || !isCompleted(buffer, candidate))
+	{
+		return false;
+	}
+
+	*index = candidate;
+	*completedNanoseconds = buffer->completedNanoseconds[candidate % buffer->capacity];
+	buffer->numberOfTakenItems++;
+	buffer->isTaken[candidate % buffer->capacity] = true;
+
+	/*
+	 *	Slide the window past the taken items at its start, freeing their slots for producers.
+	 */
+	while (buffer->isTaken[head % buffer->capacity])
+	{
+		buffer->isTaken[head % buffer->capacity] = false;
+		head++;
+	}
+	atomic_store_explicit(&buffer->head, head, memory_order_release);
+
+	return true;
+}
+
+void
+reorderBufferFree(ReorderBuffer *  buffer)
+{
+	free(buffer->completedIndices);
+	free(buffer->completedNanoseconds);
+	free(buffer->isTaken);
+	*buffer = (ReorderBuffer) {0};
+
+	return;
+}
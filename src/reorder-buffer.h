@@ -0,0 +1,128 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "common.h"
+
+/*
+ *	Bounded reorder window between parallel producers, which complete items numbered
+ *	0, 1, 2, ... in any order, and one consumer, which takes them either in index order or
+ *	as soon as they complete. Each index is published by exactly one producer. A producer
+ *	may only publish index `i` once `i` is inside the window, i.e., within `capacity` of the
+ *	oldest item not yet taken, so memory stays bounded however far the fastest producer
+ *	runs ahead. No operation takes a lock or blocks: callers poll and back off.
+ */
+typedef struct
+{
+	size_t			capacity;
+	bool			isOrdered;
+
+	/*
+	 *	Per slot, one plus the index of the item completed into it, or zero. Written by
+	 *	producers with release stores and read by the consumer with acquire loads.
+	 */
+	_Atomic uint64_t *	completedIndices;
+
+	/*
+	 *	Per slot, the completion time of its item, written before the release store.
+	 */
+	uint64_t *		completedNanoseconds;
+
+	/*
+	 *	Per slot, whether the consumer took its item out of order. Private to the consumer.
+	 */
+	bool *			isTaken;
+
+	/*
+	 *	The oldest index not yet taken. Only the consumer advances it.
+	 */
+	_Atomic uint64_t	head;
+	_Atomic uint64_t	numberOfPublishedItems;
+	uint64_t		numberOfTakenItems;
+} ReorderBuffer;
+
+/**
+ *	@brief	Allocates an empty reorder window.
+ *
+ *	@param	buffer		: Pointer to the buffer to initialize.
+ *	@param	capacity	: The number of items the window holds, at least one.
+ *	@param	isOrdered	: Whether the consumer takes items in index order.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	reorderBufferInit(ReorderBuffer *  buffer, size_t capacity, bool isOrdered);
+
+/**
+ *	@brief	Checks whether an item is inside the window, so that it may be published.
+ *
+ *	@param	buffer	: Pointer to the buffer.
+ *	@param	index	: The index of the item.
+ *	@return		: `true` if the item may be published, `false` if the producer must wait.
+ */
+static inline bool
+reorderBufferHasRoom(ReorderBuffer *  buffer, uint64_t index)
+{
+	return index < atomic_load_explicit(&buffer->head, memory_order_acquire) + buffer->capacity;
+}
+
+/**
+ *	@brief	Publishes a completed item. The item must be inside the window.
+ *
+ *	@param	buffer			: Pointer to the buffer.
+ *	@param	index			: The index of the item.
+ *	@param	completedNanoseconds	: The completion time of the item, returned when it is taken.
+ */
+void	reorderBufferPublish(ReorderBuffer *  buffer, uint64_t index, uint64_t completedNanoseconds);
+
+/**
+ *	@brief	Takes the next item: in ordered mode the oldest item, once it is complete, and in
+ *		unordered mode the oldest complete item in the window. Only one thread may take.
+ *
+ *	@param	buffer			: Pointer to the buffer.
+ *	@param	index			: Pointer to the index of the item taken.
+ *	@param	completedNanoseconds	: Pointer to the completion time of the item taken.
+ *	@return				: `true` if an item was taken, `false` if none is ready.
+ */
+bool	reorderBufferTake(ReorderBuffer *  buffer, uint64_t *  index, uint64_t *  completedNanoseconds);
+
+/**
+ *	@brief	Gets the number of items published but not yet taken.
+ *
+ *	@param	buffer	: Pointer to the buffer.
+ *	@return		: The depth of the window.
+ */
+static inline uint64_t
+reorderBufferGetDepth(ReorderBuffer *  buffer)
+{
+	return atomic_load_explicit(&buffer->numberOfPublishedItems, memory_order_relaxed) - buffer->numberOfTakenItems;
+}
+
+/**
+ *	@brief	Frees a reorder window.
+ *
+ *	@param	buffer	: Pointer to the buffer.
+ */
+void	reorderBufferFree(ReorderBuffer *  buffer);
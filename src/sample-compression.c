@@ -0,0 +1,463 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sample-compression.h"
+
+static const char	kSampleCompressionFileMagic[8] = {'S', 'G', 'S', 'A', 'M', 'P', 'Z', '1'};
+static const uint32_t	kSampleCompressionByteOrderMark = 0x01020304;
+
+/*
+ *	Largest magnitude of a sample in steps of the quantization grid for which the
+ *	rounded sample is an exact integer in double precision.
+ */
+static const double	kSampleCompressionMaxGridIndex = 4503599627370496.0;
+
+/*
+ *	Swaps the high `shift` bits of each field of `mask` in the rows `i` with the low ones of
+ *	the rows `i + distance`, for the rows `i` without the bit `distance`.
+ */
+static inline void
+swapBlocks(uint64_t *  words, size_t distance, size_t shift, uint64_t mask)
+{
+	for (size_t i = 0; i < 8; i++)
+	{
+		if ((i & distance) == 0)
+		{
+			uint64_t	t = ((words[i] >> shift) ^ words[i + distance]) & mask;
+
+			words[i] ^= t << shift;
+			words[i + distance] ^= t;
+		}
+	}
+
+	return;
+}
+
+/*
+ *	Transposes the 8x8 byte matrix whose rows are `words`, in place, by swapping blocks of
+ *	4x4, 2x2 and 1x1 bytes: afterwards, byte `j` of word `i` is byte `i` of the former word
+ *	`j`. The transpose is its own inverse.
+ */
+static inline void
+transposeBytes(uint64_t *  words)
+{
+	swapBlocks(words, 4, 32, UINT64_C(0x00000000FFFFFFFF));
+	swapBlocks(words, 2, 16, UINT64_C(0x0000FFFF0000FFFF));
+	swapBlocks(words, 1, 8, UINT64_C(0x00FF00FF00FF00FF));
+
+	return;
+}
+
+static inline size_t
+bitWidth(uint64_t value)
+{
+	size_t	width = 0;
+
+	while (value != 0)
+	{
+		width++;
+		value >>= 1;
+	}
+
+	return width;
+}
+
+/*
+ *	Stores the eight bytes of a plane of a group, each below 2^width, in `width` bytes.
+ */
+static inline void
+packPlane(uint64_t plane, size_t width, uint8_t *  output)
+{
+	if (width == 8)
+	{
+		memcpy(output, &plane, sizeof(plane));
+
+		return;
+	}
+
+	uint64_t	packed = 0;
+
+	for (size_t j = 0; j < kSampleCompressionSamplesPerGroup; j++)
+	{
+		packed |= ((plane >> (8 * j)) & 0xFF) << (width * j);
+	}
+	for (size_t k = 0; k < width; k++)
+	{
+		output[k] = (uint8_t)(packed >> (8 * k));
+	}
+
+	return;
+}
+
+static inline uint64_t
+unpackPlane(const uint8_t *  input, size_t width)
+{
+	uint64_t	packed = 0;
+	uint64_t	plane = 0;
+
+	if (width == 8)
+	{
+		memcpy(&plane, input, sizeof(plane));
+
+		return plane;
+	}
+
+	for (size_t k = 0; k < width; k++)
+	{
+		packed |= (uint64_t)input[k] << (8 * k);
+	}
+	for (size_t j = 0; j < kSampleCompressionSamplesPerGroup; j++)
+	{
+		plane |= ((packed >> (width * j)) & ((UINT64_C(1) << width) - 1)) << (8 * j);
+	}
+
+	return plane;
+}
+
+static inline uint64_t
+bitsOfDouble(double value)
+{
+	uint64_t	bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+
+	return bits;
+}
+
+static inline double
+doubleOfBits(uint64_t bits)
+{
+	double	value;
+
+	memcpy(&value, &bits, sizeof(value));
+
+	return value;
+}
+
+/*
+ *	Forms the quantized words of a block, or returns false if a sample cannot be quantized
+ *	to within the bound.
+ */
+static bool
+quantizeBlock(const double *  samples, size_t numberOfSamples, double absoluteErrorBound, uint64_t *  words, int64_t *  minimumIndex, uint64_t *  allBits)
+{
+	double		step = 2.0 * absoluteErrorBound;
+	double		inverseStep = 1.0 / step;
+	int64_t		minimum = INT64_MAX;
+	uint64_t	offsetBits = 0;
+	bool		isQuantizable = true;
+
+	/*
+	 *	Checked for the whole block at once, so that the loop has no branches.
+	 */
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		double	scaled = samples[i] * inverseStep;
+		bool	isInRange = (fabs(scaled) < kSampleCompressionMaxGridIndex);
+		int64_t	index = isInRange ? llrint(scaled) : 0;
+
+		isQuantizable &= isInRange & (fabs((double)index * step - samples[i]) <= absoluteErrorBound);
+		words[i] = (uint64_t)index;
+		minimum = (index < minimum) ? index : minimum;
+	}
+
+	if (!isQuantizable)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < numberOfSamples; i++)
+	{
+		words[i] -= (uint64_t)minimum;
+		offsetBits |= words[i];
+	}
+	*minimumIndex = minimum;
+	*allBits = offsetBits;
+
+	return true;
+}
+
+size_t
+sampleCompressionEncodeBlock(const double *  samples, size_t numberOfSamples, double absoluteErrorBound, uint8_t *  block)
+{
+	static _Thread_local uint64_t	words[kSampleCompressionSamplesPerBlock + kSampleCompressionSamplesPerGroup];
+	size_t				numberOfGroups = (numberOfSamples + kSampleCompressionSamplesPerGroup - 1) / kSampleCompressionSamplesPerGroup;
+	uint8_t *			planes[8];
+	size_t				widths[8];
+	uint64_t			base;
+	uint64_t			allBits = 0;
+	uint8_t				mode = kSampleCompressionBlockModeLossless;
+	int64_t				minimumIndex;
+
+	if ((absoluteErrorBound > 0) && quantizeBlock(samples, numberOfSamples, absoluteErrorBound, words, &minimumIndex, &allBits))
+	{
+		mode = kSampleCompressionBlockModeQuantized;
+		base = (uint64_t)minimumIndex;
+	}
+	else
+	{
+		uint64_t	previous = base = bitsOfDouble(samples[0]);
+
+		for (size_t i = 0; i < numberOfSamples; i++)
+		{
+			uint64_t	bits = bitsOfDouble(samples[i]);
+
+			words[i] = bits ^ previous;
+			allBits |= words[i];
+			previous = bits;
+		}
+	}
+
+	for (size_t i = numberOfSamples; i < numberOfGroups * kSampleCompressionSamplesPerGroup; i++)
+	{
+		words[i] = 0;
+	}
+
+	block[0] = mode;
+	planes[0] = block + kSampleCompressionBlockHeaderBytes;
+	for (size_t b = 0; b < 8; b++)
+	{
+		widths[b] = bitWidth((allBits >> (8 * b)) & 0xFF);
+		block[1 + b] = (uint8_t)widths[b];
+		if (b > 0)
+		{
+			planes[b] = planes[b - 1] + numberOfGroups * widths[b - 1];
+		}
+	}
+	memcpy(&block[1 + 8], &base, sizeof(base));
+
+	for (size_t group = 0; group < numberOfGroups; group++)
+	{
+		uint64_t	transposed[8];
+
+		memcpy(transposed, &words[group * kSampleCompressionSamplesPerGroup], sizeof(transposed));
+		transposeBytes(transposed);
+		for (size_t b = 0; b < 8; b++)
+		{
+			if (widths[b] > 0)
+			{
+				packPlane(transposed[b], widths[b], planes[b] + group * widths[b]);
+			}
+		}
+	}
+
+	return (size_t)(planes[7] + numberOfGroups * widths[7] - block);
+}
+
+CommonConstantReturnType
+sampleCompressionDecodeBlock(
+	const uint8_t *	block,
+	size_t		numberOfBytes,
+	size_t		numberOfSamples,
+	double		absoluteErrorBound,
+	double *	samples)
+{
+	size_t			numberOfGroups = (numberOfSamples + kSampleCompressionSamplesPerGroup - 1) / kSampleCompressionSamplesPerGroup;
+	const uint8_t *		planes[8];
+	size_t			widths[8];
+	size_t			expectedNumberOfBytes = kSampleCompressionBlockHeaderBytes;
+	uint64_t		base;
+	double			step = 2.0 * absoluteErrorBound;
+
+	if ((numberOfBytes < kSampleCompressionBlockHeaderBytes) || (block[0] >= kSampleCompressionBlockModeMax)
+		|| ((block[0] == kSampleCompressionBlockModeQuantized) && !(absoluteErrorBound > 0)))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t b = 0; b < 8; b++)
+	{
+		widths[b] = block[1 + b];
+		if (widths[b] > 8)
+		{
+			return kCommonConstantReturnTypeError;
+		}
+		planes[b] = block + expectedNumberOfBytes;
+		expectedNumberOfBytes += numberOfGroups * widths[b];
+	}
+	if (expectedNumberOfBytes != numberOfBytes)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+	memcpy(&base, &block[1 + 8], sizeof(base));
+
+	for (size_t group = 0; group < numberOfGroups; group++)
+	{
+		uint64_t	words[8];
+		size_t		first = group * kSampleCompressionSamplesPerGroup;
+		size_t		count = (numberOfSamples - first < kSampleCompressionSamplesPerGroup) ? numberOfSamples - first : kSampleCompressionSamplesPerGroup;
+
+		for (size_t b = 0; b < 8; b++)
+		{
+			words[b] = (widths[b] > 0) ? unpackPlane(planes[b] + group * widths[b], widths[b]) : 0;
+		}
+		transposeBytes(words);
+
+		if (block[0] == kSampleCompressionBlockModeQuantized)
+		{
+			for (size_t j = 0; j < count; j++)
+			{
+				samples[first + j] = (double)(int64_t)(base + words[j]) * step;
+			}
+		}
+		else
+		{
+			for (size_t j = 0; j < count; j++)
+			{
+				base ^= words[j];
+				samples[first + j] = doubleOfBits(base);
+			}
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+sampleCompressionWriteFile(
+	const char *	filePath,
+	const double *	samples,
+	size_t		numberOfSamples,
+	uint64_t	cpuTimeMicroseconds,
+	double		absoluteErrorBound)
+{
+	SampleCompressionFileHeader	header =
+					{
+						.version		= kSampleCompressionFileVersion,
+						.byteOrderMark		= kSampleCompressionByteOrderMark,
+						.numberOfSamples	= numberOfSamples,
+						.samplesPerBlock	= kSampleCompressionSamplesPerBlock,
+						.cpuTimeMicroseconds	= cpuTimeMicroseconds,
+						.absoluteErrorBound	= absoluteErrorBound,
+					};
+	char				temporaryFilePath[kCommonConstantMaxCharsPerFilepath];
+	uint8_t *			block;
+	FILE *				file;
+	bool				hasError = false;
+
+	memcpy(header.magic, kSampleCompressionFileMagic, sizeof(header.magic));
+
+	if (snprintf(temporaryFilePath, sizeof(temporaryFilePath), "%s.tmp", filePath) >= (int)sizeof(temporaryFilePath))
+	{
+		fprintf(stderr, "Error: The compressed sample file path is too long.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	block = malloc(kSampleCompressionMaxBlockBytes);
+	file = fopen(temporaryFilePath, "wb");
+	if ((block == NULL) || (file == NULL))
+	{
+		fprintf(stderr, "Error: Could not open the compressed sample file \"%s\" for writing.\n", temporaryFilePath);
+		free(block);
+		if (file != NULL)
+		{
+			fclose(file);
+		}
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	hasError |= (fwrite(&header, sizeof(header), 1, file) != 1);
+	for (size_t first = 0; !hasError && (first < numberOfSamples); first += kSampleCompressionSamplesPerBlock)
+	{
+		size_t		count = (numberOfSamples - first < kSampleCompressionSamplesPerBlock) ? numberOfSamples - first : kSampleCompressionSamplesPerBlock;
+		uint32_t	numberOfBytes = (uint32_t)sampleCompressionEncodeBlock(&samples[first], count, absoluteErrorBound, block);
+
+		hasError |= (fwrite(&numberOfBytes, sizeof(numberOfBytes), 1, file) != 1);
+		hasError |= (fwrite(block, 1, numberOfBytes, file) != numberOfBytes);
+	}
+	hasError |= (fclose(file) != 0);
+	free(block);
+
+	if (hasError || (rename(temporaryFilePath, filePath) != 0))
+	{
+		fprintf(stderr, "Error: Could not write the compressed sample file \"%s\".\n", filePath);
+		remove(temporaryFilePath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+sampleCompressionReadFile(const char *  filePath, SampleCompressionFileHeader *  header, double **  samples)
+{
+	FILE *		file = fopen(filePath, "rb");
+	uint8_t *	block = NULL;
+	bool		isValid;
+
+	*samples = NULL;
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open the compressed sample file \"%s\".\n", filePath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	isValid = (fread(header, sizeof(*header), 1, file) == 1)
+			&& (memcmp(header->magic, kSampleCompressionFileMagic, sizeof(header->magic)) == 0)
+			&& (header->version == kSampleCompressionFileVersion)
+			&& (header->byteOrderMark == kSampleCompressionByteOrderMark)
+			&& (header->samplesPerBlock == kSampleCompressionSamplesPerBlock)
+			&& (header->absoluteErrorBound >= 0) && isfinite(header->absoluteErrorBound)
+			&& (header->numberOfSamples <= SIZE_MAX / sizeof(double));
+
+	if (isValid)
+	{
+		block = malloc(kSampleCompressionMaxBlockBytes);
+		*samples = malloc((header->numberOfSamples > 0 ? header->numberOfSamples : 1) * sizeof(double));
+		isValid = (block != NULL) && (*samples != NULL);
+	}
+
+	for (uint64_t first = 0; isValid && (first < header->numberOfSamples); first += kSampleCompressionSamplesPerBlock)
+	{
+		size_t		count = (header->numberOfSamples - first < kSampleCompressionSamplesPerBlock) ? (size_t)(header->numberOfSamples - first) : kSampleCompressionSamplesPerBlock;
+		uint32_t	numberOfBytes;
+
+		isValid = (fread(&numberOfBytes, sizeof(numberOfBytes), 1, file) == 1)
+				&& (numberOfBytes <= kSampleCompressionMaxBlockBytes)
+				&& (fread(block, 1, numberOfBytes, file) == numberOfBytes)
+				&& (sampleCompressionDecodeBlock(block, numberOfBytes, count, header->absoluteErrorBound, &(*samples)[first]) == kCommonConstantReturnTypeSuccess);
+	}
+	isValid = isValid && (fgetc(file) == EOF);
+	fclose(file);
+	free(block);
+
+	if (!isValid)
+	{
+		fprintf(stderr, "Error: \"%s\" is not a valid compressed sample file, or it is corrupted or from a host with another byte order.\n", filePath);
+		free(*samples);
+		*samples = NULL;
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
@@ -0,0 +1,131 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "common.h"
+
+typedef enum
+{
+	kSampleCompressionSamplesPerBlock	= 1 << 16,
+	kSampleCompressionSamplesPerGroup	= 8,
+	kSampleCompressionFileVersion		= 1,
+
+	/*
+	 *	Bytes of a block before its byte planes: the mode, the bit width of each of the
+	 *	eight planes, and the base word.
+	 */
+	kSampleCompressionBlockHeaderBytes	= 1 + 8 + 8,
+	kSampleCompressionMaxBlockBytes		= kSampleCompressionBlockHeaderBytes + kSampleCompressionSamplesPerBlock * sizeof(uint64_t),
+} SampleCompressionConstant;
+
+/*
+ *	How the words of a block are formed from its samples. Lossless words are the XOR of the
+ *	bits of each sample with those of the one before it, so that the bits that samples
+ *	share are zero. Quantized words are the offsets of the samples, rounded to a grid of
+ *	twice the absolute error bound, from the smallest of the block.
+ */
+typedef enum
+{
+	kSampleCompressionBlockModeLossless	= 0,
+	kSampleCompressionBlockModeQuantized	= 1,
+	kSampleCompressionBlockModeMax,
+} SampleCompressionBlockMode;
+
+/*
+ *	Header at the start of a compressed sample file. The file continues with one block per
+ *	`samplesPerBlock` samples, each a `uint32_t` byte count followed by the block. A zero
+ *	`absoluteErrorBound` means that all blocks are lossless. All fields are in host byte
+ *	order, which `byteOrderMark` records.
+ */
+typedef struct
+{
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	byteOrderMark;
+	uint64_t	numberOfSamples;
+	uint64_t	samplesPerBlock;
+	uint64_t	cpuTimeMicroseconds;
+	double		absoluteErrorBound;
+} SampleCompressionFileHeader;
+
+/**
+ *	@brief	Compresses a block of samples. The words of the block (see
+ *		`SampleCompressionBlockMode`) are transposed into eight byte planes, and each plane
+ *		is stored with the fewest bits that hold all of its bytes, or not at all if it is
+ *		zero. With a nonzero error bound, the block is quantized unless a sample is not
+ *		finite or its rounding would not be within the bound, in which case it is lossless.
+ *
+ *	@param	samples			: The samples.
+ *	@param	numberOfSamples		: Number of samples, from 1 to `kSampleCompressionSamplesPerBlock`.
+ *	@param	absoluteErrorBound	: Largest absolute error of a decompressed sample, or 0 for lossless compression.
+ *	@param	block			: Output of at least `kSampleCompressionMaxBlockBytes` bytes.
+ *	@return				: Number of bytes of the compressed block.
+ */
+size_t	sampleCompressionEncodeBlock(const double *  samples, size_t numberOfSamples, double absoluteErrorBound, uint8_t *  block);
+
+/**
+ *	@brief	Decompresses a block of samples of `sampleCompressionEncodeBlock()`.
+ *
+ *	@param	block			: The compressed block.
+ *	@param	numberOfBytes		: Number of bytes of the compressed block.
+ *	@param	numberOfSamples		: Number of samples of the block.
+ *	@param	absoluteErrorBound	: The error bound the block was compressed with.
+ *	@param	samples			: Output of `numberOfSamples` samples.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError` if the block is malformed.
+ */
+CommonConstantReturnType	sampleCompressionDecodeBlock(
+					const uint8_t *	block,
+					size_t		numberOfBytes,
+					size_t		numberOfSamples,
+					double		absoluteErrorBound,
+					double *	samples);
+
+/**
+ *	@brief	Writes Monte Carlo output samples to a compressed sample file. The file is
+ *		written to a temporary path and renamed once complete.
+ *
+ *	@param	filePath		: Path of the file to write.
+ *	@param	samples			: The samples.
+ *	@param	numberOfSamples		: Number of samples.
+ *	@param	cpuTimeMicroseconds	: CPU time of the run, stored like the first line of `data.out`.
+ *	@param	absoluteErrorBound	: Largest absolute error of a decompressed sample, or 0 for lossless compression.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	sampleCompressionWriteFile(
+					const char *	filePath,
+					const double *	samples,
+					size_t		numberOfSamples,
+					uint64_t	cpuTimeMicroseconds,
+					double		absoluteErrorBound);
+
+/**
+ *	@brief	Reads and decompresses all samples of a compressed sample file.
+ *
+ *	@param	filePath	: Path of the file.
+ *	@param	header		: Pointer to the header of the file, written by the function.
+ *	@param	samples		: Pointer to the samples, allocated by the function and freed by the caller.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	sampleCompressionReadFile(const char *  filePath, SampleCompressionFileHeader *  header, double **  samples);
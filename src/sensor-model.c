@@ -0,0 +1,190 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "sensor-model.h"
+
+/*
+ *	The registry. The first model is the default. Each entry takes its transfer functions
+ *	from the conversion formulas of the datasheet of the part.
+ */
+static const SensorModel	kSensorModelRegistry[] =
+{
+	{
+		/*
+		 *	Figure 4 in page 8 of the SHT4xI-analog datasheet, 2024-07-03.
+		 */
+		.name		= "sht4xi-analog",
+		.description	= "Sensirion SHT4xI-analog, ratiometric humidity and temperature outputs.",
+		.transfer	= kSensorModelTransferRatiometric,
+		.channels	= {
+			[kSensorModelChannelRelativeHumidity]		= {kInputDistributionIndexVrh, kSensorCalibrationConstant1, kSensorCalibrationConstant2},
+			[kSensorModelChannelTemperatureCelcius]		= {kInputDistributionIndexVt, kSensorCalibrationConstant3, kSensorCalibrationConstant4},
+			[kSensorModelChannelTemperatureFahrenheit]	= {kInputDistributionIndexVt, kSensorCalibrationConstant5, kSensorCalibrationConstant6},
+		},
+	},
+	{
+		/*
+		 *	Section 4 of the SHT3x-ARP datasheet. The ratiometric conversion is that of the
+		 *	SHT4xI-analog.
+		 */
+		.name		= "sht3x-arp",
+		.description	= "Sensirion SHT3x-ARP, ratiometric humidity and temperature outputs.",
+		.transfer	= kSensorModelTransferRatiometric,
+		.channels	= {
+			[kSensorModelChannelRelativeHumidity]		= {kInputDistributionIndexVrh, -12.5, 125.0},
+			[kSensorModelChannelTemperatureCelcius]		= {kInputDistributionIndexVt, -66.875, 218.75},
+			[kSensorModelChannelTemperatureFahrenheit]	= {kInputDistributionIndexVt, -88.375, 393.75},
+		},
+	},
+	{
+		/*
+		 *	The analog outputs of the Sensirion parts are all ratiometric, so the model with
+		 *	outputs against a fixed reference is that of another vendor's probe.
+		 *
+		 *	Analog output scaling of the Vaisala HMP60 probe with the 0 ... 5 V outputs:
+		 *	0 ... 100 %RH and -40 ... +60 degrees Celcius, against the internal reference
+		 *	of the probe, so the outputs do not follow the supply.
+		 */
+		.name		= "hmp60-5v",
+		.description	= "Vaisala HMP60, 0 to 5 V humidity and temperature outputs against a fixed reference.",
+		.transfer	= kSensorModelTransferAffine,
+		.channels	= {
+			[kSensorModelChannelRelativeHumidity]		= {kInputDistributionIndexVrh, 0.0, 20.0},
+			[kSensorModelChannelTemperatureCelcius]		= {kInputDistributionIndexVt, -40.0, 20.0},
+			[kSensorModelChannelTemperatureFahrenheit]	= {kInputDistributionIndexVt, -40.0, 36.0},
+		},
+	},
+};
+
+const SensorModel *
+sensorModelGetDefault(void)
+{
+	return &kSensorModelRegistry[0];
+}
+
+const SensorModel *
+sensorModelFind(const char *  name)
+{
+	for (size_t i = 0; i < sizeof(kSensorModelRegistry) / sizeof(kSensorModelRegistry[0]); i++)
+	{
+		if (strcmp(kSensorModelRegistry[i].name, name) == 0)
+		{
+			return &kSensorModelRegistry[i];
+		}
+	}
+
+	return NULL;
+}
+
+void
+sensorModelPrintRegistry(FILE *  stream)
+{
+	for (size_t i = 0; i < sizeof(kSensorModelRegistry) / sizeof(kSensorModelRegistry[0]); i++)
+	{
+		fprintf(stream, "\t%-16s %s\n", kSensorModelRegistry[i].name, kSensorModelRegistry[i].description);
+	}
+
+	return;
+}
+
+void
+sensorModelGetChannelRange(
+	const SensorModel *	model,
+	SensorModelChannel	channel,
+	const double *		lowerBound,
+	const double *		upperBound,
+	double *		minimum,
+	double *		maximum)
+{
+	const SensorModelChannelTransfer *	transfer = &model->channels[channel];
+	double					argumentMinimum = lowerBound[transfer->input];
+	double					argumentMaximum = upperBound[transfer->input];
+
+	/*
+	 *	The voltages are positive, so the ratio is smallest for the largest supply.
+	 */
+	if (model->transfer == kSensorModelTransferRatiometric)
+	{
+		argumentMinimum /= upperBound[kInputDistributionIndexVsupply];
+		argumentMaximum /= lowerBound[kInputDistributionIndexVsupply];
+	}
+
+	*minimum = transfer->offset + transfer->slope * ((transfer->slope >= 0.0) ? argumentMinimum : argumentMaximum);
+	*maximum = transfer->offset + transfer->slope * ((transfer->slope >= 0.0) ? argumentMaximum : argumentMinimum);
+
+	return;
+}
+
+double
+sensorModelRatioDistributionFunction(double r, double x0, double x1, double y0, double y1)
+{
+	double	linearLow = fmax(y0, x0 / r);
+	double	linearHigh = fmin(y1, x1 / r);
+	double	oneLow = fmax(y0, x1 / r);
+	double	integral = 0.0;
+
+	if (linearHigh > linearLow)
+	{
+		integral += (r * (linearHigh * linearHigh - linearLow * linearLow) / 2.0 - x0 * (linearHigh - linearLow)) / (x1 - x0);
+	}
+
+	if (y1 > oneLow)
+	{
+		integral += y1 - oneLow;
+	}
+
+	return integral / (y1 - y0);
+}
+
+double
+sensorModelGetChannelDistributionFunction(
+	const SensorModel *	model,
+	SensorModelChannel	channel,
+	const double *		lowerBound,
+	const double *		upperBound,
+	double			value)
+{
+	const SensorModelChannelTransfer *	transfer = &model->channels[channel];
+	double					x0 = lowerBound[transfer->input];
+	double					x1 = upperBound[transfer->input];
+	double					argument = (value - transfer->offset) / transfer->slope;
+	double					probability;
+
+	if (model->transfer == kSensorModelTransferRatiometric)
+	{
+		probability = (argument <= 0.0)
+				? 0.0
+				: sensorModelRatioDistributionFunction(argument, x0, x1, lowerBound[kInputDistributionIndexVsupply], upperBound[kInputDistributionIndexVsupply]);
+	}
+	else
+	{
+		probability = fmin(fmax((argument - x0) / (x1 - x0), 0.0), 1.0);
+	}
+
+	/*
+	 *	A negative slope reverses the order of the values. The distribution is continuous.
+	 */
+	return (transfer->slope >= 0.0) ? probability : 1.0 - probability;
+}
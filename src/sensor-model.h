@@ -0,0 +1,170 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include "division.h"
+#include "utilities-config.h"
+
+/*
+ *	Transfer functions of the analog outputs of a sensor model:
+ *		kSensorModelTransferRatiometric	: The output voltage is proportional to the supply, and each
+ *						  calibrated value is affine in `V / Vsupply`.
+ *		kSensorModelTransferAffine	: The output voltage is against a fixed reference, and each
+ *						  calibrated value is affine in `V` (in Volt). `Vsupply` is unused.
+ */
+typedef enum
+{
+	kSensorModelTransferRatiometric	= 0,
+	kSensorModelTransferAffine	= 1,
+	kSensorModelTransferMax,
+} SensorModelTransfer;
+
+/*
+ *	Calibrated values that a sensor model converts from its analog outputs. They are the
+ *	first outputs of `OutputDistributionIndex`, and the derived psychrometric outputs
+ *	follow from the first two.
+ */
+typedef enum
+{
+	kSensorModelChannelRelativeHumidity	= kOutputDistributionIndexCalibratedRelativeHumidity,
+	kSensorModelChannelTemperatureCelcius	= kOutputDistributionIndexCalibratedTemperatureCelcius,
+	kSensorModelChannelTemperatureFahrenheit	= kOutputDistributionIndexCalibratedTemperatureFahrenheit,
+	kSensorModelChannelMax,
+} SensorModelChannel;
+
+/*
+ *	One calibrated value: `offset + slope * x`, where `x` is the voltage of `input` over
+ *	`Vsupply` for ratiometric models, or the voltage of `input` for affine models.
+ */
+typedef struct
+{
+	InputDistributionIndex	input;
+	double			offset;
+	double			slope;
+} SensorModelChannelTransfer;
+
+/*
+ *	A sensor model of the registry: its inputs are the voltages named by its channels,
+ *	plus `Vsupply` if it is ratiometric, and its outputs are the calibrated values of its
+ *	channels and the psychrometric outputs derived from them.
+ */
+typedef struct
+{
+	const char *			name;
+	const char *			description;
+	SensorModelTransfer		transfer;
+	SensorModelChannelTransfer	channels[kSensorModelChannelMax];
+} SensorModel;
+
+/**
+ *	@brief	Gets the default sensor model, the SHT4xI-analog.
+ *
+ *	@return	: Pointer to the default model.
+ */
+const SensorModel *	sensorModelGetDefault(void);
+
+/**
+ *	@brief	Finds a sensor model of the registry by name.
+ *
+ *	@param	name	: Name of the model.
+ *	@return		: Pointer to the model, or `NULL` if no model has this name.
+ */
+const SensorModel *	sensorModelFind(const char *  name);
+
+/**
+ *	@brief	Prints the names and descriptions of the models of the registry, one per line.
+ *
+ *	@param	stream	: The stream to print to.
+ */
+void	sensorModelPrintRegistry(FILE *  stream);
+
+/**
+ *	@brief	Gets the argument of the affine map of a channel from its input voltage and the supply
+ *		voltage: `V / Vsupply` for ratiometric models and `V` for affine ones.
+ *
+ *	@param	transfer		: The transfer function of the model.
+ *	@param	V			: The input voltage of the channel.
+ *	@param	Vsupply			: The supply voltage.
+ *	@param	reciprocalOfVsupply	: The reciprocal of `Vsupply` from `divisionApproximateReciprocal()`,
+ *					  unused for the exact tier.
+ *	@param	tier			: The accuracy tier of the division.
+ *	@return				: The argument of the affine map.
+ */
+static inline double
+sensorModelTransferArgument(SensorModelTransfer transfer, double V, double Vsupply, double reciprocalOfVsupply, DivisionAccuracyTier tier)
+{
+	return (transfer == kSensorModelTransferRatiometric) ? divisionQuotient(V, Vsupply, reciprocalOfVsupply, tier) : V;
+}
+
+/**
+ *	@brief	Gets the range of a calibrated value over inputs uniform between their bounds.
+ *
+ *	@param	model		: Pointer to the model.
+ *	@param	channel		: The channel.
+ *	@param	lowerBound	: Lower bounds of the inputs.
+ *	@param	upperBound	: Upper bounds of the inputs.
+ *	@param	minimum		: Pointer to the minimum of the value, written by the function.
+ *	@param	maximum		: Pointer to the maximum of the value, written by the function.
+ */
+void	sensorModelGetChannelRange(
+		const SensorModel *	model,
+		SensorModelChannel	channel,
+		const double *		lowerBound,
+		const double *		upperBound,
+		double *		minimum,
+		double *		maximum);
+
+/**
+ *	@brief	Distribution function of `X / Y`, with `X` uniform in [x0, x1] and `Y` uniform in
+ *		[y0, y1], both positive: `P(X <= r Y)` averaged over `Y`, where the probability
+ *		given `Y = y` is zero below `y = x0 / r`, one above `y = x1 / r`, and linear in
+ *		between.
+ *
+ *	@param	r	: The value of the ratio, positive.
+ *	@param	x0	: Lower bound of the numerator.
+ *	@param	x1	: Upper bound of the numerator.
+ *	@param	y0	: Lower bound of the denominator.
+ *	@param	y1	: Upper bound of the denominator.
+ *	@return		: `P(X / Y <= r)`.
+ */
+double	sensorModelRatioDistributionFunction(double r, double x0, double x1, double y0, double y1);
+
+/**
+ *	@brief	Distribution function of a calibrated value over inputs uniform between their bounds,
+ *		in closed form: that of the ratio for ratiometric models, and that of the uniform
+ *		input voltage for affine ones, through the affine map of the channel.
+ *
+ *	@param	model		: Pointer to the model.
+ *	@param	channel		: The channel.
+ *	@param	lowerBound	: Lower bounds of the inputs.
+ *	@param	upperBound	: Upper bounds of the inputs.
+ *	@param	value		: The value of the calibrated output.
+ *	@return			: The probability that the calibrated output is at most `value`.
+ */
+double	sensorModelGetChannelDistributionFunction(
+		const SensorModel *	model,
+		SensorModelChannel	channel,
+		const double *		lowerBound,
+		const double *		upperBound,
+		double			value);
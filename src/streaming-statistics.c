@@ -0,0 +1,452 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "streaming-statistics.h"
+
+/*
+ *	The reservoir uses its own generator (xoshiro256**, seeded with splitmix64) rather than
+ *	the UxHw API, since which item is kept must be a plain, reproducible decision.
+ */
+static uint64_t
+splitMix64(uint64_t *  state)
+{
+	uint64_t	z = (*state += 0x9E3779B97F4A7C15ULL);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+	return z ^ (z >> 31);
+}
+
+static uint64_t
+rotateLeft(uint64_t value, int shift)
+{
+	return (value << shift) | (value >> (64 - shift));
+}
+
+static uint64_t
+nextRandom(uint64_t *  state)
+{
+	uint64_t	result = rotateLeft(state[1] * 5, 7) * 9;
+	uint64_t	t = state[1] << 17;
+
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+	state[2] ^= t;
+	state[3] = rotateLeft(state[3], 45);
+
+	return result;
+}
+
+/*
+ *	Uniform double in the open interval (0, 1), so that its logarithm is finite.
+ */
+static double
+nextOpenUniform(uint64_t *  state)
+{
+	return ((double)(nextRandom(state) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+/*
+ *	Uniform index in [0, n).
+ */
+static uint64_t
+nextIndex(uint64_t *  state, uint64_t n)
+{
+	uint64_t	index = (uint64_t)(nextOpenUniform(state) * (double)n);
+
+	return (index < n) ? index : n - 1;
+}
+
+/*
+ *	Gamma(shape, 1) variate for `shape >= 1` (Marsaglia and Tsang).
+ */
+static double
+nextGamma(uint64_t *  state, double shape)
+{
+	double	d = shape - 1.0 / 3.0;
+	double	c = 1.0 / sqrt(9.0 * d);
+
+	for (;;)
+	{
+		double	x = sqrt(-2.0 * log(nextOpenUniform(state))) * cos(2.0 * M_PI * nextOpenUniform(state));
+		double	v = 1.0 + c * x;
+
+		if (v <= 0.0)
+		{
+			continue;
+		}
+
+		v = v * v * v;
+		if (log(nextOpenUniform(state)) < 0.5 * x * x + d - d * v + d * log(v))
+		{
+			return d * v;
+		}
+	}
+}
+
+/*
+ *	Algorithm L: draws how many items to skip until the next replacement.
+ */
+static void
+scheduleNextReplacement(Reservoir *  reservoir)
+{
+	double	skip = floor(log(nextOpenUniform(reservoir->randomState)) / log1p(-exp(reservoir->logW)));
+
+	/*
+	 *	When W underflows to zero, `log1p(-1)` is `-inf` and `skip` is `+0`; guard the
+	 *	other extreme so that a huge skip saturates rather than overflowing.
+	 */
+	if (!(skip < 1.8e19))
+	{
+		reservoir->nextReplacementIndex = UINT64_MAX;
+
+		return;
+	}
+
+	reservoir->nextReplacementIndex = reservoir->numberOfItemsSeen + (uint64_t)skip;
+	reservoir->logW += log(nextOpenUniform(reservoir->randomState)) / reservoir->capacity;
+
+	return;
+}
+
+/*
+ *	Starts Algorithm L on a full reservoir. W is distributed as the largest of the `capacity`
+ *	smallest keys among `numberOfItemsSeen` uniform keys, i.e., Beta(k, n - k + 1). For a
+ *	reservoir that has just filled up, this is the max of k uniforms, which is cheaper to draw.
+ */
+static void
+startAlgorithmL(Reservoir *  reservoir)
+{
+	if (reservoir->numberOfItemsSeen == reservoir->capacity)
+	{
+		reservoir->logW = log(nextOpenUniform(reservoir->randomState)) / reservoir->capacity;
+	}
+	else
+	{
+		double	a = nextGamma(reservoir->randomState, (double)reservoir->capacity);
+		double	b = nextGamma(reservoir->randomState, (double)(reservoir->numberOfItemsSeen - reservoir->capacity + 1));
+
+		reservoir->logW = log(a) - log(a + b);
+	}
+
+	scheduleNextReplacement(reservoir);
+
+	return;
+}
+
+void
+streamingStatisticsAdd(StreamingStatistics *  statistics, double value)
+{
+	double	delta = value - statistics->mean;
+
+	statistics->count++;
+	statistics->mean += delta / statistics->count;
+	statistics->sumOfSquaredDeviations += delta * (value - statistics->mean);
+
+	return;
+}
+
+void
+streamingStatisticsMerge(StreamingStatistics *  destination, const StreamingStatistics *  source)
+{
+	uint64_t	count = destination->count + source->count;
+	double		delta = source->mean - destination->mean;
+
+	if (source->count == 0)
+	{
+		return;
+	}
+
+	destination->sumOfSquaredDeviations += source->sumOfSquaredDeviations
+						+ delta * delta * ((double)destination->count * source->count / count);
+	destination->mean += delta * source->count / count;
+	destination->count = count;
+
+	return;
+}
+
+MeanAndVariance
+streamingStatisticsGetMeanAndVariance(const StreamingStatistics *  statistics)
+{
+	return (MeanAndVariance)
+	{
+		.mean		= statistics->mean,
+		.variance	= (statistics->count > 1) ? statistics->sumOfSquaredDeviations / (statistics->count - 1) : 0.0,
+	};
+}
+
+void
+streamingCovarianceInit(StreamingCovariance *  covariance, size_t dimension)
+{
+	*covariance = (StreamingCovariance) {0};
+	covariance->dimension = (dimension < kStreamingCovarianceMaxDimension) ? dimension : kStreamingCovarianceMaxDimension;
+
+	return;
+}
+
+void
+streamingCovarianceAdd(StreamingCovariance *  covariance, const double *  values)
+{
+	double	delta[kStreamingCovarianceMaxDimension];
+	size_t	dimension = covariance->dimension;
+
+	covariance->count++;
+	for (size_t i = 0; i < dimension; i++)
+	{
+		delta[i] = values[i] - covariance->mean[i];
+		covariance->mean[i] += delta[i] / covariance->count;
+	}
+
+	/*
+	 *	Only the upper triangle is accumulated; `streamingCovarianceGet()` mirrors it.
+	 */
+	for (size_t i = 0; i < dimension; i++)
+	{
+		for (size_t j = i; j < dimension; j++)
+		{
+			covariance->comoment[i][j] += delta[i] * (values[j] - covariance->mean[j]);
+		}
+	}
+
+	return;
+}
+
+void
+streamingCovarianceMerge(StreamingCovariance *  destination, const StreamingCovariance *  source)
+{
+	uint64_t	count = destination->count + source->count;
+	double		delta[kStreamingCovarianceMaxDimension];
+	double		weight;
+
+	if (source->count == 0)
+	{
+		return;
+	}
+
+	weight = (double)destination->count * source->count / count;
+	for (size_t i = 0; i < destination->dimension; i++)
+	{
+		delta[i] = source->mean[i] - destination->mean[i];
+	}
+
+	for (size_t i = 0; i < destination->dimension; i++)
+	{
+		for (size_t j = i; j < destination->dimension; j++)
+		{
+			destination->comoment[i][j] += source->comoment[i][j] + delta[i] * delta[j] * weight;
+		}
+		destination->mean[i] += delta[i] * source->count / count;
+	}
+	destination->count = count;
+
+	return;
+}
+
+double
+streamingCovarianceGet(const StreamingCovariance *  covariance, size_t i, size_t j)
+{
+	if (covariance->count < 2)
+	{
+		return 0.0;
+	}
+
+	return ((i <= j) ? covariance->comoment[i][j] : covariance->comoment[j][i]) / (covariance->count - 1);
+}
+
+void
+histogram2DInit(Histogram2D *  histogram, double lowerBoundX, double upperBoundX, double lowerBoundY, double upperBoundY)
+{
+	*histogram = (Histogram2D)
+	{
+		.lowerBound	= {lowerBoundX, lowerBoundY},
+		.upperBound	= {upperBoundX, upperBoundY},
+	};
+
+	return;
+}
+
+static size_t
+histogram2DBin(const Histogram2D *  histogram, size_t axis, double value)
+{
+	double	position = (value - histogram->lowerBound[axis]) / (histogram->upperBound[axis] - histogram->lowerBound[axis]) * kHistogram2DNumberOfBins;
+
+	if (!(position > 0.0))
+	{
+		return 0;
+	}
+
+	return (position < kHistogram2DNumberOfBins) ? (size_t)position : kHistogram2DNumberOfBins - 1;
+}
+
+void
+histogram2DAdd(Histogram2D *  histogram, double x, double y)
+{
+	histogram->counts[histogram2DBin(histogram, 0, x)][histogram2DBin(histogram, 1, y)]++;
+
+	return;
+}
+
+void
+histogram2DMerge(Histogram2D *  destination, const Histogram2D *  source)
+{
+	for (size_t i = 0; i < kHistogram2DNumberOfBins; i++)
+	{
+		for (size_t j = 0; j < kHistogram2DNumberOfBins; j++)
+		{
+			destination->counts[i][j] += source->counts[i][j];
+		}
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+reservoirInit(Reservoir *  reservoir, size_t capacity, uint64_t seed)
+{
+	*reservoir = (Reservoir) {0};
+
+	if (capacity == 0)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	reservoir->samples = malloc(capacity * sizeof(double));
+	if (reservoir->samples == NULL)
+	{
+		fprintf(stderr, "Error: Could not allocate a reservoir of %zu samples.\n", capacity);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	reservoir->capacity = capacity;
+	for (size_t i = 0; i < 4; i++)
+	{
+		reservoir->randomState[i] = splitMix64(&seed);
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+reservoirAdd(Reservoir *  reservoir, double value)
+{
+	if (reservoir->count < reservoir->capacity)
+	{
+		reservoir->samples[reservoir->count++] = value;
+		reservoir->numberOfItemsSeen++;
+
+		if (reservoir->count == reservoir->capacity)
+		{
+			startAlgorithmL(reservoir);
+		}
+
+		return;
+	}
+
+	if (reservoir->numberOfItemsSeen++ == reservoir->nextReplacementIndex)
+	{
+		reservoir->samples[nextIndex(reservoir->randomState, reservoir->capacity)] = value;
+		scheduleNextReplacement(reservoir);
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+reservoirMerge(Reservoir *  destination, Reservoir *  source)
+{
+	double *	merged;
+	uint64_t	remainingInDestination = destination->numberOfItemsSeen;
+	uint64_t	remainingInSource = source->numberOfItemsSeen;
+	size_t		unusedInDestination = destination->count;
+	size_t		unusedInSource = source->count;
+	size_t		mergedCount;
+
+	if (destination->capacity != source->capacity)
+	{
+		fprintf(stderr, "Error: Cannot merge reservoirs of different capacities.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	mergedCount = (destination->count + source->count < destination->capacity) ? destination->count + source->count : destination->capacity;
+	merged = malloc(destination->capacity * sizeof(double));
+	if (merged == NULL)
+	{
+		fprintf(stderr, "Error: Could not allocate memory to merge reservoirs.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	Sample without replacement from the union of the two streams: each slot comes from
+	 *	a stream with probability proportional to its items not yet drawn, and is a random
+	 *	not-yet-used sample of that stream's reservoir (a uniform sample of the stream).
+	 */
+	for (size_t i = 0; i < mergedCount; i++)
+	{
+		bool		isFromDestination = (nextIndex(destination->randomState, remainingInDestination + remainingInSource) < remainingInDestination);
+		double *	samples = isFromDestination ? destination->samples : source->samples;
+		size_t *	unused = isFromDestination ? &unusedInDestination : &unusedInSource;
+		size_t		j = nextIndex(destination->randomState, *unused);
+
+		merged[i] = samples[j];
+		samples[j] = samples[--(*unused)];
+		if (isFromDestination)
+		{
+			remainingInDestination--;
+		}
+		else
+		{
+			remainingInSource--;
+		}
+	}
+
+	free(destination->samples);
+	destination->samples = merged;
+	destination->count = mergedCount;
+	destination->numberOfItemsSeen += source->numberOfItemsSeen;
+
+	if (destination->count == destination->capacity)
+	{
+		startAlgorithmL(destination);
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+reservoirFree(Reservoir *  reservoir)
+{
+	free(reservoir->samples);
+	*reservoir = (Reservoir) {0};
+
+	return;
+}
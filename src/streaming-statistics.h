@@ -0,0 +1,208 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "common.h"
+
+typedef enum
+{
+	kStreamingCovarianceMaxDimension	= 8,
+	kHistogram2DNumberOfBins		= 32,
+} StreamingStatisticsConstant;
+
+/*
+ *	Streaming mean and variance (Welford). Accumulators of parallel workers can
+ *	be combined with `streamingStatisticsMerge()`.
+ */
+typedef struct
+{
+	uint64_t	count;
+	double		mean;
+	double		sumOfSquaredDeviations;
+} StreamingStatistics;
+
+/*
+ *	Streaming mean vector and covariance matrix of a vector-valued stream. `comoment[i][j]`
+ *	is the sum of products of deviations from the running means. Mergeable like
+ *	`StreamingStatistics`.
+ */
+typedef struct
+{
+	size_t		dimension;
+	uint64_t	count;
+	double		mean[kStreamingCovarianceMaxDimension];
+	double		comoment[kStreamingCovarianceMaxDimension][kStreamingCovarianceMaxDimension];
+} StreamingCovariance;
+
+/*
+ *	Fixed-range 2-D histogram of pairs of values. Values outside the range are counted
+ *	in the nearest edge bin.
+ */
+typedef struct
+{
+	double		lowerBound[2];
+	double		upperBound[2];
+	uint64_t	counts[kHistogram2DNumberOfBins][kHistogram2DNumberOfBins];
+} Histogram2D;
+
+/*
+ *	Bounded-memory uniform random sample of a stream (reservoir sampling, Algorithm L).
+ *	After `numberOfItemsSeen` items, `samples` holds `min(capacity, numberOfItemsSeen)`
+ *	items, chosen uniformly at random without replacement. Items that are not kept only
+ *	cost a counter comparison.
+ */
+typedef struct
+{
+	double *	samples;
+	size_t		capacity;
+	size_t		count;
+	uint64_t	numberOfItemsSeen;
+	uint64_t	nextReplacementIndex;
+	double		logW;
+	uint64_t	randomState[4];
+} Reservoir;
+
+/**
+ *	@brief	Adds a value to streaming statistics.
+ *
+ *	@param	statistics	: Pointer to the statistics. Zero-initialize before the first value.
+ *	@param	value		: The value to add.
+ */
+void			streamingStatisticsAdd(StreamingStatistics *  statistics, double value);
+
+/**
+ *	@brief	Merges the statistics of two disjoint streams (Chan et al.).
+ *
+ *	@param	destination	: Pointer to the statistics to merge into.
+ *	@param	source		: Pointer to the statistics to merge from.
+ */
+void			streamingStatisticsMerge(StreamingStatistics *  destination, const StreamingStatistics *  source);
+
+/**
+ *	@brief	Returns the mean and unbiased sample variance of the values added so far.
+ *
+ *	@param	statistics	: Pointer to the statistics.
+ *	@return			: The mean and variance.
+ */
+MeanAndVariance		streamingStatisticsGetMeanAndVariance(const StreamingStatistics *  statistics);
+
+/**
+ *	@brief	Resets streaming covariance for vectors of the given dimension.
+ *
+ *	@param	covariance	: Pointer to the streaming covariance.
+ *	@param	dimension	: The dimension of the vectors, at most `kStreamingCovarianceMaxDimension`.
+ */
+void			streamingCovarianceInit(StreamingCovariance *  covariance, size_t dimension);
+
+/**
+ *	@brief	Adds a vector to streaming covariance.
+ *
+ *	@param	covariance	: Pointer to the streaming covariance.
+ *	@param	values		: The vector to add, of `covariance->dimension` values.
+ */
+void			streamingCovarianceAdd(StreamingCovariance *  covariance, const double *  values);
+
+/**
+ *	@brief	Merges the streaming covariance of two disjoint streams of the same dimension.
+ *
+ *	@param	destination	: Pointer to the streaming covariance to merge into.
+ *	@param	source		: Pointer to the streaming covariance to merge from.
+ */
+void			streamingCovarianceMerge(StreamingCovariance *  destination, const StreamingCovariance *  source);
+
+/**
+ *	@brief	Returns an entry of the unbiased sample covariance matrix.
+ *
+ *	@param	covariance	: Pointer to the streaming covariance.
+ *	@param	i		: Row index.
+ *	@param	j		: Column index.
+ *	@return			: The sample covariance of components `i` and `j`.
+ */
+double			streamingCovarianceGet(const StreamingCovariance *  covariance, size_t i, size_t j);
+
+/**
+ *	@brief	Resets a 2-D histogram.
+ *
+ *	@param	histogram	: Pointer to the histogram.
+ *	@param	lowerBoundX	: Lower bound of the first value.
+ *	@param	upperBoundX	: Upper bound of the first value.
+ *	@param	lowerBoundY	: Lower bound of the second value.
+ *	@param	upperBoundY	: Upper bound of the second value.
+ */
+void			histogram2DInit(Histogram2D *  histogram, double lowerBoundX, double upperBoundX, double lowerBoundY, double upperBoundY);
+
+/**
+ *	@brief	Adds a pair of values to a 2-D histogram.
+ *
+ *	@param	histogram	: Pointer to the histogram.
+ *	@param	x		: The first value.
+ *	@param	y		: The second value.
+ */
+void			histogram2DAdd(Histogram2D *  histogram, double x, double y);
+
+/**
+ *	@brief	Merges the counts of a 2-D histogram with the same bounds.
+ *
+ *	@param	destination	: Pointer to the histogram to merge into.
+ *	@param	source		: Pointer to the histogram to merge from.
+ */
+void			histogram2DMerge(Histogram2D *  destination, const Histogram2D *  source);
+
+/**
+ *	@brief	Allocates an empty reservoir.
+ *
+ *	@param	reservoir	: Pointer to the reservoir.
+ *	@param	capacity	: The maximum number of samples kept.
+ *	@param	seed		: Seed of the reservoir's random number generator. Parallel workers
+ *				  must use different seeds.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	reservoirInit(Reservoir *  reservoir, size_t capacity, uint64_t seed);
+
+/**
+ *	@brief	Offers a value of the stream to the reservoir.
+ *
+ *	@param	reservoir	: Pointer to the reservoir.
+ *	@param	value		: The value to add.
+ */
+void			reservoirAdd(Reservoir *  reservoir, double value);
+
+/**
+ *	@brief	Merges the reservoir of a disjoint stream into `destination`, so that it holds a uniform
+ *		sample of the union of both streams. Both reservoirs must have the same capacity. The
+ *		merged reservoir keeps accepting values with `reservoirAdd()`.
+ *
+ *	@param	destination	: Pointer to the reservoir to merge into.
+ *	@param	source		: Pointer to the reservoir to merge from. Its samples are reordered.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	reservoirMerge(Reservoir *  destination, Reservoir *  source);
+
+/**
+ *	@brief	Frees the samples of a reservoir.
+ *
+ *	@param	reservoir	: Pointer to the reservoir.
+ */
+void			reservoirFree(Reservoir *  reservoir);
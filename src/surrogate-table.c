@@ -0,0 +1,540 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "surrogate-table.h"
+
+static const char	kSurrogateTableFileMagic[8] = {'S', 'G', 'S', 'U', 'R', 'R', 'T', '1'};
+static const uint32_t	kSurrogateTableByteOrderMark = 0x01020304;
+
+const double		kSurrogateTableQuantileProbabilities[kSurrogateTableNumberOfQuantiles] = {0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99};
+const char *		kSurrogateTableQuantileKeys[kSurrogateTableNumberOfQuantiles] = {"p01", "p05", "p25", "p50", "p75", "p95", "p99"};
+
+/*
+ *	Each output that the table answers is `offset + slope * ratio`.
+ */
+typedef struct
+{
+	SurrogateTableRatio	ratio;
+	double			offset;
+	double			slope;
+} SurrogateTableOutputMap;
+
+static const InputDistributionIndex	kSurrogateTableRatioNumerators[kSurrogateTableRatioMax] =
+{
+	[kSurrogateTableRatioVrhOverVsupply]	= kInputDistributionIndexVrh,
+	[kSurrogateTableRatioVtOverVsupply]	= kInputDistributionIndexVt,
+};
+
+/*
+ *	Gets the affine map of an output in the tabulated ratios from the channel of a
+ *	ratiometric sensor model. Other outputs and models are not answered by the table.
+ */
+static bool
+getOutputMap(const SensorModel *  model, size_t output, SurrogateTableOutputMap *  map)
+{
+	if ((model->transfer != kSensorModelTransferRatiometric) || (output >= kSensorModelChannelMax))
+	{
+		return false;
+	}
+
+	for (size_t ratio = 0; ratio < kSurrogateTableRatioMax; ratio++)
+	{
+		if (kSurrogateTableRatioNumerators[ratio] == model->channels[output].input)
+		{
+			*map = (SurrogateTableOutputMap) {
+					.ratio	= ratio,
+					.offset	= model->channels[output].offset,
+					.slope	= model->channels[output].slope,
+				};
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ *	FNV-1a checksum of the header, with its checksum field zero, and of the statistics.
+ */
+static uint64_t
+checksumTable(const SurrogateTableFileHeader *  header, const double *  values, size_t numberOfValues)
+{
+	SurrogateTableFileHeader	copy = *header;
+	uint64_t			hash = 0xCBF29CE484222325ULL;
+	const unsigned char *		bytes;
+
+	copy.checksum = 0;
+	bytes = (const unsigned char *)&copy;
+	for (size_t i = 0; i < sizeof(copy); i++)
+	{
+		hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+	}
+
+	bytes = (const unsigned char *)values;
+	for (size_t i = 0; i < numberOfValues * sizeof(double); i++)
+	{
+		hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+	}
+
+	return hash;
+}
+
+static size_t
+numberOfTableValues(const SurrogateTableFileHeader *  header)
+{
+	return (size_t)(kSurrogateTableRatioMax * header->numberOfNumeratorNodes * header->numberOfSupplyNodes * header->numberOfStatistics);
+}
+
+static void
+setGridScales(SurrogateTable *  table)
+{
+	table->numeratorNodesPerVolt = (double)(table->header.numberOfNumeratorNodes - 1) / (table->header.numeratorCentreHigh - table->header.numeratorCentreLow);
+	table->supplyNodesPerVolt = (double)(table->header.numberOfSupplyNodes - 1) / (table->header.supplyCentreHigh - table->header.supplyCentreLow);
+
+	return;
+}
+
+/**
+ *	@brief	Exact statistics of the ratio of a uniform numerator and a uniform supply voltage:
+ *		`E[X / Y] = E[X] E[1 / Y]` and `E[(X / Y)^2] = E[X^2] E[1 / Y^2]` by independence,
+ *		and the quantiles by bisection on the distribution function.
+ */
+static void
+computeRatioStatistics(
+	double	numeratorCentre,
+	double	numeratorHalfWidth,
+	double	supplyCentre,
+	double	supplyHalfWidth,
+	double	statistics[kSurrogateTableStatisticMax])
+{
+	double	x0 = numeratorCentre - numeratorHalfWidth;
+	double	x1 = numeratorCentre + numeratorHalfWidth;
+	double	y0 = supplyCentre - supplyHalfWidth;
+	double	y1 = supplyCentre + supplyHalfWidth;
+	double	mean = numeratorCentre * log(y1 / y0) / (y1 - y0);
+	double	meanOfSquares = (numeratorCentre * numeratorCentre + numeratorHalfWidth * numeratorHalfWidth / 3.0) / (y0 * y1);
+
+	statistics[kSurrogateTableStatisticMean] = mean;
+	statistics[kSurrogateTableStatisticStandardDeviation] = sqrt(fmax(meanOfSquares - mean * mean, 0.0));
+
+	for (size_t q = 0; q < kSurrogateTableNumberOfQuantiles; q++)
+	{
+		double	low = x0 / y1;
+		double	high = x1 / y0;
+
+		for (int iteration = 0; iteration < 200; iteration++)
+		{
+			double	middle = 0.5 * (low + high);
+
+			if ((middle <= low) || (middle >= high))
+			{
+				break;
+			}
+
+			if (sensorModelRatioDistributionFunction(middle, x0, x1, y0, y1) < kSurrogateTableQuantileProbabilities[q])
+			{
+				low = middle;
+			}
+			else
+			{
+				high = middle;
+			}
+		}
+
+		statistics[kSurrogateTableStatisticFirstQuantile + q] = 0.5 * (low + high);
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Bilinear interpolation of the statistics of one ratio at the given centres, which
+ *		must be within the grid.
+ */
+static void
+interpolateRatioStatistics(
+	const SurrogateTable *	table,
+	SurrogateTableRatio	ratio,
+	double			numeratorCentre,
+	double			supplyCentre,
+	double			statistics[kSurrogateTableStatisticMax])
+{
+	const SurrogateTableFileHeader *	header = &table->header;
+	size_t					numberOfStatistics = (size_t)header->numberOfStatistics;
+	size_t					supplyNodes = (size_t)header->numberOfSupplyNodes;
+	double					x = (numeratorCentre - header->numeratorCentreLow) * table->numeratorNodesPerVolt;
+	double					y = (supplyCentre - header->supplyCentreLow) * table->supplyNodesPerVolt;
+	size_t					i = (size_t)x;
+	size_t					j = (size_t)y;
+	double					tx;
+	double					ty;
+	const double *				node00;
+	const double *				node01;
+	const double *				node10;
+	const double *				node11;
+
+	i = (i < header->numberOfNumeratorNodes - 1) ? i : (size_t)header->numberOfNumeratorNodes - 2;
+	j = (j < supplyNodes - 1) ? j : supplyNodes - 2;
+	tx = x - (double)i;
+	ty = y - (double)j;
+
+	node00 = table->values + ((ratio * header->numberOfNumeratorNodes + i) * supplyNodes + j) * numberOfStatistics;
+	node01 = node00 + numberOfStatistics;
+	node10 = node00 + supplyNodes * numberOfStatistics;
+	node11 = node10 + numberOfStatistics;
+
+	for (size_t s = 0; s < kSurrogateTableStatisticMax; s++)
+	{
+		statistics[s] = (1.0 - tx) * ((1.0 - ty) * node00[s] + ty * node01[s])
+				+ tx * ((1.0 - ty) * node10[s] + ty * node11[s]);
+	}
+
+	return;
+}
+
+/*
+ *	Largest difference between the exact and interpolated statistics of one ratio at
+ *	the given centres.
+ */
+static double
+interpolationError(const SurrogateTable *  table, SurrogateTableRatio ratio, double numeratorCentre, double supplyCentre)
+{
+	double	exact[kSurrogateTableStatisticMax];
+	double	interpolated[kSurrogateTableStatisticMax];
+	double	error = 0.0;
+
+	computeRatioStatistics(
+		numeratorCentre,
+		table->header.halfWidth[kSurrogateTableRatioNumerators[ratio]],
+		supplyCentre,
+		table->header.halfWidth[kInputDistributionIndexVsupply],
+		exact);
+	interpolateRatioStatistics(table, ratio, numeratorCentre, supplyCentre, interpolated);
+
+	for (size_t s = 0; s < kSurrogateTableStatisticMax; s++)
+	{
+		error = fmax(error, fabs(exact[s] - interpolated[s]));
+	}
+
+	return error;
+}
+
+CommonConstantReturnType
+surrogateTableBuild(const char *  filePath)
+{
+	SurrogateTable	table = {
+				.header = {
+					.version			= kSurrogateTableFileVersion,
+					.byteOrderMark			= kSurrogateTableByteOrderMark,
+					.numberOfNumeratorNodes		= kSurrogateTableNumeratorNodes,
+					.numberOfSupplyNodes		= kSurrogateTableSupplyNodes,
+					.numberOfStatistics		= kSurrogateTableStatisticMax,
+					.numeratorCentreLow		= kSurrogateTableNumeratorCentreLow,
+					.numeratorCentreHigh		= kSurrogateTableNumeratorCentreHigh,
+					.supplyCentreLow		= kSurrogateTableSupplyCentreLow,
+					.supplyCentreHigh		= kSurrogateTableSupplyCentreHigh,
+					.halfWidth			= {
+						[kInputDistributionIndexVrh]		= (kDefaultInputDistributionVrhUniformDistHigh - kDefaultInputDistributionVrhUniformDistLow) / 2,
+						[kInputDistributionIndexVt]		= (kDefaultInputDistributionVtUniformDistHigh - kDefaultInputDistributionVtUniformDistLow) / 2,
+						[kInputDistributionIndexVsupply]	= (kDefaultInputDistributionVsupplyUniformDistHigh - kDefaultInputDistributionVsupplyUniformDistLow) / 2,
+					},
+				},
+			};
+	SurrogateTableFileHeader *	header = &table.header;
+	double				numeratorStep = (kSurrogateTableNumeratorCentreHigh - kSurrogateTableNumeratorCentreLow) / (kSurrogateTableNumeratorNodes - 1);
+	double				supplyStep = (kSurrogateTableSupplyCentreHigh - kSurrogateTableSupplyCentreLow) / (kSurrogateTableSupplyNodes - 1);
+	size_t				numberOfValues = numberOfTableValues(header);
+	char				temporaryFilePath[kCommonConstantMaxCharsPerFilepath];
+	FILE *				file;
+	bool				hasError = false;
+
+	/*
+	 *	The distribution function above assumes positive voltages everywhere on the grid.
+	 */
+	for (size_t ratio = 0; ratio < kSurrogateTableRatioMax; ratio++)
+	{
+		if ((kSurrogateTableNumeratorCentreLow - header->halfWidth[kSurrogateTableRatioNumerators[ratio]] <= 0.0)
+			|| (kSurrogateTableSupplyCentreLow - header->halfWidth[kInputDistributionIndexVsupply] <= 0.0))
+		{
+			fprintf(stderr, "Error: The surrogate table grid must only cover positive input voltages.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	memcpy(header->magic, kSurrogateTableFileMagic, sizeof(header->magic));
+	memcpy(header->quantileProbabilities, kSurrogateTableQuantileProbabilities, sizeof(header->quantileProbabilities));
+
+	setGridScales(&table);
+	table.values = malloc(numberOfValues * sizeof(double));
+	if (table.values == NULL)
+	{
+		fprintf(stderr, "Error: Could not allocate memory for the surrogate table.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t ratio = 0; ratio < kSurrogateTableRatioMax; ratio++)
+	{
+		for (size_t i = 0; i < kSurrogateTableNumeratorNodes; i++)
+		{
+			for (size_t j = 0; j < kSurrogateTableSupplyNodes; j++)
+			{
+				computeRatioStatistics(
+					kSurrogateTableNumeratorCentreLow + i * numeratorStep,
+					header->halfWidth[kSurrogateTableRatioNumerators[ratio]],
+					kSurrogateTableSupplyCentreLow + j * supplyStep,
+					header->halfWidth[kInputDistributionIndexVsupply],
+					&table.values[((ratio * kSurrogateTableNumeratorNodes + i) * kSurrogateTableSupplyNodes + j) * kSurrogateTableStatisticMax]);
+			}
+		}
+	}
+
+	/*
+	 *	Bilinear interpolation is exact at the nodes and linear along the cell edges, so its
+	 *	error peaks inside the cells: measure it at the centre and the edge midpoints of each.
+	 */
+	for (size_t ratio = 0; ratio < kSurrogateTableRatioMax; ratio++)
+	{
+		double	errorBound = 0.0;
+
+		for (size_t i = 0; i + 1 < kSurrogateTableNumeratorNodes; i++)
+		{
+			for (size_t j = 0; j + 1 < kSurrogateTableSupplyNodes; j++)
+			{
+				double	numeratorCentre = kSurrogateTableNumeratorCentreLow + i * numeratorStep;
+				double	supplyCentre = kSurrogateTableSupplyCentreLow + j * supplyStep;
+
+				errorBound = fmax(errorBound, interpolationError(&table, ratio, numeratorCentre + numeratorStep / 2, supplyCentre + supplyStep / 2));
+				errorBound = fmax(errorBound, interpolationError(&table, ratio, numeratorCentre + numeratorStep / 2, supplyCentre));
+				errorBound = fmax(errorBound, interpolationError(&table, ratio, numeratorCentre, supplyCentre + supplyStep / 2));
+			}
+		}
+
+		header->errorBound[ratio] = errorBound;
+	}
+
+	header->checksum = checksumTable(header, table.values, numberOfValues);
+
+	if (snprintf(temporaryFilePath, sizeof(temporaryFilePath), "%s.tmp", filePath) >= (int)sizeof(temporaryFilePath))
+	{
+		fprintf(stderr, "Error: The surrogate table file path is too long.\n");
+		surrogateTableFree(&table);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	file = fopen(temporaryFilePath, "wb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open the surrogate table file \"%s\" for writing.\n", temporaryFilePath);
+		surrogateTableFree(&table);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	hasError |= (fwrite(header, sizeof(*header), 1, file) != 1);
+	hasError |= (fwrite(table.values, sizeof(double), numberOfValues, file) != numberOfValues);
+	hasError |= (fclose(file) != 0);
+
+	surrogateTableFree(&table);
+
+	if (hasError || (rename(temporaryFilePath, filePath) != 0))
+	{
+		fprintf(stderr, "Error: Could not write the surrogate table file \"%s\".\n", filePath);
+		remove(temporaryFilePath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+surrogateTableLoad(SurrogateTable *  table, const char *  filePath)
+{
+	SurrogateTableFileHeader *	header = &table->header;
+	FILE *				file = fopen(filePath, "rb");
+	size_t				numberOfValues;
+	bool				isValid;
+
+	*table = (SurrogateTable) {0};
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open the surrogate table file \"%s\".\n", filePath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	isValid = (fread(header, sizeof(*header), 1, file) == 1)
+			&& (memcmp(header->magic, kSurrogateTableFileMagic, sizeof(header->magic)) == 0)
+			&& (header->version == kSurrogateTableFileVersion)
+			&& (header->byteOrderMark == kSurrogateTableByteOrderMark)
+			&& (header->numberOfNumeratorNodes >= 2) && (header->numberOfNumeratorNodes <= 65536)
+			&& (header->numberOfSupplyNodes >= 2) && (header->numberOfSupplyNodes <= 65536)
+			&& (header->numberOfStatistics == kSurrogateTableStatisticMax)
+			&& (header->numeratorCentreHigh > header->numeratorCentreLow)
+			&& (header->supplyCentreHigh > header->supplyCentreLow)
+			&& (memcmp(header->quantileProbabilities, kSurrogateTableQuantileProbabilities, sizeof(header->quantileProbabilities)) == 0);
+
+	if (isValid)
+	{
+		numberOfValues = numberOfTableValues(header);
+		table->values = malloc(numberOfValues * sizeof(double));
+		isValid = (table->values != NULL)
+				&& (fread(table->values, sizeof(double), numberOfValues, file) == numberOfValues)
+				&& (fgetc(file) == EOF)
+				&& (header->checksum == checksumTable(header, table->values, numberOfValues));
+	}
+	fclose(file);
+
+	if (!isValid)
+	{
+		fprintf(stderr, "Error: \"%s\" is not a valid surrogate table file, or it is corrupted or from a host with another byte order.\n", filePath);
+		surrogateTableFree(table);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	setGridScales(table);
+
+	if ((header->halfWidth[kInputDistributionIndexVrh] != (kDefaultInputDistributionVrhUniformDistHigh - kDefaultInputDistributionVrhUniformDistLow) / 2)
+		|| (header->halfWidth[kInputDistributionIndexVt] != (kDefaultInputDistributionVtUniformDistHigh - kDefaultInputDistributionVtUniformDistLow) / 2)
+		|| (header->halfWidth[kInputDistributionIndexVsupply] != (kDefaultInputDistributionVsupplyUniformDistHigh - kDefaultInputDistributionVsupplyUniformDistLow) / 2))
+	{
+		fprintf(stderr, "Warning: The surrogate table \"%s\" was built for other input widths, so all readings fall back to Monte Carlo.\n", filePath);
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+bool
+surrogateTableLookup(
+	const SurrogateTable *		table,
+	const SensorModel *		model,
+	const BatchReading *		reading,
+	size_t				lowerOutput,
+	size_t				upperOutput,
+	BatchReadingSummary *		summary,
+	SurrogateTableQuantiles *	quantiles)
+{
+	const SurrogateTableFileHeader *	header = &table->header;
+	double					ratioStatistics[kSurrogateTableRatioMax][kSurrogateTableStatisticMax];
+	SurrogateTableOutputMap			maps[kSensorModelChannelMax];
+	bool					isRatioNeeded[kSurrogateTableRatioMax] = {false};
+	double					supplyCentre;
+
+	for (size_t output = lowerOutput; output < upperOutput; output++)
+	{
+		if (!getOutputMap(model, output, &maps[output]))
+		{
+			return false;
+		}
+	}
+
+	for (size_t input = 0; input < kInputDistributionIndexMax; input++)
+	{
+		double	halfWidth = (reading->upperBound[input] - reading->lowerBound[input]) / 2;
+
+		if (fabs(halfWidth - header->halfWidth[input]) > 1e-9 * header->halfWidth[input])
+		{
+			return false;
+		}
+	}
+
+	supplyCentre = (reading->lowerBound[kInputDistributionIndexVsupply] + reading->upperBound[kInputDistributionIndexVsupply]) / 2;
+	if (!((supplyCentre >= header->supplyCentreLow) && (supplyCentre <= header->supplyCentreHigh)))
+	{
+		return false;
+	}
+
+	for (size_t output = lowerOutput; output < upperOutput; output++)
+	{
+		isRatioNeeded[maps[output].ratio] = true;
+	}
+
+	for (size_t ratio = 0; ratio < kSurrogateTableRatioMax; ratio++)
+	{
+		InputDistributionIndex	numerator = kSurrogateTableRatioNumerators[ratio];
+		double			numeratorCentre = (reading->lowerBound[numerator] + reading->upperBound[numerator]) / 2;
+
+		if (!isRatioNeeded[ratio])
+		{
+			continue;
+		}
+
+		if (!((numeratorCentre >= header->numeratorCentreLow) && (numeratorCentre <= header->numeratorCentreHigh)))
+		{
+			return false;
+		}
+
+		interpolateRatioStatistics(table, ratio, numeratorCentre, supplyCentre, ratioStatistics[ratio]);
+	}
+
+	summary->numberOfSamples = 0;
+	quantiles->isFromTable = true;
+
+	for (size_t output = lowerOutput; output < upperOutput; output++)
+	{
+		const SurrogateTableOutputMap *	map = &maps[output];
+		const double *			statistics = ratioStatistics[map->ratio];
+		InputDistributionIndex		numerator = kSurrogateTableRatioNumerators[map->ratio];
+		double				ratioMinimum = reading->lowerBound[numerator] / reading->upperBound[kInputDistributionIndexVsupply];
+		double				ratioMaximum = reading->upperBound[numerator] / reading->lowerBound[kInputDistributionIndexVsupply];
+		double				standardDeviation = fabs(map->slope) * statistics[kSurrogateTableStatisticStandardDeviation];
+
+		summary->mean[output] = map->offset + map->slope * statistics[kSurrogateTableStatisticMean];
+		summary->variance[output] = standardDeviation * standardDeviation;
+		summary->minimum[output] = map->offset + map->slope * ((map->slope >= 0.0) ? ratioMinimum : ratioMaximum);
+		summary->maximum[output] = map->offset + map->slope * ((map->slope >= 0.0) ? ratioMaximum : ratioMinimum);
+
+		/*
+		 *	A negative slope reverses the order of the quantiles. The probabilities are
+		 *	symmetric about the median.
+		 */
+		for (size_t q = 0; q < kSurrogateTableNumberOfQuantiles; q++)
+		{
+			size_t	ratioQuantile = (map->slope >= 0.0) ? q : kSurrogateTableNumberOfQuantiles - 1 - q;
+
+			quantiles->quantile[output][q] = map->offset + map->slope * statistics[kSurrogateTableStatisticFirstQuantile + ratioQuantile];
+		}
+
+		quantiles->errorBound[output] = fabs(map->slope) * header->errorBound[map->ratio];
+	}
+
+	return true;
+}
+
+void
+surrogateTableFree(SurrogateTable *  table)
+{
+	free(table->values);
+	*table = (SurrogateTable) {0};
+
+	return;
+}
@@ -0,0 +1,174 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "batch-engine.h"
+#include "common.h"
+#include "utilities-config.h"
+
+typedef enum
+{
+	/*
+	 *	Grid nodes along the centre of the ratiometric voltage and along the centre of the
+	 *	supply voltage, over the ranges set in `utilities-config.h`.
+	 */
+	kSurrogateTableNumeratorNodes	= 65,
+	kSurrogateTableSupplyNodes	= 33,
+	kSurrogateTableNumberOfQuantiles	= 7,
+	kSurrogateTableFileVersion	= 1,
+} SurrogateTableConstant;
+
+/*
+ *	Voltage ratios tabulated. The humidity and temperature outputs are affine in them.
+ */
+typedef enum
+{
+	kSurrogateTableRatioVrhOverVsupply	= 0,
+	kSurrogateTableRatioVtOverVsupply	= 1,
+	kSurrogateTableRatioMax,
+} SurrogateTableRatio;
+
+/*
+ *	Statistics tabulated at each grid node, for each ratio.
+ */
+typedef enum
+{
+	kSurrogateTableStatisticMean			= 0,
+	kSurrogateTableStatisticStandardDeviation	= 1,
+	kSurrogateTableStatisticFirstQuantile		= 2,
+	kSurrogateTableStatisticMax			= kSurrogateTableStatisticFirstQuantile + kSurrogateTableNumberOfQuantiles,
+} SurrogateTableStatistic;
+
+/*
+ *	Probabilities of the tabulated quantiles, and their names in the batch outputs.
+ */
+extern const double	kSurrogateTableQuantileProbabilities[kSurrogateTableNumberOfQuantiles];
+extern const char *	kSurrogateTableQuantileKeys[kSurrogateTableNumberOfQuantiles];
+
+/*
+ *	Header at the start of a surrogate table file. The file continues with the `double`
+ *	statistics, indexed as [ratio][numerator node][supply node][statistic]. `errorBound` is
+ *	the largest interpolation error of any statistic of each ratio, measured when the
+ *	table was built. All fields are in host byte order, which `byteOrderMark` records.
+ */
+typedef struct
+{
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	byteOrderMark;
+	uint64_t	numberOfNumeratorNodes;
+	uint64_t	numberOfSupplyNodes;
+	uint64_t	numberOfStatistics;
+	double		numeratorCentreLow;
+	double		numeratorCentreHigh;
+	double		supplyCentreLow;
+	double		supplyCentreHigh;
+	double		halfWidth[kInputDistributionIndexMax];
+	double		quantileProbabilities[kSurrogateTableNumberOfQuantiles];
+	double		errorBound[kSurrogateTableRatioMax];
+	uint64_t	checksum;
+} SurrogateTableFileHeader;
+
+/*
+ *	A surrogate table loaded into memory. The grid spacings are kept as reciprocals, so that a
+ *	lookup does not divide.
+ */
+typedef struct
+{
+	SurrogateTableFileHeader	header;
+	double *			values;
+	double				numeratorNodesPerVolt;
+	double				supplyNodesPerVolt;
+} SurrogateTable;
+
+/*
+ *	Quantiles of the outputs of one reading answered from the table, and the error bound of
+ *	each output, in the units of the output, that applies to its mean, standard deviation
+ *	and quantiles.
+ */
+typedef struct
+{
+	double	quantile[kOutputDistributionIndexMax][kSurrogateTableNumberOfQuantiles];
+	double	errorBound[kOutputDistributionIndexMax];
+	bool	isFromTable;
+} SurrogateTableQuantiles;
+
+/**
+ *	@brief	Builds a surrogate table file. The statistics at each grid node are exact: the
+ *		moments of the ratio of two independent uniforms are in closed form, and the
+ *		quantiles invert its piecewise closed-form distribution function by bisection.
+ *		The error bound of each ratio is the largest difference between the exact
+ *		statistics and the interpolated ones at the centres and edge midpoints of all
+ *		grid cells. The file is written to a temporary path and renamed once complete.
+ *
+ *	@param	filePath	: Path of the table file to write.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	surrogateTableBuild(const char *  filePath);
+
+/**
+ *	@brief	Loads a surrogate table file into memory and checks its header and checksum.
+ *		Warns if the table was built for other input widths, since no reading can
+ *		then be answered from it.
+ *
+ *	@param	table		: Pointer to the table to load.
+ *	@param	filePath	: Path of the table file.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	surrogateTableLoad(SurrogateTable *  table, const char *  filePath);
+
+/**
+ *	@brief	Answers the summary of one reading by bilinear interpolation in the table. The
+ *		minimum and maximum follow exactly from the input bounds. A reading is in the
+ *		domain of the table if the widths of its inputs are those of the table, the centres
+ *		of its inputs are within the grid, and the outputs from `lowerOutput` up to, but
+ *		not including, `upperOutput` are affine in the tabulated ratios, which holds for the
+ *		calibrated outputs of ratiometric sensor models.
+ *
+ *	@param	table		: Pointer to the loaded table.
+ *	@param	model		: Pointer to the sensor model, whose channels give the affine maps.
+ *	@param	reading		: Pointer to the reading.
+ *	@param	lowerOutput	: The first output to answer.
+ *	@param	upperOutput	: One past the last output to answer.
+ *	@param	summary		: Pointer to the summary, whose selected outputs are set, and whose `numberOfSamples` is set to zero.
+ *	@param	quantiles	: Pointer to the quantiles and error bounds, whose selected outputs are set.
+ *	@return			: `true` if the reading is in the domain of the table and was answered, else `false`.
+ */
+bool	surrogateTableLookup(
+		const SurrogateTable *		table,
+		const SensorModel *		model,
+		const BatchReading *		reading,
+		size_t				lowerOutput,
+		size_t				upperOutput,
+		BatchReadingSummary *		summary,
+		SurrogateTableQuantiles *	quantiles);
+
+/**
+ *	@brief	Frees a loaded table.
+ *
+ *	@param	table	: Pointer to the loaded table.
+ */
+void	surrogateTableFree(SurrogateTable *  table);
@@ -0,0 +1,597 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "time-series.h"
+
+static const char	kTimeSeriesFileMagic[8] = {'S', 'G', 'T', 'S', 'E', 'R', 'S', '1'};
+static const uint32_t	kTimeSeriesByteOrderMark = 0x01020304;
+
+/*
+ *	Buckets of the difference of successive time differences, after a prefix of one to
+ *	four bits: zero, then ranges of 7, 9 and 12 bits. Others are stored in 64 bits.
+ */
+static const size_t	kTimeSeriesDeltaBucketBits[] = {7, 9, 12};
+
+enum
+{
+	kTimeSeriesNumberOfDeltaBuckets	= sizeof(kTimeSeriesDeltaBucketBits) / sizeof(kTimeSeriesDeltaBucketBits[0]),
+	kTimeSeriesMaxLeadingZeros	= 31,
+	kTimeSeriesBlockStreamBits	= 8 * (kTimeSeriesBlockBytes - sizeof(TimeSeriesBlockHeader)),
+};
+
+static inline size_t
+countLeadingZeros(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return (size_t)__builtin_clzll(value);
+#else
+	size_t	count = 0;
+
+	while ((value & (UINT64_C(1) << 63)) == 0)
+	{
+		value <<= 1;
+		count++;
+	}
+
+	return count;
+#endif
+}
+
+static inline size_t
+countTrailingZeros(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return (size_t)__builtin_ctzll(value);
+#else
+	size_t	count = 0;
+
+	while ((value & 1) == 0)
+	{
+		value >>= 1;
+		count++;
+	}
+
+	return count;
+#endif
+}
+
+static void
+resetBlock(TimeSeriesBlock *  block)
+{
+	memset(block, 0, sizeof(*block));
+
+	return;
+}
+
+/*
+ *	Appends the low `count` bits of `value`, most significant first.
+ */
+static void
+writeBits(TimeSeriesBlock *  block, uint64_t value, size_t count)
+{
+	while (count > 0)
+	{
+		size_t	freeBits = 8 - (block->bitPosition & 7);
+		size_t	take = (count < freeBits) ? count : freeBits;
+		uint8_t	chunk = (uint8_t)((value >> (count - take)) & ((1U << take) - 1));
+
+		block->bits[block->bitPosition >> 3] |= (uint8_t)(chunk << (freeBits - take));
+		block->bitPosition += take;
+		count -= take;
+	}
+
+	return;
+}
+
+/*
+ *	Reads `count` bits into `value`. Returns false past the end of the stream of the block.
+ */
+static bool
+readBits(TimeSeriesBlock *  block, size_t count, uint64_t *  value)
+{
+	if (block->bitPosition + count > block->header.numberOfBits)
+	{
+		return false;
+	}
+
+	*value = 0;
+	while (count > 0)
+	{
+		size_t	freeBits = 8 - (block->bitPosition & 7);
+		size_t	take = (count < freeBits) ? count : freeBits;
+		uint8_t	chunk = (uint8_t)((block->bits[block->bitPosition >> 3] >> (freeBits - take)) & ((1U << take) - 1));
+
+		*value = (take == 64) ? chunk : ((*value << take) | chunk);
+		block->bitPosition += take;
+		count -= take;
+	}
+
+	return true;
+}
+
+static void
+encodeTime(TimeSeriesBlock *  block, int64_t time)
+{
+	int64_t	delta;
+	int64_t	deltaOfDelta;
+
+	if (block->header.numberOfRecords == 0)
+	{
+		block->header.firstTime = time;
+		block->previousTime = time;
+		block->previousDelta = 0;
+
+		return;
+	}
+
+	delta = (int64_t)((uint64_t)time - (uint64_t)block->previousTime);
+	deltaOfDelta = (int64_t)((uint64_t)delta - (uint64_t)block->previousDelta);
+	block->previousTime = time;
+	block->previousDelta = delta;
+
+	if (deltaOfDelta == 0)
+	{
+		writeBits(block, 0, 1);
+
+		return;
+	}
+
+	for (size_t bucket = 0; bucket < kTimeSeriesNumberOfDeltaBuckets; bucket++)
+	{
+		size_t	bits = kTimeSeriesDeltaBucketBits[bucket];
+		int64_t	low = -(INT64_C(1) << (bits - 1)) + 1;
+		int64_t	high = INT64_C(1) << (bits - 1);
+
+		if ((deltaOfDelta >= low) && (deltaOfDelta <= high))
+		{
+			/*
+			 *	The prefix is `bucket + 1` ones and a zero.
+			 */
+			writeBits(block, (UINT64_C(1) << (bucket + 2)) - 2, bucket + 2);
+			writeBits(block, (uint64_t)(deltaOfDelta - low), bits);
+
+			return;
+		}
+	}
+
+	writeBits(block, (UINT64_C(1) << (kTimeSeriesNumberOfDeltaBuckets + 1)) - 1, kTimeSeriesNumberOfDeltaBuckets + 1);
+	writeBits(block, (uint64_t)deltaOfDelta, 64);
+
+	return;
+}
+
+static bool
+decodeTime(TimeSeriesBlock *  block, bool isFirstRecord, int64_t *  time)
+{
+	uint64_t	bit = 1;
+	uint64_t	bits;
+	size_t		bucket = 0;
+	int64_t		deltaOfDelta;
+
+	if (isFirstRecord)
+	{
+		block->previousTime = *time = block->header.firstTime;
+		block->previousDelta = 0;
+
+		return true;
+	}
+
+	while ((bucket <= kTimeSeriesNumberOfDeltaBuckets) && (bit == 1))
+	{
+		if (!readBits(block, 1, &bit))
+		{
+			return false;
+		}
+		bucket += (size_t)bit;
+	}
+
+	if (bucket == 0)
+	{
+		deltaOfDelta = 0;
+	}
+	else if (bucket <= kTimeSeriesNumberOfDeltaBuckets)
+	{
+		size_t	width = kTimeSeriesDeltaBucketBits[bucket - 1];
+
+		if (!readBits(block, width, &bits))
+		{
+			return false;
+		}
+		deltaOfDelta = (int64_t)bits - (INT64_C(1) << (width - 1)) + 1;
+	}
+	else
+	{
+		if (!readBits(block, 64, &bits))
+		{
+			return false;
+		}
+		deltaOfDelta = (int64_t)bits;
+	}
+
+	block->previousDelta = (int64_t)((uint64_t)block->previousDelta + (uint64_t)deltaOfDelta);
+	block->previousTime = (int64_t)((uint64_t)block->previousTime + (uint64_t)block->previousDelta);
+	*time = block->previousTime;
+
+	return true;
+}
+
+static void
+encodeValue(TimeSeriesBlock *  block, size_t column, double value)
+{
+	uint64_t	bits;
+	uint64_t	difference;
+	size_t		leadingZeros;
+	size_t		trailingZeros;
+
+	memcpy(&bits, &value, sizeof(bits));
+	difference = bits ^ block->previousValueBits[column];
+	block->previousValueBits[column] = bits;
+
+	if (difference == 0)
+	{
+		writeBits(block, 0, 1);
+
+		return;
+	}
+
+	leadingZeros = countLeadingZeros(difference);
+	leadingZeros = (leadingZeros > kTimeSeriesMaxLeadingZeros) ? kTimeSeriesMaxLeadingZeros : leadingZeros;
+	trailingZeros = countTrailingZeros(difference);
+
+	/*
+	 *	Reuse the window of meaningful bits of the previous value if this one fits in it.
+	 */
+	if (block->hasWindow[column]
+		&& (leadingZeros >= block->previousLeadingZeros[column])
+		&& (trailingZeros >= block->previousTrailingZeros[column]))
+	{
+		writeBits(block, 2, 2);
+		writeBits(
+			block,
+			difference >> block->previousTrailingZeros[column],
+			64 - block->previousLeadingZeros[column] - block->previousTrailingZeros[column]);
+
+		return;
+	}
+
+	writeBits(block, 3, 2);
+	writeBits(block, leadingZeros, 5);
+	writeBits(block, (64 - leadingZeros - trailingZeros) & 63, 6);
+	writeBits(block, difference >> trailingZeros, 64 - leadingZeros - trailingZeros);
+	block->previousLeadingZeros[column] = leadingZeros;
+	block->previousTrailingZeros[column] = trailingZeros;
+	block->hasWindow[column] = true;
+
+	return;
+}
+
+static bool
+decodeValue(TimeSeriesBlock *  block, size_t column, double *  value)
+{
+	uint64_t	control;
+	uint64_t	meaningfulBits;
+
+	if (!readBits(block, 1, &control))
+	{
+		return false;
+	}
+
+	if (control == 1)
+	{
+		if (!readBits(block, 1, &control))
+		{
+			return false;
+		}
+
+		if (control == 1)
+		{
+			uint64_t	leadingZeros;
+			uint64_t	length;
+
+			if (!readBits(block, 5, &leadingZeros) || !readBits(block, 6, &length))
+			{
+				return false;
+			}
+			length = (length == 0) ? 64 : length;
+			if (leadingZeros + length > 64)
+			{
+				return false;
+			}
+			block->previousLeadingZeros[column] = (size_t)leadingZeros;
+			block->previousTrailingZeros[column] = (size_t)(64 - leadingZeros - length);
+			block->hasWindow[column] = true;
+		}
+		else if (!block->hasWindow[column])
+		{
+			return false;
+		}
+
+		if (!readBits(block, 64 - block->previousLeadingZeros[column] - block->previousTrailingZeros[column], &meaningfulBits))
+		{
+			return false;
+		}
+		block->previousValueBits[column] ^= meaningfulBits << block->previousTrailingZeros[column];
+	}
+
+	memcpy(value, &block->previousValueBits[column], sizeof(*value));
+
+	return true;
+}
+
+static void
+writeBlock(TimeSeriesWriter *  writer)
+{
+	writer->block.header.numberOfBits = (uint32_t)writer->block.bitPosition;
+	writer->hasError |= (fwrite(&writer->block.header, sizeof(writer->block.header), 1, writer->file) != 1);
+	writer->hasError |= (fwrite(writer->block.bits, sizeof(writer->block.bits), 1, writer->file) != 1);
+	writer->numberOfBlocks++;
+	resetBlock(&writer->block);
+
+	return;
+}
+
+CommonConstantReturnType
+timeSeriesWriterOpen(
+	TimeSeriesWriter *	writer,
+	const char *		filePath,
+	const size_t *		outputs,
+	size_t			numberOfColumns,
+	double			valueResolution)
+{
+	memset(writer, 0, sizeof(*writer));
+	memcpy(writer->header.magic, kTimeSeriesFileMagic, sizeof(writer->header.magic));
+	writer->header.version = kTimeSeriesFileVersion;
+	writer->header.byteOrderMark = kTimeSeriesByteOrderMark;
+	writer->header.blockBytes = kTimeSeriesBlockBytes;
+	writer->header.ticksPerSecond = kTimeSeriesTicksPerSecond;
+	writer->header.numberOfColumns = (uint32_t)numberOfColumns;
+	for (size_t column = 0; column < numberOfColumns; column++)
+	{
+		writer->header.outputs[column] = (uint32_t)outputs[column];
+	}
+	writer->header.valueResolution = valueResolution;
+
+	writer->file = fopen(filePath, "wb");
+	if ((writer->file == NULL) || (fwrite(&writer->header, sizeof(writer->header), 1, writer->file) != 1))
+	{
+		fprintf(stderr, "Error: Could not create the time-series file \"%s\".\n", filePath);
+		if (writer->file != NULL)
+		{
+			fclose(writer->file);
+			writer->file = NULL;
+		}
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+timeSeriesWriterAdd(TimeSeriesWriter *  writer, const TimeSeriesRecord *  record)
+{
+	TimeSeriesBlock *	block = &writer->block;
+
+	if (block->bitPosition + kTimeSeriesMaxRecordBits > kTimeSeriesBlockStreamBits)
+	{
+		writeBlock(writer);
+	}
+
+	encodeTime(block, record->time);
+
+	if (record->sensorId == block->previousSensorId)
+	{
+		writeBits(block, 0, 1);
+	}
+	else
+	{
+		writeBits(block, 1, 1);
+		writeBits(block, record->sensorId, 32);
+		block->previousSensorId = record->sensorId;
+	}
+
+	/*
+	 *	Rounding to a power of two is exact, and zeroes the low bits of the significand, so
+	 *	that the differences of successive values have long runs of trailing zeros.
+	 */
+	for (size_t column = 0; column < writer->header.numberOfColumns; column++)
+	{
+		double	value = record->values[column];
+
+		if (writer->header.valueResolution > 0)
+		{
+			value = nearbyint(value / writer->header.valueResolution) * writer->header.valueResolution;
+		}
+		encodeValue(block, column, value);
+	}
+
+	block->header.lastTime = record->time;
+	block->header.numberOfRecords++;
+	writer->numberOfRecords++;
+
+	return;
+}
+
+CommonConstantReturnType
+timeSeriesWriterClose(TimeSeriesWriter *  writer)
+{
+	if (writer->block.header.numberOfRecords > 0)
+	{
+		writeBlock(writer);
+	}
+	writer->hasError |= (fclose(writer->file) != 0);
+	writer->file = NULL;
+
+	if (writer->hasError)
+	{
+		fprintf(stderr, "Error: Could not write the time-series file.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+timeSeriesReaderOpen(TimeSeriesReader *  reader, const char *  filePath)
+{
+	TimeSeriesFileHeader *	header = &reader->header;
+	struct stat		fileStatus;
+	bool			isValid;
+
+	memset(reader, 0, sizeof(*reader));
+	reader->file = fopen(filePath, "rb");
+	if (reader->file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open the time-series file \"%s\".\n", filePath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	isValid = (fread(header, sizeof(*header), 1, reader->file) == 1)
+			&& (memcmp(header->magic, kTimeSeriesFileMagic, sizeof(header->magic)) == 0)
+			&& (header->version == kTimeSeriesFileVersion)
+			&& (header->byteOrderMark == kTimeSeriesByteOrderMark)
+			&& (header->blockBytes == kTimeSeriesBlockBytes)
+			&& (header->numberOfColumns <= kTimeSeriesMaxColumns)
+			&& (fstat(fileno(reader->file), &fileStatus) == 0)
+			&& (((uint64_t)fileStatus.st_size - sizeof(*header)) % kTimeSeriesBlockBytes == 0);
+
+	if (!isValid)
+	{
+		fprintf(stderr, "Error: \"%s\" is not a valid time-series file, or it is truncated or from a host with another byte order.\n", filePath);
+		timeSeriesReaderClose(reader);
+
+		return kCommonConstantReturnTypeError;
+	}
+	reader->numberOfBlocks = ((uint64_t)fileStatus.st_size - sizeof(*header)) / kTimeSeriesBlockBytes;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+static bool
+readBlockHeader(TimeSeriesReader *  reader, uint64_t blockIndex, TimeSeriesBlockHeader *  blockHeader)
+{
+	return (fseeko(reader->file, (off_t)(sizeof(reader->header) + blockIndex * kTimeSeriesBlockBytes), SEEK_SET) == 0)
+		&& (fread(blockHeader, sizeof(*blockHeader), 1, reader->file) == 1);
+}
+
+CommonConstantReturnType
+timeSeriesReaderSeek(TimeSeriesReader *  reader, int64_t time)
+{
+	uint64_t	low = 0;
+	uint64_t	high = reader->numberOfBlocks;
+
+	/*
+	 *	Find the last block that starts at or before `time`; the records before it are earlier.
+	 */
+	while (high - low > 1)
+	{
+		uint64_t		middle = low + (high - low) / 2;
+		TimeSeriesBlockHeader	blockHeader;
+
+		if (!readBlockHeader(reader, middle, &blockHeader))
+		{
+			reader->hasError = true;
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (blockHeader.firstTime <= time)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	reader->nextBlock = low;
+	reader->nextRecord = 0;
+	resetBlock(&reader->block);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+bool
+timeSeriesReaderNext(TimeSeriesReader *  reader, TimeSeriesRecord *  record)
+{
+	TimeSeriesBlock *	block = &reader->block;
+	uint64_t		bits;
+	bool			isValid;
+
+	while (reader->nextRecord == block->header.numberOfRecords)
+	{
+		if (reader->nextBlock == reader->numberOfBlocks)
+		{
+			return false;
+		}
+
+		resetBlock(block);
+		if (!readBlockHeader(reader, reader->nextBlock, &block->header)
+			|| (fread(block->bits, sizeof(block->bits), 1, reader->file) != 1)
+			|| (block->header.numberOfBits > kTimeSeriesBlockStreamBits))
+		{
+			reader->hasError = true;
+
+			return false;
+		}
+		reader->nextBlock++;
+		reader->nextRecord = 0;
+	}
+
+	isValid = decodeTime(block, (reader->nextRecord == 0), &record->time) && readBits(block, 1, &bits);
+	if (isValid && (bits == 1))
+	{
+		isValid = readBits(block, 32, &bits);
+		block->previousSensorId = (uint32_t)bits;
+	}
+	record->sensorId = block->previousSensorId;
+
+	for (size_t column = 0; isValid && (column < reader->header.numberOfColumns); column++)
+	{
+		isValid = decodeValue(block, column, &record->values[column]);
+	}
+
+	reader->hasError |= !isValid;
+	reader->nextRecord++;
+
+	return isValid;
+}
+
+void
+timeSeriesReaderClose(TimeSeriesReader *  reader)
+{
+	if (reader->file != NULL)
+	{
+		fclose(reader->file);
+		reader->file = NULL;
+	}
+
+	return;
+}
@@ -0,0 +1,194 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "common.h"
+#include "sensor-model.h"
+
+/*
+ *	Compressed time series of the calibrated outputs of a stream of readings, in the style of
+ *	Gorilla (Pelkonen et al., VLDB 2015). The file is a header followed by blocks of a fixed
+ *	size, each holding a self-contained bit stream of whole records, so that a reader can
+ *	seek to any block. Times are integer milliseconds, stored as the difference of successive
+ *	differences in a few bits; each value is stored as the XOR with the value of its output in
+ *	the record before, by the window of its meaningful bits.
+ */
+typedef enum
+{
+	kTimeSeriesBlockBytes		= 4096,
+	kTimeSeriesTicksPerSecond	= 1000,
+	kTimeSeriesMaxColumns		= kSensorModelChannelMax,
+	kTimeSeriesFileVersion		= 1,
+
+	/*
+	 *	Most bits of one record: a time of 4 + 64 bits, a sensor of 1 + 32 bits, and values
+	 *	of 2 + 5 + 6 + 64 bits.
+	 */
+	kTimeSeriesMaxRecordBits	= 68 + 33 + kTimeSeriesMaxColumns * 77,
+} TimeSeriesConstant;
+
+/*
+ *	Header at the start of a time-series file. `outputs` are the output indices of the
+ *	`numberOfColumns` values of each record. A nonzero `valueResolution` is the power of two
+ *	that the values were rounded to. All fields are in host byte order, which
+ *	`byteOrderMark` records.
+ */
+typedef struct
+{
+	char		magic[8];
+	uint32_t	version;
+	uint32_t	byteOrderMark;
+	uint32_t	blockBytes;
+	uint32_t	ticksPerSecond;
+	uint32_t	numberOfColumns;
+	uint32_t	outputs[kTimeSeriesMaxColumns];
+	double		valueResolution;
+} TimeSeriesFileHeader;
+
+/*
+ *	Header at the start of each block, followed by its bit stream.
+ */
+typedef struct
+{
+	uint32_t	numberOfRecords;
+	uint32_t	numberOfBits;
+	int64_t		firstTime;
+	int64_t		lastTime;
+} TimeSeriesBlockHeader;
+
+typedef struct
+{
+	int64_t		time;
+	uint32_t	sensorId;
+	double		values[kTimeSeriesMaxColumns];
+} TimeSeriesRecord;
+
+/*
+ *	State of the bit stream of one block, shared by the writer and the reader.
+ */
+typedef struct
+{
+	TimeSeriesBlockHeader	header;
+	uint8_t			bits[kTimeSeriesBlockBytes - sizeof(TimeSeriesBlockHeader)];
+	size_t			bitPosition;
+	int64_t			previousTime;
+	int64_t			previousDelta;
+	uint32_t		previousSensorId;
+	uint64_t		previousValueBits[kTimeSeriesMaxColumns];
+	size_t			previousLeadingZeros[kTimeSeriesMaxColumns];
+	size_t			previousTrailingZeros[kTimeSeriesMaxColumns];
+	bool			hasWindow[kTimeSeriesMaxColumns];
+} TimeSeriesBlock;
+
+typedef struct
+{
+	FILE *			file;
+	TimeSeriesFileHeader	header;
+	TimeSeriesBlock		block;
+	bool			hasError;
+	uint64_t		numberOfRecords;
+	uint64_t		numberOfBlocks;
+} TimeSeriesWriter;
+
+typedef struct
+{
+	FILE *			file;
+	TimeSeriesFileHeader	header;
+	TimeSeriesBlock		block;
+	uint64_t		numberOfBlocks;
+	uint64_t		nextBlock;
+	uint32_t		nextRecord;
+	bool			hasError;
+} TimeSeriesReader;
+
+/**
+ *	@brief	Creates a time-series file.
+ *
+ *	@param	writer			: Pointer to the writer.
+ *	@param	filePath		: Path of the file.
+ *	@param	outputs			: Output indices of the values of each record.
+ *	@param	numberOfColumns		: Number of values of each record, up to `kTimeSeriesMaxColumns`.
+ *	@param	valueResolution		: Power of two to round the values to, or 0 to store them exactly.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	timeSeriesWriterOpen(
+					TimeSeriesWriter *	writer,
+					const char *		filePath,
+					const size_t *		outputs,
+					size_t			numberOfColumns,
+					double			valueResolution);
+
+/**
+ *	@brief	Appends a record, and writes out the current block first if the record might not fit.
+ *
+ *	@param	writer		: Pointer to the writer.
+ *	@param	record		: The record.
+ */
+void	timeSeriesWriterAdd(TimeSeriesWriter *  writer, const TimeSeriesRecord *  record);
+
+/**
+ *	@brief	Writes out the last block and closes the file.
+ *
+ *	@param	writer	: Pointer to the writer.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if all blocks were written, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	timeSeriesWriterClose(TimeSeriesWriter *  writer);
+
+/**
+ *	@brief	Opens a time-series file for reading from its first record.
+ *
+ *	@param	reader		: Pointer to the reader.
+ *	@param	filePath	: Path of the file.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	timeSeriesReaderOpen(TimeSeriesReader *  reader, const char *  filePath);
+
+/**
+ *	@brief	Moves the reader to the block that holds the first record at or after `time`, by
+ *		a binary search of the block headers. Records must have been written in time order.
+ *
+ *	@param	reader	: Pointer to the reader.
+ *	@param	time	: The time, in ticks.
+ *	@return		: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	timeSeriesReaderSeek(TimeSeriesReader *  reader, int64_t time);
+
+/**
+ *	@brief	Reads the next record.
+ *
+ *	@param	reader	: Pointer to the reader.
+ *	@param	record	: Pointer to the record, written by the function.
+ *	@return		: `true` if a record was read, else `false` at the end of the file, or on an error, which sets `reader->hasError`.
+ */
+bool	timeSeriesReaderNext(TimeSeriesReader *  reader, TimeSeriesRecord *  record);
+
+/**
+ *	@brief	Closes a reader.
+ *
+ *	@param	reader	: Pointer to the reader.
+ */
+void	timeSeriesReaderClose(TimeSeriesReader *  reader);
@@ -0,0 +1,274 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(_POSIX_THREADS) && (_POSIX_THREADS > 0)
+#include <pthread.h>
+#define kTraceHasFlusherThread	1
+#else
+#define kTraceHasFlusherThread	0
+#endif
+#include "trace.h"
+#include "metrics.h"
+
+static const char	kTraceFileMagic[8] = {'S', 'G', 'T', 'R', 'A', 'C', 'E', '1'};
+
+/*
+ *	Polling period of the background flusher.
+ */
+static const long	kTraceFlushPeriodNanoseconds = 1000000;
+
+bool				traceIsEnabled = false;
+_Thread_local TraceThreadState	traceThreadState;
+
+static struct
+{
+	FILE *			file;
+	uint64_t		samplingInterval;
+	_Atomic bool		hasError;
+	_Atomic(TraceRing *)	rings;
+	_Atomic uint32_t	numberOfThreads;
+	_Atomic bool		isStopRequested;
+#if kTraceHasFlusherThread
+	pthread_t		flusherThread;
+	bool			hasFlusherThread;
+#endif
+} traceState;
+
+/*
+ *	Moves all records currently in `ring` to the trace file. Each ring has a single consumer:
+ *	the flusher thread, or without it the producer of the ring, and `traceClose()` once the
+ *	producers are done.
+ */
+static void
+drainRing(TraceRing *  ring)
+{
+	uint64_t	tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	uint64_t	head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+	while (tail != head)
+	{
+		size_t	first = (size_t)(tail % kTraceRingCapacity);
+		size_t	count = (size_t)(head - tail);
+
+		if (first + count > kTraceRingCapacity)
+		{
+			count = kTraceRingCapacity - first;
+		}
+
+		traceState.hasError |= (fwrite(&ring->records[first], sizeof(TraceRecord), count, traceState.file) != count);
+		tail += count;
+	}
+
+	atomic_store_explicit(&ring->tail, tail, memory_order_release);
+
+	return;
+}
+
+static void
+drainAllRings(void)
+{
+	for (TraceRing *  ring = atomic_load_explicit(&traceState.rings, memory_order_acquire); ring != NULL; ring = ring->next)
+	{
+		drainRing(ring);
+	}
+
+	return;
+}
+
+#if kTraceHasFlusherThread
+static void *
+flusherThreadMain(void *  unused)
+{
+	const struct timespec	period = {.tv_sec = 0, .tv_nsec = kTraceFlushPeriodNanoseconds};
+
+	(void)unused;
+
+	while (!atomic_load_explicit(&traceState.isStopRequested, memory_order_acquire))
+	{
+		drainAllRings();
+		nanosleep(&period, NULL);
+	}
+
+	return NULL;
+}
+#endif
+
+/*
+ *	Allocates the calling thread's ring and publishes it to the flusher.
+ */
+static TraceRing *
+registerThreadRing(void)
+{
+	TraceRing *	ring = calloc(1, sizeof(TraceRing));
+
+	if (ring == NULL)
+	{
+		return NULL;
+	}
+
+	ring->threadIndex = atomic_fetch_add(&traceState.numberOfThreads, 1);
+	ring->next = atomic_load(&traceState.rings);
+	while (!atomic_compare_exchange_weak(&traceState.rings, &ring->next, ring))
+	{
+	}
+
+	return ring;
+}
+
+CommonConstantReturnType
+traceOpen(const char *  filePath, const char * const *  variableNames, size_t numberOfVariables, uint64_t samplingInterval)
+{
+	uint32_t	header[4] = {kTraceFileVersion, sizeof(TraceRecord), (uint32_t)numberOfVariables, (uint32_t)samplingInterval};
+
+	traceState.file = fopen(filePath, "wb");
+	if (traceState.file == NULL)
+	{
+		fprintf(stderr, "Error: Could not open \"%s\" for writing.\n", filePath);
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	traceState.samplingInterval = (samplingInterval > 0) ? samplingInterval : 1;
+	traceState.hasError = (fwrite(kTraceFileMagic, 1, sizeof(kTraceFileMagic), traceState.file) != sizeof(kTraceFileMagic));
+	traceState.hasError |= (fwrite(header, sizeof(header), 1, traceState.file) != 1);
+	for (size_t i = 0; i < numberOfVariables; i++)
+	{
+		uint32_t	nameLength = (uint32_t)strlen(variableNames[i]);
+
+		traceState.hasError |= (fwrite(&nameLength, sizeof(nameLength), 1, traceState.file) != 1);
+		traceState.hasError |= (fwrite(variableNames[i], 1, nameLength, traceState.file) != nameLength);
+	}
+
+	atomic_store(&traceState.isStopRequested, false);
+#if kTraceHasFlusherThread
+	traceState.hasFlusherThread = (pthread_create(&traceState.flusherThread, NULL, flusherThreadMain, NULL) == 0);
+#endif
+	traceIsEnabled = true;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+traceBeginSampleSlowPath(uint64_t sampleIndex)
+{
+	traceThreadState.sampleIndex = sampleIndex;
+	traceThreadState.isSampleTraced = ((sampleIndex % traceState.samplingInterval) == 0);
+
+	return;
+}
+
+void
+traceValueSlowPath(uint32_t variableIndex, double value)
+{
+	TraceRing *	ring = traceThreadState.ring;
+	uint64_t	head;
+
+	if (ring == NULL)
+	{
+		ring = traceThreadState.ring = registerThreadRing();
+		if (ring == NULL)
+		{
+			traceThreadState.isSampleTraced = false;
+
+			return;
+		}
+	}
+
+	head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	if (head - atomic_load_explicit(&ring->tail, memory_order_acquire) == kTraceRingCapacity)
+	{
+#if kTraceHasFlusherThread
+		if (traceState.hasFlusherThread)
+		{
+			atomic_fetch_add_explicit(&ring->numberOfDroppedRecords, 1, memory_order_relaxed);
+
+			return;
+		}
+#endif
+		/*
+		 *	Without a flusher thread, the producer drains its own ring when it fills up.
+		 */
+		drainRing(ring);
+	}
+
+	ring->records[head % kTraceRingCapacity] = (TraceRecord)
+	{
+		.sampleIndex	= traceThreadState.sampleIndex,
+		.variableIndex	= variableIndex,
+		.threadIndex	= ring->threadIndex,
+		.value		= value,
+	};
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+	return;
+}
+
+CommonConstantReturnType
+traceClose(void)
+{
+	uint64_t	numberOfDroppedRecords = 0;
+	TraceRing *	ring;
+
+	if (traceState.file == NULL)
+	{
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	traceIsEnabled = false;
+	traceThreadState.isSampleTraced = false;
+	atomic_store_explicit(&traceState.isStopRequested, true, memory_order_release);
+#if kTraceHasFlusherThread
+	if (traceState.hasFlusherThread)
+	{
+		pthread_join(traceState.flusherThread, NULL);
+		traceState.hasFlusherThread = false;
+	}
+#endif
+
+	drainAllRings();
+	traceState.hasError |= (fclose(traceState.file) != 0);
+	traceState.file = NULL;
+
+	ring = atomic_exchange(&traceState.rings, NULL);
+	while (ring != NULL)
+	{
+		TraceRing *	next = ring->next;
+
+		numberOfDroppedRecords += atomic_load(&ring->numberOfDroppedRecords);
+		free(ring);
+		ring = next;
+	}
+	traceThreadState.ring = NULL;
+
+	metricsCount(kMetricsCounterDroppedTraceRecords, numberOfDroppedRecords);
+	if (numberOfDroppedRecords > 0)
+	{
+		fprintf(stderr, "Warning: %llu trace records were dropped. Increase the trace interval (-I).\n", (unsigned long long)numberOfDroppedRecords);
+	}
+
+	return traceState.hasError ? kCommonConstantReturnTypeError : kCommonConstantReturnTypeSuccess;
+}
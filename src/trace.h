@@ -0,0 +1,129 @@
+/*
+ *	Copyright (c) 2024, Signaloid.
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "common.h"
+
+typedef enum
+{
+	kTraceRingCapacity	= 1 << 14,
+	kTraceCacheLineSize	= 64,
+	kTraceFileVersion	= 1,
+} TraceConstant;
+
+/*
+ *	One traced value. Trace files are a header followed by these records, in host byte order.
+ */
+typedef struct
+{
+	uint64_t	sampleIndex;
+	uint32_t	variableIndex;
+	uint32_t	threadIndex;
+	double		value;
+} TraceRecord;
+
+/*
+ *	Single-producer, single-consumer ring of trace records. Each thread that records values
+ *	owns one ring and is its only producer; the flusher is the only consumer. `head` and
+ *	`tail` are on separate cache lines so that the two sides do not contend.
+ */
+typedef struct TraceRing
+{
+	_Atomic uint64_t	head;
+	uint8_t			headPadding[kTraceCacheLineSize - sizeof(uint64_t)];
+	_Atomic uint64_t	tail;
+	uint8_t			tailPadding[kTraceCacheLineSize - sizeof(uint64_t)];
+	_Atomic uint64_t	numberOfDroppedRecords;
+	uint32_t		threadIndex;
+	struct TraceRing *	next;
+	TraceRecord		records[kTraceRingCapacity];
+} TraceRing;
+
+typedef struct
+{
+	bool		isSampleTraced;
+	uint64_t	sampleIndex;
+	TraceRing *	ring;
+} TraceThreadState;
+
+extern bool				traceIsEnabled;
+extern _Thread_local TraceThreadState	traceThreadState;
+
+/**
+ *	@brief	Opens a trace file and starts the background flusher.
+ *
+ *	@param	filePath		: Path of the binary trace file.
+ *	@param	variableNames		: Names of the traced variables, indexed by variable index. Stored in the file header.
+ *	@param	numberOfVariables	: The number of traced variables.
+ *	@param	samplingInterval	: Trace one in every `samplingInterval` samples.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	traceOpen(const char *  filePath, const char * const *  variableNames, size_t numberOfVariables, uint64_t samplingInterval);
+
+/**
+ *	@brief	Stops the flusher, writes out all pending records and closes the trace file.
+ *
+ *	@return	: `kCommonConstantReturnTypeSuccess` if all records were written, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	traceClose(void);
+
+void	traceBeginSampleSlowPath(uint64_t sampleIndex);
+void	traceValueSlowPath(uint32_t variableIndex, double value);
+
+/**
+ *	@brief	Marks the start of a new sample on the calling thread, and decides whether its values are traced.
+ *
+ *	@param	sampleIndex	: The index of the sample (e.g., the Monte Carlo iteration).
+ */
+static inline void
+traceBeginSample(uint64_t sampleIndex)
+{
+	if (traceIsEnabled)
+	{
+		traceBeginSampleSlowPath(sampleIndex);
+	}
+
+	return;
+}
+
+/**
+ *	@brief	Records a value of the current sample, if the sample is traced. The record is dropped,
+ *		and counted, if the calling thread's ring is full, so the caller never blocks.
+ *
+ *	@param	variableIndex	: The index of the traced variable.
+ *	@param	value		: The value to record.
+ */
+static inline void
+traceValue(uint32_t variableIndex, double value)
+{
+	if (traceThreadState.isSampleTraced)
+	{
+		traceValueSlowPath(variableIndex, value);
+	}
+
+	return;
+}
@@ -20,6 +20,8 @@
  *	SOFTWARE.
  */
 
+#pragma once
+
 /*
  *	These constant values are taken from Figure 4 in page 8
  *	of SHT4xI-analog Datasheet, 2024-07-03.
@@ -38,6 +40,82 @@
 #define kDefaultInputDistributionVsupplyUniformDistLow		(4.8)
 #define kDefaultInputDistributionVsupplyUniformDistHigh		(5.4)
 
+/*
+ *	Seed of the random number generator that picks which Monte Carlo samples the
+ *	reservoir (-R option) keeps.
+ */
+#define kReservoirDefaultSeed					(0x5EEDULL)
+
+/*
+ *	Reservoir on more than one thread (-R and -W options): seed of the random number
+ *	generators of the inputs of the threads.
+ */
+#define kParallelReservoirDefaultSeed				(0x9A7EULL)
+
+/*
+ *	Input correlation (-c option): number of correlated input samples drawn together, so
+ *	that the Cholesky product and the Gaussian CDF run as loops over a block.
+ */
+#define kInputCorrelationSamplesPerBlock			(256)
+
+/*
+ *	Batch mode (-i option): number of Monte Carlo samples per reading when -M is not
+ *	given, and seed of the per-reading random number generators. Each reading in the
+ *	input file gives the centre of its inputs, and the inputs keep the widths of the
+ *	default input distributions.
+ */
+#define kBatchDefaultSamplesPerReading				(10000)
+#define kBatchDefaultSeed					(0xBA7CULL)
+
+/*
+ *	Anytime batch mode (-L option): the fewest Monte Carlo samples per reading, which are
+ *	also the first progressive round, the most readings evaluated together, and the
+ *	throughput of the batch engine assumed until it is first measured.
+ */
+#define kAnytimeMinimumSamplesPerReading			(64)
+#define kAnytimeMaxReadingsPerEvaluation			(1024)
+#define kAnytimeInitialSamplesPerSecond				(1e7)
+
+/*
+ *	Random pool (-G and -P options): default number of uniforms in a generated pool
+ *	(128 MiB), and seed of its random number generator.
+ */
+#define kRandomPoolDefaultNumberOfValues			(16777216)
+#define kRandomPoolDefaultGeneratorSeed				(0x9001ULL)
+
+/*
+ *	Surrogate table (-U and -Q options): ranges of the centres of the ratiometric voltages
+ *	and of the supply voltage covered by the table grid. Readings outside them fall back to
+ *	Monte Carlo.
+ */
+#define kSurrogateTableNumeratorCentreLow			(0.5)
+#define kSurrogateTableNumeratorCentreHigh			(4.5)
+#define kSurrogateTableSupplyCentreLow				(4.5)
+#define kSurrogateTableSupplyCentreHigh				(5.5)
+
+/*
+ *	Progress publication (-F option): default wall-clock interval between two snapshots.
+ */
+#define kProgressDefaultIntervalMilliseconds			(1000)
+
+/*
+ *	Metrics (-X option): wall-clock interval between two writes of the metrics file during
+ *	Monte Carlo mode and anytime batch mode. The file is also written at the end of a run.
+ */
+#define kMetricsDefaultWriteIntervalMilliseconds		(10000)
+
+/*
+ *	Polynomial chaos mode (-E option): seed of the random number generator that samples
+ *	the inputs of the expansion.
+ */
+#define kPolynomialChaosDefaultSeed				(0xC4A05ULL)
+
+/*
+ *	Incremental cache (-k option): seed of the random number generators of the inputs, so
+ *	that runs with the same input configuration draw, and can reuse, the same samples.
+ */
+#define kIncrementalCacheDefaultSeed				(0x1C4EULL)
+
 /*
  *	Input Distributions:
  *		kInputDistributionIndexVrh	: Ratiometric Analog Voltage for humidity measurement (in Volt).
@@ -57,11 +135,33 @@ typedef enum
  *		kOutputDistributionIndexCalibratedRelativeHumidity	: Calibrated Relative Humidity (percentage %).
  *		kOutputDistributionIndexCalibratedTemperatureCelcius	: Calibrated Temperature (in Celsius).
  *		kOutputDistributionIndexCalibratedTemperatureFahrenheit	: Calibrated Temperature (in Farenheit).
+ *		kOutputDistributionIndexDewPointCelcius			: Dew Point (in Celsius), derived from the calibrated humidity and temperature.
+ *		kOutputDistributionIndexAbsoluteHumidity		: Absolute Humidity (in g/m^3), derived from the calibrated humidity and temperature.
+ *		kOutputDistributionIndexHeatIndexCelcius		: Heat Index (in Celsius), derived from the calibrated humidity and temperature.
  */
 typedef enum
 {
 	kOutputDistributionIndexCalibratedRelativeHumidity	= 0,
 	kOutputDistributionIndexCalibratedTemperatureCelcius	= 1,
 	kOutputDistributionIndexCalibratedTemperatureFahrenheit	= 2,
+	kOutputDistributionIndexDewPointCelcius			= 3,
+	kOutputDistributionIndexAbsoluteHumidity		= 4,
+	kOutputDistributionIndexHeatIndexCelcius		= 5,
 	kOutputDistributionIndexMax,
 } OutputDistributionIndex;
+
+/*
+ *	Intermediate values recorded by the native trace facility (-t option):
+ *		kTraceVariableIndexVrhOverVsupply	: Humidity ratiometric voltage ratio `Vrh / Vsupply`.
+ *		kTraceVariableIndexRh			: Calibrated Relative Humidity (percentage %).
+ *		kTraceVariableIndexTcelcius		: Calibrated Temperature (in Celsius).
+ *		kTraceVariableIndexTfahrenheit		: Calibrated Temperature (in Farenheit).
+ */
+typedef enum
+{
+	kTraceVariableIndexVrhOverVsupply	= 0,
+	kTraceVariableIndexRh			= 1,
+	kTraceVariableIndexTcelcius		= 2,
+	kTraceVariableIndexTfahrenheit		= 3,
+	kTraceVariableIndexMax,
+} TraceVariableIndex;
@@ -20,10 +20,15 @@
  *	SOFTWARE.
  */
 
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
 #include <uxhw.h>
 #include "utilities.h"
+#include "arrow-ipc.h"
+#include "csv-scanner.h"
 
 void
 printUsage(void)
@@ -39,128 +44,1993 @@ printUsage(void)
 		"\t[-T, --time] (Timing mode: Times and prints the timing of the kernel execution.)\n"
 		"\t[-b, --benchmarking] (Benchmarking mode: Generate outputs in format for benchmarking.)\n"
 		"\t[-j, --json] (Print output in JSON format.)\n"
+		"\t[-c, --correlation <rho(Vrh,Vt),rho(Vrh,Vdd),rho(Vt,Vdd) : double,double,double>] (Draw the inputs through a Gaussian copula with the given correlation coefficients. Default: independent inputs.)\n"
+		"\t[-a, --arrow <Path to output Arrow IPC file : str>] (Write the output samples and run metadata to an Arrow IPC (Feather V2) file.)\n"
+		"\t[-n, --ndjson <Path to output NDJSON file, or - for standard output : str>] (Stream one compact JSON record per converted reading.)\n"
+		"\t[-N, --ndjson-batch <Number of readings : int>] (Stream one NDJSON summary record per batch of readings instead of one per reading.)\n"
+		"\t[-R, --reservoir <Number of samples : int>] (Keep a uniform random subset of this many Monte Carlo samples, in place of all of them.)\n"
+		"\t[-t, --trace <Path to output binary trace file : str>] (Trace intermediate values of the conversion natively.)\n"
+		"\t[-I, --trace-interval <Number of samples : int (Default: 1)>] (Trace one in every this many samples.)\n"
+		"\t[-i, --input <Path to input CSV file : str>] (Batch mode: Evaluate the Monte Carlo summary of each Vrh,Vt,Vsupply[,timestamp[,sensorId]] reading in the file. -M sets the samples per reading, default: %d.)\n"
+		"\t[-L, --latency-target <milliseconds : int>] (Batch mode: Evaluate readings as they arrive, with -i - for the standard input, adapting the samples per reading to the backlog to meet this latency. -M sets the most samples per reading.)\n"
+		"\t[-W, --threads <Number of threads : int (Default: number of online processors)>] (Threads used by batch mode, and by Monte Carlo mode with a reservoir (-R).)\n"
+		"\t[-G, --random-pool-generate <Path to output random pool file : str>] (Generate a pool of uniforms for -P and exit.)\n"
+		"\t[-Z, --random-pool-size <Number of uniforms : int (Default: %d)>] (Size of the pool generated with -G.)\n"
+		"\t[-P, --random-pool <Path to random pool file : str>] (Monte Carlo mode: Draw the inputs from a memory-mapped random pool.)\n"
+		"\t[-K, --random-pool-seed <seed : int (Default: 0)>] (Select the region of the random pool that this run consumes.)\n"
+		"\t[-U, --surrogate-table-build <Path to output surrogate table file : str>] (Build a table of output moments and quantiles for -Q and exit.)\n"
+		"\t[-Q, --surrogate-table <Path to surrogate table file : str>] (Batch mode: Answer readings by interpolation in a surrogate table, with Monte Carlo outside its domain.)\n"
+		"\t[-E, --polynomial-chaos <order : int>] (Monte Carlo mode: Fit a Legendre polynomial chaos expansion of this order by quadrature, and draw the samples from it.)\n"
+		"\t[-F, --progress-file <Path to output progress file : str>] (Monte Carlo mode: Publish snapshots of the output summaries to this memory-mapped file during the run.)\n"
+		"\t[-D, --progress-interval <milliseconds : int (Default: %d)>] (Time between two snapshots of -F.)\n"
+		"\t[-Y, --progress-show <Path to progress file : str>] (Print the latest snapshot of a progress file and exit.)\n"
+		"\t[-X, --metrics <Path to output metrics file : str>] (Write stage latency histograms and counters in the Prometheus text format, at the end of the run and every %d seconds.)\n"
+		"\t[-V, --sensor-model <name : str (Default: sht4xi-analog)>] (Sensor model whose transfer functions convert the voltages: sht4xi-analog, sht3x-arp or hmp60-5v.)\n"
+		"\t[-O, --output-order <ordered or unordered : str (Default: ordered)>] (Batch mode: Write each summary in the order of the readings, or as soon as it is evaluated.)\n"
+		"\t[-C, --distribution-code] (Also write a %d-byte code of each output distribution, as %d quantiles, with its Wasserstein error: of the samples with -M and one output, or of the closed form of each calibrated output in batch mode.)\n"
+		"\t[-B, --distribution-code-decode <code : str>] (Print the quantiles and support of a distribution code of -C and exit.)\n"
+		"\t[-H, --kalman-filter <drift(Rh),drift(Tcelcius) : double,double>] (Batch mode: Fuse the successive readings of each sensor with a Kalman filter, for outputs drifting by these standard deviations per square root of a second, or per reading without timestamps.)\n"
+		"\t[-J, --out-of-core <Path to spill directory : str>] (Monte Carlo mode with one output: Spill sorted runs of the samples to this directory and merge them into its samples.sorted file, for exact quantiles of more samples than fit in memory.)\n"
+		"\t[-w, --wasserstein-reference <Path to sorted samples file : str>] (Also print the exact Wasserstein distance of the -J samples to the samples.sorted file of another run.)\n"
+		"\t[-z, --compressed-samples <Path to output compressed sample file : str>] (Monte Carlo mode with one output: Write the output samples to this compressed binary file in place of data.out.)\n"
+		"\t[-e, --compression-error <bound : double (Default: 0, lossless)>] (Compress the -z samples or the -g values to within this absolute error, in the units of the output.)\n"
+		"\t[-x, --decompress-samples <Path to compressed sample file : str>] (Print the samples of a -z file in the format of data.out and exit.)\n"
+		"\t[-g, --time-series <Path to output time-series file : str>] (Batch mode: Also append the mean of each selected calibrated output of each reading to this compressed time-series file.)\n"
+		"\t[-y, --time-series-show <Path to time-series file : str>] (Print the records of a -g file as CSV and exit.)\n"
+		"\t[-u, --time-series-from <timestamp : double>] (Start -y at the first record at or after this timestamp, in seconds.)\n"
+		"\t[-d, --input-bounds <low(Vrh),high(Vrh),low(Vt),high(Vt),low(Vdd),high(Vdd) : double,...>] (Bounds of the uniform inputs, in Volts. Default: %.1f,%.1f,%.1f,%.1f,%.1f,%.1f.)\n"
+		"\t[-k, --incremental-cache <Path to cache directory : str>] (Monte Carlo mode: Reuse the input, ratio and output samples that earlier runs with the same configuration of an input left in this directory, and only compute those that depend on a changed input.)\n"
+		"\t[-A, --division-accuracy <tier : int (Default: 0)>] (Accuracy of the voltage ratios: 0 for exact division, 1 for a reciprocal with Newton refinement (within 1.33 ULP), 2 for a low-precision reciprocal (relative error 2.5e-5).)\n"
 		"\t[-h, --help] (Display this help message.)\n",
 		kOutputDistributionIndexMax,
-		kOutputDistributionIndexMax);
+		kOutputDistributionIndexMax,
+		kBatchDefaultSamplesPerReading,
+		kRandomPoolDefaultNumberOfValues,
+		kProgressDefaultIntervalMilliseconds,
+		kMetricsDefaultWriteIntervalMilliseconds / 1000,
+		kDistributionCodeSizeInBytes,
+		kDistributionCodeNumberOfQuantiles,
+		kDefaultInputDistributionVrhUniformDistLow,
+		kDefaultInputDistributionVrhUniformDistHigh,
+		kDefaultInputDistributionVtUniformDistLow,
+		kDefaultInputDistributionVtUniformDistHigh,
+		kDefaultInputDistributionVsupplyUniformDistLow,
+		kDefaultInputDistributionVsupplyUniformDistHigh);
 	fprintf(stderr, "\n");
 
 	return;
 }
 
 static void
-setDefaultCommandLineArguments(CommandLineArguments *  arguments)
+setDefaultCommandLineArguments(CommandLineArguments *  arguments)
+{
+	/*
+	 *	Older GCC versions have a bug which gives a spurious warning for
+	 *	the C universal zero initializer `{0}`. Any workaround makes the
+	 *	code less portable or prevents the common code from adding new
+	 *	fields to the `CommonCommandLineArguments` struct. Therefore, we
+	 *	surpress this warning.
+	 *
+	 *	See https://gcc.gnu.org/bugzilla/show_bug.cgi?id=53119.
+	 */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-braces"
+
+	*arguments = (CommandLineArguments)
+	{
+		.common				= (CommonCommandLineArguments) {0},
+		.isInputCorrelationEnabled	= false,
+	};
+#pragma GCC diagnostic pop
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		arguments->inputCorrelationMatrix[i][i] = 1.0;
+	}
+
+	arguments->inputLowerBound[kInputDistributionIndexVrh] = kDefaultInputDistributionVrhUniformDistLow;
+	arguments->inputUpperBound[kInputDistributionIndexVrh] = kDefaultInputDistributionVrhUniformDistHigh;
+	arguments->inputLowerBound[kInputDistributionIndexVt] = kDefaultInputDistributionVtUniformDistLow;
+	arguments->inputUpperBound[kInputDistributionIndexVt] = kDefaultInputDistributionVtUniformDistHigh;
+	arguments->inputLowerBound[kInputDistributionIndexVsupply] = kDefaultInputDistributionVsupplyUniformDistLow;
+	arguments->inputUpperBound[kInputDistributionIndexVsupply] = kDefaultInputDistributionVsupplyUniformDistHigh;
+
+	return;
+}
+
+/**
+ *	@brief	Parses the three off-diagonal input correlation coefficients, given
+ *		as a comma-separated list in the order (Vrh,Vt), (Vrh,Vdd), (Vt,Vdd).
+ *
+ *	@param	correlationArg	: The argument string of the `-c` option.
+ *	@param	arguments	: Pointer to command line arguments struct.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseInputCorrelationMatrix(const char *  correlationArg, CommandLineArguments *  arguments)
+{
+	const InputDistributionIndex	pairs[][2] =
+					{
+						{kInputDistributionIndexVrh, kInputDistributionIndexVt},
+						{kInputDistributionIndexVrh, kInputDistributionIndexVsupply},
+						{kInputDistributionIndexVt, kInputDistributionIndexVsupply},
+					};
+	const char *			cursor = correlationArg;
+
+	for (size_t i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++)
+	{
+		char *	end;
+		double	rho = strtod(cursor, &end);
+
+		if ((end == cursor) || !(rho > -1.0 && rho < 1.0))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->inputCorrelationMatrix[pairs[i][0]][pairs[i][1]] = rho;
+		arguments->inputCorrelationMatrix[pairs[i][1]][pairs[i][0]] = rho;
+
+		if (i + 1 < sizeof(pairs) / sizeof(pairs[0]))
+		{
+			if (*end != ',')
+			{
+				return kCommonConstantReturnTypeError;
+			}
+			cursor = end + 1;
+		}
+		else if (*end != '\0')
+		{
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Parses the bounds of the uniform inputs, given as a comma-separated list of the
+ *		lower and upper bound of Vrh, then of Vt, then of Vdd. The supply voltage must be
+ *		positive.
+ *
+ *	@param	inputBoundsArg	: The argument string of the `-d` option.
+ *	@param	arguments	: Pointer to command line arguments struct.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseInputBounds(const char *  inputBoundsArg, CommandLineArguments *  arguments)
+{
+	const char *	cursor = inputBoundsArg;
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		char *	end;
+		double	low = strtod(cursor, &end);
+		double	high;
+
+		if ((end == cursor) || (*end != ','))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+
+		cursor = end + 1;
+		high = strtod(cursor, &end);
+		if ((end == cursor) || (*end != ((i + 1 < kInputDistributionIndexMax) ? ',' : '\0'))
+			|| !isfinite(low) || !isfinite(high) || !(low < high)
+			|| ((i == kInputDistributionIndexVsupply) && !(low > 0.0)))
+		{
+			return kCommonConstantReturnTypeError;
+		}
+		cursor = end + 1;
+
+		arguments->inputLowerBound[i] = low;
+		arguments->inputUpperBound[i] = high;
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/**
+ *	@brief	Parses the drifts of the Kalman filter, given as the standard deviations of the
+ *		random walks of the relative humidity and of the temperature in Celsius. The drift
+ *		of the temperature in Fahrenheit follows from the one in Celsius.
+ *
+ *	@param	kalmanFilterArg	: The argument string of the `-H` option.
+ *	@param	arguments	: Pointer to command line arguments struct.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+static CommonConstantReturnType
+parseKalmanFilterProcessNoise(const char *  kalmanFilterArg, CommandLineArguments *  arguments)
+{
+	char *	end;
+	double	relativeHumidityDrift = strtod(kalmanFilterArg, &end);
+	double	temperatureDrift;
+
+	if ((end == kalmanFilterArg) || (*end != ',') || !(relativeHumidityDrift >= 0.0) || !isfinite(relativeHumidityDrift))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	kalmanFilterArg = end + 1;
+	temperatureDrift = strtod(kalmanFilterArg, &end);
+	if ((end == kalmanFilterArg) || (*end != '\0') || !(temperatureDrift >= 0.0) || !isfinite(temperatureDrift))
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	arguments->kalmanFilterProcessNoiseVariance[kSensorModelChannelRelativeHumidity] = relativeHumidityDrift * relativeHumidityDrift;
+	arguments->kalmanFilterProcessNoiseVariance[kSensorModelChannelTemperatureCelcius] = temperatureDrift * temperatureDrift;
+	arguments->kalmanFilterProcessNoiseVariance[kSensorModelChannelTemperatureFahrenheit] = (1.8 * temperatureDrift) * (1.8 * temperatureDrift);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+getCommandLineArguments(
+	int			argc,
+	char *			argv[],
+	CommandLineArguments *	arguments)
+{
+	char *			correlationArg = NULL;
+	char *			arrowOutputArg = NULL;
+	char *			ndjsonOutputArg = NULL;
+	char *			ndjsonBatchArg = NULL;
+	char *			reservoirArg = NULL;
+	char *			traceArg = NULL;
+	char *			traceIntervalArg = NULL;
+	char *			threadsArg = NULL;
+	char *			divisionAccuracyArg = NULL;
+	char *			sensorModelArg = NULL;
+	char *			outputOrderArg = NULL;
+	char *			randomPoolGenerateArg = NULL;
+	char *			randomPoolSizeArg = NULL;
+	char *			randomPoolArg = NULL;
+	char *			randomPoolSeedArg = NULL;
+	char *			surrogateTableBuildArg = NULL;
+	char *			surrogateTableArg = NULL;
+	char *			polynomialChaosArg = NULL;
+	char *			latencyTargetArg = NULL;
+	char *			progressFileArg = NULL;
+	char *			progressIntervalArg = NULL;
+	char *			progressShowArg = NULL;
+	char *			metricsArg = NULL;
+	bool			isDistributionCodeEnabled = false;
+	char *			distributionCodeDecodeArg = NULL;
+	char *			kalmanFilterArg = NULL;
+	char *			outOfCoreArg = NULL;
+	char *			wassersteinReferenceArg = NULL;
+	char *			compressedSamplesArg = NULL;
+	char *			compressionErrorArg = NULL;
+	char *			decompressSamplesArg = NULL;
+	char *			timeSeriesArg = NULL;
+	char *			timeSeriesShowArg = NULL;
+	char *			timeSeriesFromArg = NULL;
+	char *			inputBoundsArg = NULL;
+	char *			incrementalCacheArg = NULL;
+	DemoOption		demoSpecificOptions[] =
+				{
+					{ .opt = "c", .optAlternative = "correlation", .hasArg = true, .foundArg = &correlationArg, .foundOpt = NULL },
+					{ .opt = "a", .optAlternative = "arrow", .hasArg = true, .foundArg = &arrowOutputArg, .foundOpt = NULL },
+					{ .opt = "n", .optAlternative = "ndjson", .hasArg = true, .foundArg = &ndjsonOutputArg, .foundOpt = NULL },
+					{ .opt = "N", .optAlternative = "ndjson-batch", .hasArg = true, .foundArg = &ndjsonBatchArg, .foundOpt = NULL },
+					{ .opt = "R", .optAlternative = "reservoir", .hasArg = true, .foundArg = &reservoirArg, .foundOpt = NULL },
+					{ .opt = "t", .optAlternative = "trace", .hasArg = true, .foundArg = &traceArg, .foundOpt = NULL },
+					{ .opt = "I", .optAlternative = "trace-interval", .hasArg = true, .foundArg = &traceIntervalArg, .foundOpt = NULL },
+					{ .opt = "L", .optAlternative = "latency-target", .hasArg = true, .foundArg = &latencyTargetArg, .foundOpt = NULL },
+					{ .opt = "W", .optAlternative = "threads", .hasArg = true, .foundArg = &threadsArg, .foundOpt = NULL },
+					{ .opt = "A", .optAlternative = "division-accuracy", .hasArg = true, .foundArg = &divisionAccuracyArg, .foundOpt = NULL },
+					{ .opt = "V", .optAlternative = "sensor-model", .hasArg = true, .foundArg = &sensorModelArg, .foundOpt = NULL },
+					{ .opt = "O", .optAlternative = "output-order", .hasArg = true, .foundArg = &outputOrderArg, .foundOpt = NULL },
+					{ .opt = "G", .optAlternative = "random-pool-generate", .hasArg = true, .foundArg = &randomPoolGenerateArg, .foundOpt = NULL },
+					{ .opt = "Z", .optAlternative = "random-pool-size", .hasArg = true, .foundArg = &randomPoolSizeArg, .foundOpt = NULL },
+					{ .opt = "P", .optAlternative = "random-pool", .hasArg = true, .foundArg = &randomPoolArg, .foundOpt = NULL },
+					{ .opt = "K", .optAlternative = "random-pool-seed", .hasArg = true, .foundArg = &randomPoolSeedArg, .foundOpt = NULL },
+					{ .opt = "U", .optAlternative = "surrogate-table-build", .hasArg = true, .foundArg = &surrogateTableBuildArg, .foundOpt = NULL },
+					{ .opt = "Q", .optAlternative = "surrogate-table", .hasArg = true, .foundArg = &surrogateTableArg, .foundOpt = NULL },
+					{ .opt = "E", .optAlternative = "polynomial-chaos", .hasArg = true, .foundArg = &polynomialChaosArg, .foundOpt = NULL },
+					{ .opt = "F", .optAlternative = "progress-file", .hasArg = true, .foundArg = &progressFileArg, .foundOpt = NULL },
+					{ .opt = "D", .optAlternative = "progress-interval", .hasArg = true, .foundArg = &progressIntervalArg, .foundOpt = NULL },
+					{ .opt = "Y", .optAlternative = "progress-show", .hasArg = true, .foundArg = &progressShowArg, .foundOpt = NULL },
+					{ .opt = "X", .optAlternative = "metrics", .hasArg = true, .foundArg = &metricsArg, .foundOpt = NULL },
+					{ .opt = "C", .optAlternative = "distribution-code", .hasArg = false, .foundArg = NULL, .foundOpt = &isDistributionCodeEnabled },
+					{ .opt = "B", .optAlternative = "distribution-code-decode", .hasArg = true, .foundArg = &distributionCodeDecodeArg, .foundOpt = NULL },
+					{ .opt = "H", .optAlternative = "kalman-filter", .hasArg = true, .foundArg = &kalmanFilterArg, .foundOpt = NULL },
+					{ .opt = "J", .optAlternative = "out-of-core", .hasArg = true, .foundArg = &outOfCoreArg, .foundOpt = NULL },
+					{ .opt = "w", .optAlternative = "wasserstein-reference", .hasArg = true, .foundArg = &wassersteinReferenceArg, .foundOpt = NULL },
+					{ .opt = "z", .optAlternative = "compressed-samples", .hasArg = true, .foundArg = &compressedSamplesArg, .foundOpt = NULL },
+					{ .opt = "e", .optAlternative = "compression-error", .hasArg = true, .foundArg = &compressionErrorArg, .foundOpt = NULL },
+					{ .opt = "x", .optAlternative = "decompress-samples", .hasArg = true, .foundArg = &decompressSamplesArg, .foundOpt = NULL },
+					{ .opt = "g", .optAlternative = "time-series", .hasArg = true, .foundArg = &timeSeriesArg, .foundOpt = NULL },
+					{ .opt = "y", .optAlternative = "time-series-show", .hasArg = true, .foundArg = &timeSeriesShowArg, .foundOpt = NULL },
+					{ .opt = "u", .optAlternative = "time-series-from", .hasArg = true, .foundArg = &timeSeriesFromArg, .foundOpt = NULL },
+					{ .opt = "d", .optAlternative = "input-bounds", .hasArg = true, .foundArg = &inputBoundsArg, .foundOpt = NULL },
+					{ .opt = "k", .optAlternative = "incremental-cache", .hasArg = true, .foundArg = &incrementalCacheArg, .foundOpt = NULL },
+					{0},
+				};
+
+	if (arguments == NULL)
+	{
+		fprintf(stderr, "Arguments pointer is NULL.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	setDefaultCommandLineArguments(arguments);
+
+	if (parseArgs(argc, argv, &arguments->common, demoSpecificOptions) != 0)
+	{
+		fprintf(stderr, "Parsing command line arguments failed\n");
+		printUsage();
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	Process command-line arguments
+	 */
+	if (arguments->common.isHelpEnabled)
+	{
+		printUsage();
+
+		exit(EXIT_SUCCESS);
+	}
+
+	if (correlationArg != NULL)
+	{
+		if (parseInputCorrelationMatrix(correlationArg, arguments) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The input correlation (-c) must be three comma-separated real numbers in (-1, 1).\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isInputCorrelationEnabled = true;
+	}
+
+	if (arrowOutputArg != NULL)
+	{
+		int	length = snprintf(arguments->arrowOutputFilePath, kCommonConstantMaxCharsPerFilepath, "%s", arrowOutputArg);
+
+		if ((length < 0) || (length >= kCommonConstantMaxCharsPerFilepath))
+		{
+			fprintf(stderr, "Error: The Arrow IPC output file path (-a) is too long.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isArrowOutputEnabled = true;
+	}
+
+	if (ndjsonOutputArg != NULL)
+	{
+		int	length = snprintf(arguments->ndjsonOutputFilePath, kCommonConstantMaxCharsPerFilepath, "%s", ndjsonOutputArg);
+
+		if ((length < 0) || (length >= kCommonConstantMaxCharsPerFilepath))
+		{
+			fprintf(stderr, "Error: The NDJSON output file path (-n) is too long.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isNDJSONOutputEnabled = true;
+	}
+
+	if (ndjsonBatchArg != NULL)
+	{
+		int	ndjsonBatchSize;
+
+		if ((parseIntChecked(ndjsonBatchArg, &ndjsonBatchSize) != kCommonConstantReturnTypeSuccess) || (ndjsonBatchSize <= 0))
+		{
+			fprintf(stderr, "Error: The NDJSON batch size (-N) must be a positive integer.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->isNDJSONOutputEnabled)
+		{
+			fprintf(stderr, "Error: The NDJSON batch size (-N) requires an NDJSON output (-n).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->ndjsonBatchSize = (size_t)ndjsonBatchSize;
+	}
+
+	if (reservoirArg != NULL)
+	{
+		int	reservoirCapacity;
+
+		if ((parseIntChecked(reservoirArg, &reservoirCapacity) != kCommonConstantReturnTypeSuccess) || (reservoirCapacity <= 0))
+		{
+			fprintf(stderr, "Error: The reservoir size (-R) must be a positive integer.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->common.isMonteCarloMode)
+		{
+			fprintf(stderr, "Error: The reservoir (-R) is only supported in Monte Carlo mode.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->reservoirCapacity = (size_t)reservoirCapacity;
+	}
+
+	if (traceArg != NULL)
+	{
+		int	length = snprintf(arguments->traceFilePath, kCommonConstantMaxCharsPerFilepath, "%s", traceArg);
+
+		if ((length < 0) || (length >= kCommonConstantMaxCharsPerFilepath))
+		{
+			fprintf(stderr, "Error: The trace file path (-t) is too long.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isTraceEnabled = true;
+	}
+
+	arguments->traceSamplingInterval = 1;
+	if (traceIntervalArg != NULL)
+	{
+		int	traceSamplingInterval;
+
+		if ((parseIntChecked(traceIntervalArg, &traceSamplingInterval) != kCommonConstantReturnTypeSuccess) || (traceSamplingInterval <= 0))
+		{
+			fprintf(stderr, "Error: The trace interval (-I) must be a positive integer.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->traceSamplingInterval = (size_t)traceSamplingInterval;
+	}
+
+	if (threadsArg != NULL)
+	{
+		int	numberOfThreads;
+
+		if ((parseIntChecked(threadsArg, &numberOfThreads) != kCommonConstantReturnTypeSuccess) || (numberOfThreads <= 0))
+		{
+			fprintf(stderr, "Error: The number of threads (-W) must be a positive integer.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->numberOfThreads = (size_t)numberOfThreads;
+	}
+
+	if (divisionAccuracyArg != NULL)
+	{
+		int	divisionAccuracyTier;
+
+		if ((parseIntChecked(divisionAccuracyArg, &divisionAccuracyTier) != kCommonConstantReturnTypeSuccess)
+			|| (divisionAccuracyTier < 0) || (divisionAccuracyTier >= kDivisionAccuracyTierMax))
+		{
+			fprintf(stderr, "Error: The division accuracy tier (-A) must be an integer from 0 to %d.\n", kDivisionAccuracyTierMax - 1);
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->divisionAccuracyTier = (DivisionAccuracyTier)divisionAccuracyTier;
+	}
+
+	arguments->sensorModel = sensorModelGetDefault();
+	if (sensorModelArg != NULL)
+	{
+		arguments->sensorModel = sensorModelFind(sensorModelArg);
+		if (arguments->sensorModel == NULL)
+		{
+			fprintf(stderr, "Error: Unknown sensor model (-V) \"%s\". The sensor models are:\n", sensorModelArg);
+			sensorModelPrintRegistry(stderr);
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if ((randomPoolGenerateArg != NULL) && (randomPoolArg != NULL))
+	{
+		fprintf(stderr, "Error: Please either generate a random pool (-G) or use one (-P).\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((randomPoolGenerateArg != NULL) || (randomPoolArg != NULL))
+	{
+		const char *	path = (randomPoolGenerateArg != NULL) ? randomPoolGenerateArg : randomPoolArg;
+		int		length = snprintf(arguments->randomPoolFilePath, kCommonConstantMaxCharsPerFilepath, "%s", path);
+
+		if ((length < 0) || (length >= kCommonConstantMaxCharsPerFilepath))
+		{
+			fprintf(stderr, "Error: The random pool file path (-G or -P) is too long.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isRandomPoolGenerationEnabled = (randomPoolGenerateArg != NULL);
+		arguments->isRandomPoolEnabled = (randomPoolArg != NULL);
+	}
+
+	arguments->randomPoolNumberOfValues = kRandomPoolDefaultNumberOfValues;
+	if (randomPoolSizeArg != NULL)
+	{
+		int	randomPoolNumberOfValues;
+
+		if ((parseIntChecked(randomPoolSizeArg, &randomPoolNumberOfValues) != kCommonConstantReturnTypeSuccess) || (randomPoolNumberOfValues <= 0))
+		{
+			fprintf(stderr, "Error: The random pool size (-Z) must be a positive integer.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->isRandomPoolGenerationEnabled)
+		{
+			fprintf(stderr, "Error: The random pool size (-Z) requires generating a random pool (-G).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->randomPoolNumberOfValues = (size_t)randomPoolNumberOfValues;
+	}
+
+	if (randomPoolSeedArg != NULL)
+	{
+		int	randomPoolRegionSeed;
+
+		if ((parseIntChecked(randomPoolSeedArg, &randomPoolRegionSeed) != kCommonConstantReturnTypeSuccess) || (randomPoolRegionSeed < 0))
+		{
+			fprintf(stderr, "Error: The random pool seed (-K) must be a non-negative integer.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->isRandomPoolEnabled)
+		{
+			fprintf(stderr, "Error: The random pool seed (-K) requires a random pool (-P).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->randomPoolRegionSeed = (uint64_t)randomPoolRegionSeed;
+	}
+
+	/*
+	 *	The pool holds independent uniforms for the native Monte Carlo loop.
+	 */
+	if (arguments->isRandomPoolEnabled)
+	{
+		if (!arguments->common.isMonteCarloMode || arguments->isInputCorrelationEnabled || arguments->common.isInputFromFileEnabled)
+		{
+			fprintf(stderr, "Error: The random pool (-P) requires Monte Carlo mode (-M), and does not support -c or -i.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if ((surrogateTableBuildArg != NULL) && (surrogateTableArg != NULL))
+	{
+		fprintf(stderr, "Error: Please either build a surrogate table (-U) or use one (-Q).\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((surrogateTableBuildArg != NULL) || (surrogateTableArg != NULL))
+	{
+		const char *	path = (surrogateTableBuildArg != NULL) ? surrogateTableBuildArg : surrogateTableArg;
+		int		length = snprintf(arguments->surrogateTableFilePath, kCommonConstantMaxCharsPerFilepath, "%s", path);
+
+		if ((length < 0) || (length >= kCommonConstantMaxCharsPerFilepath))
+		{
+			fprintf(stderr, "Error: The surrogate table file path (-U or -Q) is too long.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isSurrogateTableBuildEnabled = (surrogateTableBuildArg != NULL);
+		arguments->isSurrogateTableEnabled = (surrogateTableArg != NULL);
+	}
+
+	/*
+	 *	The surrogate table answers the per-reading summaries of batch mode.
+	 */
+	if (arguments->isSurrogateTableEnabled && !arguments->common.isInputFromFileEnabled)
+	{
+		fprintf(stderr, "Error: The surrogate table (-Q) requires batch mode (-i).\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (polynomialChaosArg != NULL)
+	{
+		int	polynomialChaosOrder;
+
+		if ((parseIntChecked(polynomialChaosArg, &polynomialChaosOrder) != kCommonConstantReturnTypeSuccess)
+			|| (polynomialChaosOrder < 1) || (polynomialChaosOrder > kPolynomialChaosMaxOrder))
+		{
+			fprintf(stderr, "Error: The polynomial chaos order (-E) must be an integer from 1 to %d.\n", kPolynomialChaosMaxOrder);
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		/*
+		 *	The expansion is in the independent uniform inputs, and replaces the model in the
+		 *	native Monte Carlo loop.
+		 */
+		if (!arguments->common.isMonteCarloMode || arguments->isInputCorrelationEnabled || arguments->common.isInputFromFileEnabled
+			|| arguments->isRandomPoolEnabled || arguments->isTraceEnabled)
+		{
+			fprintf(stderr, "Error: The polynomial chaos expansion (-E) requires Monte Carlo mode (-M), and does not support -c, -i, -P or -t.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->polynomialChaosOrder = (size_t)polynomialChaosOrder;
+	}
+
+	if (latencyTargetArg != NULL)
+	{
+		int	latencyTargetMilliseconds;
+
+		if ((parseIntChecked(latencyTargetArg, &latencyTargetMilliseconds) != kCommonConstantReturnTypeSuccess) || (latencyTargetMilliseconds <= 0))
+		{
+			fprintf(stderr, "Error: The latency target (-L) must be a positive integer.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		/*
+		 *	The surrogate table answers readings at a fixed cost, so it has no budget to adapt.
+		 */
+		if (!arguments->common.isInputFromFileEnabled || arguments->isSurrogateTableEnabled)
+		{
+			fprintf(stderr, "Error: The latency target (-L) requires batch mode (-i), and does not support -Q.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->latencyTargetMilliseconds = (size_t)latencyTargetMilliseconds;
+	}
+
+	if (outputOrderArg != NULL)
+	{
+		if ((strcmp(outputOrderArg, "ordered") != 0) && (strcmp(outputOrderArg, "unordered") != 0))
+		{
+			fprintf(stderr, "Error: The output order (-O) must be \"ordered\" or \"unordered\".\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		/*
+		 *	Readings answered from a surrogate table, and anytime evaluations, are written in
+		 *	order as a whole.
+		 */
+		arguments->isUnorderedOutputEnabled = (strcmp(outputOrderArg, "unordered") == 0);
+		if (arguments->isUnorderedOutputEnabled
+			&& (!arguments->common.isInputFromFileEnabled || arguments->isSurrogateTableEnabled || (arguments->latencyTargetMilliseconds > 0)))
+		{
+			fprintf(stderr, "Error: Unordered output (-O) requires batch mode (-i), and does not support -Q or -L.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if ((progressFileArg != NULL) && (progressShowArg != NULL))
+	{
+		fprintf(stderr, "Error: Please either publish progress (-F) or show it (-Y).\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((progressFileArg != NULL) || (progressShowArg != NULL))
+	{
+		const char *	path = (progressFileArg != NULL) ? progressFileArg : progressShowArg;
+		int		length = snprintf(arguments->progressFilePath, kCommonConstantMaxCharsPerFilepath, "%s", path);
+
+		if ((length < 0) || (length >= kCommonConstantMaxCharsPerFilepath))
+		{
+			fprintf(stderr, "Error: The progress file path (-F or -Y) is too long.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isProgressPublicationEnabled = (progressFileArg != NULL);
+		arguments->isProgressShowEnabled = (progressShowArg != NULL);
+	}
+
+	/*
+	 *	Snapshots summarize the samples of the native Monte Carlo loop.
+	 */
+	if (arguments->isProgressPublicationEnabled && (!arguments->common.isMonteCarloMode || arguments->common.isInputFromFileEnabled))
+	{
+		fprintf(stderr, "Error: Progress publication (-F) requires Monte Carlo mode (-M), and does not support -i.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	arguments->progressIntervalMilliseconds = kProgressDefaultIntervalMilliseconds;
+	if (progressIntervalArg != NULL)
+	{
+		int	progressIntervalMilliseconds;
+
+		if ((parseIntChecked(progressIntervalArg, &progressIntervalMilliseconds) != kCommonConstantReturnTypeSuccess) || (progressIntervalMilliseconds <= 0))
+		{
+			fprintf(stderr, "Error: The progress interval (-D) must be a positive integer.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->isProgressPublicationEnabled)
+		{
+			fprintf(stderr, "Error: The progress interval (-D) requires progress publication (-F).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->progressIntervalMilliseconds = (size_t)progressIntervalMilliseconds;
+	}
+
+	if (metricsArg != NULL)
+	{
+		int	length = snprintf(arguments->metricsFilePath, kCommonConstantMaxCharsPerFilepath, "%s", metricsArg);
+
+		if ((length < 0) || (length >= kCommonConstantMaxCharsPerFilepath))
+		{
+			fprintf(stderr, "Error: The metrics file path (-X) is too long.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isMetricsOutputEnabled = true;
+	}
+
+	if (distributionCodeDecodeArg != NULL)
+	{
+		int	length = snprintf(arguments->distributionCodeText, sizeof(arguments->distributionCodeText), "%s", distributionCodeDecodeArg);
+
+		if ((length < 0) || (length != kDistributionCodeBase64Length))
+		{
+			fprintf(stderr, "Error: The distribution code (-B) must be %d base64 characters.\n", kDistributionCodeBase64Length);
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isDistributionCodeDecodeEnabled = true;
+	}
+
+	/*
+	 *	Codes are encoded from the samples of one output, or from the closed form of the
+	 *	calibrated outputs of each reading in batch mode.
+	 */
+	if (isDistributionCodeEnabled
+		&& !arguments->common.isInputFromFileEnabled
+		&& (!arguments->common.isMonteCarloMode || !arguments->common.isOutputSelected || (arguments->common.outputSelect >= kOutputDistributionIndexMax)
+			|| arguments->common.isOutputJSONMode || arguments->common.isBenchmarkingMode))
+	{
+		fprintf(stderr, "Error: Distribution codes (-C) require batch mode (-i), or Monte Carlo mode (-M) with one output (-S) and without -j or -b.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+	arguments->isDistributionCodeEnabled = isDistributionCodeEnabled;
+
+	if (kalmanFilterArg != NULL)
+	{
+		if (parseKalmanFilterProcessNoise(kalmanFilterArg, arguments) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The Kalman filter drifts (-H) must be two comma-separated non-negative real numbers.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		/*
+		 *	Each sensor's filter fuses its readings in order.
+		 */
+		if (!arguments->common.isInputFromFileEnabled || arguments->isUnorderedOutputEnabled)
+		{
+			fprintf(stderr, "Error: The Kalman filter (-H) requires batch mode (-i), and does not support -O unordered.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isKalmanFilterEnabled = true;
+	}
+
+	if (outOfCoreArg != NULL)
+	{
+		int	length = snprintf(arguments->outOfCoreDirectoryPath, kCommonConstantMaxCharsPerFilepath, "%s", outOfCoreArg);
+
+		if ((length < 0) || (length >= kCommonConstantMaxCharsPerFilepath))
+		{
+			fprintf(stderr, "Error: The out-of-core spill directory path (-J) is too long.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		/*
+		 *	The samples of one output go to disk in place of the sample array, so nothing
+		 *	that reads the array afterwards is available.
+		 */
+		if (!arguments->common.isMonteCarloMode || !arguments->common.isOutputSelected || (arguments->common.outputSelect >= kOutputDistributionIndexMax)
+			|| arguments->common.isInputFromFileEnabled || arguments->common.isOutputJSONMode || arguments->isArrowOutputEnabled
+			|| (arguments->reservoirCapacity > 0) || arguments->isDistributionCodeEnabled)
+		{
+			fprintf(stderr, "Error: Out-of-core mode (-J) requires Monte Carlo mode (-M) with one output (-S), and does not support -i, -j, -a, -R or -C.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isOutOfCoreEnabled = true;
+	}
+
+	if (wassersteinReferenceArg != NULL)
+	{
+		int	length = snprintf(arguments->wassersteinReferenceFilePath, kCommonConstantMaxCharsPerFilepath, "%s", wassersteinReferenceArg);
+
+		if ((length < 0) || (length >= kCommonConstantMaxCharsPerFilepath))
+		{
+			fprintf(stderr, "Error: The Wasserstein reference file path (-w) is too long.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->isOutOfCoreEnabled)
+		{
+			fprintf(stderr, "Error: The Wasserstein reference (-w) requires out-of-core mode (-J).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isWassersteinReferenceEnabled = true;
+	}
+
+	if ((compressedSamplesArg != NULL) && (decompressSamplesArg != NULL))
+	{
+		fprintf(stderr, "Error: Please either write compressed samples (-z) or decompress them (-x).\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((compressedSamplesArg != NULL) || (decompressSamplesArg != NULL))
+	{
+		const char *	path = (compressedSamplesArg != NULL) ? compressedSamplesArg : decompressSamplesArg;
+		int		length = snprintf(arguments->compressedSamplesFilePath, kCommonConstantMaxCharsPerFilepath, "%s", path);
+
+		if ((length < 0) || (length >= kCommonConstantMaxCharsPerFilepath))
+		{
+			fprintf(stderr, "Error: The compressed sample file path (-z or -x) is too long.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isSampleCompressionEnabled = (compressedSamplesArg != NULL);
+		arguments->isSampleDecompressionEnabled = (decompressSamplesArg != NULL);
+	}
+
+	/*
+	 *	The compressed file takes the place of `data.out`, which only holds the samples of one output.
+	 */
+	if (arguments->isSampleCompressionEnabled
+		&& (!arguments->common.isMonteCarloMode || !arguments->common.isOutputSelected || (arguments->common.outputSelect >= kOutputDistributionIndexMax)
+			|| arguments->common.isInputFromFileEnabled || arguments->isOutOfCoreEnabled))
+	{
+		fprintf(stderr, "Error: Compressed samples (-z) require Monte Carlo mode (-M) with one output (-S), and do not support -i or -J.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((timeSeriesArg != NULL) && (timeSeriesShowArg != NULL))
+	{
+		fprintf(stderr, "Error: Please either write a time series (-g) or print one (-y).\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if ((timeSeriesArg != NULL) || (timeSeriesShowArg != NULL))
+	{
+		const char *	path = (timeSeriesArg != NULL) ? timeSeriesArg : timeSeriesShowArg;
+		int		length = snprintf(arguments->timeSeriesFilePath, kCommonConstantMaxCharsPerFilepath, "%s", path);
+
+		if ((length < 0) || (length >= kCommonConstantMaxCharsPerFilepath))
+		{
+			fprintf(stderr, "Error: The time-series file path (-g or -y) is too long.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isTimeSeriesOutputEnabled = (timeSeriesArg != NULL);
+		arguments->isTimeSeriesPrintEnabled = (timeSeriesShowArg != NULL);
+	}
+
+	/*
+	 *	A time series holds the calibrated outputs of successive readings, in their order.
+	 */
+	if (arguments->isTimeSeriesOutputEnabled
+		&& (!arguments->common.isInputFromFileEnabled || arguments->isUnorderedOutputEnabled
+			|| (arguments->common.isOutputSelected && (arguments->common.outputSelect >= kSensorModelChannelMax)
+				&& (arguments->common.outputSelect < kOutputDistributionIndexMax))))
+	{
+		fprintf(stderr, "Error: A time series (-g) requires batch mode (-i) and a calibrated output (-S), and does not support -O unordered.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	if (timeSeriesFromArg != NULL)
+	{
+		char *	end;
+
+		arguments->timeSeriesSeekSeconds = strtod(timeSeriesFromArg, &end);
+		if ((end == timeSeriesFromArg) || (*end != '\0') || !isfinite(arguments->timeSeriesSeekSeconds))
+		{
+			fprintf(stderr, "Error: The time-series start (-u) must be a real number.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->isTimeSeriesPrintEnabled)
+		{
+			fprintf(stderr, "Error: The time-series start (-u) requires printing a time series (-y).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isTimeSeriesSeekEnabled = true;
+	}
+
+	/*
+	 *	Readings of batch mode carry their own bounds, and the surrogate table is built for
+	 *	the widths of the default bounds.
+	 */
+	if (inputBoundsArg != NULL)
+	{
+		if (parseInputBounds(inputBoundsArg, arguments) != kCommonConstantReturnTypeSuccess)
+		{
+			fprintf(stderr, "Error: The input bounds (-d) must be three comma-separated pairs of increasing real numbers, with a positive supply voltage.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (arguments->common.isInputFromFileEnabled || arguments->isSurrogateTableBuildEnabled)
+		{
+			fprintf(stderr, "Error: The input bounds (-d) do not support -i or -U.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	if (incrementalCacheArg != NULL)
+	{
+		int	length = snprintf(arguments->incrementalCacheDirectoryPath, sizeof(arguments->incrementalCacheDirectoryPath), "%s", incrementalCacheArg);
+
+		if ((length < 0) || ((size_t)length >= sizeof(arguments->incrementalCacheDirectoryPath)))
+		{
+			fprintf(stderr, "Error: The incremental cache directory path (-k) is too long.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		/*
+		 *	The cached inputs are independent uniforms of generators of their own, and the
+		 *	conversion is split into columns that the trace does not see.
+		 */
+		if (!arguments->common.isMonteCarloMode || arguments->common.isInputFromFileEnabled || arguments->isInputCorrelationEnabled
+			|| arguments->isRandomPoolEnabled || (arguments->polynomialChaosOrder > 0) || arguments->isTraceEnabled)
+		{
+			fprintf(stderr, "Error: The incremental cache (-k) requires Monte Carlo mode (-M), and does not support -i, -c, -P, -E or -t.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		arguments->isIncrementalCacheEnabled = true;
+	}
+
+	if (compressionErrorArg != NULL)
+	{
+		char *	end;
+
+		arguments->sampleCompressionErrorBound = strtod(compressionErrorArg, &end);
+		if ((end == compressionErrorArg) || (*end != '\0') || !(arguments->sampleCompressionErrorBound > 0) || !isfinite(arguments->sampleCompressionErrorBound))
+		{
+			fprintf(stderr, "Error: The compression error bound (-e) must be a positive real number.\n");
+			printUsage();
+
+			return kCommonConstantReturnTypeError;
+		}
+
+		if (!arguments->isSampleCompressionEnabled && !arguments->isTimeSeriesOutputEnabled)
+		{
+			fprintf(stderr, "Error: The compression error bound (-e) requires compressed samples (-z) or a time series (-g).\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	/*
+	 *	On more than one thread, the reservoir is filled by threads that draw independent
+	 *	uniform inputs from generators of their own, and that only keep the selected output.
+	 */
+	if ((arguments->reservoirCapacity > 0) && (arguments->numberOfThreads > 1))
+	{
+		if (arguments->isInputCorrelationEnabled || arguments->isRandomPoolEnabled || (arguments->polynomialChaosOrder > 0)
+			|| arguments->isIncrementalCacheEnabled || arguments->isTraceEnabled || arguments->isNDJSONOutputEnabled
+			|| arguments->isProgressPublicationEnabled || arguments->isMetricsOutputEnabled)
+		{
+			fprintf(stderr, "Error: A reservoir (-R) on more than one thread (-W) does not support -c, -P, -E, -k, -t, -n, -F or -X.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	/*
+	 *	Batch mode evaluates each reading of the input file on its own, natively, and
+	 *	only writes per-reading summaries.
+	 */
+	if (arguments->common.isInputFromFileEnabled)
+	{
+		if (arguments->isInputCorrelationEnabled || arguments->isArrowOutputEnabled || (arguments->ndjsonBatchSize > 0)
+			|| (arguments->reservoirCapacity > 0) || arguments->isTraceEnabled || arguments->common.isBenchmarkingMode
+			|| arguments->common.isWriteToFileEnabled || arguments->common.isOutputJSONMode
+			|| (arguments->divisionAccuracyTier != kDivisionAccuracyTierExact) || arguments->isSurrogateTableBuildEnabled)
+		{
+			fprintf(stderr, "Error: Batch mode (-i) only supports the -S, -M, -T, -n, -W, -Q, -L, -X, -V, -O, -C, -H, -g and -e options.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	/*
+	 *	Write to output file is not supported in MonteCarlo Mode.
+	 */
+	if (arguments->common.isWriteToFileEnabled && arguments->common.isMonteCarloMode)
+	{
+		fprintf(stderr, "Writing to output file is not supported in MonteCarlo Mode.\n");
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	/*
+	 *	If no output selected from CLA, set the print all value as default.
+	 */
+	if (!arguments->common.isOutputSelected)
+	{
+		arguments->common.outputSelect = kOutputDistributionIndexMax;
+	}
+
+	/*
+	 *	If a single output is selected, we must be in benchmarking mode or Monte Carlo mode.
+	 */
+	if (arguments->common.outputSelect > kOutputDistributionIndexMax)
+	{
+		fprintf(
+			stderr,
+			"Output select value (-S option) is greater than the possible number of outputs: Provided %zd. Max: %d\n",
+			arguments->common.outputSelect,
+			kOutputDistributionIndexMax);
+	}
+	/*
+	 *	When all outputs are selected, we cannot be in benchmarking mode, or keep Monte Carlo
+	 *	samples in a reservoir. Monte Carlo mode then accumulates joint output statistics
+	 *	instead of output samples.
+	 */
+	else if (arguments->common.outputSelect == kOutputDistributionIndexMax)
+	{
+		if ((arguments->common.isBenchmarkingMode) || (arguments->reservoirCapacity > 0))
+		{
+			fprintf(stderr, "Error: Please select a single output when in benchmarking mode or when using a reservoir.\n");
+
+			return kCommonConstantReturnTypeError;
+		}
+	}
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+setInputCorrelation(CommandLineArguments *  arguments, InputCorrelation *  inputCorrelation)
+{
+	*inputCorrelation = (InputCorrelation) {0};
+
+	if (!arguments->isInputCorrelationEnabled)
+	{
+		return kCommonConstantReturnTypeSuccess;
+	}
+
+	/*
+	 *	Cholesky-Banachiewicz decomposition. The matrix is tiny, so this runs
+	 *	once at startup and the sampling loop only does the triangular product.
+	 */
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		for (size_t j = 0; j <= i; j++)
+		{
+			double	sum = arguments->inputCorrelationMatrix[i][j];
+
+			for (size_t k = 0; k < j; k++)
+			{
+				sum -= inputCorrelation->choleskyFactor[i][k] * inputCorrelation->choleskyFactor[j][k];
+			}
+
+			if (i == j)
+			{
+				if (!(sum > 0.0))
+				{
+					fprintf(stderr, "Error: The input correlation matrix (-c) is not positive definite.\n");
+
+					return kCommonConstantReturnTypeError;
+				}
+				inputCorrelation->choleskyFactor[i][i] = sqrt(sum);
+			}
+			else
+			{
+				inputCorrelation->choleskyFactor[i][j] = sum / inputCorrelation->choleskyFactor[j][j];
+			}
+		}
+	}
+
+	inputCorrelation->isEnabled = true;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Compact NDJSON field names of the outputs, indexed by `OutputDistributionIndex`.
+ */
+static const char *	kNDJSONOutputKeys[kOutputDistributionIndexMax] =
+			{
+				[kOutputDistributionIndexCalibratedRelativeHumidity]		= "rh",
+				[kOutputDistributionIndexCalibratedTemperatureCelcius]		= "tC",
+				[kOutputDistributionIndexCalibratedTemperatureFahrenheit]	= "tF",
+				[kOutputDistributionIndexDewPointCelcius]			= "dpC",
+				[kOutputDistributionIndexAbsoluteHumidity]			= "ah",
+				[kOutputDistributionIndexHeatIndexCelcius]			= "hiC",
+			};
+
+void
+getSelectedOutputRange(CommandLineArguments *  arguments, size_t *  lowerBound, size_t *  upperBound)
+{
+	if (arguments->common.outputSelect == kOutputDistributionIndexMax)
+	{
+		*lowerBound = 0;
+		*upperBound = kOutputDistributionIndexMax;
+	}
+	else
+	{
+		*lowerBound = arguments->common.outputSelect;
+		*upperBound = arguments->common.outputSelect + 1;
+	}
+
+	return;
+}
+
+void
+writeNDJSONReadingRecord(
+	NDJSONWriter *		writer,
+	CommandLineArguments *	arguments,
+	size_t			readingIndex,
+	double *		outputDistributions)
+{
+	size_t	lowerBound;
+	size_t	upperBound;
+
+	getSelectedOutputRange(arguments, &lowerBound, &upperBound);
+
+	ndjsonWriterBeginRecord(writer);
+	ndjsonWriterAddUnsigned(writer, "i", readingIndex);
+	for (size_t i = lowerBound; i < upperBound; i++)
+	{
+		ndjsonWriterAddDouble(writer, kNDJSONOutputKeys[i], outputDistributions[i]);
+	}
+	ndjsonWriterEndRecord(writer);
+
+	return;
+}
+
+void
+accumulateNDJSONBatchSummary(
+	NDJSONWriter *		writer,
+	CommandLineArguments *	arguments,
+	NDJSONBatchSummary *	batchSummary,
+	size_t *		batchIndex,
+	double *		outputDistributions)
+{
+	size_t	lowerBound;
+	size_t	upperBound;
+
+	getSelectedOutputRange(arguments, &lowerBound, &upperBound);
+
+	if (outputDistributions != NULL)
+	{
+		batchSummary->numberOfReadings++;
+		for (size_t i = lowerBound; i < upperBound; i++)
+		{
+			double	value = outputDistributions[i];
+			double	delta = value - batchSummary->mean[i];
+
+			batchSummary->mean[i] += delta / batchSummary->numberOfReadings;
+			batchSummary->sumOfSquaredDeviations[i] += delta * (value - batchSummary->mean[i]);
+
+			if ((batchSummary->numberOfReadings == 1) || (value < batchSummary->minimum[i]))
+			{
+				batchSummary->minimum[i] = value;
+			}
+			if ((batchSummary->numberOfReadings == 1) || (value > batchSummary->maximum[i]))
+			{
+				batchSummary->maximum[i] = value;
+			}
+		}
+
+		if (batchSummary->numberOfReadings < arguments->ndjsonBatchSize)
+		{
+			return;
+		}
+	}
+
+	if (batchSummary->numberOfReadings == 0)
+	{
+		return;
+	}
+
+	ndjsonWriterBeginRecord(writer);
+	ndjsonWriterAddUnsigned(writer, "batch", *batchIndex);
+	ndjsonWriterAddUnsigned(writer, "n", batchSummary->numberOfReadings);
+	for (size_t i = lowerBound; i < upperBound; i++)
+	{
+		ndjsonWriterBeginObject(writer, kNDJSONOutputKeys[i]);
+		ndjsonWriterAddDouble(writer, "mean", batchSummary->mean[i]);
+		ndjsonWriterAddDouble(
+			writer,
+			"variance",
+			(batchSummary->numberOfReadings > 1) ? batchSummary->sumOfSquaredDeviations[i] / (batchSummary->numberOfReadings - 1) : 0.0);
+		ndjsonWriterAddDouble(writer, "min", batchSummary->minimum[i]);
+		ndjsonWriterAddDouble(writer, "max", batchSummary->maximum[i]);
+		ndjsonWriterEndObject(writer);
+	}
+	ndjsonWriterEndRecord(writer);
+
+	/*
+	 *	Each batch summary is a completed result, so hand it to consumers right away.
+	 */
+	ndjsonWriterFlush(writer);
+
+	*batchSummary = (NDJSONBatchSummary) {0};
+	(*batchIndex)++;
+
+	return;
+}
+
+/*
+ *	Parses one line [line, lineEnd) of the CSV input of batch mode, as a `CSVScannerLineParser`.
+ */
+static CommonConstantReturnType
+parseBatchReadingFromCSVRecord(const char *  line, const char *  lineEnd, void *  item, bool *  isReading)
+{
+	const double	halfWidths[kInputDistributionIndexMax] =
+			{
+				[kInputDistributionIndexVrh]		= (kDefaultInputDistributionVrhUniformDistHigh - kDefaultInputDistributionVrhUniformDistLow) / 2,
+				[kInputDistributionIndexVt]		= (kDefaultInputDistributionVtUniformDistHigh - kDefaultInputDistributionVtUniformDistLow) / 2,
+				[kInputDistributionIndexVsupply]	= (kDefaultInputDistributionVsupplyUniformDistHigh - kDefaultInputDistributionVsupplyUniformDistLow) / 2,
+			};
+	BatchReading *	reading = item;
+	const char *	cursor = line;
+	const char *	end;
+	size_t		numberOfFields = 0;
+	double		fields[kInputDistributionIndexMax + 2];
+
+	/*
+	 *	Parse up to five comma-separated numbers. A line whose first field is not a
+	 *	number is a header or a comment.
+	 */
+	while (numberOfFields < sizeof(fields) / sizeof(fields[0]))
+	{
+		end = csvScannerParseDouble(cursor, lineEnd, &fields[numberOfFields]);
+		if (end == cursor)
+		{
+			break;
+		}
+		numberOfFields++;
+
+		while ((end < lineEnd) && ((*end == ' ') || (*end == '\t')))
+		{
+			end++;
+		}
+		if ((end == lineEnd) || (*end != ','))
+		{
+			break;
+		}
+		cursor = end + 1;
+	}
+
+	*isReading = false;
+	if (numberOfFields == 0)
+	{
+		return kCommonConstantReturnTypeSuccess;
+	}
+	if (numberOfFields < kInputDistributionIndexMax)
+	{
+		return kCommonConstantReturnTypeError;
+	}
+
+	for (size_t i = 0; i < kInputDistributionIndexMax; i++)
+	{
+		reading->lowerBound[i] = fields[i] - halfWidths[i];
+		reading->upperBound[i] = fields[i] + halfWidths[i];
+	}
+	reading->sequenceNumber = 0;
+	reading->timestamp = (numberOfFields > kInputDistributionIndexMax) ? fields[kInputDistributionIndexMax] : NAN;
+	reading->sensorId = (numberOfFields > kInputDistributionIndexMax + 1) ? (uint32_t)fields[kInputDistributionIndexMax + 1] : 0;
+	*isReading = true;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+CommonConstantReturnType
+parseBatchReadingFromCSVLine(const char *  line, BatchReading *  reading, bool *  isReading)
+{
+	return parseBatchReadingFromCSVRecord(line, line + strlen(line), reading, isReading);
+}
+
+CommonConstantReturnType
+readBatchReadingsFromCSVFile(
+	const char *		filePath,
+	size_t			numberOfThreads,
+	BatchReading **		readings,
+	size_t *		numberOfReadings)
+{
+	void *	items = NULL;
+	size_t	count = 0;
+	size_t	errorLineNumber;
+
+	if (csvScannerReadFile(filePath, numberOfThreads, sizeof(BatchReading), parseBatchReadingFromCSVRecord, &items, &count, &errorLineNumber))
+	{
+		if (errorLineNumber > 0)
+		{
+			fprintf(stderr, "Error: Line %zu of the input file has fewer than %d values.\n", errorLineNumber, kInputDistributionIndexMax);
+		}
+
+		return kCommonConstantReturnTypeError;
+	}
+
+	*readings = items;
+	for (size_t i = 0; i < count; i++)
+	{
+		(*readings)[i].sequenceNumber = i;
+	}
+	*numberOfReadings = count;
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+/*
+ *	Closed form of one calibrated output of a reading, for the distribution code encoder.
+ */
+typedef struct
+{
+	const SensorModel *	model;
+	SensorModelChannel	channel;
+	const BatchReading *	reading;
+} ReadingChannelDistribution;
+
+static double
+getReadingChannelDistributionFunction(const void *  context, double value)
+{
+	const ReadingChannelDistribution *	distribution = context;
+
+	return sensorModelGetChannelDistributionFunction(
+			distribution->model,
+			distribution->channel,
+			distribution->reading->lowerBound,
+			distribution->reading->upperBound,
+			value);
+}
+
+/*
+ *	Encodes the distribution of a calibrated output of a reading as base64 text, and
+ *	returns its Wasserstein error.
+ */
+static double
+getReadingChannelDistributionCode(
+	CommandLineArguments *	arguments,
+	const BatchReading *	reading,
+	SensorModelChannel	channel,
+	char *			text)
+{
+	ReadingChannelDistribution	distribution =
+					{
+						.model		= arguments->sensorModel,
+						.channel	= channel,
+						.reading	= reading,
+					};
+	DistributionCode		code;
+	double				minimum;
+	double				maximum;
+
+	sensorModelGetChannelRange(arguments->sensorModel, channel, reading->lowerBound, reading->upperBound, &minimum, &maximum);
+	distributionCodeEncodeDistributionFunction(&code, getReadingChannelDistributionFunction, &distribution, minimum, maximum);
+	distributionCodeToBase64(&code, text);
+
+	return code.wassersteinError;
+}
+
+void
+writeBatchReadingSummariesHeader(CommandLineArguments *  arguments, bool hasQuantiles)
+{
+	size_t	lowerBound;
+	size_t	upperBound;
+
+	getSelectedOutputRange(arguments, &lowerBound, &upperBound);
+
+	printf("sequenceNumber,timestamp,sensorId,numberOfSamples");
+	for (size_t i = lowerBound; i < upperBound; i++)
+	{
+		printf(",%s.mean,%s.variance,%s.min,%s.max", kNDJSONOutputKeys[i], kNDJSONOutputKeys[i], kNDJSONOutputKeys[i], kNDJSONOutputKeys[i]);
+		if (arguments->latencyTargetMilliseconds > 0)
+		{
+			printf(",%s.standardError", kNDJSONOutputKeys[i]);
+		}
+		if (hasQuantiles)
+		{
+			for (size_t q = 0; q < kSurrogateTableNumberOfQuantiles; q++)
+			{
+				printf(",%s.%s", kNDJSONOutputKeys[i], kSurrogateTableQuantileKeys[q]);
+			}
+			printf(",%s.errorBound", kNDJSONOutputKeys[i]);
+		}
+		if (arguments->isDistributionCodeEnabled && (i < kSensorModelChannelMax))
+		{
+			printf(",%s.code,%s.codeError", kNDJSONOutputKeys[i], kNDJSONOutputKeys[i]);
+		}
+		if (arguments->isKalmanFilterEnabled && (i < kSensorModelChannelMax))
+		{
+			printf(",%s.filterMean,%s.filterVariance", kNDJSONOutputKeys[i], kNDJSONOutputKeys[i]);
+		}
+	}
+	printf("\n");
+
+	return;
+}
+
+/**
+ *	@brief  Appends the means of the calibrated outputs of a reading to a time series. A reading
+ *		without a timestamp is placed one second after the reading before it.
+ *
+ *	@param  timeSeries	: Pointer to the open time-series writer.
+ *	@param  reading		: Pointer to the reading.
+ *	@param  summary		: Pointer to the summary of the reading.
+ */
+static void
+appendBatchReadingTimeSeriesRecord(TimeSeriesWriter *  timeSeries, const BatchReading *  reading, const BatchReadingSummary *  summary)
 {
-	/*
-	 *	Older GCC versions have a bug which gives a spurious warning for
-	 *	the C universal zero initializer `{0}`. Any workaround makes the
-	 *	code less portable or prevents the common code from adding new
-	 *	fields to the `CommonCommandLineArguments` struct. Therefore, we
-	 *	surpress this warning.
-	 *
-	 *	See https://gcc.gnu.org/bugzilla/show_bug.cgi?id=53119.
-	 */
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wmissing-braces"
+	TimeSeriesRecord	record;
 
-	*arguments = (CommandLineArguments)
+	record.time = isfinite(reading->timestamp)
+			? llround(reading->timestamp * kTimeSeriesTicksPerSecond)
+			: (int64_t)reading->sequenceNumber * kTimeSeriesTicksPerSecond;
+	record.sensorId = reading->sensorId;
+	for (size_t column = 0; column < timeSeries->header.numberOfColumns; column++)
 	{
-		.common	= (CommonCommandLineArguments) {0}
-	};
-#pragma GCC diagnostic pop
+		record.values[column] = summary->mean[timeSeries->header.outputs[column]];
+	}
+	timeSeriesWriterAdd(timeSeries, &record);
+
+	return;
+}
+
+void
+writeBatchReadingSummaries(
+	NDJSONWriter *			writer,
+	CommandLineArguments *		arguments,
+	const BatchReading *		readings,
+	const BatchReadingSummary *	summaries,
+	const SurrogateTableQuantiles *	quantiles,
+	KalmanFilterBank *		filterBank,
+	TimeSeriesWriter *		timeSeries,
+	size_t				numberOfReadings)
+{
+	size_t	lowerBound;
+	size_t	upperBound;
+	bool	isStandardErrorEnabled = (arguments->latencyTargetMilliseconds > 0);
+	char	codeText[kDistributionCodeBase64Length + 1];
+
+	getSelectedOutputRange(arguments, &lowerBound, &upperBound);
+
+	for (size_t reading = 0; reading < numberOfReadings; reading++)
+	{
+		const BatchReadingSummary *	summary = &summaries[reading];
+		bool				isFromTable = (quantiles != NULL) && quantiles[reading].isFromTable;
+		KalmanFilterPosterior		posterior;
+		bool				isFiltered = false;
+
+		/*
+		 *	The calibrated outputs are the first outputs, in the order of the channels. A
+		 *	reading of a sensor beyond the capacity of the bank is not filtered.
+		 */
+		if (filterBank != NULL)
+		{
+			isFiltered = kalmanFilterBankUpdate(
+					filterBank,
+					readings[reading].sensorId,
+					readings[reading].timestamp,
+					summary->mean,
+					summary->variance,
+					&posterior);
+		}
+
+		if (timeSeries != NULL)
+		{
+			appendBatchReadingTimeSeriesRecord(timeSeries, &readings[reading], summary);
+		}
+
+		if (writer != NULL)
+		{
+			ndjsonWriterBeginRecord(writer);
+			ndjsonWriterAddUnsigned(writer, "i", readings[reading].sequenceNumber);
+			if (isfinite(readings[reading].timestamp))
+			{
+				ndjsonWriterAddDouble(writer, "ts", readings[reading].timestamp);
+			}
+			ndjsonWriterAddUnsigned(writer, "sensor", readings[reading].sensorId);
+			ndjsonWriterAddUnsigned(writer, "n", summary->numberOfSamples);
+			for (size_t i = lowerBound; i < upperBound; i++)
+			{
+				ndjsonWriterBeginObject(writer, kNDJSONOutputKeys[i]);
+				ndjsonWriterAddDouble(writer, "mean", summary->mean[i]);
+				ndjsonWriterAddDouble(writer, "variance", summary->variance[i]);
+				ndjsonWriterAddDouble(writer, "min", summary->minimum[i]);
+				ndjsonWriterAddDouble(writer, "max", summary->maximum[i]);
+				if (isStandardErrorEnabled)
+				{
+					ndjsonWriterAddDouble(writer, "stderr", sqrt(summary->variance[i] / (double)summary->numberOfSamples));
+				}
+				if (isFromTable)
+				{
+					for (size_t q = 0; q < kSurrogateTableNumberOfQuantiles; q++)
+					{
+						ndjsonWriterAddDouble(writer, kSurrogateTableQuantileKeys[q], quantiles[reading].quantile[i][q]);
+					}
+					ndjsonWriterAddDouble(writer, "errorBound", quantiles[reading].errorBound[i]);
+				}
+				if (arguments->isDistributionCodeEnabled && (i < kSensorModelChannelMax))
+				{
+					double	codeError = getReadingChannelDistributionCode(arguments, &readings[reading], (SensorModelChannel)i, codeText);
+
+					ndjsonWriterAddString(writer, "code", codeText);
+					ndjsonWriterAddDouble(writer, "codeError", codeError);
+				}
+				if ((filterBank != NULL) && (i < kSensorModelChannelMax))
+				{
+					ndjsonWriterAddDouble(writer, "filterMean", isFiltered ? posterior.mean[i] : NAN);
+					ndjsonWriterAddDouble(writer, "filterVariance", isFiltered ? posterior.variance[i] : NAN);
+				}
+				ndjsonWriterEndObject(writer);
+			}
+			ndjsonWriterEndRecord(writer);
+
+			continue;
+		}
+
+		printf(
+			"%" PRIu64 ",%.6f,%" PRIu32 ",%" PRIu64,
+			readings[reading].sequenceNumber,
+			readings[reading].timestamp,
+			readings[reading].sensorId,
+			summary->numberOfSamples);
+		for (size_t i = lowerBound; i < upperBound; i++)
+		{
+			printf(",%.6g,%.6g,%.6g,%.6g", summary->mean[i], summary->variance[i], summary->minimum[i], summary->maximum[i]);
+			if (isStandardErrorEnabled)
+			{
+				printf(",%.3g", sqrt(summary->variance[i] / (double)summary->numberOfSamples));
+			}
+
+			/*
+			 *	Readings evaluated by Monte Carlo leave the quantile columns empty.
+			 */
+			if (isFromTable)
+			{
+				for (size_t q = 0; q < kSurrogateTableNumberOfQuantiles; q++)
+				{
+					printf(",%.6g", quantiles[reading].quantile[i][q]);
+				}
+				printf(",%.3g", quantiles[reading].errorBound[i]);
+			}
+			else if (quantiles != NULL)
+			{
+				for (size_t q = 0; q <= kSurrogateTableNumberOfQuantiles; q++)
+				{
+					printf(",");
+				}
+			}
+
+			if (arguments->isDistributionCodeEnabled && (i < kSensorModelChannelMax))
+			{
+				double	codeError = getReadingChannelDistributionCode(arguments, &readings[reading], (SensorModelChannel)i, codeText);
+
+				printf(",%s,%.3g", codeText, codeError);
+			}
+
+			if ((filterBank != NULL) && (i < kSensorModelChannelMax))
+			{
+				if (isFiltered)
+				{
+					printf(",%.6g,%.6g", posterior.mean[i], posterior.variance[i]);
+				}
+				else
+				{
+					printf(",,");
+				}
+			}
+		}
+		printf("\n");
+	}
+
+	return;
+}
+
+void
+printProgressSnapshot(
+	const ProgressSnapshot *	snapshot,
+	const char **			outputVariableDescriptions,
+	const char **			unitsOfMeasurement)
+{
+	printf(
+		"Progress: %" PRIu64 " of %" PRIu64 " samples (%.1lf%%) in %.3lf seconds, %s.\n",
+		snapshot->numberOfSamples,
+		snapshot->numberOfSamplesRequested,
+		(snapshot->numberOfSamplesRequested > 0) ? 100.0 * (double)snapshot->numberOfSamples / (double)snapshot->numberOfSamplesRequested : 0.0,
+		snapshot->elapsedSeconds,
+		snapshot->isFinal ? "finished" : "running");
+
+	for (size_t output = snapshot->lowerOutput; (output < snapshot->upperOutput) && (output < kOutputDistributionIndexMax); output++)
+	{
+		printf(
+			"\t%s: mean %.6lf %s, standard deviation %.6lf %s, standard error %.3g %s",
+			outputVariableDescriptions[output],
+			snapshot->mean[output],
+			unitsOfMeasurement[output],
+			sqrt(snapshot->variance[output]),
+			unitsOfMeasurement[output],
+			snapshot->standardError[output],
+			unitsOfMeasurement[output]);
+		for (size_t q = 0; q < kProgressSnapshotNumberOfQuantiles; q++)
+		{
+			printf(", %s %.6lf", kProgressSnapshotQuantileKeys[q], snapshot->quantile[output][q]);
+		}
+		printf(".\n");
+	}
 
 	return;
 }
 
+static int
+compareDoubles(const void *  a, const void *  b)
+{
+	double	x = *(const double *)a;
+	double	y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
 CommonConstantReturnType
-getCommandLineArguments(
-	int			argc,
-	char *			argv[],
-	CommandLineArguments *	arguments)
+printDistributionCodeOfSamples(const double *  samples, size_t numberOfSamples, const char *  unitsOfMeasurement)
 {
-	DemoOption		demoSpecificOptions = {0};
+	DistributionCode	code;
+	char			text[kDistributionCodeBase64Length + 1];
+	double *		sortedSamples;
 
-	if (arguments == NULL)
+	if (numberOfSamples == 0)
 	{
-		fprintf(stderr, "Arguments pointer is NULL.\n");
+		fprintf(stderr, "Error: There are no samples to encode.\n");
 
 		return kCommonConstantReturnTypeError;
 	}
 
-	setDefaultCommandLineArguments(arguments);
+	sortedSamples = (double *) checkedMalloc(numberOfSamples * sizeof(double), __FILE__, __LINE__);
+	memcpy(sortedSamples, samples, numberOfSamples * sizeof(double));
+	qsort(sortedSamples, numberOfSamples, sizeof(double), compareDoubles);
+	distributionCodeEncodeSortedSamples(&code, sortedSamples, numberOfSamples);
+	free(sortedSamples);
 
-	/*
-	 *	This application example has no application specific arguments.
-	 */
-	if (parseArgs(argc, argv, &arguments->common, &demoSpecificOptions) != 0)
+	distributionCodeToBase64(&code, text);
+	printf(
+		"\nDistribution code (%d bytes, %d quantiles): %s\n\tWasserstein error to the %zu samples: %.3g %s.\n",
+		kDistributionCodeSizeInBytes,
+		kDistributionCodeNumberOfQuantiles,
+		text,
+		numberOfSamples,
+		code.wassersteinError,
+		unitsOfMeasurement);
+
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+printDecodedDistributionCode(const DistributionCode *  code)
+{
+	printf(
+		"Distribution code: support [%.6g, %.6g], Wasserstein error %.3g, median %.6g.\n",
+		code->minimum,
+		code->maximum,
+		code->wassersteinError,
+		distributionCodeGetQuantile(code, 0.5));
+	for (size_t q = 0; q < kSurrogateTableNumberOfQuantiles; q++)
 	{
-		fprintf(stderr, "Parsing command line arguments failed\n");
-		printUsage();
+		printf("\t%s %.6g\n", kSurrogateTableQuantileKeys[q], distributionCodeGetQuantile(code, kSurrogateTableQuantileProbabilities[q]));
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+printCompressedSamples(const char *  filePath)
+{
+	SampleCompressionFileHeader	header;
+	double *			samples;
 
+	if (sampleCompressionReadFile(filePath, &header, &samples))
+	{
 		return kCommonConstantReturnTypeError;
 	}
 
-	/*
-	 *	Process command-line arguments
-	 */
-	if (arguments->common.isHelpEnabled)
+	printf("%" PRIu64 "\n", header.cpuTimeMicroseconds);
+	for (uint64_t i = 0; i < header.numberOfSamples; i++)
 	{
-		printUsage();
-
-		exit(EXIT_SUCCESS);
+		printf("%lf\n", samples[i]);
 	}
+	free(samples);
 
-	if (arguments->common.isInputFromFileEnabled)
+	return kCommonConstantReturnTypeSuccess;
+}
+
+void
+printIncrementalCacheColumns(const IncrementalCache *  cache)
+{
+	const char *	inputNames[kInputDistributionIndexMax] =
+			{
+				[kInputDistributionIndexVrh]		= "Vrh",
+				[kInputDistributionIndexVt]		= "Vt",
+				[kInputDistributionIndexVsupply]	= "Vsupply",
+			};
+	const char *	ratioNames[kInputDistributionIndexMax] =
+			{
+				[kInputDistributionIndexVrh]		= "Vrh / Vsupply",
+				[kInputDistributionIndexVt]		= "Vt / Vsupply",
+				[kInputDistributionIndexVsupply]	= "Vsupply / Vsupply",
+			};
+	const char **	names[kIncrementalCacheColumnKindMax] =
+			{
+				[kIncrementalCacheColumnKindInput]	= inputNames,
+				[kIncrementalCacheColumnKindRatio]	= (cache->model->transfer == kSensorModelTransferRatiometric) ? ratioNames : inputNames,
+				[kIncrementalCacheColumnKindOutput]	= kNDJSONOutputKeys,
+			};
+	const size_t	numberOfColumns[kIncrementalCacheColumnKindMax] =
+			{
+				[kIncrementalCacheColumnKindInput]	= kInputDistributionIndexMax,
+				[kIncrementalCacheColumnKindRatio]	= kInputDistributionIndexMax,
+				[kIncrementalCacheColumnKindOutput]	= kOutputDistributionIndexMax,
+			};
+	const char *	kindNames[kIncrementalCacheColumnKindMax] =
+			{
+				[kIncrementalCacheColumnKindInput]	= "input",
+				[kIncrementalCacheColumnKindRatio]	= "ratio",
+				[kIncrementalCacheColumnKindOutput]	= "output",
+			};
+
+	for (int isCached = 1; isCached >= 0; isCached--)
 	{
-		fprintf(stderr, "Reading inputs from CSV file is not currently supported\n");
+		size_t	numberOfPrintedColumns = 0;
 
-		return kCommonConstantReturnTypeError;
+		fprintf(stderr, "Incremental cache: %s", isCached ? "reusing" : "computing");
+		for (size_t kind = 0; kind < kIncrementalCacheColumnKindMax; kind++)
+		{
+			for (size_t index = 0; index < numberOfColumns[kind]; index++)
+			{
+				const IncrementalCacheColumn *	column = &cache->columns[kind][index];
+
+				if (column->isNeeded && (column->isCached == (bool)isCached))
+				{
+					fprintf(stderr, " [%s %s]", kindNames[kind], names[kind][index]);
+					numberOfPrintedColumns++;
+				}
+			}
+		}
+		fprintf(stderr, "%s\n", (numberOfPrintedColumns == 0) ? " no columns" : "");
+	}
+
+	return;
+}
+
+CommonConstantReturnType
+openBatchReadingTimeSeries(CommandLineArguments *  arguments, TimeSeriesWriter *  writer)
+{
+	size_t	lowerBound;
+	size_t	upperBound;
+	size_t	outputs[kTimeSeriesMaxColumns];
+	size_t	numberOfColumns = 0;
+	double	valueResolution = 0.0;
+
+	getSelectedOutputRange(arguments, &lowerBound, &upperBound);
+	for (size_t i = lowerBound; (i < upperBound) && (i < kSensorModelChannelMax); i++)
+	{
+		outputs[numberOfColumns++] = i;
 	}
 
 	/*
-	 *	Write to output file is not supported in MonteCarlo Mode.
+	 *	The largest power of two within twice the error bound, so that rounding to it is
+	 *	within the bound.
 	 */
-	if (arguments->common.isWriteToFileEnabled && arguments->common.isMonteCarloMode)
+	if (arguments->sampleCompressionErrorBound > 0)
 	{
-		fprintf(stderr, "Writing to output file is not supported in MonteCarlo Mode.\n");
+		valueResolution = exp2(floor(log2(2.0 * arguments->sampleCompressionErrorBound)));
+	}
 
+	return timeSeriesWriterOpen(writer, arguments->timeSeriesFilePath, outputs, numberOfColumns, valueResolution);
+}
+
+CommonConstantReturnType
+printTimeSeries(CommandLineArguments *  arguments)
+{
+	TimeSeriesReader	reader;
+	TimeSeriesRecord	record;
+	int64_t			fromTime = INT64_MIN;
+
+	if (timeSeriesReaderOpen(&reader, arguments->timeSeriesFilePath))
+	{
 		return kCommonConstantReturnTypeError;
 	}
 
-	/*
-	 *	If no output selected from CLA, set the print all value as default.
-	 */
-	if (!arguments->common.isOutputSelected)
+	for (size_t column = 0; column < reader.header.numberOfColumns; column++)
 	{
-		arguments->common.outputSelect = kOutputDistributionIndexMax;
+		if (reader.header.outputs[column] >= kOutputDistributionIndexMax)
+		{
+			fprintf(stderr, "Error: The time-series file \"%s\" has an unknown output.\n", arguments->timeSeriesFilePath);
+			timeSeriesReaderClose(&reader);
+
+			return kCommonConstantReturnTypeError;
+		}
 	}
 
-	/*
-	 *	If a single output is selected, we must be in benchmarking mode or Monte Carlo mode.
-	 */
-	if (arguments->common.outputSelect > kOutputDistributionIndexMax)
+	if (arguments->isTimeSeriesSeekEnabled)
 	{
-		fprintf(
-			stderr,
-			"Output select value (-S option) is greater than the possible number of outputs: Provided %zd. Max: %d\n",
-			arguments->common.outputSelect,
-			kOutputDistributionIndexMax);
+		fromTime = llround(arguments->timeSeriesSeekSeconds * kTimeSeriesTicksPerSecond);
+		if (timeSeriesReaderSeek(&reader, fromTime))
+		{
+			fprintf(stderr, "Error: Could not seek in the time-series file \"%s\".\n", arguments->timeSeriesFilePath);
+			timeSeriesReaderClose(&reader);
+
+			return kCommonConstantReturnTypeError;
+		}
 	}
+
+	printf("timestamp,sensorId");
+	for (size_t column = 0; column < reader.header.numberOfColumns; column++)
+	{
+		printf(",%s", kNDJSONOutputKeys[reader.header.outputs[column]]);
+	}
+	printf("\n");
+
 	/*
-	 *	When all outputs are selected, we cannot be in benchmarking mode or Monte Carlo mode.
+	 *	The block found by the seek may start with earlier records.
 	 */
-	else if (arguments->common.outputSelect == kOutputDistributionIndexMax)
+	while (timeSeriesReaderNext(&reader, &record))
 	{
-		if ((arguments->common.isBenchmarkingMode) || (arguments->common.isMonteCarloMode))
+		if (record.time < fromTime)
 		{
-			fprintf(stderr, "Error: Please select a single output when in benchmarking mode or Monte Carlo mode.\n");
+			continue;
+		}
 
-			return kCommonConstantReturnTypeError;
+		printf("%.3f,%" PRIu32, (double)record.time / kTimeSeriesTicksPerSecond, record.sensorId);
+		for (size_t column = 0; column < reader.header.numberOfColumns; column++)
+		{
+			printf(",%.17g", record.values[column]);
 		}
+		printf("\n");
+	}
+	timeSeriesReaderClose(&reader);
+
+	if (reader.hasError)
+	{
+		fprintf(stderr, "Error: The time-series file \"%s\" is corrupted.\n", arguments->timeSeriesFilePath);
+
+		return kCommonConstantReturnTypeError;
 	}
 
 	return kCommonConstantReturnTypeSuccess;
 }
 
+void
+printOutOfCoreSummary(const OutOfCoreSummary *  summary, const char *  unitsOfMeasurement)
+{
+	printf(
+		"\nOut-of-core samples: %" PRIu64 " in %zu sorted runs, merged into %s, support [%.6g, %.6g] %s.\n",
+		summary->numberOfSamples,
+		summary->numberOfRuns,
+		summary->sortedFilePath,
+		summary->minimum,
+		summary->maximum,
+		unitsOfMeasurement);
+	printf("\tExact quantiles:");
+	for (size_t q = 0; q < kOutOfCoreNumberOfQuantiles; q++)
+	{
+		printf(" %s %.6g", kOutOfCoreQuantileKeys[q], summary->quantile[q]);
+	}
+	printf("\n\tEmpirical distribution function:");
+	for (size_t k = 0; k < kOutOfCoreNumberOfECDFPoints; k++)
+	{
+		printf(" F(%.6g) = %.6f", summary->ecdfValue[k], summary->ecdf[k]);
+	}
+	printf("\n");
+
+	if (summary->hasReference)
+	{
+		printf(
+			"\tWasserstein distance to the %" PRIu64 " reference samples: %.6g %s.\n",
+			summary->numberOfReferenceSamples,
+			summary->wassersteinDistance,
+			unitsOfMeasurement);
+	}
+
+	return;
+}
+
+void
+printPolynomialChaosSummary(
+	const PolynomialChaosExpansion *	expansion,
+	const char **				outputVariableDescriptions,
+	const char **				unitsOfMeasurement)
+{
+	const char *	inputNames[kInputDistributionIndexMax] =
+			{
+				[kInputDistributionIndexVrh]		= "Vrh",
+				[kInputDistributionIndexVt]		= "Vt",
+				[kInputDistributionIndexVsupply]	= "Vsupply",
+			};
+
+	printf(
+		"\nPolynomial chaos expansion: order %zu, %zu terms, %zu model evaluations.\n",
+		expansion->order,
+		expansion->numberOfTerms,
+		expansion->numberOfModelEvaluations);
+
+	for (size_t output = expansion->lowerOutput; output < expansion->upperOutput; output++)
+	{
+		double	mean;
+		double	variance;
+		double	firstOrder[kInputDistributionIndexMax];
+		double	total[kInputDistributionIndexMax];
+
+		polynomialChaosGetMoments(expansion, output, &mean, &variance);
+		polynomialChaosGetSobolIndices(expansion, output, firstOrder, total);
+
+		printf(
+			"\t%s: mean %.6lf %s, standard deviation %.6lf %s, %zu active terms.\n",
+			outputVariableDescriptions[output],
+			mean,
+			unitsOfMeasurement[output],
+			sqrt(variance),
+			unitsOfMeasurement[output],
+			expansion->numberOfActiveTerms[output]);
+		printf("\t\tSobol indices (first order / total):");
+		for (size_t d = 0; d < kInputDistributionIndexMax; d++)
+		{
+			printf(" %s %.4lf / %.4lf%s", inputNames[d], firstOrder[d], total[d], (d + 1 < kInputDistributionIndexMax) ? "," : "\n");
+		}
+	}
+
+	return;
+}
+
 void
 printCalibratedValueAndProbabilities(double calibratedSensorOutput, const char *  variableDescription, const char *  unitsOfMeasurement)
 {
@@ -231,6 +2101,7 @@ void
 printJSONFormattedOutput(
 	CommandLineArguments *	arguments,
 	double *		monteCarloOutputSamples,
+	size_t			numberOfMonteCarloOutputSamples,
 	double *		outputDistributions,
 	const char **		outputVariableDescriptions)
 {
@@ -252,19 +2123,21 @@ printJSONFormattedOutput(
 	for (OutputDistributionIndex outputSelect = outputSelectLowerBound; outputSelect < outputSelectUpperBound; outputSelect++)
 	{
 		/*
-		 *	If in Monte Carlo mode, `pointerToOutputVariable` points to the beginning of the `monteCarloOutputSamples` array.
-		 *	In this case, `arguments.common.numberOfMonteCarloIterations` is the length of the `monteCarloOutputSamples` array.
-		 *	Else, it points to the entry of the `outputVariables` to be used.
-		 *	In this case, `arguments.common.numberOfMonteCarloIterations` equals 1.
+		 *	If there are Monte Carlo samples, `pointerToOutputVariable` points to the column of this output in the
+		 *	`monteCarloOutputSamples` array. In this case, `numberOfMonteCarloOutputSamples` is the length of each column
+		 *	(the number of iterations, or the reservoir size when a reservoir is used).
+		 *	Else, it points to the entry of the `outputVariables` to be used. In this case, the length is 1.
 		 */
-		double *	pointerToOutputVariable = arguments->common.isMonteCarloMode ? monteCarloOutputSamples : &outputDistributions[outputSelect];
+		double *	pointerToOutputVariable = (monteCarloOutputSamples != NULL)
+							? &monteCarloOutputSamples[(outputSelect - outputSelectLowerBound) * numberOfMonteCarloOutputSamples]
+							: &outputDistributions[outputSelect];
 
 		populateJSONVariableStruct(
 			&jsonVariables[outputSelect],
 			pointerToOutputVariable,
 			outputVariableDescriptions[outputSelect],
 			outputSelect,
-			arguments->common.numberOfMonteCarloIterations);
+			(monteCarloOutputSamples != NULL) ? numberOfMonteCarloOutputSamples : 1);
 	}
 
 	printJSONVariables(
@@ -274,3 +2147,148 @@ printJSONFormattedOutput(
 
 	return;
 }
+
+CommonConstantReturnType
+writeOutputsToArrowIPCFile(
+	CommandLineArguments *	arguments,
+	double *		monteCarloOutputSamples,
+	size_t			numberOfMonteCarloOutputSamples,
+	double *		outputDistributions,
+	const char **		outputVariableDescriptions,
+	uint64_t		cpuTimeUsedMicroseconds)
+{
+	const double *		columns[kOutputDistributionIndexMax];
+	const char *		columnNames[kOutputDistributionIndexMax];
+	size_t			numberOfColumns = 0;
+	char			outputSelectString[32];
+	char			numberOfSamplesString[32];
+	char			numberOfRowsString[32];
+	size_t			numberOfRows = (monteCarloOutputSamples != NULL) ? numberOfMonteCarloOutputSamples : 1;
+	char			cpuTimeString[32];
+	char			correlationString[96];
+	ArrowIPCMetadataEntry	metadata[] =
+				{
+					{ .key = "application",		.value = "SHT4xARP Sensor Calibration Use Case" },
+					{ .key = "outputSelect",	.value = outputSelectString },
+					{ .key = "numberOfSamples",	.value = numberOfSamplesString },
+					{ .key = "numberOfRows",	.value = numberOfRowsString },
+					{ .key = "isMonteCarloMode",	.value = arguments->common.isMonteCarloMode ? "true" : "false" },
+					{ .key = "inputCorrelation",	.value = correlationString },
+					{ .key = "cpuTimeMicroseconds",	.value = cpuTimeString },
+				};
+	size_t			numberOfMetadataEntries = sizeof(metadata) / sizeof(metadata[0]);
+
+	snprintf(outputSelectString, sizeof(outputSelectString), "%zu", arguments->common.outputSelect);
+	snprintf(numberOfSamplesString, sizeof(numberOfSamplesString), "%zu", arguments->common.numberOfMonteCarloIterations);
+	snprintf(numberOfRowsString, sizeof(numberOfRowsString), "%zu", numberOfRows);
+	snprintf(cpuTimeString, sizeof(cpuTimeString), "%" PRIu64, cpuTimeUsedMicroseconds);
+	snprintf(
+		correlationString,
+		sizeof(correlationString),
+		"%.17g,%.17g,%.17g",
+		arguments->inputCorrelationMatrix[kInputDistributionIndexVrh][kInputDistributionIndexVt],
+		arguments->inputCorrelationMatrix[kInputDistributionIndexVrh][kInputDistributionIndexVsupply],
+		arguments->inputCorrelationMatrix[kInputDistributionIndexVt][kInputDistributionIndexVsupply]);
+
+	/*
+	 *	Without timing there is no meaningful CPU time to record, so drop the last entry.
+	 */
+	if (!(arguments->common.isTimingEnabled || arguments->common.isBenchmarkingMode))
+	{
+		numberOfMetadataEntries--;
+	}
+
+	for (size_t outputSelect = 0; outputSelect < kOutputDistributionIndexMax; outputSelect++)
+	{
+		if ((arguments->common.outputSelect != kOutputDistributionIndexMax) && (arguments->common.outputSelect != outputSelect))
+		{
+			continue;
+		}
+
+		/*
+		 *	As in `printJSONFormattedOutput()`, the samples of each selected output are one column of `monteCarloOutputSamples`.
+		 */
+		columns[numberOfColumns] = (monteCarloOutputSamples != NULL)
+						? &monteCarloOutputSamples[numberOfColumns * numberOfMonteCarloOutputSamples]
+						: &outputDistributions[outputSelect];
+		columnNames[numberOfColumns] = outputVariableDescriptions[outputSelect];
+		numberOfColumns++;
+	}
+
+	return writeDoubleColumnsToArrowIPCFile(
+			arguments->arrowOutputFilePath,
+			columns,
+			columnNames,
+			numberOfColumns,
+			numberOfRows,
+			metadata,
+			numberOfMetadataEntries);
+}
+
+void
+printJointOutputStatistics(
+	const StreamingCovariance *	covariance,
+	const Histogram2D *		histogram,
+	const char **			outputVariableDescriptions,
+	const char **			unitsOfMeasurement)
+{
+	printf("\nJoint statistics of %" PRIu64 " Monte Carlo samples:\n", covariance->count);
+
+	printf("\n\tMean and standard deviation:\n");
+	for (size_t i = 0; i < covariance->dimension; i++)
+	{
+		printf(
+			"\t\t%-40s %12.6lf +/- %.6lf %s\n",
+			outputVariableDescriptions[i],
+			covariance->mean[i],
+			sqrt(streamingCovarianceGet(covariance, i, i)),
+			unitsOfMeasurement[i]);
+	}
+
+	printf("\n\tCovariance matrix:\n");
+	for (size_t i = 0; i < covariance->dimension; i++)
+	{
+		printf("\t\t");
+		for (size_t j = 0; j < covariance->dimension; j++)
+		{
+			printf("%14.6lf", streamingCovarianceGet(covariance, i, j));
+		}
+		printf("\n");
+	}
+
+	printf("\n\tCorrelation matrix:\n");
+	for (size_t i = 0; i < covariance->dimension; i++)
+	{
+		printf("\t\t");
+		for (size_t j = 0; j < covariance->dimension; j++)
+		{
+			double	denominator = sqrt(streamingCovarianceGet(covariance, i, i) * streamingCovarianceGet(covariance, j, j));
+
+			printf("%10.6lf", (denominator > 0.0) ? streamingCovarianceGet(covariance, i, j) / denominator : 0.0);
+		}
+		printf("\n");
+	}
+
+	printf(
+		"\n\t2-D histogram of (%s, %s): %d x %d bins over [%.4lf, %.4lf] x [%.4lf, %.4lf].\n",
+		outputVariableDescriptions[kOutputDistributionIndexCalibratedRelativeHumidity],
+		outputVariableDescriptions[kOutputDistributionIndexCalibratedTemperatureCelcius],
+		kHistogram2DNumberOfBins,
+		kHistogram2DNumberOfBins,
+		histogram->lowerBound[0],
+		histogram->upperBound[0],
+		histogram->lowerBound[1],
+		histogram->upperBound[1]);
+	printf("\tEach row is a humidity bin; each column is a temperature bin.\n");
+	for (size_t i = 0; i < kHistogram2DNumberOfBins; i++)
+	{
+		printf("\t\t");
+		for (size_t j = 0; j < kHistogram2DNumberOfBins; j++)
+		{
+			printf("%s%" PRIu64, (j == 0) ? "" : ",", histogram->counts[i][j]);
+		}
+		printf("\n");
+	}
+
+	return;
+}
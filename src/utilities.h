@@ -22,14 +22,105 @@
 
 #pragma once
 
+#include "batch-engine.h"
 #include "common.h"
+#include "distribution-code.h"
+#include "incremental-cache.h"
+#include "division.h"
+#include "kalman-filter.h"
+#include "ndjson.h"
+#include "out-of-core.h"
+#include "sample-compression.h"
+#include "polynomial-chaos.h"
+#include "streaming-statistics.h"
+#include "surrogate-table.h"
+#include "time-series.h"
+#include "progress-snapshot.h"
+#include "sensor-model.h"
 #include "utilities-config.h"
 
 typedef struct
 {
 	CommonCommandLineArguments	common;
+	bool				isInputCorrelationEnabled;
+	double				inputCorrelationMatrix[kInputDistributionIndexMax][kInputDistributionIndexMax];
+	bool				isArrowOutputEnabled;
+	char				arrowOutputFilePath[kCommonConstantMaxCharsPerFilepath];
+	bool				isNDJSONOutputEnabled;
+	char				ndjsonOutputFilePath[kCommonConstantMaxCharsPerFilepath];
+	size_t				ndjsonBatchSize;
+	size_t				reservoirCapacity;
+	bool				isTraceEnabled;
+	char				traceFilePath[kCommonConstantMaxCharsPerFilepath];
+	size_t				traceSamplingInterval;
+	size_t				numberOfThreads;
+	DivisionAccuracyTier		divisionAccuracyTier;
+	const SensorModel *		sensorModel;
+	bool				isUnorderedOutputEnabled;
+	bool				isRandomPoolGenerationEnabled;
+	bool				isRandomPoolEnabled;
+	char				randomPoolFilePath[kCommonConstantMaxCharsPerFilepath];
+	size_t				randomPoolNumberOfValues;
+	uint64_t			randomPoolRegionSeed;
+	bool				isSurrogateTableBuildEnabled;
+	bool				isSurrogateTableEnabled;
+	char				surrogateTableFilePath[kCommonConstantMaxCharsPerFilepath];
+	size_t				polynomialChaosOrder;
+	size_t				latencyTargetMilliseconds;
+	bool				isProgressPublicationEnabled;
+	bool				isProgressShowEnabled;
+	char				progressFilePath[kCommonConstantMaxCharsPerFilepath];
+	size_t				progressIntervalMilliseconds;
+	bool				isMetricsOutputEnabled;
+	char				metricsFilePath[kCommonConstantMaxCharsPerFilepath];
+	bool				isDistributionCodeEnabled;
+	bool				isDistributionCodeDecodeEnabled;
+	char				distributionCodeText[kDistributionCodeBase64Length + 1];
+	bool				isKalmanFilterEnabled;
+	double				kalmanFilterProcessNoiseVariance[kSensorModelChannelMax];
+	bool				isOutOfCoreEnabled;
+	char				outOfCoreDirectoryPath[kCommonConstantMaxCharsPerFilepath];
+	bool				isWassersteinReferenceEnabled;
+	char				wassersteinReferenceFilePath[kCommonConstantMaxCharsPerFilepath];
+	bool				isSampleCompressionEnabled;
+	bool				isSampleDecompressionEnabled;
+	char				compressedSamplesFilePath[kCommonConstantMaxCharsPerFilepath];
+	double				sampleCompressionErrorBound;
+	bool				isTimeSeriesOutputEnabled;
+	bool				isTimeSeriesPrintEnabled;
+	char				timeSeriesFilePath[kCommonConstantMaxCharsPerFilepath];
+	bool				isTimeSeriesSeekEnabled;
+	double				timeSeriesSeekSeconds;
+	double				inputLowerBound[kInputDistributionIndexMax];
+	double				inputUpperBound[kInputDistributionIndexMax];
+	bool				isIncrementalCacheEnabled;
+	char				incrementalCacheDirectoryPath[kIncrementalCacheMaxCharsPerDirectoryPath];
 } CommandLineArguments;
 
+/*
+ *	Running summary of the readings of one NDJSON batch. `sumOfSquaredDeviations` is
+ *	accumulated with Welford's algorithm.
+ */
+typedef struct
+{
+	size_t	numberOfReadings;
+	double	mean[kOutputDistributionIndexMax];
+	double	sumOfSquaredDeviations[kOutputDistributionIndexMax];
+	double	minimum[kOutputDistributionIndexMax];
+	double	maximum[kOutputDistributionIndexMax];
+} NDJSONBatchSummary;
+
+/*
+ *	Gaussian copula used to draw correlated input samples. `choleskyFactor` is the
+ *	lower-triangular factor `L` of the input correlation matrix, such that `L * L^T`
+ *	equals the matrix. It is computed once at startup.
+ */
+typedef struct
+{
+	bool	isEnabled;
+	double	choleskyFactor[kInputDistributionIndexMax][kInputDistributionIndexMax];
+} InputCorrelation;
+
 /**
  *	@brief	Print out command line usage.
  */
@@ -46,6 +137,16 @@ void	printUsage(void);
  */
 CommonConstantReturnType getCommandLineArguments(int argc, char *  argv[], CommandLineArguments *  arguments);
 
+/**
+ *	@brief	Computes the Cholesky factor of the input correlation matrix given on the command line.
+ *
+ *	@param	arguments		: Pointer to command line arguments struct.
+ *	@param	inputCorrelation	: Pointer to the struct where the Cholesky factor is written.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else
+ *					  `kCommonConstantReturnTypeError` if the matrix is not positive definite.
+ */
+CommonConstantReturnType setInputCorrelation(CommandLineArguments *  arguments, InputCorrelation *  inputCorrelation);
+
 /**
  *	@brief  Prints the output of the evaluation in a human-readable form.
  *
@@ -76,12 +177,253 @@ void	populateJSONVariableStruct(
  *		a single value or all values stored in `outputDistributions`.
  *
  *	@param  arguments			: The command-line arguments, specifying which outputs will be printed.
- *	@param  monteCarloOutputSamples		: The array of data samples of Monte Carlo.
+ *	@param  monteCarloOutputSamples		: The array of data samples of Monte Carlo, one column per selected output, or `NULL`.
+ *	@param  numberOfMonteCarloOutputSamples	: The number of samples in each column of `monteCarloOutputSamples`.
  *	@param  outputDistributions 		: The array that stores the distributions to be printed.
  *	@param  outputVariableDescriptions	: An array of strings containing the descriptions of the variables to be printed.
  */
 void	printJSONFormattedOutput(
 		CommandLineArguments *	arguments,
 		double *		monteCarloOutputSamples,
+		size_t			numberOfMonteCarloOutputSamples,
 		double *		outputDistributions,
 		const char **		outputVariableDescriptions);
+
+/**
+ *	@brief  Writes the output distributions to an Arrow IPC (Feather V2) file, with one `float64`
+ *		column per selected output and the run parameters as schema metadata. In Monte Carlo
+ *		mode the column holds the output samples, else it holds the single output value.
+ *
+ *	@param  arguments			: The command-line arguments, specifying which outputs will be written.
+ *	@param  monteCarloOutputSamples		: The array of data samples of Monte Carlo, one column per selected output, or `NULL`.
+ *	@param  numberOfMonteCarloOutputSamples	: The number of samples in each column of `monteCarloOutputSamples`.
+ *	@param  outputDistributions 		: The array that stores the distributions to be written.
+ *	@param  outputVariableDescriptions	: An array of strings containing the descriptions of the variables, used as column names.
+ *	@param  cpuTimeUsedMicroseconds		: The CPU time of the run, stored in the metadata.
+ *	@return					: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	writeOutputsToArrowIPCFile(
+					CommandLineArguments *	arguments,
+					double *		monteCarloOutputSamples,
+					size_t			numberOfMonteCarloOutputSamples,
+					double *		outputDistributions,
+					const char **		outputVariableDescriptions,
+					uint64_t		cpuTimeUsedMicroseconds);
+
+/**
+ *	@brief  Writes one NDJSON record with the selected outputs of a single converted reading.
+ *
+ *	@param  writer			: Pointer to the open NDJSON writer.
+ *	@param  arguments		: The command-line arguments, specifying which outputs are written.
+ *	@param  readingIndex		: The index of the reading (Monte Carlo iteration).
+ *	@param  outputDistributions	: The array of outputs of the reading.
+ */
+void	writeNDJSONReadingRecord(
+		NDJSONWriter *		writer,
+		CommandLineArguments *	arguments,
+		size_t			readingIndex,
+		double *		outputDistributions);
+
+/**
+ *	@brief  Adds the selected outputs of a converted reading to a batch summary. Once the batch
+ *		holds `arguments->ndjsonBatchSize` readings, writes it as one NDJSON record, flushes
+ *		the writer, and resets the summary.
+ *
+ *	@param  writer			: Pointer to the open NDJSON writer.
+ *	@param  arguments		: The command-line arguments, specifying which outputs are summarized.
+ *	@param  batchSummary		: Pointer to the summary of the current batch. Must be zero-initialized before the first reading.
+ *	@param  batchIndex		: Pointer to the index of the current batch. Incremented when the batch is written.
+ *	@param  outputDistributions	: The array of outputs of the reading. `NULL` writes out a partially-filled batch.
+ */
+void	accumulateNDJSONBatchSummary(
+		NDJSONWriter *		writer,
+		CommandLineArguments *	arguments,
+		NDJSONBatchSummary *	batchSummary,
+		size_t *		batchIndex,
+		double *		outputDistributions);
+
+/**
+ *	@brief  Prints the joint statistics of all outputs accumulated in Monte Carlo mode: means,
+ *		standard deviations, the covariance and correlation matrices, and the 2-D histogram
+ *		of the calibrated relative humidity and temperature in Celsius.
+ *
+ *	@param  covariance			: Pointer to the streaming covariance of all outputs.
+ *	@param  histogram			: Pointer to the 2-D histogram of (humidity, temperature in Celsius).
+ *	@param  outputVariableDescriptions	: An array of strings containing the descriptions of the outputs.
+ *	@param  unitsOfMeasurement		: An array of strings containing the units of measurement of the outputs.
+ */
+void	printJointOutputStatistics(
+		const StreamingCovariance *	covariance,
+		const Histogram2D *		histogram,
+		const char **			outputVariableDescriptions,
+		const char **			unitsOfMeasurement);
+
+/**
+ *	@brief  Prints the moments and Sobol sensitivity indices of the outputs of a polynomial chaos
+ *		expansion, which follow from its coefficients.
+ *
+ *	@param  expansion			: Pointer to the fitted expansion.
+ *	@param  outputVariableDescriptions	: An array of strings containing the descriptions of the outputs.
+ *	@param  unitsOfMeasurement		: An array of strings containing the units of measurement of the outputs.
+ */
+void	printPolynomialChaosSummary(
+		const PolynomialChaosExpansion *	expansion,
+		const char **				outputVariableDescriptions,
+		const char **				unitsOfMeasurement);
+
+/**
+ *	@brief  Encodes Monte Carlo samples as a distribution code and prints its base64 text and
+ *		its Wasserstein error to the samples.
+ *
+ *	@param  samples			: The samples, which are left unchanged.
+ *	@param  numberOfSamples		: The number of samples.
+ *	@param  unitsOfMeasurement	: The units of measurement of the samples.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	printDistributionCodeOfSamples(const double *  samples, size_t numberOfSamples, const char *  unitsOfMeasurement);
+
+/**
+ *	@brief  Prints the support, Wasserstein error and quantiles of a decoded distribution code.
+ *
+ *	@param  code	: Pointer to the code.
+ */
+void	printDecodedDistributionCode(const DistributionCode *  code);
+
+/**
+ *	@brief  Prints the exact quantiles and empirical distribution function of the samples of an
+ *		out-of-core run, and their Wasserstein distance to the reference samples, if any.
+ *
+ *	@param  summary			: Pointer to the summary of the merge.
+ *	@param  unitsOfMeasurement	: The units of measurement of the samples.
+ */
+void	printOutOfCoreSummary(const OutOfCoreSummary *  summary, const char *  unitsOfMeasurement);
+
+/**
+ *	@brief  Decompresses a compressed sample file and prints it in the format of `data.out`:
+ *		the CPU time of the run in microseconds, then one sample per line.
+ *
+ *	@param  filePath	: Path of the compressed sample file.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	printCompressedSamples(const char *  filePath);
+
+/**
+ *	@brief  Prints, on the standard error, which columns of a run the incremental cache holds
+ *		and which the run computes.
+ *
+ *	@param  cache	: Pointer to the opened incremental cache.
+ */
+void	printIncrementalCacheColumns(const IncrementalCache *  cache);
+
+/**
+ *	@brief  Opens the time-series file of batch mode, with one column for the mean of each
+ *		selected calibrated output, rounded to a power of two within the error bound of `-e`.
+ *
+ *	@param  arguments	: The command-line arguments, specifying the file and the outputs.
+ *	@param  writer		: Pointer to the time-series writer to open.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	openBatchReadingTimeSeries(CommandLineArguments *  arguments, TimeSeriesWriter *  writer);
+
+/**
+ *	@brief  Prints the records of a time-series file as CSV, from the first record at or after
+ *		the seek time of `-u`, if any.
+ *
+ *	@param  arguments	: The command-line arguments, specifying the file and the seek time.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	printTimeSeries(CommandLineArguments *  arguments);
+
+/**
+ *	@brief  Prints a progress snapshot of a Monte Carlo run: the samples so far and, for each
+ *		tracked output, its mean, standard deviation, the standard error of the mean and
+ *		the streaming quantiles.
+ *
+ *	@param  snapshot			: Pointer to the snapshot.
+ *	@param  outputVariableDescriptions	: An array of strings containing the descriptions of the outputs.
+ *	@param  unitsOfMeasurement		: An array of strings containing the units of measurement of the outputs.
+ */
+void	printProgressSnapshot(
+		const ProgressSnapshot *	snapshot,
+		const char **			outputVariableDescriptions,
+		const char **			unitsOfMeasurement);
+
+/**
+ *	@brief  Parses one line of the CSV input of batch mode, `Vrh,Vt,Vsupply[,timestamp[,sensorId]]`.
+ *		Each input is uniformly distributed around the value read, with the width of its
+ *		default input distribution. The sequence number of the reading is set to zero.
+ *
+ *	@param  line		: The line, terminated by a newline or a null character.
+ *	@param  reading		: Pointer where the reading is returned.
+ *	@param  isReading	: Pointer where `false` is returned for a line that does not start with a number, such as a header.
+ *	@return			: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`
+ *				  if the line has fewer than three values.
+ */
+CommonConstantReturnType	parseBatchReadingFromCSVLine(const char *  line, BatchReading *  reading, bool *  isReading);
+
+/**
+ *	@brief  Reads the readings of batch mode from a CSV file with one reading per line, as
+ *		`Vrh,Vt,Vsupply[,timestamp[,sensorId]]`. Lines that do not start with a number, such
+ *		as a header, are skipped. Each input is uniformly distributed around the value read,
+ *		with the width of its default input distribution. Large files are parsed by several
+ *		threads, and the readings are numbered in file order.
+ *
+ *	@param  filePath		: Path of the CSV file to read.
+ *	@param  numberOfThreads		: The most threads to parse with.
+ *	@param  readings		: Pointer where the dynamically-allocated array of readings is returned. Free with `free()`.
+ *	@param  numberOfReadings	: Pointer where the number of readings is returned.
+ *	@return				: `kCommonConstantReturnTypeSuccess` if successful, else `kCommonConstantReturnTypeError`.
+ */
+CommonConstantReturnType	readBatchReadingsFromCSVFile(
+					const char *		filePath,
+					size_t			numberOfThreads,
+					BatchReading **		readings,
+					size_t *		numberOfReadings);
+
+/**
+ *	@brief  Gets the half-open range of the outputs selected with -S.
+ *
+ *	@param  arguments	: The command-line arguments.
+ *	@param  lowerBound	: Pointer where the first selected output is returned.
+ *	@param  upperBound	: Pointer where one past the last selected output is returned.
+ */
+void	getSelectedOutputRange(CommandLineArguments *  arguments, size_t *  lowerBound, size_t *  upperBound);
+
+/**
+ *	@brief  Writes the CSV header line of the per-reading summaries of batch mode to the
+ *		standard output.
+ *
+ *	@param  arguments		: The command-line arguments, specifying which outputs are written.
+ *	@param  hasQuantiles		: Whether the summaries carry surrogate table quantiles.
+ */
+void	writeBatchReadingSummariesHeader(CommandLineArguments *  arguments, bool hasQuantiles);
+
+/**
+ *	@brief  Writes the per-reading summaries of batch mode, with the selected outputs of each
+ *		reading. Writes one NDJSON record per reading if `writer` is not `NULL`, else writes
+ *		CSV lines, without the header, to the standard output. With a surrogate table, readings
+ *		answered from the table have zero samples and also carry their quantiles and error
+ *		bounds. With a latency target, each output also carries the standard error of its mean.
+ *		With a bank of filters, each reading updates the filters of its sensor, and each
+ *		calibrated output also carries the posterior mean and variance of its sensor.
+ *		With a time-series writer, the means of the calibrated outputs of each reading are
+ *		also appended to the time series.
+ *
+ *	@param  writer			: Pointer to the open NDJSON writer, or `NULL` for CSV output.
+ *	@param  arguments		: The command-line arguments, specifying which outputs are written.
+ *	@param  readings		: Array of readings.
+ *	@param  summaries		: Array of the summaries of the readings.
+ *	@param  quantiles		: Array of the surrogate table quantiles of the readings, or `NULL` without a surrogate table.
+ *	@param  filterBank		: Pointer to the bank of filters of the sensors, or `NULL` without filtering.
+ *	@param  timeSeries		: Pointer to the open time-series writer, or `NULL` without a time series.
+ *	@param  numberOfReadings	: The number of readings.
+ */
+void	writeBatchReadingSummaries(
+		NDJSONWriter *			writer,
+		CommandLineArguments *		arguments,
+		const BatchReading *		readings,
+		const BatchReadingSummary *	summaries,
+		const SurrogateTableQuantiles *	quantiles,
+		KalmanFilterBank *		filterBank,
+		TimeSeriesWriter *		timeSeries,
+		size_t				numberOfReadings);